@@ -52,8 +52,6 @@ int main()
 
 		double Mflops = (N-2)*(N-2)*(N-2) * 11.0 * niters / 1.0e+6;
 
-    generateFastTraversalOrder(TinyVector<int,2>(N-2,N-2));
-
     timer.start();
     check = acoustic3D_BlitzRaw(N, niters);
     timer.stop();
@@ -0,0 +1,39 @@
+// Tuning file generator
+//
+//   autotune [FILE]
+//
+// measures the tile sizes and thresholds of this machine with
+// autoTune() (see blitz/autotune.h), printing the timings, and writes
+// them to FILE, by default the tuning file of this machine read by
+// TuningParameters::instance().  Run it with the number of threads
+// the programs will use.
+
+#include <blitz/array.h>
+#include <blitz/autotune.h>
+
+#include <iostream>
+#include <string>
+
+BZ_USING_NAMESPACE(blitz)
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    const string file = (argc > 1) ? string(argv[1])
+        : TuningParameters::defaultFile();
+    if (file.empty())
+    {
+        cerr << "autotune: no file given, and HOME is not set" << endl;
+        return 1;
+    }
+
+    autoTune(&cout);
+
+    if (!TuningParameters::instance().save(file))
+    {
+        cerr << "autotune: cannot write " << file << endl;
+        return 1;
+    }
+    cout << "Wrote " << file << endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+// 3D stencil traversal benchmark
+//
+// Evaluates a 7-point stencil on N^3 arrays with the stack traversal,
+// plane by plane with the tiled 2D traversal, and in tiles visited in
+// storage, Morton and Hilbert order (see blitz/traversal.h).  The
+// traversal is forced through TuningParameters.  Where the hardware
+// counters can be read, the last-level cache misses of each traversal
+// give the memory traffic it actually caused (see saveCSV).
+
+#include <blitz/array.h>
+#include <blitz/benchext.h>
+#include <blitz/rand-uniform.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+const sizeType never = ~sizeType(0);
+
+void initializeRandomDouble(double* data, int numElements)
+{
+    static Random<Uniform> rnd;
+
+    for (int i=0; i < numElements; ++i)
+        data[i] = rnd.random();
+}
+
+void stencil3D(BenchmarkExt<int>& bench, const char* description,
+    bool curve, TileOrder order)
+{
+    TuningParameters& params = TuningParameters::instance();
+    const sizeType curveCache = params.curveStencilCache();
+    params.setCurveStencilCache(curve ? 0 : never);
+    params.setCurveTile(params.curveTileSize(), order);
+
+    bench.beginImplementation(description);
+
+    while (!bench.doneImplementationBenchmark())
+    {
+        int N = bench.getParameter();
+        cout << description << ": N = " << N << endl;
+
+        long iters = bench.getIterations();
+
+        Array<double,3> A(N,N,N), B(N,N,N);
+        initializeRandomDouble(A.data(), N*N*N);
+        initializeRandomDouble(B.data(), N*N*N);
+        double c = 1/7.;
+        Range I(1,N-2), J(1,N-2), K(1,N-2);
+
+        bench.start();
+        for (long i=0; i < iters; ++i)
+        {
+            A(I,J,K) = c * (B(I,J,K) + B(I+1,J,K) + B(I-1,J,K) + B(I,J+1,K)
+                + B(I,J-1,K) + B(I,J,K+1) + B(I,J,K-1));
+            B(I,J,K) = c * (A(I,J,K) + A(I+1,J,K) + A(I-1,J,K) + A(I,J+1,K)
+                + A(I,J-1,K) + A(I,J,K+1) + A(I,J,K-1));
+        }
+        bench.stop();
+    }
+
+    bench.endImplementation();
+    params.setCurveStencilCache(curveCache);
+}
+
+// Each plane of the result is a 2D stencil with 7 operands
+void stencil2DPlanes(BenchmarkExt<int>& bench)
+{
+    TuningParameters& params = TuningParameters::instance();
+    const sizeType tiledCache = params.tiledStencilCache();
+    params.setTiledStencilCache(0);
+
+    bench.beginImplementation("Tiled 2D planes");
+
+    while (!bench.doneImplementationBenchmark())
+    {
+        int N = bench.getParameter();
+        cout << "Tiled 2D planes: N = " << N << endl;
+
+        long iters = bench.getIterations();
+
+        Array<double,3> A(N,N,N), B(N,N,N);
+        initializeRandomDouble(A.data(), N*N*N);
+        initializeRandomDouble(B.data(), N*N*N);
+        double c = 1/7.;
+        Range J(1,N-2), K(1,N-2);
+
+        bench.start();
+        for (long i=0; i < iters; ++i)
+        {
+            for (int p=1; p < N-1; ++p)
+                A(p,J,K) = c * (B(p,J,K) + B(p+1,J,K) + B(p-1,J,K)
+                    + B(p,J+1,K) + B(p,J-1,K) + B(p,J,K+1) + B(p,J,K-1));
+            for (int p=1; p < N-1; ++p)
+                B(p,J,K) = c * (A(p,J,K) + A(p+1,J,K) + A(p-1,J,K)
+                    + A(p,J+1,K) + A(p,J-1,K) + A(p,J,K+1) + A(p,J,K-1));
+        }
+        bench.stop();
+    }
+
+    bench.endImplementation();
+    params.setTiledStencilCache(tiledCache);
+}
+
+int main()
+{
+    BenchmarkExt<int> bench("3D stencil traversals", 5);
+
+    const int numSizes = 8;
+
+    bench.setNumParameters(numSizes);
+    bench.setRateDescription("Mflops/s");
+
+    Vector<int> parameters(numSizes);
+    Vector<long> iters(numSizes);
+    Vector<double> flops(numSizes);
+    Vector<double> bytes(numSizes);
+
+    for (int i=0; i < numSizes; ++i)
+    {
+        parameters[i] = (i+1) * 32;
+        iters[i] = 256 / (i+1) / (i+1) / (i+1);
+        if (iters[i] < 2)
+            iters[i] = 2;
+        double npoints = parameters[i] - 2;
+        flops[i] = npoints * npoints * npoints * 7 * 2;
+        bytes[i] = 2 * sizeof(double) * npoints * npoints * npoints * 2;
+    }
+
+    bench.setParameterVector(parameters);
+    bench.setIterations(iters);
+    bench.setFlopsPerIteration(flops);
+    bench.setBytesPerIteration(bytes);
+    if (!bench.enableCounters())
+        cout << "Hardware counters not available" << endl;
+
+    bench.beginBenchmarking();
+    stencil3D(bench, "Stack", false, storageTileOrder);
+    stencil2DPlanes(bench);
+    stencil3D(bench, "Tiles, storage order", true, storageTileOrder);
+    stencil3D(bench, "Tiles, Morton order", true, mortonTileOrder);
+    stencil3D(bench, "Tiles, Hilbert order", true, hilbertTileOrder);
+    bench.endBenchmarking();
+
+    bench.saveMatlabGraph("curve3d.m", "plot");
+
+    return 0;
+}
@@ -85,6 +85,7 @@ int main()
     Vector<int> parameters(numSizes);
     Vector<long> iters(numSizes);
     Vector<double> flops(numSizes);
+    Vector<double> bytes(numSizes);
 
     for (int i=0; i < numSizes; ++i)
     {
@@ -93,11 +94,13 @@ int main()
         if (iters[i] < 2)
             iters[i] = 2;
         flops[i] = 2 * parameters[i] * 2;
+        bytes[i] = 3 * sizeof(double) * parameters[i] * 2;
     }
 
     bench.setParameterVector(parameters);
     bench.setIterations(iters);
     bench.setFlopsPerIteration(flops);
+    bench.setBytesPerIteration(bytes);
 
     bench.beginBenchmarking();
 
@@ -81,6 +81,7 @@ int main()
     Vector<int> parameters(numSizes);
     Vector<long> iters(numSizes);
     Vector<double> flops(numSizes);
+    Vector<double> bytes(numSizes);
 
     for (int i=0; i < numSizes; ++i)
     {
@@ -89,11 +90,13 @@ int main()
         if (iters[i] < 2)
             iters[i] = 2;
         flops[i] = 4 * parameters[i];
+        bytes[i] = 6 * sizeof(double) * parameters[i];
     }
 
     bench.setParameterVector(parameters);
     bench.setIterations(iters);
     bench.setFlopsPerIteration(flops);
+    bench.setBytesPerIteration(bytes);
 
     bench.beginBenchmarking();
 
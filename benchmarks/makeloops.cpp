@@ -57,6 +57,52 @@ public:
 		return flops_;
 	}
 
+	// Number of arrays streamed through memory per element: every
+	// array read (unless already written earlier in the loop body)
+	// plus every array written.
+	int arrayAccesses() const
+	{
+		int read[maxArrays], written[maxArrays];
+		for (int i=0; i < maxArrays; ++i)
+			read[i] = written[i] = 0;
+
+		const char* p = loopBuffer_;
+		while (*p) {
+			const char* eq = strchr(p, '=');
+			if (!eq)
+				break;
+			const char* end = strchr(eq, ';');
+			if (!end)
+				end = eq + strlen(eq);
+			for (const char* q = eq+1; q < end; ++q)
+				if (*q == '$') {
+					int k = arrayIndex(q[1]);
+					if ((k >= 0) && !written[k])
+						read[k] = 1;
+				}
+			for (const char* q = p; q < eq; ++q)
+				if (*q == '$') {
+					int k = arrayIndex(q[1]);
+					if (k >= 0)
+						written[k] = 1;
+				}
+			p = *end ? end+1 : end;
+		}
+
+		int count = 0;
+		for (int i=0; i < numArrays_; ++i)
+			count += read[i] + written[i];
+		return count;
+	}
+
+	int arrayIndex(char c) const
+	{
+		for (int i=0; i < numArrays_; ++i)
+			if (arrays_[i] == c)
+				return i;
+		return -1;
+	}
+
 	int isArray(char c) const
 	{
 		for (int i=0; i < numArrays_; ++i)
@@ -385,6 +431,7 @@ void cppVersion(loop& lp)
 	"    Vector<int> parameters(numSizes);\n"
 	"    Vector<long> iters(numSizes);\n"
 	"    Vector<double> flops(numSizes);\n"
+	"    Vector<double> bytes(numSizes);\n"
 	"\n"
 	"    for (int i=0; i < numSizes; ++i)\n"
 	"    {\n"
@@ -393,11 +440,14 @@ void cppVersion(loop& lp)
 	"        if (iters[i] < 2)\n"
 	"            iters[i] = 2;\n"
 	"        flops[i] = " << lp.flops() << " * parameters[i];\n"
+	"        bytes[i] = " << lp.arrayAccesses()
+	<< " * sizeof(double) * parameters[i];\n"
 	"    }\n"
 	"\n"
 	"    bench.setParameterVector(parameters);\n"
 	"    bench.setIterations(iters);\n"
 	"    bench.setFlopsPerIteration(flops);\n"
+	"    bench.setBytesPerIteration(bytes);\n"
 	"\n"
 	"    bench.beginBenchmarking();" << endl << endl;
 
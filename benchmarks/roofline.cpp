@@ -0,0 +1,391 @@
+// Roofline benchmark driver
+//
+// The benchmark programs append their results to the CSV file named by
+// BZ_BENCHMARK_CSV (see BenchmarkExt::saveCSV).  This program
+//
+//   roofline -stream FILE
+//       runs a STREAM-like copy/triad baseline with the current number
+//       of threads and appends it to FILE in the same format;
+//
+//   roofline [-json FILE] [-csv FILE] [-baseline FILE] [-tolerance X]
+//            RESULTS.csv...
+//       merges result files, relates each kernel to the STREAM triad
+//       bandwidth measured with the same thread count, writes the
+//       merged results as JSON and/or CSV, and compares the Mflops
+//       (Mbytes/s for STREAM) of every kernel, size and thread count
+//       against a baseline CSV written earlier by -csv.  Any result
+//       more than the tolerance (default 0.1) below the baseline is
+//       reported, and the exit status is 1.
+//
+// "make check-roofline" runs the whole sweep; see Makefile.am.
+
+#include <blitz/array.h>
+#include <blitz/benchext.h>
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+BZ_USING_NAMESPACE(blitz)
+using namespace std;
+
+struct Result {
+    string benchmark, implementation;
+    double parameter;
+    int threads;
+    long iterations;
+    double seconds, mflops, mbs, measuredMbs;
+
+    string key() const
+    {
+        ostringstream os;
+        os << benchmark << '\t' << implementation << '\t' << parameter
+           << '\t' << threads;
+        return os.str();
+    }
+
+    // The figure compared against the baseline
+    double rate() const
+    { return (mflops > 0) ? mflops : mbs; }
+};
+
+static const char* header = "benchmark,implementation,parameter,threads,"
+    "iterations,seconds,mflops,mbytes_per_s,measured_mbytes_per_s";
+
+// STREAM-like baseline: copy (memcpy) and triad over arrays which do not
+// fit in cache, threaded with OpenMP when available.
+
+void streamCopy(double* restrict a, const double* restrict b, int N)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+    {
+        const int nt = omp_get_num_threads(), t = omp_get_thread_num();
+        const int first = int((long(N) * t) / nt);
+        const int last = int((long(N) * (t+1)) / nt);
+        memcpy(a + first, b + first, (last - first) * sizeof(double));
+    }
+#else
+    memcpy(a, b, N * sizeof(double));
+#endif
+}
+
+void streamTriad(double* restrict a, const double* restrict b,
+    const double* restrict c, double s, int N)
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i=0; i < N; ++i)
+        a[i] = b[i] + s * c[i];
+}
+
+// Runs one STREAM kernel over a range of vector lengths and appends the
+// results to filename.  Returns the bandwidth for the longest vectors.
+double streamBenchmark(const char* kernel, const char* filename)
+{
+    const bool triad = !strcmp(kernel, "triad");
+    const int numSizes = 4;
+    BenchmarkExt<int> bench("STREAM", 1);
+    bench.setNumParameters(numSizes);
+    bench.setRateDescription("Mbytes/s");
+
+    Vector<int> parameters(numSizes);
+    Vector<long> iters(numSizes);
+    Vector<double> flops(numSizes);
+    Vector<double> bytes(numSizes);
+
+    for (int i=0; i < numSizes; ++i)
+    {
+        parameters[i] = (int)pow(10.0, i+4);
+        iters[i] = 200000000L / parameters[i];
+        if (iters[i] < 10)
+            iters[i] = 10;
+        // copy: one read and one write stream; triad: two read streams,
+        // one write stream and 2 flops per element
+        flops[i] = triad ? 2.0 * parameters[i] : 0.0;
+        bytes[i] = (triad ? 3 : 2) * sizeof(double) * parameters[i];
+    }
+
+    bench.setParameterVector(parameters);
+    bench.setIterations(iters);
+    bench.setFlopsPerIteration(flops);
+    bench.setBytesPerIteration(bytes);
+    bench.beginBenchmarking();
+
+    bench.beginImplementation(kernel);
+    while (!bench.doneImplementationBenchmark())
+    {
+        const int N = bench.getParameter();
+        const long iters = bench.getIterations();
+        double* a = new double[N];
+        double* b = new double[N];
+        double* c = new double[N];
+
+        // First touch by the threads which will use the data
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i=0; i < N; ++i)
+            a[i] = b[i] = c[i] = 1.0;
+
+        bench.start();
+        if (triad)
+            for (long it=0; it < iters; ++it)
+                streamTriad(a, b, c, 0.5, N);
+        else
+            for (long it=0; it < iters; ++it)
+                streamCopy(a, b, N);
+        bench.stop();
+
+        delete [] a;
+        delete [] b;
+        delete [] c;
+    }
+    bench.endImplementation();
+
+    // endBenchmarking() already saved the results if BZ_BENCHMARK_CSV
+    // names the same file
+    bench.endBenchmarking();
+    const char* csv = getenv("BZ_BENCHMARK_CSV");
+    if (!csv || strcmp(csv, filename))
+        bench.saveCSV(filename);
+    return bench.getBandwidth(0, numSizes - 1);
+}
+
+int runStream(const char* filename)
+{
+    const double copy = streamBenchmark("copy", filename);
+    const double triad = streamBenchmark("triad", filename);
+    cout << "STREAM (" << BenchmarkExt<int>::numThreads() << " threads): "
+         << "copy " << copy << " Mbytes/s, triad " << triad << " Mbytes/s"
+         << endl;
+    return 0;
+}
+
+// Splits one CSV line into fields, undoing the quoting of saveCSV().
+vector<string> splitCSV(const string& line)
+{
+    vector<string> fields;
+    string field;
+    bool quoted = false;
+    for (string::size_type i=0; i < line.size(); ++i)
+    {
+        const char c = line[i];
+        if (quoted) {
+            if (c != '"')
+                field += c;
+            else if ((i+1 < line.size()) && (line[i+1] == '"'))
+                field += line[++i];
+            else
+                quoted = false;
+        }
+        else if (c == '"')
+            quoted = true;
+        else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        }
+        else if (c != '\r')
+            field += c;
+    }
+    fields.push_back(field);
+    return fields;
+}
+
+bool readResults(const char* filename, vector<Result>& results)
+{
+    ifstream ifs(filename);
+    if (!ifs.good())
+    {
+        cerr << "roofline: cannot read " << filename << endl;
+        return false;
+    }
+
+    string line;
+    while (getline(ifs, line))
+    {
+        vector<string> f = splitCSV(line);
+        if ((f.size() < 9) || (f[0] == "benchmark"))
+            continue;
+
+        Result r;
+        r.benchmark = f[0];
+        r.implementation = f[1];
+        r.parameter = atof(f[2].c_str());
+        r.threads = atoi(f[3].c_str());
+        r.iterations = atol(f[4].c_str());
+        r.seconds = atof(f[5].c_str());
+        r.mflops = atof(f[6].c_str());
+        r.mbs = atof(f[7].c_str());
+        r.measuredMbs = atof(f[8].c_str());
+        results.push_back(r);
+    }
+    return true;
+}
+
+void writeQuoted(ostream& os, const string& str, char quote, bool json)
+{
+    os << quote;
+    for (string::size_type i=0; i < str.size(); ++i)
+    {
+        if (str[i] == quote)
+            os << (json ? '\\' : quote);
+        else if (json && (str[i] == '\\'))
+            os << '\\';
+        os << str[i];
+    }
+    os << quote;
+}
+
+int main(int argc, char** argv)
+{
+    const char* jsonFile = 0;
+    const char* csvFile = 0;
+    const char* baselineFile = 0;
+    double tolerance = 0.1;
+    vector<const char*> inputs;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-stream") && (i+1 < argc))
+            return runStream(argv[++i]);
+        else if (!strcmp(argv[i], "-json") && (i+1 < argc))
+            jsonFile = argv[++i];
+        else if (!strcmp(argv[i], "-csv") && (i+1 < argc))
+            csvFile = argv[++i];
+        else if (!strcmp(argv[i], "-baseline") && (i+1 < argc))
+            baselineFile = argv[++i];
+        else if (!strcmp(argv[i], "-tolerance") && (i+1 < argc))
+            tolerance = atof(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            cerr << "usage: roofline -stream FILE" << endl
+                 << "       roofline [-json FILE] [-csv FILE] "
+                 << "[-baseline FILE] [-tolerance X] RESULTS.csv..." << endl;
+            return 2;
+        }
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    vector<Result> results;
+    for (unsigned i=0; i < inputs.size(); ++i)
+        if (!readResults(inputs[i], results))
+            return 2;
+
+    // Attainable bandwidth for each thread count: the STREAM triad on
+    // the largest vectors.
+    map<int,double> triad;
+    map<int,double> triadSize;
+    for (unsigned i=0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        if ((r.benchmark == "STREAM") && (r.implementation == "triad")
+            && (r.parameter >= triadSize[r.threads]))
+        {
+            triadSize[r.threads] = r.parameter;
+            triad[r.threads] = r.mbs;
+        }
+    }
+
+    if (csvFile)
+    {
+        ofstream ofs(csvFile);
+        ofs << header << endl;
+        ofs.precision(12);
+        for (unsigned i=0; i < results.size(); ++i)
+        {
+            const Result& r = results[i];
+            writeQuoted(ofs, r.benchmark, '"', false);
+            ofs << ",";
+            writeQuoted(ofs, r.implementation, '"', false);
+            ofs << "," << r.parameter << "," << r.threads << ","
+                << r.iterations << "," << r.seconds << "," << r.mflops
+                << "," << r.mbs << "," << r.measuredMbs << endl;
+        }
+    }
+
+    if (jsonFile)
+    {
+        ofstream ofs(jsonFile);
+        ofs.precision(12);
+        ofs << "{" << endl << "  \"stream_triad_mbytes_per_s\": {";
+        for (map<int,double>::const_iterator iter = triad.begin();
+            iter != triad.end(); ++iter)
+        {
+            ofs << (iter == triad.begin() ? " " : ", ")
+                << "\"" << iter->first << "\": " << iter->second;
+        }
+        ofs << " }," << endl << "  \"results\": [" << endl;
+
+        for (unsigned i=0; i < results.size(); ++i)
+        {
+            const Result& r = results[i];
+            ofs << "    { \"benchmark\": ";
+            writeQuoted(ofs, r.benchmark, '"', true);
+            ofs << ", \"implementation\": ";
+            writeQuoted(ofs, r.implementation, '"', true);
+            ofs << ", \"parameter\": " << r.parameter
+                << ", \"threads\": " << r.threads
+                << ", \"seconds\": " << r.seconds
+                << ", \"mflops\": " << r.mflops
+                << ", \"mbytes_per_s\": " << r.mbs;
+            if (r.measuredMbs >= 0)
+                ofs << ", \"measured_mbytes_per_s\": " << r.measuredMbs;
+            // Arithmetic intensity and the fraction of the bandwidth
+            // roof reached
+            if ((r.mbs > 0) && (r.mflops > 0))
+                ofs << ", \"flops_per_byte\": " << r.mflops / r.mbs;
+            if ((r.mbs > 0) && (triad[r.threads] > 0))
+                ofs << ", \"fraction_of_stream\": "
+                    << r.mbs / triad[r.threads];
+            ofs << " }" << (i+1 < results.size() ? "," : "") << endl;
+        }
+        ofs << "  ]" << endl << "}" << endl;
+    }
+
+    if (!baselineFile)
+        return 0;
+
+    vector<Result> baseline;
+    if (!readResults(baselineFile, baseline))
+        return 2;
+
+    map<string,double> reference;
+    for (unsigned i=0; i < baseline.size(); ++i)
+        reference[baseline[i].key()] = baseline[i].rate();
+
+    int regressions = 0, compared = 0;
+    for (unsigned i=0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        map<string,double>::const_iterator iter = reference.find(r.key());
+        if ((iter == reference.end()) || (iter->second <= 0))
+            continue;
+
+        ++compared;
+        if (r.rate() < (1.0 - tolerance) * iter->second)
+        {
+            ++regressions;
+            cout << "REGRESSION: " << r.benchmark << " [" << r.implementation
+                 << "] size " << r.parameter << ", " << r.threads
+                 << " threads: " << r.rate() << " vs. " << iter->second
+                 << " (" << 100.0 * (r.rate() / iter->second - 1.0) << "%)"
+                 << endl;
+        }
+    }
+
+    cout << compared << " results compared against " << baselineFile
+         << ", " << regressions << " regressions" << endl;
+    return regressions ? 1 : 0;
+}
@@ -54,6 +54,7 @@ int main()
     Vector<int> parameters(numSizes);
     Vector<long> iters(numSizes);
     Vector<double> flops(numSizes);
+    Vector<double> bytes(numSizes);
 
     for (int i=0; i < numSizes; ++i)
     {
@@ -63,11 +64,13 @@ int main()
             iters[i] = 2;
         int npoints = parameters[i] - 2;
         flops[i] = npoints * npoints * npoints * 7 * 2;
+        bytes[i] = 2 * sizeof(double) * npoints * npoints * npoints * 2;
     }
 
     bench.setParameterVector(parameters);
     bench.setIterations(iters);
     bench.setFlopsPerIteration(flops);
+    bench.setBytesPerIteration(bytes);
 
     bench.beginBenchmarking();
 #ifdef FORTRAN_90
@@ -113,8 +116,6 @@ void stencilBlitzVersion(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -161,8 +162,6 @@ void stencilBlitzExpressionVersion(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -195,8 +194,6 @@ void stencilBlitzProductVersion(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N),C(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -230,8 +227,6 @@ void stencilBlitzProductVersion2(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -269,8 +264,6 @@ void stencilBlitzProductVersion3(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -303,8 +296,6 @@ void stencilBlitzIndexVersion(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
         bench.start();
@@ -337,8 +328,6 @@ void stencilBlitzStencilVersion(BenchmarkExt<int>& bench)
         Array<double,3> A(N,N,N), B(N,N,N);
         initializeRandomDouble(A.data(), N*N*N, A.stride(thirdDim));
         initializeRandomDouble(B.data(), N*N*N, B.stride(thirdDim));
-        TinyVector<int,2> size = N-2;
-        generateFastTraversalOrder(size);
         double c = 1/7.;
        
 	;        bench.start();
@@ -54,6 +54,11 @@
 
 #include <blitz/indexexpr.h>
 #include <blitz/prettyprint.h>
+#include <blitz/profile.h>
+
+#ifdef BZ_RUNTIME_TUNING
+#include <blitz/machine.h>
+#endif
 
 #include <blitz/array/slice.h>     // Subarrays and slicing
 #include <blitz/array/map.h>       // Tensor index notation
@@ -77,6 +82,12 @@ class ConstArrayIterator;
 template<typename T_numtype, int N_rank>
 class FastArrayIterator;
 
+template<typename T_numtype, int N_rank>
+class SegmentedArrayIterator;
+
+template<typename T_numtype, int N_rank>
+class ConstSegmentedArrayIterator;
+
 template<typename P_expr>
 class _bz_ArrayExpr;
 
@@ -122,6 +133,8 @@ public:
      *            templates
      * iterator   is a STL-style iterator
      * const_iterator is an STL-style const iterator
+     * segmented_iterator and const_segmented_iterator are STL-style
+     *            random-access iterators
      */
 
     typedef P_numtype                T_numtype;
@@ -131,6 +144,9 @@ public:
 
     typedef ArrayIterator<T_numtype,N_rank> iterator;
     typedef ConstArrayIterator<T_numtype,N_rank> const_iterator;
+    typedef SegmentedArrayIterator<T_numtype,N_rank> segmented_iterator;
+    typedef ConstSegmentedArrayIterator<T_numtype,N_rank>
+        const_segmented_iterator;
 
     static const int _bz_rank = N_rank;
 
@@ -850,6 +866,12 @@ public:
     T_iterator                        beginFast() const
     { return T_iterator(*this); }
 
+    segmented_iterator                beginSegmented()
+    { return segmented_iterator(*this, 0); }
+
+    const_segmented_iterator          beginSegmented() const
+    { return const_segmented_iterator(*this, 0); }
+
     // Deprecated: now extractComponent(...)
     template<typename P_numtype2>
     Array<P_numtype2,N_rank>          chopComponent(P_numtype2 a, int compNum,
@@ -929,6 +951,12 @@ public:
     const_iterator                    end() const
     { return const_iterator(*this,0); }
 
+    segmented_iterator                endSegmented()
+    { return segmented_iterator(*this, numElements()); }
+
+    const_segmented_iterator          endSegmented() const
+    { return const_segmented_iterator(*this, numElements()); }
+
     int                               extent(int rank) const
     { return length_[rank]; }
 
@@ -1103,6 +1131,11 @@ public:
     // NEEDS_WORK -- resizeAndPreserve(Range,...)
     // NEEDS_WORK -- resizeAndPreserve(const Domain<N_rank>&);
 
+    // The extent the slowest-varying rank can be given by
+    // resizeAndPreserve() without reallocating, and a way to raise it
+    int                               capacity() const;
+    void                              reserve(int extent);
+
     T_array                           reverse(int rank);
     void                              reverseSelf(int rank);
 
@@ -2307,14 +2340,12 @@ public:
     template<typename T_expr, typename T_update>
     inline T_array& evaluate(T_expr expr, T_update);
 
-#ifdef BZ_HAVE_STD
 #ifdef BZ_ARRAY_SPACE_FILLING_TRAVERSAL
     template<typename T_expr, typename T_update>
     inline T_array& evaluateWithFastTraversal(
-        const TraversalOrder<N_rank - 1>& order, 
+        TileOrder order, int tileSize,
         T_expr expr, T_update);
 #endif // BZ_ARRAY_SPACE_FILLING_TRAVERSAL
-#endif
 
 #ifdef BZ_ARRAY_2D_STENCIL_TILING
     template<typename T_expr, typename T_update>
@@ -2357,6 +2388,10 @@ protected:
 
     _bz_inline2 void computeStrides();
     _bz_inline2 void setupStorage(int rank);
+    void setupStorageWithCapacity(int capacity);
+    bool isLaidOutForGrowth() const;
+    const T_numtype* firstInMemory() const;
+    bool resizeInPlace(int extent);
     void constructSubarray(Array<T_numtype, N_rank>& array, 
         const RectDomain<N_rank>&);
     void constructSubarray(Array<T_numtype, N_rank>& array,
@@ -2532,6 +2567,11 @@ BZ_NAMESPACE_END
 #include <blitz/array/io.cc>        // Output formatting
 #include <blitz/array/et.h>         // Expression templates
 #include <blitz/array/reduce.h>     // Array reduction expression templates
+#include <blitz/array/multireduce.h> // Several reductions in one pass
+#include <blitz/array/scan.h>        // Cumulative sums and other scans
+#include <blitz/array/batched.h>     // Small-matrix operations over arrays
+#include <blitz/array/view.h>        // Non-owning views of array data
+#include <blitz/array/fixed.h>       // Arrays with extents known at compile time
 #include <blitz/array/interlace.cc> // Allocation of interlaced arrays
 #include <blitz/array/resize.cc>    // Array resize, resizeAndPreserve
 #include <blitz/array/slicing.cc>   // Slicing and subarrays
@@ -0,0 +1,777 @@
+/***************************************************************************
+ * blitz/array/batched.cc  Small-matrix operations over whole arrays of
+ *                         TinyMatrix and TinyVector
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_BATCHED_CC
+#define BZ_ARRAY_BATCHED_CC
+
+#ifndef BZ_ARRAY_BATCHED_H
+ #error <blitz/array/batched.cc> must be included via <blitz/array/batched.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * A batch holds component c of lane l in x[c][l].  The kernels with
+ * byLanes true work on whole batches, with the loop over the lanes
+ * innermost, and may overwrite their operands.  The others work on the
+ * components of one element, and read all of them before writing the
+ * result, which may be one of the operands.
+ */
+
+// Access to the elements of an operand, by their number in row-major
+// order of the index, or in memory order when all the operands are laid
+// out alike
+template<typename T_element, int N_rank>
+class _bz_BatchOperand {
+public:
+    typedef multicomponent_traits<T_element> T_traits;
+    typedef _bz_typename T_traits::T_element T_scalar;
+
+    // A scalar array has zero components in the traits, and one here
+    static const int numComponents = (T_traits::numComponents == 0) ? 1
+        : T_traits::numComponents;
+
+    _bz_BatchOperand(const Array<T_element,N_rank>& A, bool flat)
+      : data_(const_cast<T_element*>(A.data())), stride_(A.stride()),
+        extent_(A.extent()), flat_(flat)
+    { }
+
+    T_scalar* element(sizeType n) const
+    {
+        if (flat_)
+            return reinterpret_cast<T_scalar*>(data_ + n);
+
+        diffType offset = 0;
+        for (int r=N_rank-1; r >= 0; --r)
+        {
+            offset += diffType(n % extent_(r)) * stride_(r);
+            n /= extent_(r);
+        }
+        return reinterpret_cast<T_scalar*>(data_ + offset);
+    }
+
+    // Copies elements n0, ..., n0+w-1 into lanes 0, ..., w-1, and the
+    // first of them into the remaining lanes
+    void load(T_scalar (*x)[BZ_BATCH_WIDTH], sizeType n0, int w) const
+    {
+        if (flat_ && (w == BZ_BATCH_WIDTH))
+        {
+            const T_scalar* restrict e = element(n0);
+            for (int c=0; c < numComponents; ++c)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    x[c][l] = e[l * numComponents + c];
+            return;
+        }
+
+        for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+        {
+            const T_scalar* e = element(n0 + ((l < w) ? l : 0));
+            for (int c=0; c < numComponents; ++c)
+                x[c][l] = e[c];
+        }
+    }
+
+    void store(T_scalar (*x)[BZ_BATCH_WIDTH], sizeType n0, int w) const
+    {
+        if (flat_ && (w == BZ_BATCH_WIDTH))
+        {
+            T_scalar* restrict e = element(n0);
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                for (int c=0; c < numComponents; ++c)
+                    e[l * numComponents + c] = x[c][l];
+            return;
+        }
+
+        for (int l=0; l < w; ++l)
+        {
+            T_scalar* e = element(n0 + l);
+            for (int c=0; c < numComponents; ++c)
+                e[c] = x[c][l];
+        }
+    }
+
+private:
+    T_element* data_;
+    TinyVector<diffType,N_rank> stride_;
+    TinyVector<int,N_rank> extent_;
+    bool flat_;
+};
+
+// True if A and B are contiguous with the same, ascending, layout
+template<typename T_element1, typename T_element2, int N_rank>
+inline bool _bz_batchFlat(const Array<T_element1,N_rank>& A,
+    const Array<T_element2,N_rank>& B)
+{
+    if (!A.isStorageContiguous() || !B.isStorageContiguous())
+        return false;
+    for (int r=0; r < N_rank; ++r)
+        if ((A.stride(r) != B.stride(r)) || (A.stride(r) <= 0))
+            return false;
+    return true;
+}
+
+// The drivers: kernels with byLanes true take a batch at a time, the
+// others one element at a time, on its components in place
+
+template<bool byLanes>
+struct _bz_batchRun {
+    template<typename T_kernel, typename T_out, typename T_in, int N_rank>
+    static void apply(const Array<T_out,N_rank>& out,
+        const Array<T_in,N_rank>& in)
+    {
+        typedef _bz_BatchOperand<T_out,N_rank> T_result;
+        typedef _bz_BatchOperand<T_in,N_rank> T_operand;
+        typedef _bz_typename T_result::T_scalar T_scalar;
+
+        BZPRECONDITION(areShapesConformable(out.shape(), in.shape()));
+
+        const bool flat = _bz_batchFlat(out, in);
+        const T_result result(out, flat);
+        const T_operand a(in, flat);
+
+        const sizeType count = out.numElements();
+        const diffType numBatches = (count + BZ_BATCH_WIDTH - 1)
+            / BZ_BATCH_WIDTH;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+        for (diffType batch=0; batch < numBatches; ++batch)
+        {
+            T_scalar x[T_result::numComponents][BZ_BATCH_WIDTH];
+            T_scalar y[T_operand::numComponents][BZ_BATCH_WIDTH];
+            const sizeType n0 = sizeType(batch) * BZ_BATCH_WIDTH;
+            const int w = (count - n0 < BZ_BATCH_WIDTH) ? int(count - n0)
+                : BZ_BATCH_WIDTH;
+
+            a.load(y, n0, w);
+            T_kernel::apply(x, y);
+            result.store(x, n0, w);
+        }
+    }
+
+    template<typename T_kernel, typename T_out, typename T_in1,
+        typename T_in2, int N_rank>
+    static void apply(const Array<T_out,N_rank>& out,
+        const Array<T_in1,N_rank>& in1, const Array<T_in2,N_rank>& in2)
+    {
+        typedef _bz_BatchOperand<T_out,N_rank> T_result;
+        typedef _bz_BatchOperand<T_in1,N_rank> T_operand1;
+        typedef _bz_BatchOperand<T_in2,N_rank> T_operand2;
+        typedef _bz_typename T_result::T_scalar T_scalar;
+
+        BZPRECONDITION(areShapesConformable(out.shape(), in1.shape()));
+        BZPRECONDITION(areShapesConformable(out.shape(), in2.shape()));
+
+        const bool flat = _bz_batchFlat(out, in1) && _bz_batchFlat(out, in2);
+        const T_result result(out, flat);
+        const T_operand1 a(in1, flat);
+        const T_operand2 b(in2, flat);
+
+        const sizeType count = out.numElements();
+        const diffType numBatches = (count + BZ_BATCH_WIDTH - 1)
+            / BZ_BATCH_WIDTH;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+        for (diffType batch=0; batch < numBatches; ++batch)
+        {
+            T_scalar x[T_result::numComponents][BZ_BATCH_WIDTH];
+            T_scalar y[T_operand1::numComponents][BZ_BATCH_WIDTH];
+            T_scalar z[T_operand2::numComponents][BZ_BATCH_WIDTH];
+            const sizeType n0 = sizeType(batch) * BZ_BATCH_WIDTH;
+            const int w = (count - n0 < BZ_BATCH_WIDTH) ? int(count - n0)
+                : BZ_BATCH_WIDTH;
+
+            a.load(y, n0, w);
+            b.load(z, n0, w);
+            T_kernel::apply(x, y, z);
+            result.store(x, n0, w);
+        }
+    }
+};
+
+template<>
+struct _bz_batchRun<false> {
+    template<typename T_kernel, typename T_out, typename T_in, int N_rank>
+    static void apply(const Array<T_out,N_rank>& out,
+        const Array<T_in,N_rank>& in)
+    {
+        BZPRECONDITION(areShapesConformable(out.shape(), in.shape()));
+
+        const bool flat = _bz_batchFlat(out, in);
+        const _bz_BatchOperand<T_out,N_rank> result(out, flat);
+        const _bz_BatchOperand<T_in,N_rank> a(in, flat);
+        const diffType count = out.numElements();
+
+        if (flat)
+        {
+            typedef _bz_typename _bz_BatchOperand<T_out,N_rank>::T_scalar
+                T_outScalar;
+            typedef _bz_typename _bz_BatchOperand<T_in,N_rank>::T_scalar
+                T_inScalar;
+            T_outScalar* y = result.element(0);
+            const T_inScalar* x = a.element(0);
+            const int ny = result.numComponents, nx = a.numComponents;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+            for (diffType n=0; n < count; ++n)
+                T_kernel::apply(y + n * ny, x + n * nx);
+            return;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+        for (diffType n=0; n < count; ++n)
+            T_kernel::apply(result.element(n), a.element(n));
+    }
+
+    template<typename T_kernel, typename T_out, typename T_in1,
+        typename T_in2, int N_rank>
+    static void apply(const Array<T_out,N_rank>& out,
+        const Array<T_in1,N_rank>& in1, const Array<T_in2,N_rank>& in2)
+    {
+        BZPRECONDITION(areShapesConformable(out.shape(), in1.shape()));
+        BZPRECONDITION(areShapesConformable(out.shape(), in2.shape()));
+
+        const bool flat = _bz_batchFlat(out, in1) && _bz_batchFlat(out, in2);
+        const _bz_BatchOperand<T_out,N_rank> result(out, flat);
+        const _bz_BatchOperand<T_in1,N_rank> a(in1, flat);
+        const _bz_BatchOperand<T_in2,N_rank> b(in2, flat);
+        const diffType count = out.numElements();
+
+        if (flat)
+        {
+            typedef _bz_typename _bz_BatchOperand<T_out,N_rank>::T_scalar
+                T_outScalar;
+            typedef _bz_typename _bz_BatchOperand<T_in1,N_rank>::T_scalar
+                T_in1Scalar;
+            typedef _bz_typename _bz_BatchOperand<T_in2,N_rank>::T_scalar
+                T_in2Scalar;
+            T_outScalar* y = result.element(0);
+            const T_in1Scalar* x1 = a.element(0);
+            const T_in2Scalar* x2 = b.element(0);
+            const int ny = result.numComponents, n1 = a.numComponents,
+                n2 = b.numComponents;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+            for (diffType n=0; n < count; ++n)
+                T_kernel::apply(y + n * ny, x1 + n * n1, x2 + n * n2);
+            return;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+    if (count >= BZ_BATCH_PARALLEL_THRESHOLD)
+#endif
+        for (diffType n=0; n < count; ++n)
+            T_kernel::apply(result.element(n), a.element(n), b.element(n));
+    }
+};
+
+template<typename T>
+inline T _bz_batchAbs(T x)
+{
+    return (x < T(0)) ? -x : x;
+}
+
+// Brings the row r >= k with the largest |a(r,k)| to row k, in each
+// lane, exchanging the rows of the N x N_x matrix x along with it.
+// swapped[l] is set to 1 in the lanes where rows were exchanged.
+template<typename T, int N, int N_x>
+inline void _bz_batchPivot(T (*a)[BZ_BATCH_WIDTH], T (*x)[BZ_BATCH_WIDTH],
+    int k, T* swapped)
+{
+    T best[BZ_BATCH_WIDTH], row[BZ_BATCH_WIDTH];
+
+    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+    {
+        best[l] = _bz_batchAbs(a[k*N + k][l]);
+        row[l] = T(k);
+    }
+    for (int r=k+1; r < N; ++r)
+        for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+        {
+            const T v = _bz_batchAbs(a[r*N + k][l]);
+            const bool larger = v > best[l];
+            best[l] = larger ? v : best[l];
+            row[l] = larger ? T(r) : row[l];
+        }
+
+    for (int r=k+1; r < N; ++r)
+    {
+        for (int c=0; c < N; ++c)
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+            {
+                const bool exchange = (row[l] == T(r));
+                const T ak = a[k*N + c][l], ar = a[r*N + c][l];
+                a[k*N + c][l] = exchange ? ar : ak;
+                a[r*N + c][l] = exchange ? ak : ar;
+            }
+        for (int c=0; c < N_x; ++c)
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+            {
+                const bool exchange = (row[l] == T(r));
+                const T xk = x[k*N_x + c][l], xr = x[r*N_x + c][l];
+                x[k*N_x + c][l] = exchange ? xr : xk;
+                x[r*N_x + c][l] = exchange ? xk : xr;
+            }
+    }
+
+    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+        swapped[l] = (row[l] != T(k)) ? T(1) : T(0);
+}
+
+// The products are cheap enough that transposing into lanes costs more
+// than it saves: the compiler vectorizes them within each element.
+
+template<typename T, int N_rows, int N_inner, int N_columns>
+struct _bz_batchMatMat {
+    static const bool byLanes = false;
+
+    static void apply(T* c, const T* a, const T* b)
+    {
+        T ab[N_rows * N_columns];
+        for (int i=0; i < N_rows; ++i)
+            for (int j=0; j < N_columns; ++j)
+            {
+                T s = a[i*N_inner] * b[j];
+                for (int k=1; k < N_inner; ++k)
+                    s += a[i*N_inner + k] * b[k*N_columns + j];
+                ab[i*N_columns + j] = s;
+            }
+        for (int i=0; i < N_rows * N_columns; ++i)
+            c[i] = ab[i];
+    }
+};
+
+template<typename T, int N_rows, int N_columns>
+struct _bz_batchMatVec {
+    static const bool byLanes = false;
+
+    static void apply(T* y, const T* a, const T* x)
+    {
+        T ax[N_rows];
+        for (int i=0; i < N_rows; ++i)
+        {
+            T s = a[i*N_columns] * x[0];
+            for (int j=1; j < N_columns; ++j)
+                s += a[i*N_columns + j] * x[j];
+            ax[i] = s;
+        }
+        for (int i=0; i < N_rows; ++i)
+            y[i] = ax[i];
+    }
+};
+
+// Determinants: the product of the pivots of the LU decomposition, or
+// the explicit formula up to 3x3
+
+template<typename T, int N>
+struct _bz_batchDeterminant {
+    static const bool byLanes = true;
+
+    static void apply(T (*d)[BZ_BATCH_WIDTH], T (*a)[BZ_BATCH_WIDTH])
+    {
+        T swapped[BZ_BATCH_WIDTH];
+
+        for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+            d[0][l] = T(1);
+
+        for (int k=0; k < N; ++k)
+        {
+            _bz_batchPivot<T,N,0>(a, a, k, swapped);
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                d[0][l] *= (swapped[l] != T(0)) ? -a[k*N + k][l]
+                    : a[k*N + k][l];
+
+            for (int r=k+1; r < N; ++r)
+            {
+                // A zero pivot has already made the determinant zero
+                T f[BZ_BATCH_WIDTH];
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                {
+                    const T pivot = a[k*N + k][l];
+                    f[l] = a[r*N + k][l] / ((pivot == T(0)) ? T(1) : pivot);
+                }
+                for (int c=k+1; c < N; ++c)
+                    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                        a[r*N + c][l] -= f[l] * a[k*N + c][l];
+            }
+        }
+    }
+};
+
+template<typename T>
+struct _bz_batchDeterminant<T,1> {
+    static const bool byLanes = false;
+
+    static void apply(T* d, const T* a)
+    { d[0] = a[0]; }
+};
+
+template<typename T>
+struct _bz_batchDeterminant<T,2> {
+    static const bool byLanes = false;
+
+    static void apply(T* d, const T* a)
+    { d[0] = a[0] * a[3] - a[1] * a[2]; }
+};
+
+template<typename T>
+struct _bz_batchDeterminant<T,3> {
+    static const bool byLanes = false;
+
+    static void apply(T* d, const T* a)
+    {
+        d[0] = a[0] * (a[4] * a[8] - a[5] * a[7])
+            - a[1] * (a[3] * a[8] - a[5] * a[6])
+            + a[2] * (a[3] * a[7] - a[4] * a[6]);
+    }
+};
+
+// Inverses: Gauss-Jordan elimination with partial pivoting, or the
+// adjugate up to 3x3
+
+template<typename T, int N>
+struct _bz_batchInverse {
+    static const bool byLanes = true;
+
+    static void apply(T (*x)[BZ_BATCH_WIDTH], T (*a)[BZ_BATCH_WIDTH])
+    {
+        T swapped[BZ_BATCH_WIDTH];
+
+        for (int i=0; i < N; ++i)
+            for (int j=0; j < N; ++j)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    x[i*N + j][l] = (i == j) ? T(1) : T(0);
+
+        for (int k=0; k < N; ++k)
+        {
+            _bz_batchPivot<T,N,N>(a, x, k, swapped);
+
+            T f[BZ_BATCH_WIDTH];
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                f[l] = T(1) / a[k*N + k][l];
+            for (int c=0; c < N; ++c)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                {
+                    a[k*N + c][l] *= f[l];
+                    x[k*N + c][l] *= f[l];
+                }
+
+            for (int r=0; r < N; ++r)
+            {
+                if (r == k)
+                    continue;
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    f[l] = a[r*N + k][l];
+                for (int c=0; c < N; ++c)
+                    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    {
+                        a[r*N + c][l] -= f[l] * a[k*N + c][l];
+                        x[r*N + c][l] -= f[l] * x[k*N + c][l];
+                    }
+            }
+        }
+    }
+};
+
+template<typename T>
+struct _bz_batchInverse<T,1> {
+    static const bool byLanes = false;
+
+    static void apply(T* x, const T* a)
+    { x[0] = T(1) / a[0]; }
+};
+
+template<typename T>
+struct _bz_batchInverse<T,2> {
+    static const bool byLanes = false;
+
+    static void apply(T* x, const T* a)
+    {
+        const T a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+        const T s = T(1) / (a0 * a3 - a1 * a2);
+        x[0] = a3 * s;
+        x[1] = -a1 * s;
+        x[2] = -a2 * s;
+        x[3] = a0 * s;
+    }
+};
+
+template<typename T>
+struct _bz_batchInverse<T,3> {
+    static const bool byLanes = false;
+
+    static void apply(T* x, const T* a)
+    {
+        const T c0 = a[4] * a[8] - a[5] * a[7],
+            c1 = a[5] * a[6] - a[3] * a[8],
+            c2 = a[3] * a[7] - a[4] * a[6];
+        const T s = T(1) / (a[0] * c0 + a[1] * c1 + a[2] * c2);
+
+        T y[9];
+        y[0] = c0 * s;
+        y[1] = (a[2] * a[7] - a[1] * a[8]) * s;
+        y[2] = (a[1] * a[5] - a[2] * a[4]) * s;
+        y[3] = c1 * s;
+        y[4] = (a[0] * a[8] - a[2] * a[6]) * s;
+        y[5] = (a[2] * a[3] - a[0] * a[5]) * s;
+        y[6] = c2 * s;
+        y[7] = (a[1] * a[6] - a[0] * a[7]) * s;
+        y[8] = (a[0] * a[4] - a[1] * a[3]) * s;
+        for (int i=0; i < 9; ++i)
+            x[i] = y[i];
+    }
+};
+
+template<typename T, int N>
+struct _bz_batchSymmetricEigenvalues {
+    static const bool byLanes = true;
+
+    static void apply(T (*lambda)[BZ_BATCH_WIDTH], T (*a)[BZ_BATCH_WIDTH])
+    {
+        for (int i=1; i < N; ++i)
+            for (int j=0; j < i; ++j)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    a[i*N + j][l] = a[j*N + i][l];
+
+        T c[BZ_BATCH_WIDTH], s[BZ_BATCH_WIDTH];
+
+        for (int sweep=0; sweep < BZ_BATCH_JACOBI_SWEEPS; ++sweep)
+            for (int p=0; p < N-1; ++p)
+                for (int q=p+1; q < N; ++q)
+                {
+                    // The rotation which zeroes a(p,q), as in Numerical
+                    // Recipes; none where it is zero already
+                    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    {
+                        const T apq = a[p*N + q][l];
+                        const bool zero = (apq == T(0));
+                        const T theta = (a[q*N + q][l] - a[p*N + p][l])
+                            / (T(2) * (zero ? T(1) : apq));
+                        T t = (zero ? T(0) : T(1)) / (_bz_batchAbs(theta)
+                            + BZ_MATHFN_SCOPE(sqrt)(theta * theta + T(1)));
+                        t = (theta < T(0)) ? -t : t;
+                        c[l] = T(1) / BZ_MATHFN_SCOPE(sqrt)(t * t + T(1));
+                        s[l] = t * c[l];
+                    }
+
+                    for (int k=0; k < N; ++k)
+                        for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                        {
+                            const T akp = a[k*N + p][l], akq = a[k*N + q][l];
+                            a[k*N + p][l] = c[l] * akp - s[l] * akq;
+                            a[k*N + q][l] = s[l] * akp + c[l] * akq;
+                        }
+                    for (int k=0; k < N; ++k)
+                        for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                        {
+                            const T apk = a[p*N + k][l], aqk = a[q*N + k][l];
+                            a[p*N + k][l] = c[l] * apk - s[l] * aqk;
+                            a[q*N + k][l] = s[l] * apk + c[l] * aqk;
+                        }
+                }
+
+        for (int i=0; i < N; ++i)
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                lambda[i][l] = a[i*N + i][l];
+
+        // Sort by exchanges of neighbours
+        for (int i=0; i < N-1; ++i)
+            for (int j=0; j < N-1-i; ++j)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                {
+                    const T x = lambda[j][l], y = lambda[j+1][l];
+                    lambda[j][l] = (y < x) ? y : x;
+                    lambda[j+1][l] = (y < x) ? x : y;
+                }
+    }
+};
+
+template<typename T, int N>
+struct _bz_batchSolve {
+    static const bool byLanes = true;
+
+    static void apply(T (*x)[BZ_BATCH_WIDTH], T (*a)[BZ_BATCH_WIDTH],
+        T (*b)[BZ_BATCH_WIDTH])
+    {
+        T swapped[BZ_BATCH_WIDTH];
+
+        for (int k=0; k < N; ++k)
+        {
+            _bz_batchPivot<T,N,1>(a, b, k, swapped);
+            for (int r=k+1; r < N; ++r)
+            {
+                T f[BZ_BATCH_WIDTH];
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                {
+                    f[l] = a[r*N + k][l] / a[k*N + k][l];
+                    b[r][l] -= f[l] * b[k][l];
+                }
+                for (int c=k+1; c < N; ++c)
+                    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                        a[r*N + c][l] -= f[l] * a[k*N + c][l];
+            }
+        }
+
+        for (int i=N-1; i >= 0; --i)
+        {
+            for (int k=i+1; k < N; ++k)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    b[i][l] -= a[i*N + k][l] * x[k][l];
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                x[i][l] = b[i][l] / a[i*N + i][l];
+        }
+    }
+};
+
+template<typename T, int N>
+struct _bz_batchCholeskySolve {
+    static const bool byLanes = true;
+
+    static void apply(T (*x)[BZ_BATCH_WIDTH], T (*a)[BZ_BATCH_WIDTH],
+        T (*b)[BZ_BATCH_WIDTH])
+    {
+        // a = L L^T, with L overwriting the lower triangle
+        for (int j=0; j < N; ++j)
+        {
+            for (int k=0; k < j; ++k)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    a[j*N + j][l] -= a[j*N + k][l] * a[j*N + k][l];
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                a[j*N + j][l] = BZ_MATHFN_SCOPE(sqrt)(a[j*N + j][l]);
+
+            for (int i=j+1; i < N; ++i)
+            {
+                for (int k=0; k < j; ++k)
+                    for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                        a[i*N + j][l] -= a[i*N + k][l] * a[j*N + k][l];
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    a[i*N + j][l] /= a[j*N + j][l];
+            }
+        }
+
+        // L y = b, with y overwriting b, then L^T x = y
+        for (int i=0; i < N; ++i)
+        {
+            for (int k=0; k < i; ++k)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    b[i][l] -= a[i*N + k][l] * b[k][l];
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                b[i][l] /= a[i*N + i][l];
+        }
+        for (int i=N-1; i >= 0; --i)
+        {
+            for (int k=i+1; k < N; ++k)
+                for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                    b[i][l] -= a[k*N + i][l] * x[k][l];
+            for (int l=0; l < BZ_BATCH_WIDTH; ++l)
+                x[i][l] = b[i][l] / a[i*N + i][l];
+        }
+    }
+};
+
+template<typename T_numtype, int N_rows, int N_inner, int N_columns,
+    int N_rank>
+void batchedProduct(Array<TinyMatrix<T_numtype,N_rows,N_columns>,N_rank> C,
+    const Array<TinyMatrix<T_numtype,N_rows,N_inner>,N_rank>& A,
+    const Array<TinyMatrix<T_numtype,N_inner,N_columns>,N_rank>& B)
+{
+    typedef _bz_batchMatMat<T_numtype,N_rows,N_inner,N_columns> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(C, A, B);
+}
+
+template<typename T_numtype, int N_rows, int N_columns, int N_rank>
+void batchedProduct(Array<TinyVector<T_numtype,N_rows>,N_rank> y,
+    const Array<TinyMatrix<T_numtype,N_rows,N_columns>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N_columns>,N_rank>& x)
+{
+    typedef _bz_batchMatVec<T_numtype,N_rows,N_columns> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(y, A, x);
+}
+
+template<typename T_numtype, int N, int N_rank>
+void batchedDeterminant(Array<T_numtype,N_rank> d,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A)
+{
+    typedef _bz_batchDeterminant<T_numtype,N> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(d, A);
+}
+
+template<typename T_numtype, int N, int N_rank>
+void batchedInverse(Array<TinyMatrix<T_numtype,N,N>,N_rank> Ainv,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A)
+{
+    typedef _bz_batchInverse<T_numtype,N> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(Ainv, A);
+}
+
+template<typename T_numtype, int N, int N_rank>
+void batchedSymmetricEigenvalues(Array<TinyVector<T_numtype,N>,N_rank> lambda,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A)
+{
+    typedef _bz_batchSymmetricEigenvalues<T_numtype,N> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(lambda, A);
+}
+
+template<typename T_numtype, int N, int N_rank>
+void batchedSolve(Array<TinyVector<T_numtype,N>,N_rank> x,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N>,N_rank>& b)
+{
+    typedef _bz_batchSolve<T_numtype,N> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(x, A, b);
+}
+
+template<typename T_numtype, int N, int N_rank>
+void batchedCholeskySolve(Array<TinyVector<T_numtype,N>,N_rank> x,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N>,N_rank>& b)
+{
+    typedef _bz_batchCholeskySolve<T_numtype,N> T_kernel;
+    _bz_batchRun<T_kernel::byLanes>::template apply<T_kernel>(x, A, b);
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_BATCHED_CC
@@ -0,0 +1,140 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/batched.h  Small-matrix operations over whole arrays of
+ *                        TinyMatrix and TinyVector
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_BATCHED_H
+#define BZ_ARRAY_BATCHED_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/batched.h> must be included via <blitz/array.h>
+#endif
+
+#ifndef BZ_TINYMAT_H
+ #include <blitz/tinymat.h>
+#endif
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Number of matrices handled together, one per SIMD lane.
+#ifndef BZ_BATCH_WIDTH
+ #define BZ_BATCH_WIDTH 8
+#endif
+
+// Batches of fewer matrices than this are done by one thread.
+#ifndef BZ_BATCH_PARALLEL_THRESHOLD
+ #define BZ_BATCH_PARALLEL_THRESHOLD 4096
+#endif
+
+// Jacobi sweeps for the symmetric eigenvalues.  The convergence is
+// quadratic; this is enough for matrices up to about 8x8.
+#ifndef BZ_BATCH_JACOBI_SWEEPS
+ #define BZ_BATCH_JACOBI_SWEEPS 8
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * Element-by-element linear algebra on arrays of small matrices, e.g.
+ * for a field of 3x3 tensors:
+ *
+ *   Array<TinyMatrix<double,3,3>,3> D(nx,ny,nz), Dinv(nx,ny,nz);
+ *   Array<TinyVector<double,3>,3> grad(nx,ny,nz), flux(nx,ny,nz);
+ *   Array<double,3> det(nx,ny,nz);
+ *
+ *   batchedProduct(flux, D, grad);      // flux(i) = D(i) grad(i)
+ *   batchedInverse(Dinv, D);
+ *   batchedDeterminant(det, D);
+ *
+ * The products, and the determinants and inverses up to 3x3, are done
+ * one element at a time; they are short enough for the compiler to
+ * vectorize within each element.  The other operations take the matrices
+ * BZ_BATCH_WIDTH at a time and transpose them into one array per matrix
+ * element, so that the arithmetic of a batch runs across the SIMD lanes.
+ * Pivoting is then done with selects rather than branches, so all the
+ * lanes follow the same path.  With OpenMP, the elements or batches are
+ * shared between threads.
+ *
+ * The results are passed by value: like any Array copy, they refer to
+ * the caller's data, so views may be passed.  All the arrays must have
+ * the same shape.  A result may be one of the operands, but must not
+ * otherwise overlap them.  Singular matrices give infinities or NaNs,
+ * as division by zero does; nothing is checked.
+ */
+
+// C(i) = A(i) B(i)
+template<typename T_numtype, int N_rows, int N_inner, int N_columns,
+    int N_rank>
+void batchedProduct(Array<TinyMatrix<T_numtype,N_rows,N_columns>,N_rank> C,
+    const Array<TinyMatrix<T_numtype,N_rows,N_inner>,N_rank>& A,
+    const Array<TinyMatrix<T_numtype,N_inner,N_columns>,N_rank>& B);
+
+// y(i) = A(i) x(i)
+template<typename T_numtype, int N_rows, int N_columns, int N_rank>
+void batchedProduct(Array<TinyVector<T_numtype,N_rows>,N_rank> y,
+    const Array<TinyMatrix<T_numtype,N_rows,N_columns>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N_columns>,N_rank>& x);
+
+// d(i) = det A(i)
+template<typename T_numtype, int N, int N_rank>
+void batchedDeterminant(Array<T_numtype,N_rank> d,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A);
+
+// Ainv(i) = A(i)^-1, by cofactors up to 3x3, otherwise by Gauss-Jordan
+// elimination with partial pivoting
+template<typename T_numtype, int N, int N_rank>
+void batchedInverse(Array<TinyMatrix<T_numtype,N,N>,N_rank> Ainv,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A);
+
+// lambda(i) = the eigenvalues of the symmetric A(i), in increasing
+// order, by cyclic Jacobi rotations.  Only the upper triangle is read.
+template<typename T_numtype, int N, int N_rank>
+void batchedSymmetricEigenvalues(Array<TinyVector<T_numtype,N>,N_rank> lambda,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A);
+
+// Solves A(i) x(i) = b(i) by LU decomposition with partial pivoting
+template<typename T_numtype, int N, int N_rank>
+void batchedSolve(Array<TinyVector<T_numtype,N>,N_rank> x,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N>,N_rank>& b);
+
+// Solves A(i) x(i) = b(i) for symmetric positive definite A(i) by
+// Cholesky decomposition.  Only the lower triangle is read.
+template<typename T_numtype, int N, int N_rank>
+void batchedCholeskySolve(Array<TinyVector<T_numtype,N>,N_rank> x,
+    const Array<TinyMatrix<T_numtype,N,N>,N_rank>& A,
+    const Array<TinyVector<T_numtype,N>,N_rank>& b);
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/batched.cc>
+
+#endif // BZ_ARRAY_BATCHED_H
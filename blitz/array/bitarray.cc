@@ -0,0 +1,337 @@
+/***************************************************************************
+ * blitz/array/bitarray.cc  Bit-packed boolean arrays for masks and flags
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_BITARRAY_CC
+#define BZ_ARRAY_BITARRAY_CC
+
+#ifndef BZ_ARRAY_BITARRAY_H
+ #error <blitz/array/bitarray.cc> must be included via <blitz/array/bitarray.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+template<int N_rank>
+void BitArray<N_rank>::setup(const T_index& lbound, const T_index& extent)
+{
+    lbound_ = lbound;
+    extent_ = extent;
+
+    // Row-major bit strides
+    numElements_ = 1;
+    for (int r=N_rank-1; r >= 0; --r)
+    {
+        stride_(r) = numElements_;
+        numElements_ *= extent_(r);
+    }
+
+    words_.resize(_bz_bits::numWords(numElements_));
+    if (numWords())
+        words()[numWords() - 1] = 0;
+}
+
+template<int N_rank> template<typename T_expr>
+BitArray<N_rank>::BitArray(const _bz_ArrayExpr<T_expr>& x)
+{
+    T_index lbound, extent;
+    for (int r=0; r < N_rank; ++r)
+    {
+        BZPRECHECK((x.lbound(r) != INT_MIN) && (x.ubound(r) != INT_MAX),
+            "BitArray<" << N_rank << "> packed from an expression without "
+            "a domain")
+        lbound(r) = x.lbound(r);
+        extent(r) = x.ubound(r) - x.lbound(r) + 1;
+    }
+    setup(lbound, extent);
+    pack(x, lbound);
+}
+
+template<int N_rank>
+void BitArray<N_rank>::reference(const BitArray<N_rank>& x)
+{
+    lbound_ = x.lbound_;
+    extent_ = x.extent_;
+    stride_ = x.stride_;
+    numElements_ = x.numElements_;
+    words_.reference(x.words_);
+}
+
+template<int N_rank>
+BitArray<N_rank> BitArray<N_rank>::copy() const
+{
+    BitArray<N_rank> x(lbound_, extent_);
+    x = *this;
+    return x;
+}
+
+template<int N_rank>
+bool BitArray<N_rank>::isInRange(const T_index& i) const
+{
+    for (int r=0; r < N_rank; ++r)
+        if ((i(r) < lbound_(r)) || (i(r) >= lbound_(r) + extent_(r)))
+            return false;
+    return true;
+}
+
+template<int N_rank>
+void BitArray<N_rank>::clearTail()
+{
+    if (numWords())
+        words()[numWords() - 1] &= _bz_bits::lastMask(numElements_);
+}
+
+template<int N_rank>
+BitArray<N_rank>& BitArray<N_rank>::operator=(const BitArray<N_rank>& x)
+{
+    for (int r=0; r < N_rank; ++r)
+    {
+        BZPRECHECK(extent_(r) == x.extent_(r),
+            "BitArray of shape " << x.extent_ << " assigned to one of shape "
+            << extent_)
+    }
+
+    if (words() != x.words())
+    {
+        T_word* restrict dst = words();
+        const T_word* restrict src = x.words();
+        const sizeType n = numWords();
+        for (sizeType w=0; w < n; ++w)
+            dst[w] = src[w];
+    }
+    return *this;
+}
+
+template<int N_rank>
+BitArray<N_rank>& BitArray<N_rank>::operator=(bool x)
+{
+    T_word* restrict dst = words();
+    const T_word value = x ? ~T_word(0) : T_word(0);
+    const sizeType n = numWords();
+    for (sizeType w=0; w < n; ++w)
+        dst[w] = value;
+    clearTail();
+    return *this;
+}
+
+template<int N_rank>
+BitArray<N_rank>& BitArray<N_rank>::operator=(const Array<bool,N_rank>& x)
+{
+    BZPRECHECK(areShapesConformable(extent_, x.extent()),
+        "Array<bool," << N_rank << "> of shape " << x.extent()
+        << " assigned to a BitArray of shape " << extent_)
+    pack(x.beginFast(), x.lbound());
+    return *this;
+}
+
+template<int N_rank> template<typename T_expr>
+BitArray<N_rank>& BitArray<N_rank>::operator=(const _bz_ArrayExpr<T_expr>& x)
+{
+    BZPRECHECK(x.shapeCheck(extent_),
+        "Expression assigned to a BitArray of shape " << extent_
+        << " has a different shape")
+
+    // The expression is read over its own domain; ranks it does not
+    // bound (index placeholders) take the indices of this array
+    T_index first;
+    for (int r=0; r < N_rank; ++r)
+        first(r) = (x.lbound(r) == INT_MIN) ? lbound_(r) : x.lbound(r);
+    pack(x, first);
+    return *this;
+}
+
+template<int N_rank> template<typename T_expr>
+BitArray<N_rank>& BitArray<N_rank>::operator=(const _bz_BitExpr<T_expr>& x)
+{
+    for (int r=0; r < N_rank; ++r)
+    {
+        BZPRECHECK(extent_(r) == x.extent()(r),
+            "Bit expression of shape " << x.extent()
+            << " assigned to a BitArray of shape " << extent_)
+    }
+
+    // Word w of the result depends only on word w of the operands, so
+    // the destination may appear on the right
+    T_word* restrict dst = words();
+    const sizeType n = numWords();
+    for (sizeType w=0; w < n; ++w)
+        dst[w] = x.word(w);
+    clearTail();
+    return *this;
+}
+
+template<int N_rank> template<typename T_expr>
+void BitArray<N_rank>::pack(T_expr expr, const T_index& first)
+{
+    if (numElements_ == 0)
+        return;
+
+    const int innerRank = N_rank - 1;
+    const int length = extent_(innerRank);
+    T_word* restrict dst = words();
+
+    // Bits are gathered into word until it is full; the rows run on from
+    // one to the next without padding
+    T_word word = 0;
+    int bit = 0;
+    T_index i = first;
+
+    while (true)
+    {
+        expr.moveTo(i);
+        expr.loadStride(innerRank);
+
+#ifdef BZ_USE_FAST_READ_ARRAY_EXPR
+        if (expr.isUnitStride(innerRank))
+        {
+            int j = 0;
+
+            // Whole words at once while the row is word-aligned
+            if (bit == 0)
+                for (; j + _bz_bits::wordBits <= length;
+                    j += _bz_bits::wordBits)
+                {
+                    T_word w = 0;
+                    for (int b=0; b < _bz_bits::wordBits; ++b)
+                        w |= T_word(bool(expr.fastRead(j + b))) << b;
+                    *dst++ = w;
+                }
+
+            for (; j < length; ++j)
+            {
+                word |= T_word(bool(expr.fastRead(j))) << bit;
+                if (++bit == _bz_bits::wordBits)
+                {
+                    *dst++ = word;
+                    word = 0;
+                    bit = 0;
+                }
+            }
+        }
+        else
+#endif
+        {
+            for (int j=0; j < length; ++j)
+            {
+                word |= T_word(bool(*expr)) << bit;
+                expr.advance();
+                if (++bit == _bz_bits::wordBits)
+                {
+                    *dst++ = word;
+                    word = 0;
+                    bit = 0;
+                }
+            }
+        }
+
+        // Next row
+        int r = innerRank - 1;
+        while ((r >= 0) && (++i(r) >= first(r) + extent_(r)))
+        {
+            i(r) = first(r);
+            --r;
+        }
+        if (r < 0)
+            break;
+    }
+
+    if (bit)
+        *dst = word;
+}
+
+// Reductions over the words of a bit expression
+
+template<typename T_expr>
+sizeType _bz_bitCount(const T_expr& x)
+{
+    const sizeType numBits = x.numElements(),
+        full = numBits / _bz_bits::wordBits;
+    sizeType n = 0;
+    for (sizeType w=0; w < full; ++w)
+        n += _bz_bits::popcount(x.word(w));
+    if (full < _bz_bits::numWords(numBits))
+        n += _bz_bits::popcount(x.word(full) & _bz_bits::lastMask(numBits));
+    return n;
+}
+
+template<typename T_expr>
+bool _bz_bitAny(const T_expr& x)
+{
+    const sizeType numBits = x.numElements(),
+        full = numBits / _bz_bits::wordBits;
+    for (sizeType w=0; w < full; ++w)
+        if (x.word(w))
+            return true;
+    if (full < _bz_bits::numWords(numBits))
+        return (x.word(full) & _bz_bits::lastMask(numBits)) != 0;
+    return false;
+}
+
+template<typename T_expr>
+bool _bz_bitAll(const T_expr& x)
+{
+    typedef _bz_bits::T_word T_word;
+    const sizeType numBits = x.numElements(),
+        full = numBits / _bz_bits::wordBits;
+    for (sizeType w=0; w < full; ++w)
+        if (x.word(w) != ~T_word(0))
+            return false;
+    if (full < _bz_bits::numWords(numBits))
+    {
+        const T_word mask = _bz_bits::lastMask(numBits);
+        return (x.word(full) & mask) == mask;
+    }
+    return true;
+}
+
+template<int N_rank>
+sizeType count(const BitArray<N_rank>& x)
+{ return _bz_bitCount(_bz_BitArrayWords<N_rank>(x)); }
+
+template<typename T_expr>
+sizeType count(const _bz_BitExpr<T_expr>& x)
+{ return _bz_bitCount(x); }
+
+template<int N_rank>
+bool any(const BitArray<N_rank>& x)
+{ return _bz_bitAny(_bz_BitArrayWords<N_rank>(x)); }
+
+template<typename T_expr>
+bool any(const _bz_BitExpr<T_expr>& x)
+{ return _bz_bitAny(x); }
+
+template<int N_rank>
+bool all(const BitArray<N_rank>& x)
+{ return _bz_bitAll(_bz_BitArrayWords<N_rank>(x)); }
+
+template<typename T_expr>
+bool all(const _bz_BitExpr<T_expr>& x)
+{ return _bz_bitAll(x); }
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_BITARRAY_CC
@@ -0,0 +1,750 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/bitarray.h  Bit-packed boolean arrays for masks and flags
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_BITARRAY_H
+#define BZ_ARRAY_BITARRAY_H
+
+#ifndef BZ_ARRAY_H
+ #include <blitz/array.h>
+#endif
+
+#include <climits>
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * Array<bool,N> spends a byte on every element.  BitArray<N> stores one
+ * bit per element, packed in row-major order into machine words, for
+ * masks and flags on large grids:
+ *
+ *   BitArray<3> solid(phi < 0.);           // pack a boolean expression
+ *   BitArray<3> wet = !solid && (h > 0.);  // one word (64 cells) per op
+ *   sizeType n = count(wet);               // popcount
+ *   u = where(wet, u + dt * f, 0.);        // condition of an expression
+ *   wet(i,j,k) = false;                    // single bits, via a proxy
+ *
+ * !, && and || between BitArrays are evaluated a word at a time, and
+ * count(), any() and all() reduce whole words.  Anywhere else a BitArray
+ * behaves as an ordinary bool-valued array operand.  Copy construction
+ * shares the bits, as for Array; assignment copies them.
+ *
+ * The bits past the last element of the last word are kept zero.
+ */
+
+template<int N_rank>
+class BitArray;
+
+// The word type and its bit operations
+struct _bz_bits {
+    typedef unsigned long T_word;
+
+    static const int wordBits = sizeof(T_word) * CHAR_BIT;
+
+    static sizeType numWords(sizeType numBits)
+    { return (numBits + wordBits - 1) / wordBits; }
+
+    // The valid bits of the last word of numBits bits
+    static T_word lastMask(sizeType numBits)
+    {
+        const int tail = numBits % wordBits;
+        return tail ? (T_word(1) << tail) - 1 : ~T_word(0);
+    }
+
+    static int popcount(T_word x)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountl(x);
+#else
+        int n = 0;
+        for (; x; x &= x - 1)
+            ++n;
+        return n;
+#endif
+    }
+};
+
+// Proxy for one bit of a BitArray
+class _bz_BitReference {
+public:
+    typedef _bz_bits::T_word T_word;
+
+    _bz_BitReference(T_word& word, T_word mask)
+      : word_(&word), mask_(mask)
+    { }
+
+    operator bool() const
+    { return (*word_ & mask_) != 0; }
+
+    _bz_BitReference& operator=(bool x)
+    {
+        if (x)
+            *word_ |= mask_;
+        else
+            *word_ &= ~mask_;
+        return *this;
+    }
+
+    _bz_BitReference& operator=(const _bz_BitReference& x)
+    { return *this = bool(x); }
+
+private:
+    T_word* word_;
+    T_word mask_;
+};
+
+/*
+ * Word-at-a-time expressions.  Every node has rank, lbound(), extent(),
+ * numElements() and word(w), the w'th word of the packed result; the
+ * bits past the end are garbage until masked.
+ */
+
+template<int N_rank>
+class _bz_BitArrayWords {
+public:
+    typedef _bz_bits::T_word T_word;
+    static const int rank = N_rank;
+
+    _bz_BitArrayWords(const BitArray<N_rank>& array)
+      : array_(array)
+    { }
+
+    T_word word(sizeType w) const
+    { return array_.words()[w]; }
+
+    const TinyVector<int,N_rank>& lbound() const
+    { return array_.lbound(); }
+
+    const TinyVector<int,N_rank>& extent() const
+    { return array_.extent(); }
+
+    sizeType numElements() const
+    { return array_.numElements(); }
+
+private:
+    const BitArray<N_rank>& array_;
+};
+
+template<typename P_left, typename P_right, typename P_op>
+class _bz_BitBinaryOp {
+public:
+    typedef _bz_bits::T_word T_word;
+    static const int rank = P_left::rank;
+
+    _bz_BitBinaryOp(const P_left& left, const P_right& right)
+      : left_(left), right_(right)
+    {
+        for (int r=0; r < rank; ++r)
+        {
+            BZPRECHECK(left_.extent()(r) == right_.extent()(r),
+                "Bit arrays of shapes " << left_.extent() << " and "
+                << right_.extent() << " in one expression")
+        }
+    }
+
+    T_word word(sizeType w) const
+    { return P_op::apply(left_.word(w), right_.word(w)); }
+
+    const TinyVector<int,rank>& lbound() const
+    { return left_.lbound(); }
+
+    const TinyVector<int,rank>& extent() const
+    { return left_.extent(); }
+
+    sizeType numElements() const
+    { return left_.numElements(); }
+
+private:
+    P_left left_;
+    P_right right_;
+};
+
+template<typename P_expr>
+class _bz_BitNot {
+public:
+    typedef _bz_bits::T_word T_word;
+    static const int rank = P_expr::rank;
+
+    _bz_BitNot(const P_expr& expr)
+      : expr_(expr)
+    { }
+
+    T_word word(sizeType w) const
+    { return ~expr_.word(w); }
+
+    const TinyVector<int,rank>& lbound() const
+    { return expr_.lbound(); }
+
+    const TinyVector<int,rank>& extent() const
+    { return expr_.extent(); }
+
+    sizeType numElements() const
+    { return expr_.numElements(); }
+
+private:
+    P_expr expr_;
+};
+
+struct _bz_BitAnd {
+    static _bz_bits::T_word apply(_bz_bits::T_word a, _bz_bits::T_word b)
+    { return a & b; }
+};
+
+struct _bz_BitOr {
+    static _bz_bits::T_word apply(_bz_bits::T_word a, _bz_bits::T_word b)
+    { return a | b; }
+};
+
+// Wrapper which marks a word expression as such for overloading
+template<typename P_expr>
+class _bz_BitExpr : public ETBase<_bz_BitExpr<P_expr> > {
+public:
+    typedef P_expr T_expr;
+    typedef _bz_bits::T_word T_word;
+    static const int rank = P_expr::rank;
+
+    _bz_BitExpr(const P_expr& expr)
+      : expr_(expr)
+    { }
+
+    T_word word(sizeType w) const
+    { return expr_.word(w); }
+
+    const TinyVector<int,rank>& lbound() const
+    { return expr_.lbound(); }
+
+    const TinyVector<int,rank>& extent() const
+    { return expr_.extent(); }
+
+    sizeType numElements() const
+    { return expr_.numElements(); }
+
+    const P_expr& expr() const
+    { return expr_; }
+
+private:
+    P_expr expr_;
+};
+
+template<typename T>
+struct _bz_BitOperand;
+
+template<int N_rank>
+struct _bz_BitOperand<BitArray<N_rank> > {
+    typedef _bz_BitArrayWords<N_rank> T_expr;
+    static T_expr getExpr(const BitArray<N_rank>& x)
+    { return T_expr(x); }
+};
+
+template<typename T>
+struct _bz_BitOperand<_bz_BitExpr<T> > {
+    typedef T T_expr;
+    static const T_expr& getExpr(const _bz_BitExpr<T>& x)
+    { return x.expr(); }
+};
+
+template<int N_rank>
+class BitArray : public ETBase<BitArray<N_rank> > {
+
+public:
+    typedef bool T_numtype;
+    typedef _bz_bits::T_word T_word;
+    typedef TinyVector<int,N_rank> T_index;
+    static const int rank = N_rank;
+
+    BitArray()
+      : lbound_(0), extent_(0), stride_(0), numElements_(0)
+    { }
+
+    explicit BitArray(int extent0)
+    {
+        BZPRECONDITION(N_rank == 1);
+        setup(T_index(0), T_index(extent0));
+    }
+
+    BitArray(int extent0, int extent1)
+    {
+        BZPRECONDITION(N_rank == 2);
+        T_index extent;
+        extent(0) = extent0;
+        extent(N_rank - 1) = extent1;
+        setup(T_index(0), extent);
+    }
+
+    BitArray(int extent0, int extent1, int extent2)
+    {
+        BZPRECONDITION(N_rank == 3);
+        T_index extent;
+        extent(0) = extent0;
+        extent(1 % N_rank) = extent1;
+        extent(N_rank - 1) = extent2;
+        setup(T_index(0), extent);
+    }
+
+    explicit BitArray(const T_index& extent)
+    { setup(T_index(0), extent); }
+
+    BitArray(const T_index& lbound, const T_index& extent)
+    { setup(lbound, extent); }
+
+    // A copy shares the bits of x, as copies of Arrays do; see copy()
+    BitArray(const BitArray<N_rank>& x)
+      : ETBase<BitArray<N_rank> >(x), lbound_(x.lbound_),
+        extent_(x.extent_), stride_(x.stride_),
+        numElements_(x.numElements_), words_(x.words_)
+    { }
+
+    // Pack a boolean array or expression over its domain
+    explicit BitArray(const Array<bool,N_rank>& x)
+    {
+        setup(x.lbound(), x.extent());
+        pack(x.beginFast(), x.lbound());
+    }
+
+    template<typename T_expr>
+    BitArray(const _bz_ArrayExpr<T_expr>& x);
+
+    template<typename T_expr>
+    BitArray(const _bz_BitExpr<T_expr>& x)
+    {
+        setup(x.lbound(), x.extent());
+        *this = x;
+    }
+
+    // Make this array share the bits of x
+    void reference(const BitArray<N_rank>& x);
+
+    // A deep copy
+    BitArray<N_rank> copy() const;
+
+    // Change the shape; the contents are lost
+    void resize(const T_index& extent)
+    { setup(lbound_, extent); }
+
+    int lbound(int r) const
+    { return lbound_(r); }
+
+    int ubound(int r) const
+    { return lbound_(r) + extent_(r) - 1; }
+
+    int extent(int r) const
+    { return extent_(r); }
+
+    const T_index& lbound() const
+    { return lbound_; }
+
+    T_index ubound() const
+    { return lbound_ + extent_ - 1; }
+
+    const T_index& extent() const
+    { return extent_; }
+
+    sizeType numElements() const
+    { return numElements_; }
+
+    RectDomain<N_rank> domain() const
+    { return RectDomain<N_rank>(lbound(), ubound()); }
+
+    bool isInRange(const T_index& i) const;
+
+    // The packed words; element i is bit bitIndex(i)
+    const T_word* words() const
+    { return words_.data(); }
+
+    T_word* words()
+    { return words_.data(); }
+
+    sizeType numWords() const
+    { return words_.numElements(); }
+
+    diffType bitIndex(const T_index& i) const
+    {
+        diffType k = 0;
+        for (int r=0; r < N_rank; ++r)
+            k += stride_(r) * (i(r) - lbound_(r));
+        return k;
+    }
+
+    bool bit(diffType k) const
+    {
+        return (words()[sizeType(k) / _bz_bits::wordBits]
+            >> (sizeType(k) % _bz_bits::wordBits)) & 1;
+    }
+
+    _bz_BitReference bitReference(diffType k)
+    {
+        return _bz_BitReference(words()[sizeType(k) / _bz_bits::wordBits],
+            T_word(1) << (sizeType(k) % _bz_bits::wordBits));
+    }
+
+    bool operator()(const T_index& i) const
+    {
+        BZPRECHECK(isInRange(i), "BitArray index out of range: " << i)
+        return bit(bitIndex(i));
+    }
+
+    bool operator()(int i0) const
+    { return (*this)(T_index(i0)); }
+
+    bool operator()(int i0, int i1) const
+    { return (*this)(TinyVector<int,2>(i0, i1)); }
+
+    bool operator()(int i0, int i1, int i2) const
+    { return (*this)(TinyVector<int,3>(i0, i1, i2)); }
+
+    _bz_BitReference operator()(const T_index& i)
+    {
+        BZPRECHECK(isInRange(i), "BitArray index out of range: " << i)
+        return bitReference(bitIndex(i));
+    }
+
+    _bz_BitReference operator()(int i0)
+    { return (*this)(T_index(i0)); }
+
+    _bz_BitReference operator()(int i0, int i1)
+    { return (*this)(TinyVector<int,2>(i0, i1)); }
+
+    _bz_BitReference operator()(int i0, int i1, int i2)
+    { return (*this)(TinyVector<int,3>(i0, i1, i2)); }
+
+    BitArray<N_rank>& operator=(const BitArray<N_rank>& x);
+
+    BitArray<N_rank>& operator=(bool x);
+
+    BitArray<N_rank>& operator=(const Array<bool,N_rank>& x);
+
+    template<typename T_expr>
+    BitArray<N_rank>& operator=(const _bz_ArrayExpr<T_expr>& x);
+
+    template<typename T_expr>
+    BitArray<N_rank>& operator=(const _bz_BitExpr<T_expr>& x);
+
+    template<typename T>
+    BitArray<N_rank>& operator&=(const T& x)
+    { return *this = (*this && x); }
+
+    template<typename T>
+    BitArray<N_rank>& operator|=(const T& x)
+    { return *this = (*this || x); }
+
+private:
+    void setup(const T_index& lbound, const T_index& extent);
+
+    // Evaluate a bool-valued iterator over the domain, in storage order;
+    // first is the index of expr at the first element of this array
+    template<typename T_expr>
+    void pack(T_expr expr, const T_index& first);
+
+    // Clear the bits past the last element
+    void clearTail();
+
+    T_index lbound_, extent_;
+    TinyVector<diffType,N_rank> stride_;
+    sizeType numElements_;
+    Array<T_word,1> words_;
+};
+
+/*
+ * Word-at-a-time logical operators
+ */
+
+template<typename T_left, typename T_right, typename T_op>
+struct _bz_BitBinaryResult {
+    typedef _bz_BitExpr<_bz_BitBinaryOp<
+        _bz_typename _bz_BitOperand<T_left>::T_expr,
+        _bz_typename _bz_BitOperand<T_right>::T_expr, T_op> > T_result;
+
+    static T_result apply(const T_left& a, const T_right& b)
+    {
+        return T_result(_bz_BitBinaryOp<
+            _bz_typename _bz_BitOperand<T_left>::T_expr,
+            _bz_typename _bz_BitOperand<T_right>::T_expr, T_op>(
+                _bz_BitOperand<T_left>::getExpr(a),
+                _bz_BitOperand<T_right>::getExpr(b)));
+    }
+};
+
+#define BZ_DECLARE_BIT_BINARY_OP(name,op)                                 \
+template<int N_rank>                                                      \
+inline _bz_typename _bz_BitBinaryResult<BitArray<N_rank>,                 \
+    BitArray<N_rank>, op>::T_result                                       \
+name(const BitArray<N_rank>& a, const BitArray<N_rank>& b)                \
+{                                                                         \
+    return _bz_BitBinaryResult<BitArray<N_rank>, BitArray<N_rank>,        \
+        op>::apply(a, b);                                                 \
+}                                                                         \
+                                                                          \
+template<int N_rank, typename T>                                          \
+inline _bz_typename _bz_BitBinaryResult<BitArray<N_rank>,                 \
+    _bz_BitExpr<T>, op>::T_result                                         \
+name(const BitArray<N_rank>& a, const _bz_BitExpr<T>& b)                  \
+{                                                                         \
+    return _bz_BitBinaryResult<BitArray<N_rank>, _bz_BitExpr<T>,          \
+        op>::apply(a, b);                                                 \
+}                                                                         \
+                                                                          \
+template<typename T, int N_rank>                                          \
+inline _bz_typename _bz_BitBinaryResult<_bz_BitExpr<T>,                   \
+    BitArray<N_rank>, op>::T_result                                       \
+name(const _bz_BitExpr<T>& a, const BitArray<N_rank>& b)                  \
+{                                                                         \
+    return _bz_BitBinaryResult<_bz_BitExpr<T>, BitArray<N_rank>,          \
+        op>::apply(a, b);                                                 \
+}                                                                         \
+                                                                          \
+template<typename T1, typename T2>                                        \
+inline _bz_typename _bz_BitBinaryResult<_bz_BitExpr<T1>,                  \
+    _bz_BitExpr<T2>, op>::T_result                                        \
+name(const _bz_BitExpr<T1>& a, const _bz_BitExpr<T2>& b)                  \
+{                                                                         \
+    return _bz_BitBinaryResult<_bz_BitExpr<T1>, _bz_BitExpr<T2>,          \
+        op>::apply(a, b);                                                 \
+}
+
+BZ_DECLARE_BIT_BINARY_OP(operator&&, _bz_BitAnd)
+BZ_DECLARE_BIT_BINARY_OP(operator||, _bz_BitOr)
+
+#undef BZ_DECLARE_BIT_BINARY_OP
+
+template<int N_rank>
+inline _bz_BitExpr<_bz_BitNot<_bz_BitArrayWords<N_rank> > >
+operator!(const BitArray<N_rank>& a)
+{
+    return _bz_BitExpr<_bz_BitNot<_bz_BitArrayWords<N_rank> > >(
+        _bz_BitArrayWords<N_rank>(a));
+}
+
+template<typename T>
+inline _bz_BitExpr<_bz_BitNot<T> >
+operator!(const _bz_BitExpr<T>& a)
+{
+    return _bz_BitExpr<_bz_BitNot<T> >(_bz_BitOperand<_bz_BitExpr<T> >
+        ::getExpr(a));
+}
+
+/*
+ * Popcount reductions
+ */
+
+template<int N_rank>
+sizeType count(const BitArray<N_rank>& x);
+
+template<typename T_expr>
+sizeType count(const _bz_BitExpr<T_expr>& x);
+
+template<int N_rank>
+bool any(const BitArray<N_rank>& x);
+
+template<typename T_expr>
+bool any(const _bz_BitExpr<T_expr>& x);
+
+template<int N_rank>
+bool all(const BitArray<N_rank>& x);
+
+template<typename T_expr>
+bool all(const _bz_BitExpr<T_expr>& x);
+
+/*
+ * A BitArray as an operand of ordinary array expressions, e.g. the
+ * condition of where().  It reads single bits, tracking the position
+ * as a bit index.
+ */
+
+template<int N_rank>
+class _bz_BitArrayIterator {
+public:
+    typedef bool T_numtype;
+    typedef _bz_bits::T_word T_word;
+    typedef const BitArray<N_rank>& T_ctorArg1;
+    typedef int T_ctorArg2;    // dummy
+    typedef _bz_BitArrayIterator<N_rank> T_range_result;
+
+    static const int
+        numArrayOperands = 1,
+        numIndexPlaceholders = 0,
+        rank = N_rank;
+
+    _bz_BitArrayIterator(const BitArray<N_rank>& array)
+      : array_(array), data_(array.words()), pos_(0), stride_(1)
+    {
+        diffType s = 1;
+        for (int r=N_rank-1; r >= 0; --r)
+        {
+            strides_(r) = s;
+            s *= array.extent(r);
+        }
+    }
+
+    _bz_BitArrayIterator(const _bz_BitArrayIterator<N_rank>& x)
+      : array_(x.array_), data_(array_.words()), pos_(x.pos_),
+        stride_(x.stride_), strides_(x.strides_)
+    { }
+
+    bool bit(diffType k) const
+    {
+        return (data_[sizeType(k) / _bz_bits::wordBits]
+            >> (sizeType(k) % _bz_bits::wordBits)) & 1;
+    }
+
+    bool operator*() const
+    { return bit(pos_); }
+
+    bool first_value() const
+    { return bit(0); }
+
+    bool operator()(const TinyVector<int,N_rank>& i) const
+    { return array_(i); }
+
+    int ascending(const int r) const
+    { return (r < N_rank) ? true : INT_MIN; }
+
+    int ordering(const int r) const
+    { return (r < N_rank) ? N_rank - 1 - r : INT_MIN; }
+
+    int lbound(const int r) const
+    { return (r < N_rank) ? array_.lbound(r) : INT_MIN; }
+
+    int ubound(const int r) const
+    { return (r < N_rank) ? array_.ubound(r) : INT_MAX; }
+
+    RectDomain<N_rank> domain() const
+    { return array_.domain(); }
+
+    void push(int position)
+    { stack_[position] = pos_; }
+
+    void pop(int position)
+    { pos_ = stack_[position]; }
+
+    void advance()
+    { pos_ += stride_; }
+
+    void advance(int n)
+    { pos_ += n * stride_; }
+
+    void loadStride(int r)
+    { stride_ = strides_(r); }
+
+    bool isUnitStride(int r) const
+    { return strides_(r) == 1; }
+
+    void advanceUnitStride()
+    { ++pos_; }
+
+    bool canCollapse(int outerLoopRank, int innerLoopRank) const
+    {
+        return strides_(outerLoopRank)
+            == strides_(innerLoopRank) * array_.extent(innerLoopRank);
+    }
+
+    bool operator[](int i) const
+    { return bit(pos_ + i * stride_); }
+
+    bool fastRead(sizeType i) const
+    { return bit(pos_ + i); }
+
+    void _bz_offsetData(sizeType i)
+    { pos_ += i; }
+
+    void _bz_offsetData(sizeType offset, int dim)
+    { pos_ += offset * strides_(dim); }
+
+    void _bz_offsetData(sizeType offset1, int dim1, sizeType offset2,
+        int dim2)
+    { pos_ += offset1 * strides_(dim1) + offset2 * strides_(dim2); }
+
+    diffType suggestStride(int r) const
+    { return strides_(r); }
+
+    bool isStride(int r, diffType stride) const
+    { return strides_(r) == stride; }
+
+    template<int N_rank2>
+    void moveTo(const TinyVector<int,N_rank2>& i)
+    { pos_ = array_.bitIndex(i); }
+
+    bool shift(int offset, int dim) const
+    { return bit(pos_ + offset * strides_(dim)); }
+
+    bool shift(int offset1, int dim1, int offset2, int dim2) const
+    { return bit(pos_ + offset1 * strides_(dim1) + offset2 * strides_(dim2)); }
+
+    void prettyPrint(BZ_STD_SCOPE(string) &str,
+        prettyPrintFormat& format) const
+    {
+        if (format.tersePrintingSelected())
+            str += format.nextArrayOperandSymbol();
+        else
+            str += "BitArray";
+    }
+
+    template<typename T_shape>
+    bool shapeCheck(const T_shape& shape) const
+    { return areShapesConformable(shape, array_.extent()); }
+
+    // Expressions holding a BitArray cannot be sliced
+    template<typename T1, typename T2 = nilArraySection,
+        typename T3 = nilArraySection, typename T4 = nilArraySection,
+        typename T5 = nilArraySection, typename T6 = nilArraySection,
+        typename T7 = nilArraySection, typename T8 = nilArraySection,
+        typename T9 = nilArraySection, typename T10 = nilArraySection,
+        typename T11 = nilArraySection>
+    class SliceInfo {
+    public:
+        typedef _bz_BitArrayIterator<N_rank> T_slice;
+    };
+
+private:
+    // A copy, sharing the bits, so that packed temporaries live on
+    BitArray<N_rank> array_;
+    const T_word* data_;
+    diffType pos_, stride_;
+    TinyVector<diffType,N_rank> strides_;
+    diffType stack_[N_rank];
+};
+
+template<int N_rank>
+struct asExpr<BitArray<N_rank> > {
+    typedef _bz_BitArrayIterator<N_rank> T_expr;
+    static T_expr getExpr(const BitArray<N_rank>& x)
+    { return T_expr(x); }
+};
+
+template<typename T>
+struct asExpr<_bz_BitExpr<T> > {
+    typedef _bz_BitArrayIterator<_bz_BitExpr<T>::rank> T_expr;
+    static T_expr getExpr(const _bz_BitExpr<T>& x)
+    { return T_expr(BitArray<_bz_BitExpr<T>::rank>(x)); }
+};
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/bitarray.cc>
+
+#endif // BZ_ARRAY_BITARRAY_H
@@ -151,6 +151,47 @@ cout << "Interior: " << interior.lbound() << ", " << interior.ubound()
     return iteration;
 }
 
+// Matrix-free conjugate gradient for a symmetric positive definite
+// operator.  The operator is any callable A such that A(p, q) computes
+// q = A p for arrays shaped like x (e.g. a SparseOperator, see
+// <blitz/sparse.h>).  Iterates until |r| <= tolerance * |b| and returns
+// the number of iterations taken, or -1 if maxIterations was reached.
+
+template<typename T_operator, typename T_numtype, int N_rank>
+int conjugateGradient(const T_operator& A, Array<T_numtype,N_rank>& x,
+    const Array<T_numtype,N_rank>& b, double tolerance, int maxIterations)
+{
+    // Not interlaced: operators may require contiguous storage.
+    Array<T_numtype,N_rank> r(x.shape()), p(x.shape()), q(x.shape());
+
+    A(x, q);
+    r = b - q;
+    p = r;
+
+    T_numtype bnorm2 = sum(b * b);
+    if (bnorm2 == T_numtype(0))
+        bnorm2 = 1;
+    const T_numtype halt = tolerance * tolerance * bnorm2;
+
+    T_numtype rho = sum(r * r);
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        if (rho <= halt)
+            return iteration;
+
+        A(p, q);
+        T_numtype alpha = rho / sum(p * q);
+        x += alpha * p;
+        r -= alpha * q;
+
+        T_numtype oldrho = rho;
+        rho = sum(r * r);
+        p = r + (rho / oldrho) * p;
+    }
+
+    return (rho <= halt) ? maxIterations : -1;
+}
+
 BZ_NAMESPACE_END
 
 #endif // BZ_CGSOLVE_H
@@ -46,24 +46,23 @@ BZ_NAMESPACE(blitz)
  *   (see <blitz/indexexpr.h>)
  * - Stack traversal also scans through the destination array in storage
  *   order.  However, push/pop stack iterators are used.
- * - Fast traversal follows a Hilbert (or other) space-filling curve to
- *   improve cache reuse for stencilling operations.  Currently, the
- *   space filling curves must be generated by calling 
- *   generateFastTraversalOrder(TinyVector<int,N_dimensions>).
+ * - Fast traversal divides the ranks but the innermost into tiles, and
+ *   visits the tiles along a Hilbert (or other) space-filling curve to
+ *   improve cache reuse for stencilling operations.  The rows of each
+ *   tile are evaluated with the unit stride loop of stack traversal.
  * - 2D tiled traversal follows a tiled traversal, to improve cache reuse
  *   for 2D stencils.  Space filling curves have too much overhead to use
  *   in two-dimensions.
  *
  * _bz_tryFastTraversal is a helper class.  Fast traversals are only
  * attempted if the expression looks like a stencil -- it's at least
- * three-dimensional, has at least six array operands, and there are
+ * three-dimensional, has more than six array operands, and there are
  * no index placeholders in the expression.  These are all things which
  * can be checked at compile time, so the if()/else() syntax has been
- * replaced with this class template.
+ * replaced with this class template.  The traversal is then used if the
+ * planes the stencil reads do not fit in the cache.
  */
 
-// Fast traversals require <set> from the ISO/ANSI C++ standard library
-#ifdef BZ_HAVE_STD
 #ifdef BZ_ARRAY_SPACE_FILLING_TRAVERSAL
 
 template<bool canTryFastTraversal>
@@ -82,41 +81,30 @@ struct _bz_tryFastTraversal<true> {
     static bool tryFast(Array<T_numtype,N_rank>& array, 
         BZ_ETPARM(T_expr) expr, T_update)
     {
-        // See if there's an appropriate space filling curve available.
-        // Currently fast traversals use an N-1 dimensional curve.  The
-        // Nth dimension column corresponding to each point on the curve
-        // is traversed in the normal fashion.
-        TraversalOrderCollection<N_rank-1> traversals;
-        TinyVector<int, N_rank - 1> traversalGridSize;
-
-        for (int i=0; i < N_rank - 1; ++i)
-            traversalGridSize[i] = array.length(array.ordering(i+1));
-
-#ifdef BZ_DEBUG_TRAVERSE
-cout << "traversalGridSize = " << traversalGridSize << endl;
-cout.flush();
-#endif
-
-        const TraversalOrder<N_rank-1>* order =
-            traversals.find(traversalGridSize);
-
-        if (order)
-        {
-#ifdef BZ_DEBUG_TRAVERSE
-    cerr << "Array<" << BZ_DEBUG_TEMPLATE_AS_STRING_LITERAL(T_numtype)
-         << ", " << N_rank << ">: Using stack traversal" << endl;
+        // Like the 2D tiling heuristic: a stencil of width 3 reads three
+        // planes of the two innermost ranks of about three arrays.  If
+        // they fit in the cache, the stack traversal reuses them anyway.
+        sizeType cacheNeeded = 3 * 3 * sizeof(T_numtype)
+            * array.length(array.ordering(0))
+            * array.length(array.ordering(1));
+
+#ifdef BZ_RUNTIME_TUNING
+        const TuningParameters& params = TuningParameters::instance();
+        if (cacheNeeded <= params.curveStencilCache())
+            return false;
+        array.evaluateWithFastTraversal(params.tileOrder(),
+            params.curveTileSize(), expr, T_update());
+#else
+        if (cacheNeeded <= BZ_L2_CACHE_ESTIMATED_SIZE)
+            return false;
+        array.evaluateWithFastTraversal(BZ_ARRAY_SPACE_FILLING_ORDER,
+            BZ_ARRAY_SPACE_FILLING_TILE_SIZE, expr, T_update());
 #endif
-            // A curve was available -- use fast traversal.
-            array.evaluateWithFastTraversal(*order, expr, T_update());
-            return true;
-        }
-
-        return false;
+        return true;
     }
 };
 
 #endif // BZ_ARRAY_SPACE_FILLING_TRAVERSAL
-#endif // BZ_HAVE_STD
 
 template<typename T_numtype, int N_rank> template<typename T_expr, typename T_update>
 inline Array<T_numtype, N_rank>& 
@@ -190,9 +178,38 @@ Array<T_numtype, N_rank>::evaluate(T_expr expr,
     TAU_PROFILE(" ", exprDescription, TAU_BLITZ);
 #endif
 
+    // Built-in profiler (see <blitz/profile.h>), keyed the same way
+#ifdef BZ_PROFILE_EXPRESSIONS
+    static _bz_expressionProfileKey profileKey;
+    if (_bz_evaluationProfile::active() && !profileKey.expression.length())
+    {
+        profileKey.expression = "A";
+        prettyPrintFormat format(true);
+        format.nextArrayOperandSymbol();
+        T_update::prettyPrint(profileKey.expression);
+        expr.prettyPrint(profileKey.expression, format);
+    }
+    _bz_evaluationProfile profile(profileKey, numElements());
+#endif
+
     // Determine which evaluation mechanism to use 
     if (T_expr::numIndexPlaceholders > 0)
     {
+#ifdef BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL
+        // The expression involves index placeholders.  These are
+        // counters which the stack traversal advances with the loops,
+        // and index mappings such as B(tensor::j,tensor::i) step through
+        // B by its strides, so nothing is recomputed from the index.
+        // Start all the operands at the first element of this array,
+        // as index traversal would.
+
+        expr.moveTo(base());
+
+        if (N_rank == 1)
+            return evaluateWithStackTraversal1(expr, T_update());
+        else
+            return evaluateWithStackTraversalN(expr, T_update());
+#else
         // The expression involves index placeholders, so have to
         // use index traversal rather than stack traversal.
 
@@ -200,15 +217,13 @@ Array<T_numtype, N_rank>::evaluate(T_expr expr,
             return evaluateWithIndexTraversal1(expr, T_update());
         else
             return evaluateWithIndexTraversalN(expr, T_update());
+#endif
     }
     else {
 
         // If this expression looks like an array stencil, then attempt to
         // use a fast traversal order.
-        // Fast traversals require <set> from the ISO/ANSI C++ standard
-        // library.
 
-#ifdef BZ_HAVE_STD
 #ifdef BZ_ARRAY_SPACE_FILLING_TRAVERSAL
 
         enum { isStencil = (N_rank >= 3) && (T_expr::numArrayOperands > 6)
@@ -218,7 +233,6 @@ Array<T_numtype, N_rank>::evaluate(T_expr expr,
             return *this;
 
 #endif
-#endif
 
 #ifdef BZ_ARRAY_2D_STENCIL_TILING
         // Does this look like a 2-dimensional stencil on a largeish
@@ -237,8 +251,14 @@ Array<T_numtype, N_rank>::evaluate(T_expr expr,
             //    3 arrays involved in stencil
             //    Uniform data type in arrays (all T_numtype)
             
-            int cacheNeeded = 3 * 3 * sizeof(T_numtype) * length(ordering(0));
+            sizeType cacheNeeded = 3 * 3 * sizeof(T_numtype)
+                * length(ordering(0));
+#ifdef BZ_RUNTIME_TUNING
+            if (cacheNeeded
+                > TuningParameters::instance().tiledStencilCache())
+#else
             if (cacheNeeded > BZ_L1_CACHE_ESTIMATED_SIZE)
+#endif
                 return evaluateWithTiled2DTraversal(expr, T_update());
         }
 
@@ -286,6 +306,9 @@ Array<T_numtype, N_rank>::evaluateWithStackTraversal1(
     bool useCommonStride = false;
 #endif
 
+    BZ_PROFILE_TRAVERSAL(stackTraversal);
+    BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride);
+
     const T_numtype * last = iter.data() + length(firstRank) 
         * stride(firstRank);
 
@@ -538,6 +561,10 @@ Array<T_numtype, N_rank>::evaluateWithStackTraversalN(
 
 #endif // BZ_COLLAPSE_LOOPS
 
+    BZ_PROFILE_TRAVERSAL((firstNoncollapsedLoop > 1) ? collapsedTraversal
+        : stackTraversal);
+    BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride);
+
     /*
      * Now we actually perform the loops.  This while loop contains
      * two parts: first, the innermost loop is performed.  Then we
@@ -688,6 +715,9 @@ Array<T_numtype, N_rank>::evaluateWithIndexTraversal1(
 {
     TinyVector<int,N_rank> index;
 
+    BZ_PROFILE_TRAVERSAL(indexTraversal);
+    BZ_PROFILE_INNER_LOOP(stride(firstRank) == 1, false);
+
     if (stride(firstRank) == 1)
     {
         T_numtype * restrict iter = data_ + lbound(firstRank);
@@ -740,6 +770,9 @@ Array<T_numtype, N_rank>::evaluateWithIndexTraversalN(
 
     iter.loadStride(maxRank);
 
+    BZ_PROFILE_TRAVERSAL(indexTraversal);
+    BZ_PROFILE_INNER_LOOP(stride(maxRank) == 1, false);
+
     TinyVector<int,N_rank> index, last;
 
     index = storage_.base();
@@ -792,30 +825,25 @@ Array<T_numtype, N_rank>::evaluateWithIndexTraversalN(
     return *this; 
 }
 
-// Fast traversals require <set> from the ISO/ANSI C++ standard library
-
-#ifdef BZ_HAVE_STD
 #ifdef BZ_ARRAY_SPACE_FILLING_TRAVERSAL
 
 template<typename T_numtype, int N_rank> template<typename T_expr, typename T_update>
 inline Array<T_numtype, N_rank>&
 Array<T_numtype, N_rank>::evaluateWithFastTraversal(
-    const TraversalOrder<N_rank - 1>& order, 
+    TileOrder order, int tileSize,
     T_expr expr,
     T_update)
 {
     const int maxRank = ordering(0);
-
-#ifdef BZ_DEBUG_TRAVERSE
-    const int secondLastRank = ordering(1);
-    cerr << "maxRank = " << maxRank << " secondLastRank = " << secondLastRank
-         << endl;
-#endif
+    const int N_outer = N_rank - 1;
 
     FastArrayIterator<T_numtype, N_rank> iter(*this);
     iter.push(0);
     expr.push(0);
 
+    iter.loadStride(maxRank);
+    expr.loadStride(maxRank);
+
     bool useUnitStride = iter.isUnitStride(maxRank) 
                           && expr.isUnitStride(maxRank);
 
@@ -830,92 +858,120 @@ Array<T_numtype, N_rank>::evaluateWithFastTraversal(
     bool useCommonStride = false;
 #endif
 
+    BZ_PROFILE_TRAVERSAL(spaceFillingTraversal);
+    BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride);
+
     int lastLength = length(maxRank);
 
-    for (int i=0; i < order.length(); ++i)
+    // Tile j of the curve spans the rows [first,last) along ordering(j+1)
+    TinyVector<int, N_outer> outerLength, numTiles, tile, first, last, row;
+    for (int j=0; j < N_outer; ++j)
     {
-        iter.pop(0);
-        expr.pop(0);
+        outerLength[j] = length(ordering(j+1));
+        numTiles[j] = (outerLength[j] + tileSize - 1) / tileSize;
+    }
+
+    TraversalOrder<N_outer> tiles(numTiles, order);
+
+    while (tiles.next(tile))
+    {
+        for (int j=0; j < N_outer; ++j)
+        {
+            first[j] = tile[j] * tileSize;
+            last[j] = first[j] + tileSize;
+            if (last[j] > outerLength[j])
+                last[j] = outerLength[j];
+        }
+        row = first;
 
+        for (;;)
+        {
 #ifdef BZ_DEBUG_TRAVERSE
-    cerr << "Traversing: " << order[i] << endl;
+    cerr << "Traversing: " << row << endl;
 #endif
-        // Position the iterator at the start of the next column       
-        for (int j=1; j < N_rank; ++j)
-        {
-            iter.loadStride(ordering(j));
-            expr.loadStride(ordering(j));
+            // Position the iterator at the start of the row
+            iter.pop(0);
+            expr.pop(0);
 
-            int offset = order[i][j-1];
-            iter.advance(offset);
-            expr.advance(offset);
-        }
+            for (int j=0; j < N_outer; ++j)
+            {
+                iter.loadStride(ordering(j+1));
+                expr.loadStride(ordering(j+1));
+                iter.advance(row[j]);
+                expr.advance(row[j]);
+            }
 
-        iter.loadStride(maxRank);
-        expr.loadStride(maxRank);
+            iter.loadStride(maxRank);
+            expr.loadStride(maxRank);
 
-        // Evaluate the expression along the column
+            // Evaluate the expression along the row
 
-        if ((useUnitStride) || (useCommonStride))
-        {
+            if ((useUnitStride) || (useCommonStride))
+            {
 #ifdef BZ_USE_FAST_READ_ARRAY_EXPR
-            diffType ubound = lastLength * commonStride;
-            T_numtype* restrict data = const_cast<T_numtype*>(iter.data());
+                diffType ubound = lastLength * commonStride;
+                T_numtype* restrict data = const_cast<T_numtype*>(iter.data());
 
-            if (commonStride == 1)
-            {            
+                if (commonStride == 1)
+                {            
  #ifndef BZ_ARRAY_FAST_TRAVERSAL_UNROLL
-                for (diffType i=0; i < ubound; ++i)
-                    T_update::update(*data++, expr.fastRead(i));
+                    for (diffType i=0; i < ubound; ++i)
+                        T_update::update(*data++, expr.fastRead(i));
  #else
-                diffType n1 = ubound & 3;
-                diffType i=0;
-                for (; i < n1; ++i)
-                    T_update::update(*data++, expr.fastRead(i));
+                    diffType n1 = ubound & 3;
+                    diffType i=0;
+                    for (; i < n1; ++i)
+                        T_update::update(*data++, expr.fastRead(i));
 
-                for (; i < ubound; i += 4)
-                {
-                    T_update::update(*data++, expr.fastRead(i));
-                    T_update::update(*data++, expr.fastRead(i+1));
-                    T_update::update(*data++, expr.fastRead(i+2));
-                    T_update::update(*data++, expr.fastRead(i+3));
-                }
+                    for (; i < ubound; i += 4)
+                    {
+                        T_update::update(*data++, expr.fastRead(i));
+                        T_update::update(*data++, expr.fastRead(i+1));
+                        T_update::update(*data++, expr.fastRead(i+2));
+                        T_update::update(*data++, expr.fastRead(i+3));
+                    }
  #endif  // BZ_ARRAY_FAST_TRAVERSAL_UNROLL
-            }
+                }
  #ifdef BZ_ARRAY_EXPR_USE_COMMON_STRIDE
-            else {
-                for (diffType i=0; i < ubound; i += commonStride)
-                    T_update::update(data[i], expr.fastRead(i));
-            }
+                else {
+                    for (diffType i=0; i < ubound; i += commonStride)
+                        T_update::update(data[i], expr.fastRead(i));
+                }
  #endif // BZ_ARRAY_EXPR_USE_COMMON_STRIDE
-
-            iter.advance(lastLength * commonStride);
-            expr.advance(lastLength * commonStride);
 #else   // ! BZ_USE_FAST_READ_ARRAY_EXPR
-            T_numtype* restrict last = const_cast<T_numtype*>(iter.data()) 
-                + lastLength * commonStride;
+                T_numtype* restrict last = const_cast<T_numtype*>(iter.data()) 
+                    + lastLength * commonStride;
 
-            while (iter.data() != last)
-            {
-                T_update::update(*const_cast<T_numtype*>(iter.data()), *expr);
-                iter.advance(commonStride);
-                expr.advance(commonStride);
-            }
+                while (iter.data() != last)
+                {
+                    T_update::update(*const_cast<T_numtype*>(iter.data()),
+                        *expr);
+                    iter.advance(commonStride);
+                    expr.advance(commonStride);
+                }
 #endif  // BZ_USE_FAST_READ_ARRAY_EXPR
+            }
+            else {
+                // No common stride
 
-        }
-        else {
-            // No common stride
-
-            T_numtype* restrict last = const_cast<T_numtype*>(iter.data()) 
-                + lastLength * stride(maxRank);
+                for (int i=0; i < lastLength; ++i)
+                {
+                    T_update::update(*const_cast<T_numtype*>(iter.data()),
+                        *expr);
+                    iter.advance();
+                    expr.advance();
+                }
+            }
 
-            while (iter.data() != last)
+            // Next row of the tile, ordering(1) fastest
+            int j = 0;
+            while ((j < N_outer) && (++row[j] == last[j]))
             {
-                T_update::update(*const_cast<T_numtype*>(iter.data()), *expr);
-                iter.advance();
-                expr.advance();
+                row[j] = first[j];
+                ++j;
             }
+            if (j == N_outer)
+                break;
         }
     }
 
@@ -923,7 +979,6 @@ Array<T_numtype, N_rank>::evaluateWithFastTraversal(
 }
 
 #endif // BZ_ARRAY_SPACE_FILLING_TRAVERSAL
-#endif // BZ_HAVE_STD
 
 #ifdef BZ_ARRAY_2D_NEW_STENCIL_TILING
 
@@ -945,6 +1000,9 @@ Array<T_numtype, N_rank>::evaluateWithTiled2DTraversal(
     int count = 0;
 #endif
 
+    iter.loadStride(minorRank);
+    expr.loadStride(minorRank);
+
     bool useUnitStride = iter.isUnitStride(minorRank)
                           && expr.isUnitStride(minorRank);
 
@@ -966,11 +1024,18 @@ Array<T_numtype, N_rank>::evaluateWithTiled2DTraversal(
     bool haveCommonMajorStride = iter.isStride(majorRank,commonMajorStride)
         && expr.isStride(majorRank,commonMajorStride);
 
+    BZ_PROFILE_TRAVERSAL(tiledTraversal);
+    BZ_PROFILE_INNER_LOOP(useUnitStride && haveCommonMajorStride, false);
 
     int maxi = length(majorRank);
     int maxj = length(minorRank);
 
+#ifdef BZ_RUNTIME_TUNING
+    const int tileHeight = TuningParameters::instance().stencilTileHeight(),
+        tileWidth = TuningParameters::instance().stencilTileWidth();
+#else
     const int tileHeight = 16, tileWidth = 3;
+#endif
 
     int bi, bj;
     for (bi=0; bi < maxi; bi += tileHeight)
@@ -1136,12 +1201,21 @@ Array<T_numtype, N_rank>::evaluateWithTiled2DTraversal(
     const int minorRank = ordering(0);
     const int majorRank = ordering(1);
 
-    const int blockSize = 16;
+#ifdef BZ_RUNTIME_TUNING
+    const int blockHeight = TuningParameters::instance().stencilTileHeight(),
+        blockWidth = TuningParameters::instance().stencilTileWidth();
+#else
+    const int blockHeight = BZ_ARRAY_2D_STENCIL_TILE_SIZE,
+        blockWidth = BZ_ARRAY_2D_STENCIL_TILE_SIZE;
+#endif
     
     FastArrayIterator<T_numtype, N_rank> iter(*this);
     iter.push(0);
     expr.push(0);
 
+    iter.loadStride(minorRank);
+    expr.loadStride(minorRank);
+
     bool useUnitStride = iter.isUnitStride(minorRank)
                           && expr.isUnitStride(minorRank);
 
@@ -1156,19 +1230,22 @@ Array<T_numtype, N_rank>::evaluateWithTiled2DTraversal(
     bool useCommonStride = false;
 #endif
 
+    BZ_PROFILE_TRAVERSAL(tiledTraversal);
+    BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride);
+
     int maxi = length(majorRank);
     int maxj = length(minorRank);
 
     int bi, bj;
-    for (bi=0; bi < maxi; bi += blockSize)
+    for (bi=0; bi < maxi; bi += blockHeight)
     {
-        int ni = bi + blockSize;
+        int ni = bi + blockHeight;
         if (ni > maxi)
             ni = maxi;
 
-        for (bj=0; bj < maxj; bj += blockSize)
+        for (bj=0; bj < maxj; bj += blockWidth)
         {
-            int nj = bj + blockSize;
+            int nj = bj + blockWidth;
             if (nj > maxj)
                 nj = maxj;
 
@@ -205,7 +205,7 @@ public:
     T_numtype operator[](int i) const
     { return iter_[i]; }
 
-    T_numtype fastRead(int i) const
+    BZ_ALWAYS_INLINE T_numtype fastRead(int i) const
     { return iter_.fastRead(i); }
 
     // this is needed for the stencil expression fastRead to work
@@ -666,7 +666,7 @@ public:
     T_numtype operator[](int i) const
     { return T_op::apply(iter_[i]); }
 
-    T_numtype fastRead(int i) const
+    BZ_ALWAYS_INLINE T_numtype fastRead(int i) const
     { return T_op::apply(iter_.fastRead(i)); }
 
   // this is needed for the stencil expression fastRead to work
@@ -854,7 +854,7 @@ public:
     T_numtype operator[](int i) const
     { return T_op::apply(iter1_[i], iter2_[i]); }
 
-    T_numtype fastRead(int i) const
+    BZ_ALWAYS_INLINE T_numtype fastRead(int i) const
     { return T_op::apply(iter1_.fastRead(i), iter2_.fastRead(i)); }
 
     // this is needed for the stencil expression fastRead to work
@@ -1103,7 +1103,7 @@ public:
     T_numtype operator[](int i) const
     { return T_op::apply(iter1_[i], iter2_[i], iter3_[i]); }
 
-    T_numtype fastRead(int i) const
+    BZ_ALWAYS_INLINE T_numtype fastRead(int i) const
     {
         return T_op::apply(iter1_.fastRead(i),
                            iter2_.fastRead(i),
@@ -1394,7 +1394,7 @@ public:
     T_numtype operator[](int i)
     { return T_op::apply(iter1_[i], iter2_[i], iter3_[i], iter4_[i]); }
 
-    T_numtype fastRead(int i) const
+    BZ_ALWAYS_INLINE T_numtype fastRead(int i) const
     {
         return T_op::apply(iter1_.fastRead(i),
                            iter2_.fastRead(i),
@@ -0,0 +1,151 @@
+/***************************************************************************
+ * blitz/array/fixed.cc  Arrays whose extents are template parameters
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_FIXED_CC
+#define BZ_ARRAY_FIXED_CC
+
+#ifndef BZ_ARRAY_FIXED_H
+ #error <blitz/array/fixed.cc> must be included via <blitz/array/fixed.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * If every operand is unit stride along the last rank, and each rank can
+ * be collapsed into the next, the operands are read in the same order as
+ * the elements are stored, and the whole array is one loop of N_size
+ * iterations.  This is decided from the strides of the Array operands
+ * only; for FixedArrays and constants it is known at compile time.
+ * Otherwise the operands are traversed rank by rank, as in
+ * Array::evaluateWithStackTraversalN(), with the loops unrolled over the
+ * ranks.  Index placeholders and index mappings are traversed in the
+ * same way, unless BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL is undefined, in
+ * which case they are evaluated by index.
+ */
+
+template<int N_loop, int N_inner>
+struct _bz_FixedTraversal {
+    template<typename T_shape, typename T_numtype, typename T_expr,
+        typename T_update>
+    static void traverse(T_numtype*& data, T_expr& expr, T_update)
+    {
+        for (int i=0; i < T_shape::extent(N_loop); ++i)
+        {
+            expr.push(N_loop);
+            _bz_FixedTraversal<N_loop+1,N_inner>::template
+                traverse<T_shape>(data, expr, T_update());
+            expr.pop(N_loop);
+            expr.loadStride(N_loop);
+            expr.advance();
+        }
+    }
+};
+
+template<int N_inner>
+struct _bz_FixedTraversal<N_inner,N_inner> {
+    template<typename T_shape, typename T_numtype, typename T_expr,
+        typename T_update>
+    static void traverse(T_numtype*& data, T_expr& expr, T_update)
+    {
+        const int length = T_shape::extent(N_inner);
+        expr.loadStride(N_inner);
+        for (int i=0; i < length; ++i)
+            T_update::update(data[i], expr[i]);
+        data += length;
+    }
+};
+
+template<typename P_numtype, int N0, int N1, int N2, int N3>
+template<typename T_expr, typename T_update>
+void FixedArray<P_numtype,N0,N1,N2,N3>::evaluate(T_expr expr, T_update)
+{
+    BZPRECHECK(expr.shapeCheck(shape()),
+        "Shape check failed: FixedArray of shape " << shape()
+        << " assigned an expression of another shape");
+
+#ifdef BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL
+    if (T_expr::numIndexPlaceholders > 0)
+        expr.moveTo(TinyVector<int,rank>(0));
+#else
+    if (T_expr::numIndexPlaceholders > 0)
+    {
+        TinyVector<int,rank> index(0);
+        for (int i=0; i < N_size; ++i)
+        {
+            T_update::update(data_[i], expr(index));
+            for (int r=rank-1; r >= 0; --r)
+            {
+                if (++index(r) < T_shape::extent(r))
+                    break;
+                index(r) = 0;
+            }
+        }
+        return;
+    }
+#endif
+
+    expr.loadStride(rank-1);
+    bool flat = expr.isUnitStride(rank-1);
+    for (int r=0; flat && (r < rank-1); ++r)
+        flat = expr.canCollapse(r, r+1);
+
+    if (flat)
+    {
+        for (int i=0; i < N_size; ++i)
+            T_update::update(data_[i], expr.fastRead(i));
+        return;
+    }
+
+    T_numtype* data = data_;
+    _bz_FixedTraversal<0,rank-1>::template
+        traverse<T_shape>(data, expr, T_update());
+}
+
+template<typename T_reduction, typename T_numtype, int N0, int N1, int N2,
+    int N3>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceFixed(const FixedArray<T_numtype,N0,N1,N2,N3>& x,
+    T_reduction reduction)
+{
+    typedef FixedArray<T_numtype,N0,N1,N2,N3> T_fixed;
+    const T_numtype* restrict data = x.data();
+
+    _bz_ReduceReset<T_reduction::needIndex,T_reduction::needInit> reset;
+    reset(reduction, 0, x.beginFast());
+
+    for (int i=0; i < T_fixed::N_size; ++i)
+        if (!reduction(data[i], i % T_fixed::extent(T_fixed::rank-1)))
+            break;
+
+    return reduction.result(T_fixed::N_size);
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_FIXED_CC
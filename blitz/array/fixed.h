@@ -0,0 +1,564 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/fixed.h  Arrays whose extents are template parameters
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_FIXED_H
+#define BZ_ARRAY_FIXED_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/fixed.h> must be included via <blitz/array.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * A FixedArray has its extents as template parameters and holds its
+ * elements itself, in the C storage order with bases of zero:
+ *
+ *   FixedArray<double,8,8,8> block;      // an 8x8x8 tile
+ *   FixedArray<float,4> state, flux;     // a 4-component state
+ *
+ *   block = A(Range(0,7), Range(8,15), Range(0,7)) * 2;
+ *   flux = state * state + 1;
+ *   double s = sum(block);
+ *
+ * Up to four ranks are supported; an extent of 0 marks the end of the
+ * shape.  Since the extents and strides are known to the compiler, the
+ * loops evaluating an expression into a FixedArray, and the complete
+ * reductions of one, have constant trip counts and can be unrolled and
+ * vectorized.  When every operand is stored contiguously in the same
+ * order, which is always so for FixedArrays, the whole array is done in
+ * one loop; otherwise each element is found by its index.
+ *
+ * FixedArrays may be mixed with Arrays in expressions, with the same
+ * shapes, and expressions of FixedArrays may be assigned to Arrays.
+ * Copying a FixedArray copies its elements.
+ */
+
+// The shape of a FixedArray.  The ranks after the last have an extent of
+// one, so the strides of the others are the same for any rank.
+
+template<int N0, int N1, int N2, int N3>
+struct _bz_FixedShape {
+    static const int rank = (N1 == 0) ? 1 : (N2 == 0) ? 2 : (N3 == 0) ? 3 : 4;
+
+    static const int
+        extent0 = N0,
+        extent1 = (N1 == 0) ? 1 : N1,
+        extent2 = (N2 == 0) ? 1 : N2,
+        extent3 = (N3 == 0) ? 1 : N3;
+
+    static const int
+        stride3 = 1,
+        stride2 = extent3,
+        stride1 = extent2 * stride2,
+        stride0 = extent1 * stride1;
+
+    static const int numElements = extent0 * stride0;
+
+    static int extent(int r)
+    {
+        return (r == 0) ? extent0 : (r == 1) ? extent1 : (r == 2) ? extent2
+            : extent3;
+    }
+
+    static diffType stride(int r)
+    {
+        return (r == 0) ? stride0 : (r == 1) ? stride1 : (r == 2) ? stride2
+            : stride3;
+    }
+
+    static diffType offset(int i0, int i1, int i2, int i3)
+    { return i0 * stride0 + i1 * stride1 + i2 * stride2 + i3 * stride3; }
+
+    template<int N_rank>
+    static diffType offset(const TinyVector<int,N_rank>& index)
+    {
+        diffType offset = 0;
+        for (int r=0; r < N_rank; ++r)
+            offset += index(r) * stride(r);
+        return offset;
+    }
+};
+
+template<typename P_numtype, int N0, int N1 = 0, int N2 = 0, int N3 = 0>
+class FixedArray;
+
+// The expression operand for a FixedArray.  It follows FastArrayIterator,
+// with the strides and bounds taken from the shape.
+
+template<typename P_numtype, int N0, int N1, int N2, int N3>
+class FastFixedArrayIterator {
+public:
+    typedef P_numtype                             T_numtype;
+    typedef _bz_FixedShape<N0,N1,N2,N3>           T_shape;
+    typedef FixedArray<P_numtype,N0,N1,N2,N3>     T_fixed;
+    typedef const T_fixed& T_ctorArg1;
+    typedef int            T_ctorArg2;    // dummy
+
+    static const int
+        numArrayOperands = 1,
+        numIndexPlaceholders = 0,
+        rank = T_shape::rank;
+
+    typedef FastArrayCopyIterator<T_numtype,rank> T_range_result;
+
+    FastFixedArrayIterator(const T_fixed& array)
+      : first_(array.data()), data_(array.data()), stride_(1)
+    { }
+
+    T_numtype operator()(const TinyVector<int,rank>& i) const
+    { return first_[T_shape::offset(i)]; }
+
+    T_range_result operator()(const RectDomain<rank>& d) const
+    { return T_range_result(array()(d)); }
+
+    int ascending(const int r) const
+    { return (r < rank) ? 1 : INT_MIN; }
+
+    int ordering(const int r) const
+    { return (r < rank) ? rank - 1 - r : INT_MIN; }
+
+    int lbound(const int r) const
+    { return (r < rank) ? 0 : INT_MIN; }
+
+    int ubound(const int r) const
+    { return (r < rank) ? T_shape::extent(r) - 1 : INT_MAX; }
+
+    RectDomain<rank> domain() const
+    {
+        TinyVector<int,rank> ub;
+        for (int r=0; r < rank; ++r)
+            ub(r) = T_shape::extent(r) - 1;
+        return RectDomain<rank>(TinyVector<int,rank>(0), ub);
+    }
+
+    T_numtype first_value() const { return *first_; }
+
+    T_numtype operator*() const
+    { return *data_; }
+
+    T_numtype operator[](int i) const
+    { return data_[i * stride_]; }
+
+    T_numtype fastRead(sizeType i) const
+    { return data_[i]; }
+
+    diffType suggestStride(int r) const
+    { return T_shape::stride(r); }
+
+    bool isStride(int r, diffType stride) const
+    { return T_shape::stride(r) == stride; }
+
+    void push(int position)
+    { stack_[position] = data_; }
+
+    void pop(int position)
+    { data_ = stack_[position]; }
+
+    void advance()
+    { data_ += stride_; }
+
+    void advance(int n)
+    { data_ += n * stride_; }
+
+    void loadStride(int r)
+    { stride_ = T_shape::stride(r); }
+
+    bool isUnitStride(int r) const
+    { return T_shape::stride(r) == 1; }
+
+    void advanceUnitStride()
+    { ++data_; }
+
+    bool canCollapse(int outerLoopRank, int innerLoopRank) const
+    {
+        return T_shape::stride(innerLoopRank) * T_shape::extent(innerLoopRank)
+            == T_shape::stride(outerLoopRank);
+    }
+
+    void _bz_offsetData(sizeType i)
+    { data_ += i; }
+
+    void _bz_offsetData(sizeType offset, int dim)
+    { data_ += offset * T_shape::stride(dim); }
+
+    void _bz_offsetData(sizeType offset1, int dim1, sizeType offset2, int dim2)
+    {
+        data_ += offset1 * T_shape::stride(dim1)
+            + offset2 * T_shape::stride(dim2);
+    }
+
+    T_numtype shift(int offset, int dim) const
+    { return data_[offset * T_shape::stride(dim)]; }
+
+    T_numtype shift(int offset1, int dim1, int offset2, int dim2) const
+    {
+        return data_[offset1 * T_shape::stride(dim1)
+            + offset2 * T_shape::stride(dim2)];
+    }
+
+    template<int N_rank2>
+    void moveTo(const TinyVector<int,N_rank2>& i)
+    { data_ = first_ + T_shape::offset(i); }
+
+    void prettyPrint(BZ_STD_SCOPE(string) &str,
+        prettyPrintFormat& format) const
+    {
+        if (format.tersePrintingSelected())
+            str += format.nextArrayOperandSymbol();
+        else
+        {
+            str += "FixedArray<";
+            str += BZ_DEBUG_TEMPLATE_AS_STRING_LITERAL(T_numtype);
+            str += ",";
+            char tmpBuf[10];
+            sprintf(tmpBuf, "%d", rank);
+            str += tmpBuf;
+            str += ">";
+        }
+    }
+
+    template<typename T_shapeVector>
+    bool shapeCheck(const T_shapeVector& shape) const
+    {
+        TinyVector<int,rank> extent;
+        for (int r=0; r < rank; ++r)
+            extent(r) = T_shape::extent(r);
+        return areShapesConformable(shape, extent);
+    }
+
+    // Slices of expressions go through an Array sharing the elements
+    template<typename T1, typename T2 = nilArraySection,
+        class T3 = nilArraySection, typename T4 = nilArraySection,
+        class T5 = nilArraySection, typename T6 = nilArraySection,
+        class T7 = nilArraySection, typename T8 = nilArraySection,
+        class T9 = nilArraySection, typename T10 = nilArraySection,
+        class T11 = nilArraySection>
+    class SliceInfo {
+    public:
+        typedef FastArrayCopyIterator<T_numtype, blitz::SliceInfo<T_numtype,
+            T1, T2, T3, T4, T5, T6, T7, T8, T9, T10, T11>::rank> T_slice;
+    };
+
+    template<typename T1, typename T2, typename T3, typename T4, typename T5,
+        typename T6, typename T7, typename T8, typename T9, typename T10,
+        typename T11>
+    typename SliceInfo<T1,T2,T3,T4,T5,T6,T7,T8,T9,T10,T11>::T_slice
+    operator()(T1 r1, T2 r2, T3 r3, T4 r4, T5 r5, T6 r6, T7 r7, T8 r8, T9 r9,
+        T10 r10, T11 r11) const
+    {
+        typedef typename SliceInfo<T1,T2,T3,T4,T5,T6,T7,T8,T9,T10,T11>::T_slice
+            slice;
+        return slice(array()(r1, r2, r3, r4, r5, r6, r7, r8, r9, r10, r11));
+    }
+
+private:
+    Array<T_numtype,rank> array() const
+    {
+        TinyVector<int,rank> extent;
+        for (int r=0; r < rank; ++r)
+            extent(r) = T_shape::extent(r);
+        return Array<T_numtype,rank>(const_cast<T_numtype*>(first_), extent,
+            neverDeleteData);
+    }
+
+    const T_numtype * restrict           first_;
+    const T_numtype * restrict           data_;
+    const T_numtype *                    stack_[rank];
+    diffType                             stride_;
+};
+
+template<typename P_numtype, int N0, int N1, int N2, int N3>
+class FixedArray
+#ifdef BZ_NEW_EXPRESSION_TEMPLATES
+    : public ETBase<FixedArray<P_numtype,N0,N1,N2,N3> >
+#endif
+{
+public:
+    typedef P_numtype                                 T_numtype;
+    typedef _bz_FixedShape<N0,N1,N2,N3>               T_shape;
+    typedef FixedArray<P_numtype,N0,N1,N2,N3>         T_fixed;
+    typedef FastFixedArrayIterator<P_numtype,N0,N1,N2,N3> T_iterator;
+
+    static const int
+        rank = T_shape::rank,
+        N_size = T_shape::numElements;
+
+    typedef Array<P_numtype,T_shape::rank>            T_array;
+
+    FixedArray()
+    { }
+
+    explicit FixedArray(T_numtype x)
+    { *this = x; }
+
+    template<typename T_expr>
+    explicit FixedArray(const ETBase<T_expr>& expr)
+    { *this = expr; }
+
+    //////////////////////////////////////////////
+    // Shape and storage
+    //////////////////////////////////////////////
+
+    static int lbound(int)
+    { return 0; }
+
+    static int ubound(int r)
+    { return T_shape::extent(r) - 1; }
+
+    static int extent(int r)
+    { return T_shape::extent(r); }
+
+    static diffType stride(int r)
+    { return T_shape::stride(r); }
+
+    static int base(int)
+    { return 0; }
+
+    static sizeType numElements()
+    { return N_size; }
+
+    static TinyVector<int,rank> shape()
+    {
+        TinyVector<int,rank> x;
+        for (int r=0; r < rank; ++r)
+            x(r) = T_shape::extent(r);
+        return x;
+    }
+
+    static TinyVector<int,rank> extent()
+    { return shape(); }
+
+    static RectDomain<rank> domain()
+    { return RectDomain<rank>(TinyVector<int,rank>(0), shape() - 1); }
+
+    T_numtype* data()
+    { return data_; }
+
+    const T_numtype* data() const
+    { return data_; }
+
+    T_numtype* dataFirst()
+    { return data_; }
+
+    const T_numtype* dataFirst() const
+    { return data_; }
+
+    T_iterator beginFast() const
+    { return T_iterator(*this); }
+
+    // An Array sharing the elements, without a reference count
+    T_array asArray() const
+    {
+        return T_array(const_cast<T_numtype*>(data_), shape(),
+            neverDeleteData);
+    }
+
+    //////////////////////////////////////////////
+    // Elements
+    //////////////////////////////////////////////
+
+    T_numtype& operator()(int i0)
+    {
+        BZPRECONDITION(rank == 1);
+        BZPRECHECK((unsigned)i0 < (unsigned)N0,
+            "FixedArray index out of range: " << i0);
+        return data_[i0];
+    }
+
+    const T_numtype& operator()(int i0) const
+    { return const_cast<T_fixed&>(*this)(i0); }
+
+    T_numtype& operator()(int i0, int i1)
+    {
+        BZPRECONDITION(rank == 2);
+        BZPRECHECK(((unsigned)i0 < (unsigned)T_shape::extent0)
+            && ((unsigned)i1 < (unsigned)T_shape::extent1),
+            "FixedArray index out of range: (" << i0 << ", " << i1 << ")");
+        return data_[T_shape::offset(i0, i1, 0, 0)];
+    }
+
+    const T_numtype& operator()(int i0, int i1) const
+    { return const_cast<T_fixed&>(*this)(i0, i1); }
+
+    T_numtype& operator()(int i0, int i1, int i2)
+    {
+        BZPRECONDITION(rank == 3);
+        BZPRECHECK(((unsigned)i0 < (unsigned)T_shape::extent0)
+            && ((unsigned)i1 < (unsigned)T_shape::extent1)
+            && ((unsigned)i2 < (unsigned)T_shape::extent2),
+            "FixedArray index out of range: (" << i0 << ", " << i1 << ", "
+            << i2 << ")");
+        return data_[T_shape::offset(i0, i1, i2, 0)];
+    }
+
+    const T_numtype& operator()(int i0, int i1, int i2) const
+    { return const_cast<T_fixed&>(*this)(i0, i1, i2); }
+
+    T_numtype& operator()(int i0, int i1, int i2, int i3)
+    {
+        BZPRECONDITION(rank == 4);
+        BZPRECHECK(((unsigned)i0 < (unsigned)T_shape::extent0)
+            && ((unsigned)i1 < (unsigned)T_shape::extent1)
+            && ((unsigned)i2 < (unsigned)T_shape::extent2)
+            && ((unsigned)i3 < (unsigned)T_shape::extent3),
+            "FixedArray index out of range: (" << i0 << ", " << i1 << ", "
+            << i2 << ", " << i3 << ")");
+        return data_[T_shape::offset(i0, i1, i2, i3)];
+    }
+
+    const T_numtype& operator()(int i0, int i1, int i2, int i3) const
+    { return const_cast<T_fixed&>(*this)(i0, i1, i2, i3); }
+
+    T_numtype& operator()(const TinyVector<int,rank>& index)
+    {
+        BZPRECHECK(isInRange(index), "FixedArray index out of range: "
+            << index);
+        return data_[T_shape::offset(index)];
+    }
+
+    const T_numtype& operator()(const TinyVector<int,rank>& index) const
+    { return const_cast<T_fixed&>(*this)(index); }
+
+    T_numtype& operator[](sizeType i)
+    {
+        BZPRECHECK(i < sizeType(N_size), "FixedArray index out of range: "
+            << i);
+        return data_[i];
+    }
+
+    const T_numtype& operator[](sizeType i) const
+    { return const_cast<T_fixed&>(*this)[i]; }
+
+    static bool isInRange(const TinyVector<int,rank>& index)
+    {
+        for (int r=0; r < rank; ++r)
+            if ((unsigned)index(r) >= (unsigned)T_shape::extent(r))
+                return false;
+        return true;
+    }
+
+    //////////////////////////////////////////////
+    // Assignment
+    //////////////////////////////////////////////
+
+    T_fixed& operator=(T_numtype x)
+    {
+        for (int i=0; i < N_size; ++i)
+            data_[i] = x;
+        return *this;
+    }
+
+    template<typename T_expr>
+    T_fixed& operator=(const ETBase<T_expr>& expr)
+    {
+        evaluate(asExpr<T_expr>::getExpr(expr.unwrap()),
+            _bz_update<T_numtype,
+            _bz_typename asExpr<T_expr>::T_expr::T_numtype>());
+        return *this;
+    }
+
+#define BZ_FIXED_ARRAY_UPDATE(op,name)                                  \
+    template<typename T_expr>                                           \
+    T_fixed& operator op(const ETBase<T_expr>& expr)                    \
+    {                                                                   \
+        evaluate(asExpr<T_expr>::getExpr(expr.unwrap()),                \
+            name<T_numtype,                                             \
+            _bz_typename asExpr<T_expr>::T_expr::T_numtype>());         \
+        return *this;                                                   \
+    }                                                                   \
+                                                                        \
+    T_fixed& operator op(T_numtype x)                                   \
+    {                                                                   \
+        for (int i=0; i < N_size; ++i)                                  \
+            data_[i] op x;                                              \
+        return *this;                                                   \
+    }
+
+    BZ_FIXED_ARRAY_UPDATE(+=, _bz_plus_update)
+    BZ_FIXED_ARRAY_UPDATE(-=, _bz_minus_update)
+    BZ_FIXED_ARRAY_UPDATE(*=, _bz_multiply_update)
+    BZ_FIXED_ARRAY_UPDATE(/=, _bz_divide_update)
+
+#undef BZ_FIXED_ARRAY_UPDATE
+
+    template<typename T_expr, typename T_update>
+    void evaluate(T_expr expr, T_update);
+
+private:
+    T_numtype data_[N_size];
+};
+
+template<typename T, int N0, int N1, int N2, int N3>
+struct asExpr<FixedArray<T,N0,N1,N2,N3> > {
+    typedef FastFixedArrayIterator<T,N0,N1,N2,N3> T_expr;
+    static T_expr getExpr(const FixedArray<T,N0,N1,N2,N3>& x)
+    { return T_expr(x); }
+};
+
+// Complete reductions over the elements in storage order
+
+template<typename T_reduction, typename T_numtype, int N0, int N1, int N2,
+    int N3>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceFixed(const FixedArray<T_numtype,N0,N1,N2,N3>& x,
+    T_reduction reduction);
+
+#define BZ_DECL_FIXED_ARRAY_FULL_REDUCE(fn,reduction)                   \
+template<typename T_numtype, int N0, int N1, int N2, int N3>            \
+inline                                                                  \
+_bz_typename reduction<T_numtype>::T_resulttype                         \
+fn(const FixedArray<T_numtype,N0,N1,N2,N3>& x)                          \
+{                                                                       \
+    return _bz_reduceFixed(x, reduction<T_numtype>());                  \
+}
+
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(sum,      ReduceSum)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(mean,     ReduceMean)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE((min),    ReduceMin)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE((max),    ReduceMax)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE((minmax), ReduceMinMax)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(product,  ReduceProduct)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(count,    ReduceCount)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(any,      ReduceAny)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(all,      ReduceAll)
+BZ_DECL_FIXED_ARRAY_FULL_REDUCE(variance, ReduceVariance)
+
+#undef BZ_DECL_FIXED_ARRAY_FULL_REDUCE
+
+template<typename T, int N0, int N1, int N2, int N3>
+ostream& operator<<(ostream& os, const FixedArray<T,N0,N1,N2,N3>& x)
+{ return os << x.asArray(); }
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/fixed.cc>
+
+#endif // BZ_ARRAY_FIXED_H
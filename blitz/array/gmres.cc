@@ -0,0 +1,461 @@
+/***************************************************************************
+ * blitz/array/gmres.cc  Restarted GMRES and its workspace kernels
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_GMRES_CC
+#define BZ_ARRAY_GMRES_CC
+
+#ifndef BZ_ARRAY_GMRES_H
+ #error <blitz/array/gmres.cc> must be included via <blitz/array/gmres.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+// Inside a parallel region, the calling thread's share of [0,length)
+inline void _bz_threadRange(sizeType length, sizeType& lo, sizeType& hi,
+    int& thread)
+{
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+    const int numThreads = omp_get_num_threads();
+#else
+    thread = 0;
+    const int numThreads = 1;
+#endif
+    lo = length * thread / numThreads;
+    hi = length * (thread + 1) / numThreads;
+}
+
+template<typename P_numtype, int N_rank>
+void GMRESWorkspace<P_numtype,N_rank>::setup(const T_array& x, int restart)
+{
+    BZPRECONDITION(restart >= 1);
+
+    bool fits = (restart == restart_);
+    for (int i=0; i < N_rank; ++i)
+        fits = fits && (x.extent(i) == shape_(i)) && (x.base(i) == base_(i))
+            && (x.ordering(i) == ordering_(i));
+    if (fits)
+        return;
+
+    restart_ = restart;
+    shape_ = x.shape();
+    base_ = x.base();
+    ordering_ = x.ordering();
+    length_ = x.numElements();
+
+#ifdef _OPENMP
+    numThreads_ = omp_get_max_threads();
+#else
+    numThreads_ = 1;
+#endif
+
+    // restart+1 basis vectors and one scratch vector in one block, which
+    // may hold more than 2^31 elements
+    data_.resize(sizeType(restart_ + 2) * length_);
+
+    GeneralArrayStorage<N_rank> storage(ordering_,
+        TinyVector<bool,N_rank>(true));
+    storage.base() = base_;
+
+    views_.clear();
+    views_.reserve(restart_ + 2);
+    for (int k=0; k < restart_ + 2; ++k)
+        views_.push_back(T_array(basisData(k), shape_, neverDeleteData,
+            storage));
+
+    H.resize(restart_ + 1, restart_);
+    cs.resize(restart_);
+    sn.resize(restart_);
+    g.resize(restart_ + 1);
+    y.resize(restart_);
+    h.resize(restart_ + 1);
+    partial_.resize(numThreads_ * (restart_ + 2));
+}
+
+template<typename P_numtype, int N_rank>
+void GMRESWorkspace<P_numtype,N_rank>::project(int k,
+    const T_numtype* restrict w, T_numtype* hout)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    clearPartials();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+    {
+        sizeType lo, hi;
+        int thread;
+        _bz_threadRange(length_, lo, hi, thread);
+        T_numtype* restrict acc = partial(thread);
+        for (int j=0; j < k; ++j)
+            acc[j] = 0;
+
+        // One cache-sized chunk of w against all k basis vectors
+        for (sizeType b0 = lo; b0 < hi; b0 += BZ_GMRES_BLOCK_SIZE)
+        {
+            const sizeType b1 = (hi - b0 < BZ_GMRES_BLOCK_SIZE) ? hi
+                : b0 + BZ_GMRES_BLOCK_SIZE;
+            for (int j=0; j < k; ++j)
+            {
+                const T_numtype* restrict v = basisData(j);
+                T_numtype s = 0;
+                for (sizeType i=b0; i < b1; ++i)
+                    s += traits::conj(v[i]) * w[i];
+                acc[j] += s;
+            }
+        }
+    }
+
+    for (int j=0; j < k; ++j)
+    {
+        hout[j] = 0;
+        for (int t=0; t < numThreads_; ++t)
+            hout[j] += partial(t)[j];
+    }
+}
+
+template<typename P_numtype, int N_rank>
+typename GMRESWorkspace<P_numtype,N_rank>::T_real
+GMRESWorkspace<P_numtype,N_rank>::subtract(int k, T_numtype* restrict w,
+    const T_numtype* hin, bool wantNorm)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    clearPartials();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+    {
+        sizeType lo, hi;
+        int thread;
+        _bz_threadRange(length_, lo, hi, thread);
+        T_real nrm = 0;
+
+        for (sizeType b0 = lo; b0 < hi; b0 += BZ_GMRES_BLOCK_SIZE)
+        {
+            const sizeType b1 = (hi - b0 < BZ_GMRES_BLOCK_SIZE) ? hi
+                : b0 + BZ_GMRES_BLOCK_SIZE;
+            for (int j=0; j < k; ++j)
+            {
+                const T_numtype* restrict v = basisData(j);
+                const T_numtype hj = hin[j];
+                for (sizeType i=b0; i < b1; ++i)
+                    w[i] -= hj * v[i];
+            }
+            if (wantNorm)
+                for (sizeType i=b0; i < b1; ++i)
+                    nrm += traits::norm(w[i]);
+        }
+        partial(thread)[0] = nrm;
+    }
+
+    T_real nrm = 0;
+    if (wantNorm)
+        for (int t=0; t < numThreads_; ++t)
+            nrm += traits::abs(partial(t)[0]);
+    return nrm;
+}
+
+template<typename P_numtype, int N_rank>
+P_numtype GMRESWorkspace<P_numtype,N_rank>::axpyDot(T_numtype alpha, int j,
+    T_numtype* restrict w, int next)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    const T_numtype* restrict v = basisData(j);
+    clearPartials();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+    {
+        sizeType lo, hi;
+        int thread;
+        _bz_threadRange(length_, lo, hi, thread);
+        T_numtype s = 0;
+        if (next >= 0)
+        {
+            const T_numtype* restrict u = basisData(next);
+            for (sizeType i=lo; i < hi; ++i)
+            {
+                w[i] -= alpha * v[i];
+                s += traits::conj(u[i]) * w[i];
+            }
+        }
+        else {
+            // |w|^2: w is read through w only, so as not to alias it
+            for (sizeType i=lo; i < hi; ++i)
+            {
+                w[i] -= alpha * v[i];
+                s += traits::conj(w[i]) * w[i];
+            }
+        }
+        partial(thread)[0] = s;
+    }
+
+    T_numtype s = 0;
+    for (int t=0; t < numThreads_; ++t)
+        s += partial(t)[0];
+    return s;
+}
+
+template<typename P_numtype, int N_rank>
+typename GMRESWorkspace<P_numtype,N_rank>::T_real
+GMRESWorkspace<P_numtype,N_rank>::normSquared(int j)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    const T_numtype* restrict v = basisData(j);
+    clearPartials();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+    {
+        sizeType lo, hi;
+        int thread;
+        _bz_threadRange(length_, lo, hi, thread);
+        T_real s = 0;
+        for (sizeType i=lo; i < hi; ++i)
+            s += traits::norm(v[i]);
+        partial(thread)[0] = s;
+    }
+
+    T_real s = 0;
+    for (int t=0; t < numThreads_; ++t)
+        s += traits::abs(partial(t)[0]);
+    return s;
+}
+
+template<typename P_numtype, int N_rank>
+void GMRESWorkspace<P_numtype,N_rank>::combine(int k, const T_numtype* yin,
+    T_numtype* restrict w)
+{
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+    {
+        sizeType lo, hi;
+        int thread;
+        _bz_threadRange(length_, lo, hi, thread);
+        for (sizeType b0 = lo; b0 < hi; b0 += BZ_GMRES_BLOCK_SIZE)
+        {
+            const sizeType b1 = (hi - b0 < BZ_GMRES_BLOCK_SIZE) ? hi
+                : b0 + BZ_GMRES_BLOCK_SIZE;
+            for (sizeType i=b0; i < b1; ++i)
+                w[i] = 0;
+            for (int j=0; j < k; ++j)
+            {
+                const T_numtype* restrict v = basisData(j);
+                const T_numtype yj = yin[j];
+                for (sizeType i=b0; i < b1; ++i)
+                    w[i] += yj * v[i];
+            }
+        }
+    }
+}
+
+// Givens rotation [c s; -conj(s) c] which zeroes b in (a, b).  c is
+// real, so the same code serves real and complex systems.
+template<typename T_numtype, typename T_real>
+inline void _bz_givens(const T_numtype& a, const T_numtype& b,
+    T_real& c, T_numtype& s)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    const T_real absa = traits::abs(a), absb = traits::abs(b);
+
+    if (absb == T_real(0)) {
+        c = 1;
+        s = 0;
+    }
+    else if (absa == T_real(0)) {
+        c = 0;
+        s = 1;
+    }
+    else {
+        const T_real scale = absa + absb;
+        const T_real t = scale * BZ_MATHFN_SCOPE(sqrt)(
+            (absa/scale)*(absa/scale) + (absb/scale)*(absb/scale));
+        c = absa / t;
+        s = (a / absa) * traits::conj(b) / t;
+    }
+}
+
+template<typename T_operator, typename T_preconditioner,
+         typename T_numtype, int N_rank>
+int gmres(const T_operator& A, Array<T_numtype,N_rank>& x,
+    const Array<T_numtype,N_rank>& b, GMRESWorkspace<T_numtype,N_rank>& ws,
+    double tolerance, int maxIterations, const T_preconditioner& M,
+    GMRESPreconditioning side, GMRESOrthogonalization orthogonalization)
+{
+    typedef _bz_krylovTraits<T_numtype> traits;
+    typedef typename traits::T_real T_real;
+
+    BZPRECHECK(x.numElements() == b.numElements(),
+        "gmres: x and b must have the same shape");
+
+    if (ws.restart() < 1)
+        ws.setup(x, 30);
+    else
+        ws.setup(x, ws.restart());
+
+    const bool precondition =
+        !_bz_isIdentityPreconditioner<T_preconditioner>::value;
+    const bool left = precondition && (side == gmresLeftPreconditioning);
+    const bool right = precondition && (side == gmresRightPreconditioning);
+
+    const int m = ws.restart();
+    Array<T_numtype,N_rank>& z = ws.scratch();
+    T_numtype* restrict zdata = ws.basisData(m + 1);
+
+    // Norm of the (preconditioned) right-hand side
+    if (left)
+        M(b, z);
+    else
+        z = b;
+    T_real bnorm = BZ_MATHFN_SCOPE(sqrt)(ws.normSquared(m + 1));
+    if (bnorm == T_real(0))
+        bnorm = 1;
+
+    int iterations = 0;
+    T_real error = 0;
+
+    while (true)
+    {
+        // r = b - A x, or M^{-1}(b - A x), into V_0
+        Array<T_numtype,N_rank>& v0 = ws.basis(0);
+        A(x, v0);
+        if (left) {
+            z = b - v0;
+            M(z, v0);
+        }
+        else
+            v0 = b - v0;
+
+        const T_real beta = BZ_MATHFN_SCOPE(sqrt)(ws.normSquared(0));
+        error = beta / bnorm;
+        if ((error <= tolerance) || (iterations >= maxIterations))
+            break;
+
+        v0 *= T_numtype(1) / beta;
+        ws.g = 0;
+        ws.g(0) = beta;
+
+        int k = 0;
+        while ((k < m) && (iterations < maxIterations))
+        {
+            // V_{k+1} = A V_k, with the preconditioner on either side
+            Array<T_numtype,N_rank>& w = ws.basis(k + 1);
+            T_numtype* restrict wdata = ws.basisData(k + 1);
+            if (right) {
+                M(ws.basis(k), z);
+                A(z, w);
+            }
+            else if (left) {
+                A(ws.basis(k), z);
+                M(z, w);
+            }
+            else
+                A(ws.basis(k), w);
+
+            // Orthogonalize against V_0..V_k
+            T_numtype* hk = ws.h.data();
+            T_real wnorm2;
+            if (orthogonalization == gmresClassicalGramSchmidt2)
+            {
+                T_numtype* h2 = ws.y.data();
+                ws.project(k + 1, wdata, hk);
+                ws.subtract(k + 1, wdata, hk, false);
+                ws.project(k + 1, wdata, h2);
+                wnorm2 = ws.subtract(k + 1, wdata, h2, true);
+                for (int j=0; j <= k; ++j)
+                    hk[j] += h2[j];
+            }
+            else {
+                ws.project(1, wdata, hk);
+                for (int j=0; j < k; ++j)
+                    hk[j+1] = ws.axpyDot(hk[j], j, wdata, j + 1);
+                wnorm2 = traits::abs(ws.axpyDot(hk[k], k, wdata, -1));
+            }
+
+            const T_real wnorm = BZ_MATHFN_SCOPE(sqrt)(wnorm2);
+            for (int j=0; j <= k; ++j)
+                ws.H(j, k) = hk[j];
+            ws.H(k+1, k) = wnorm;
+
+            // Apply the previous rotations to the new column and
+            // compute the one which eliminates H(k+1,k).
+            for (int j=0; j < k; ++j)
+            {
+                const T_numtype t = ws.cs(j) * ws.H(j,k) + ws.sn(j) * ws.H(j+1,k);
+                ws.H(j+1,k) = -traits::conj(ws.sn(j)) * ws.H(j,k)
+                    + ws.cs(j) * ws.H(j+1,k);
+                ws.H(j,k) = t;
+            }
+            _bz_givens(ws.H(k,k), ws.H(k+1,k), ws.cs(k), ws.sn(k));
+            ws.H(k,k) = ws.cs(k) * ws.H(k,k) + ws.sn(k) * ws.H(k+1,k);
+            ws.H(k+1,k) = 0;
+            ws.g(k+1) = -traits::conj(ws.sn(k)) * ws.g(k);
+            ws.g(k) = ws.cs(k) * ws.g(k);
+
+            ++k;
+            ++iterations;
+            error = traits::abs(ws.g(k)) / bnorm;
+
+            // Converged, or an exact (happy) breakdown
+            if ((error <= tolerance) || (wnorm == T_real(0)))
+                break;
+
+            w *= T_numtype(1) / wnorm;
+        }
+
+        // Solve the k x k triangular system H y = g, then update x
+        for (int i=k-1; i >= 0; --i)
+        {
+            T_numtype t = ws.g(i);
+            for (int j=i+1; j < k; ++j)
+                t -= ws.H(i,j) * ws.y(j);
+            ws.y(i) = t / ws.H(i,i);
+        }
+
+        ws.combine(k, ws.y.data(), zdata);
+        if (right) {
+            // V_k is no longer needed and holds M^{-1} z
+            M(z, ws.basis(k));
+            x += ws.basis(k);
+        }
+        else
+            x += z;
+    }
+
+    ws.setResult(iterations, error);
+    return (error <= tolerance) ? iterations : -1;
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_GMRES_CC
@@ -0,0 +1,252 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/gmres.h  Matrix-free restarted GMRES with a reusable
+ *                      Krylov workspace
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ * References:
+ *   Y. Saad and M. H. Schultz, "GMRES: a generalized minimal residual
+ *   algorithm for solving nonsymmetric linear systems", SIAM J. Sci.
+ *   Stat. Comput. 7 (1986) 856-869.
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_GMRES_H
+#define BZ_ARRAY_GMRES_H
+
+#ifndef BZ_ARRAY_H
+ #include <blitz/array.h>
+#endif
+
+#include <vector>
+#include <algorithm>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Length of the chunks used by the blocked (BLAS-2 style) kernels:
+// one chunk of w is kept in cache while all basis vectors stream past.
+#ifndef BZ_GMRES_BLOCK_SIZE
+ #define BZ_GMRES_BLOCK_SIZE 1024
+#endif
+
+BZ_NAMESPACE(blitz)
+
+// Scalar helpers which work for both real and complex element types
+template<typename T>
+struct _bz_krylovTraits {
+    typedef T T_real;
+    static T conj(const T& x) { return x; }
+    static T_real abs(const T& x) { return BZ_MATHFN_SCOPE(fabs)(x); }
+    static T_real norm(const T& x) { return x * x; }
+};
+
+#ifdef BZ_HAVE_COMPLEX
+template<typename T>
+struct _bz_krylovTraits<complex<T> > {
+    typedef T T_real;
+    static complex<T> conj(const complex<T>& x)
+    { return BZ_CMATHFN_SCOPE(conj)(x); }
+    static T_real abs(const complex<T>& x)
+    { return BZ_CMATHFN_SCOPE(abs)(x); }
+    static T_real norm(const complex<T>& x)
+    { return x.real()*x.real() + x.imag()*x.imag(); }
+};
+#endif
+
+enum GMRESOrthogonalization {
+    // Modified Gram-Schmidt with each update fused to the next dot
+    // product: k+1 passes over memory for k basis vectors.
+    gmresModifiedGramSchmidt,
+    // Classical Gram-Schmidt with one reorthogonalization (CGS2), done
+    // as blocked matrix-vector products: 4 passes independent of k.
+    gmresClassicalGramSchmidt2
+};
+
+enum GMRESPreconditioning { gmresLeftPreconditioning,
+                            gmresRightPreconditioning };
+
+// The preconditioner callback computes z = M^{-1} r as M(r, z).
+struct IdentityPreconditioner {
+    template<typename T_array>
+    void operator()(const T_array& r, T_array& z) const
+    { z = r; }
+};
+
+template<typename T>
+struct _bz_isIdentityPreconditioner {
+    static const bool value = false;
+};
+
+template<>
+struct _bz_isIdentityPreconditioner<IdentityPreconditioner> {
+    static const bool value = true;
+};
+
+/*
+ * GMRESWorkspace<T,N> owns everything gmres() needs: the Krylov basis,
+ * one scratch vector and the small Hessenberg/Givens arrays.  It is
+ * (re)allocated only when the shape of the unknowns or the restart
+ * length changes, so repeated solves in a time loop allocate nothing.
+ * The basis is one contiguous block, which is what lets the
+ * orthogonalization run as blocked matrix-vector products.
+ */
+template<typename P_numtype, int N_rank>
+class GMRESWorkspace {
+
+public:
+    typedef P_numtype T_numtype;
+    typedef typename _bz_krylovTraits<T_numtype>::T_real T_real;
+    typedef Array<T_numtype,N_rank> T_array;
+
+    GMRESWorkspace()
+      : restart_(0), length_(0), numThreads_(1), iterations_(0),
+        residual_(0), shape_(0), base_(0), ordering_(0)
+    { }
+
+    GMRESWorkspace(const T_array& x, int restart)
+      : restart_(0), length_(0), numThreads_(1), iterations_(0),
+        residual_(0), shape_(0), base_(0), ordering_(0)
+    { setup(x, restart); }
+
+    // Prepare for unknowns shaped like x; does nothing if the current
+    // allocation already fits.
+    void setup(const T_array& x, int restart);
+
+    int restart() const
+    { return restart_; }
+
+    // Results of the last solve: total inner iterations and the final
+    // relative residual estimate.
+    int iterations() const
+    { return iterations_; }
+
+    T_real residual() const
+    { return residual_; }
+
+    void setResult(int iterations, T_real residual)
+    {
+        iterations_ = iterations;
+        residual_ = residual;
+    }
+
+    // Krylov basis vector k (0 <= k <= restart) and the scratch vector
+    T_array& basis(int k)
+    { return views_[k]; }
+
+    T_array& scratch()
+    { return views_[restart_ + 1]; }
+
+    T_numtype* restrict basisData(int k)
+    { return &data_[0] + sizeType(k) * length_; }
+
+    sizeType length() const
+    { return length_; }
+
+    // Blocked kernels on the contiguous basis.  All of them reduce over
+    // the whole vector, threaded when compiled with OpenMP.
+
+    // h[j] = <V_j, w> for j < k
+    void project(int k, const T_numtype* restrict w, T_numtype* h);
+
+    // w -= sum_{j<k} h[j] V_j; returns |w|^2 if wantNorm
+    T_real subtract(int k, T_numtype* restrict w, const T_numtype* h,
+        bool wantNorm);
+
+    // w -= alpha V_j, returning <V_next, w> (or |w|^2 if next < 0)
+    T_numtype axpyDot(T_numtype alpha, int j, T_numtype* restrict w,
+        int next);
+
+    // |V_j|^2, where j == restart() + 1 is the scratch vector
+    T_real normSquared(int j);
+
+    // w = sum_{j<k} y[j] V_j
+    void combine(int k, const T_numtype* y, T_numtype* restrict w);
+
+    // Small dense arrays, indexed from zero
+    Array<T_numtype,2> H;            // Hessenberg, (restart+1) x restart
+    Array<T_real,1> cs;              // Givens cosines
+    Array<T_numtype,1> sn, g, y, h;  // Givens sines, rhs, solution, scratch
+
+private:
+    GMRESWorkspace(const GMRESWorkspace&) { }
+    void operator=(const GMRESWorkspace&) { }
+
+    // Per-thread partial sums.  Cleared before each kernel since the
+    // runtime may start fewer threads than requested.
+    T_numtype* partial(int thread)
+    { return &partial_[thread * (restart_ + 2)]; }
+
+    void clearPartials()
+    { std::fill(partial_.begin(), partial_.end(), T_numtype(0)); }
+
+    int restart_;
+    sizeType length_;
+    int numThreads_;
+    int iterations_;
+    T_real residual_;
+    TinyVector<int,N_rank> shape_, base_, ordering_;
+    std::vector<T_numtype> data_;
+    std::vector<T_array> views_;
+    std::vector<T_numtype> partial_;
+};
+
+/*
+ * Restarted GMRES(m) for A x = b with an arbitrary operator: A(p, q)
+ * must compute q = A p for arrays shaped like x, e.g. a SparseOperator
+ * from <blitz/sparse.h> or a stencil application.  x holds the initial
+ * guess on entry and the solution on exit.  Iterates until the
+ * (preconditioned) residual relative to b drops below tolerance, and
+ * returns the number of inner iterations, or -1 if maxIterations inner
+ * iterations were not enough; ws.residual() holds the final estimate.
+ *
+ * With left preconditioning the residual is measured as
+ * |M^{-1}(b - A x)| / |M^{-1} b|, with right preconditioning as the
+ * true |b - A x| / |b|.
+ */
+template<typename T_operator, typename T_preconditioner,
+         typename T_numtype, int N_rank>
+int gmres(const T_operator& A, Array<T_numtype,N_rank>& x,
+    const Array<T_numtype,N_rank>& b, GMRESWorkspace<T_numtype,N_rank>& ws,
+    double tolerance, int maxIterations, const T_preconditioner& M,
+    GMRESPreconditioning side = gmresRightPreconditioning,
+    GMRESOrthogonalization orthogonalization = gmresModifiedGramSchmidt);
+
+template<typename T_operator, typename T_numtype, int N_rank>
+inline int gmres(const T_operator& A, Array<T_numtype,N_rank>& x,
+    const Array<T_numtype,N_rank>& b, GMRESWorkspace<T_numtype,N_rank>& ws,
+    double tolerance, int maxIterations)
+{
+    return gmres(A, x, b, ws, tolerance, maxIterations,
+        IdentityPreconditioner());
+}
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/gmres.cc>
+
+#endif // BZ_ARRAY_GMRES_H
@@ -0,0 +1,463 @@
+/***************************************************************************
+ * blitz/array/indexplan.cc  Precompiled index sets for repeated
+ *                           gather/scatter
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_INDEXPLAN_CC
+#define BZ_ARRAY_INDEXPLAN_CC
+
+#ifndef BZ_ARRAY_INDEXPLAN_H
+ #error <blitz/array/indexplan.cc> must be included via <blitz/array/indexplan.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+BZ_NAMESPACE(blitz)
+
+// Expansion of the entries of an index container into points
+
+template<int N_rank>
+inline void _bz_indexPlanAppend(std::vector<TinyVector<int,N_rank> >& points,
+    const TinyVector<int,N_rank>& x)
+{
+    points.push_back(x);
+}
+
+inline void _bz_indexPlanAppend(std::vector<TinyVector<int,1> >& points,
+    int x)
+{
+    points.push_back(TinyVector<int,1>(x));
+}
+
+template<int N_rank>
+void _bz_indexPlanAppend(std::vector<TinyVector<int,N_rank> >& points,
+    const RectDomain<N_rank>& domain)
+{
+    for (int r=0; r < N_rank; ++r)
+        if (domain.ubound(r) < domain.lbound(r))
+            return;
+
+    TinyVector<int,N_rank> i = domain.lbound();
+    while (true)
+    {
+        points.push_back(i);
+        int r = N_rank - 1;
+        while ((r >= 0) && (++i(r) > domain.ubound(r)))
+        {
+            i(r) = domain.lbound(r);
+            --r;
+        }
+        if (r < 0)
+            break;
+    }
+}
+
+template<int N_rank> template<typename T_numtype, typename T_container>
+void IndexPlan<N_rank>::build(const Array<T_numtype,N_rank>& array,
+    const T_container& index)
+{
+    std::vector<T_index> points;
+    _bz_typename T_container::const_iterator iter = index.begin(),
+        end = index.end();
+    for (; iter != end; ++iter)
+        _bz_indexPlanAppend(points, *iter);
+
+    compile(array, points);
+}
+
+template<int N_rank> template<typename T_numtype>
+void IndexPlan<N_rank>::build(const Array<T_numtype,N_rank>& array,
+    const Array<bool,N_rank>& mask)
+{
+    for (int r=0; r < N_rank; ++r)
+    {
+        BZPRECHECK((mask.lbound(r) == array.lbound(r))
+            && (mask.ubound(r) == array.ubound(r)),
+            "IndexPlan<" << N_rank << "> mask of domain " << mask.lbound()
+            << " to " << mask.ubound() << " for an array of domain "
+            << array.lbound() << " to " << array.ubound())
+    }
+
+    std::vector<T_index> points;
+    _bz_typename Array<bool,N_rank>::const_iterator iter = mask.begin(),
+        end = mask.end();
+    for (; iter != end; ++iter)
+        if (*iter)
+            points.push_back(iter.position());
+
+    compile(array, points);
+}
+
+template<int N_rank> template<typename T_numtype, typename T_expr>
+void IndexPlan<N_rank>::build(const Array<T_numtype,N_rank>& array,
+    const _bz_ArrayExpr<T_expr>& mask)
+{
+    Array<bool,N_rank> m(array.lbound(), array.extent());
+    m = mask;
+    build(array, m);
+}
+
+template<int N_rank> template<typename T_numtype>
+void IndexPlan<N_rank>::compile(const Array<T_numtype,N_rank>& array,
+    const std::vector<T_index>& points)
+{
+    runRank_ = array.ordering(0);
+    stride_ = array.stride();
+
+    // Sort into memory order and drop duplicates
+    std::vector<std::pair<diffType,sizeType> > order(points.size());
+    for (sizeType k=0; k < points.size(); ++k)
+    {
+        diffType offset = 0;
+        for (int r=0; r < N_rank; ++r)
+            offset += stride_(r) * points[k](r);
+        order[k] = std::make_pair(offset, k);
+    }
+    std::sort(order.begin(), order.end());
+
+    positions_.clear();
+    offsets_.clear();
+    positions_.reserve(order.size());
+    offsets_.reserve(order.size());
+    for (sizeType k=0; k < order.size(); ++k)
+    {
+        if ((k > 0) && (order[k].first == order[k-1].first))
+            continue;
+        offsets_.push_back(order[k].first);
+        positions_.push_back(points[order[k].second]);
+    }
+
+    const sizeType n = size();
+    if (n == 0)
+    {
+        lbound_ = 0;
+        ubound_ = -1;
+    }
+    else
+    {
+        lbound_ = positions_[0];
+        ubound_ = positions_[0];
+        for (sizeType k=1; k < n; ++k)
+            for (int r=0; r < N_rank; ++r)
+            {
+                lbound_(r) = std::min(lbound_(r), positions_[k](r));
+                ubound_(r) = std::max(ubound_(r), positions_[k](r));
+            }
+    }
+
+    // Length of the run starting at each point: the next point must be
+    // the neighbour along runRank_
+    std::vector<sizeType> runLength(n);
+    for (sizeType k=n; k-- > 0; )
+    {
+        runLength[k] = 1;
+        if ((k+1 < n) && (offsets_[k+1] - offsets_[k] == stride_(runRank_))
+            && (positions_[k+1](runRank_) == positions_[k](runRank_) + 1))
+            runLength[k] += runLength[k+1];
+    }
+
+    // Segments: contiguous runs, and batches of the points between them
+    const sizeType maxSegment = BZ_INDEX_PLAN_MAX_SEGMENT;
+    segments_.clear();
+    contiguous_.clear();
+    segments_.push_back(0);
+    sizeType k = 0;
+    while (k < n)
+    {
+        if (runLength[k] >= BZ_INDEX_PLAN_MIN_RUN)
+        {
+            k += std::min(runLength[k], maxSegment);
+            contiguous_.push_back(true);
+        }
+        else
+        {
+            sizeType first = k;
+            while ((k < n) && (k - first < maxSegment)
+                && (runLength[k] < BZ_INDEX_PLAN_MIN_RUN))
+                ++k;
+            contiguous_.push_back(false);
+        }
+        segments_.push_back(k);
+    }
+
+    // Parts: one per thread, with about the same number of points
+    int numParts = 1;
+#ifdef _OPENMP
+    numParts = omp_get_max_threads();
+#endif
+    numParts = std::max(1, std::min(numParts, numSegments()));
+
+    parts_.clear();
+    parts_.push_back(0);
+    int s = 0;
+    for (int p=1; p < numParts; ++p)
+    {
+        sizeType target = n * p / numParts;
+        while ((s < numSegments()) && (segments_[s] < target))
+            ++s;
+        parts_.push_back(s);
+    }
+    parts_.push_back(numSegments());
+}
+
+template<int N_rank> template<typename T_numtype>
+bool IndexPlan<N_rank>::conforms(const Array<T_numtype,N_rank>& array) const
+{
+    if (size() == 0)
+        return true;
+    for (int r=0; r < N_rank; ++r)
+        if (array.stride(r) != stride_(r))
+            return false;
+    return array.isInRange(lbound_) && array.isInRange(ubound_);
+}
+
+template<int N_rank>
+sizeType IndexPlan<N_rank>::numCoalesced() const
+{
+    sizeType n = 0;
+    for (int s=0; s < numSegments(); ++s)
+        if (contiguous_[s])
+            n += segmentEnd(s) - segmentBegin(s);
+    return n;
+}
+
+template<typename T_array, int N_rank>
+template<template<typename,typename> class T_update, typename T_rhs>
+void IndirectArray<T_array, IndexPlan<N_rank> >::apply(T_rhs rhs)
+{
+    typedef _bz_typename asExpr<T_rhs>::T_expr T_expr;
+    typedef _bz_typename T_array::T_numtype T_numtype;
+    typedef T_update<T_numtype, _bz_typename T_expr::T_numtype> T_updater;
+    T_expr expr(rhs);
+
+    BZPRECHECK(index_.conforms(array_),
+        "IndexPlan<" << N_rank << "> applied to an array with different "
+        "strides," << endl << "or which does not contain all its points")
+
+    T_numtype* restrict dataZero = array_.dataZero();
+    const int runRank = index_.runRank();
+    const diffType runStride = index_.runStride();
+    const int numParts = index_.numParts();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) \
+    if (index_.size() >= BZ_INDEX_PLAN_PARALLEL_THRESHOLD)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        // Each thread moves its own copy of the expression
+        T_expr e(expr);
+
+        for (int s=index_.firstSegment(p); s < index_.firstSegment(p+1); ++s)
+        {
+            const sizeType first = index_.segmentBegin(s),
+                last = index_.segmentEnd(s);
+
+            if (!index_.isContiguous(s))
+            {
+                for (sizeType k=first; k < last; ++k)
+                {
+                    e.moveTo(index_.position(k));
+                    T_updater::update(dataZero[index_.offset(k)], *e);
+                }
+                continue;
+            }
+
+            T_numtype* restrict data = dataZero + index_.offset(first);
+            const int length = last - first;
+            e.moveTo(index_.position(first));
+            e.loadStride(runRank);
+
+#ifdef BZ_USE_FAST_READ_ARRAY_EXPR
+            if ((runStride == 1) && e.isUnitStride(runRank))
+            {
+                for (int i=0; i < length; ++i)
+                    T_updater::update(data[i], e.fastRead(i));
+                continue;
+            }
+#endif
+
+            for (int i=0; i < length; ++i)
+            {
+                T_updater::update(data[i * runStride], *e);
+                e.advance();
+            }
+        }
+    }
+}
+
+template<typename T_numtype, int N_rank>
+void gather(const Array<T_numtype,N_rank>& A, const IndexPlan<N_rank>& plan,
+    Array<T_numtype,1>& out)
+{
+    BZPRECHECK(plan.conforms(A),
+        "IndexPlan<" << N_rank << "> applied to an array with different "
+        "strides," << endl << "or which does not contain all its points")
+    BZPRECHECK(out.numElements() == plan.size(),
+        "gather() into an array of " << out.numElements()
+        << " elements from a plan of " << plan.size() << " points")
+
+    const T_numtype* restrict src = A.dataZero();
+    T_numtype* restrict dst = out.data();
+    const diffType dstStride = out.stride(firstDim);
+    const diffType runStride = plan.runStride();
+    const int numParts = plan.numParts();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) \
+    if (plan.size() >= BZ_INDEX_PLAN_PARALLEL_THRESHOLD)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        for (int s=plan.firstSegment(p); s < plan.firstSegment(p+1); ++s)
+        {
+            const sizeType first = plan.segmentBegin(s),
+                last = plan.segmentEnd(s);
+            const sizeType length = last - first;
+            T_numtype* restrict d = dst + first * dstStride;
+
+            if (plan.isContiguous(s))
+            {
+                const T_numtype* restrict run = src + plan.offset(first);
+                if ((dstStride == 1) && (runStride == 1))
+                    for (sizeType i=0; i < length; ++i)
+                        d[i] = run[i];
+                else
+                    for (sizeType i=0; i < length; ++i)
+                        d[i * dstStride] = run[i * runStride];
+            }
+            else
+            {
+                const diffType* restrict offset = &plan.offset(first);
+                if (dstStride == 1)
+                    for (sizeType i=0; i < length; ++i)
+                        d[i] = src[offset[i]];
+                else
+                    for (sizeType i=0; i < length; ++i)
+                        d[i * dstStride] = src[offset[i]];
+            }
+        }
+    }
+}
+
+template<typename T_numtype, int N_rank>
+void scatter(const Array<T_numtype,1>& in, Array<T_numtype,N_rank>& A,
+    const IndexPlan<N_rank>& plan)
+{
+    BZPRECHECK(plan.conforms(A),
+        "IndexPlan<" << N_rank << "> applied to an array with different "
+        "strides," << endl << "or which does not contain all its points")
+    BZPRECHECK(in.numElements() == plan.size(),
+        "scatter() from an array of " << in.numElements()
+        << " elements through a plan of " << plan.size() << " points")
+
+    const T_numtype* restrict src = in.data();
+    T_numtype* restrict dst = A.dataZero();
+    const diffType srcStride = in.stride(firstDim);
+    const diffType runStride = plan.runStride();
+    const int numParts = plan.numParts();
+
+    // The points are distinct, so the parts write disjoint elements
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) \
+    if (plan.size() >= BZ_INDEX_PLAN_PARALLEL_THRESHOLD)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        for (int s=plan.firstSegment(p); s < plan.firstSegment(p+1); ++s)
+        {
+            const sizeType first = plan.segmentBegin(s),
+                last = plan.segmentEnd(s);
+            const sizeType length = last - first;
+            const T_numtype* restrict v = src + first * srcStride;
+
+            if (plan.isContiguous(s))
+            {
+                T_numtype* restrict run = dst + plan.offset(first);
+                if ((srcStride == 1) && (runStride == 1))
+                    for (sizeType i=0; i < length; ++i)
+                        run[i] = v[i];
+                else
+                    for (sizeType i=0; i < length; ++i)
+                        run[i * runStride] = v[i * srcStride];
+            }
+            else
+            {
+                const diffType* restrict offset = &plan.offset(first);
+                if (srcStride == 1)
+                    for (sizeType i=0; i < length; ++i)
+                        dst[offset[i]] = v[i];
+                else
+                    for (sizeType i=0; i < length; ++i)
+                        dst[offset[i]] = v[i * srcStride];
+            }
+        }
+    }
+}
+
+template<typename T_expr, int N_rank, typename T_reduction>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceOverPlan(T_expr expr, const IndexPlan<N_rank>& plan,
+    T_reduction reduction)
+{
+    const int runRank = plan.runRank();
+    reduction.reset();
+
+    for (int s=0; s < plan.numSegments(); ++s)
+    {
+        const sizeType first = plan.segmentBegin(s),
+            last = plan.segmentEnd(s);
+
+        if (!plan.isContiguous(s))
+        {
+            for (sizeType k=first; k < last; ++k)
+            {
+                expr.moveTo(plan.position(k));
+                if (!reduction(*expr, k))
+                    return reduction.result(plan.size());
+            }
+            continue;
+        }
+
+        expr.moveTo(plan.position(first));
+        expr.loadStride(runRank);
+        for (sizeType k=first; k < last; ++k)
+        {
+            if (!reduction(*expr, k))
+                return reduction.result(plan.size());
+            expr.advance();
+        }
+    }
+
+    return reduction.result(plan.size());
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_INDEXPLAN_CC
@@ -0,0 +1,284 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/indexplan.h  Precompiled index sets for repeated
+ *                          gather/scatter
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_INDEXPLAN_H
+#define BZ_ARRAY_INDEXPLAN_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/indexplan.h> must be included via <blitz/array.h>
+#endif
+
+#include <vector>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Points which follow each other along the fastest rank are coalesced
+// into runs of at least this length; shorter runs are left as single
+// points.
+#ifndef BZ_INDEX_PLAN_MIN_RUN
+ #define BZ_INDEX_PLAN_MIN_RUN 4
+#endif
+
+// Upper bound on the points in one segment, which is the unit of work
+// handed to a thread.
+#ifndef BZ_INDEX_PLAN_MAX_SEGMENT
+ #define BZ_INDEX_PLAN_MAX_SEGMENT 1024
+#endif
+
+// Plans with fewer points than this are applied by one thread.
+#ifndef BZ_INDEX_PLAN_PARALLEL_THRESHOLD
+ #define BZ_INDEX_PLAN_PARALLEL_THRESHOLD 16384
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * IndexPlan<N> is an index set compiled once for the layout of an array
+ * and then applied any number of times:
+ *
+ *   IndexPlan<3> plan(A, points);     // list<TinyVector<int,3> >, or
+ *                                     // RectDomain<3> strips/boxes
+ *   A[plan] = B + C;                  // scatter an expression
+ *   A[plan] += B;                     // or update through it
+ *   gather(A, plan, v);               // v(k) = A(plan.position(k))
+ *   scatter(v, A, plan);              // A(plan.position(k)) = v(k)
+ *
+ * The points are sorted into memory order and duplicates removed, so
+ * plan.size() may be smaller than the container.  Points adjacent along
+ * the fastest-varying rank are coalesced into contiguous runs, the rest
+ * are kept as a list of offsets for a plain gather loop.  The work is
+ * split into segments, and the segments into one part per thread; with
+ * OpenMP the parts run in parallel.
+ *
+ * A plan stores offsets, so it may be applied to any array with the same
+ * strides whose domain holds all the points, e.g. to every field of a
+ * simulation sharing one grid.
+ *
+ * A plan may also be built from a mask, to restrict work to a sparse
+ * active region and keep it across time steps:
+ *
+ *   IndexPlan<2> active(phi, abs(phi) < width);   // or an Array<bool,2>
+ *   phi[active] = phi + dt * rhs;                 // O(active) work
+ *   double total = sum(phi * phi, active);        // likewise
+ *
+ * The restricted reductions are sum, mean, min, max, product, count,
+ * any and all.
+ */
+
+template<int N_rank>
+class IndexPlan {
+
+public:
+    typedef TinyVector<int,N_rank> T_index;
+
+    IndexPlan()
+      : runRank_(0), stride_(0), lbound_(0), ubound_(-1)
+    { segments_.push_back(0); parts_.push_back(0); }
+
+    template<typename T_numtype, typename T_container>
+    IndexPlan(const Array<T_numtype,N_rank>& array, const T_container& index)
+    { build(array, index); }
+
+    // Compile the points (or RectDomains) in index for arrays laid out
+    // like array
+    template<typename T_numtype, typename T_container>
+    void build(const Array<T_numtype,N_rank>& array,
+        const T_container& index);
+
+    // Compile the points of array's domain where mask is true
+    template<typename T_numtype>
+    void build(const Array<T_numtype,N_rank>& array,
+        const Array<bool,N_rank>& mask);
+
+    template<typename T_numtype, typename T_expr>
+    void build(const Array<T_numtype,N_rank>& array,
+        const _bz_ArrayExpr<T_expr>& mask);
+
+    // Number of distinct points
+    sizeType size() const
+    { return offsets_.size(); }
+
+    // Point k in memory order, and its offset from dataZero()
+    const T_index& position(sizeType k) const
+    { return positions_[k]; }
+
+    const diffType& offset(sizeType k) const
+    { return offsets_[k]; }
+
+    // Segment s covers points [segmentBegin(s), segmentEnd(s)); in a
+    // contiguous segment successive points are stride(runRank()) apart.
+    int numSegments() const
+    { return segments_.size() - 1; }
+
+    sizeType segmentBegin(int s) const
+    { return segments_[s]; }
+
+    sizeType segmentEnd(int s) const
+    { return segments_[s+1]; }
+
+    bool isContiguous(int s) const
+    { return contiguous_[s]; }
+
+    int runRank() const
+    { return runRank_; }
+
+    diffType runStride() const
+    { return stride_(runRank_); }
+
+    // Part p is segments [firstSegment(p), firstSegment(p+1))
+    int numParts() const
+    { return parts_.size() - 1; }
+
+    int firstSegment(int p) const
+    { return parts_[p]; }
+
+    // True if the plan may be applied to array
+    template<typename T_numtype>
+    bool conforms(const Array<T_numtype,N_rank>& array) const;
+
+    // Number of points in contiguous runs
+    sizeType numCoalesced() const;
+
+private:
+    template<typename T_numtype>
+    void compile(const Array<T_numtype,N_rank>& array,
+        const std::vector<T_index>& points);
+
+    int runRank_;
+    TinyVector<diffType,N_rank> stride_;
+    T_index lbound_, ubound_;
+    std::vector<T_index> positions_;
+    std::vector<diffType> offsets_;
+    std::vector<sizeType> segments_;
+    std::vector<bool> contiguous_;
+    std::vector<int> parts_;
+};
+
+// Scatter of an expression through a plan: A[plan] = expr, A[plan] += expr
+template<typename T_array, int N_rank>
+class IndirectArray<T_array, IndexPlan<N_rank> > {
+
+public:
+    IndirectArray(T_array& array, IndexPlan<N_rank>& index)
+        : array_(array), index_(index)
+    { }
+
+    template<typename T_expr>
+    void operator=(T_expr expr)
+    { apply<_bz_update>(expr); }
+
+    template<typename T_expr>
+    void operator+=(T_expr expr)
+    { apply<_bz_plus_update>(expr); }
+
+    template<typename T_expr>
+    void operator-=(T_expr expr)
+    { apply<_bz_minus_update>(expr); }
+
+    template<typename T_expr>
+    void operator*=(T_expr expr)
+    { apply<_bz_multiply_update>(expr); }
+
+    template<typename T_expr>
+    void operator/=(T_expr expr)
+    { apply<_bz_divide_update>(expr); }
+
+protected:
+    template<template<typename,typename> class T_update, typename T_expr>
+    void apply(T_expr expr);
+
+    T_array& array_;
+    const IndexPlan<N_rank>& index_;
+};
+
+// out(k) = A(plan.position(k)); out must have plan.size() elements
+template<typename T_numtype, int N_rank>
+void gather(const Array<T_numtype,N_rank>& A, const IndexPlan<N_rank>& plan,
+    Array<T_numtype,1>& out);
+
+template<typename T_numtype, int N_rank>
+inline Array<T_numtype,1> gather(const Array<T_numtype,N_rank>& A,
+    const IndexPlan<N_rank>& plan)
+{
+    Array<T_numtype,1> out(plan.size());
+    gather(A, plan, out);
+    return out;
+}
+
+// A(plan.position(k)) = in(k)
+template<typename T_numtype, int N_rank>
+void scatter(const Array<T_numtype,1>& in, Array<T_numtype,N_rank>& A,
+    const IndexPlan<N_rank>& plan);
+
+// Reductions of an expression over the points of a plan
+
+template<typename T_expr, int N_rank, typename T_reduction>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceOverPlan(T_expr expr, const IndexPlan<N_rank>& plan,
+    T_reduction reduction);
+
+#define BZ_DECL_PLAN_REDUCE(fn,reduction)                               \
+template<typename T_expr, int N_rank>                                   \
+inline                                                                  \
+_bz_typename reduction<_bz_typename T_expr::T_numtype>::T_resulttype    \
+fn(_bz_ArrayExpr<T_expr> expr, const IndexPlan<N_rank>& plan)           \
+{                                                                       \
+    return _bz_reduceOverPlan(expr, plan,                               \
+        reduction<_bz_typename T_expr::T_numtype>());                   \
+}                                                                       \
+                                                                        \
+template<typename T_numtype, int N_rank>                                \
+inline                                                                  \
+_bz_typename reduction<T_numtype>::T_resulttype                         \
+fn(const Array<T_numtype, N_rank>& array, const IndexPlan<N_rank>& plan) \
+{                                                                       \
+    return _bz_reduceOverPlan(array.beginFast(), plan,                  \
+        reduction<T_numtype>());                                        \
+}
+
+BZ_DECL_PLAN_REDUCE(sum,      ReduceSum)
+BZ_DECL_PLAN_REDUCE(mean,     ReduceMean)
+BZ_DECL_PLAN_REDUCE((min),    ReduceMin)
+BZ_DECL_PLAN_REDUCE((max),    ReduceMax)
+BZ_DECL_PLAN_REDUCE(product,  ReduceProduct)
+BZ_DECL_PLAN_REDUCE(count,    ReduceCount)
+BZ_DECL_PLAN_REDUCE(any,      ReduceAny)
+BZ_DECL_PLAN_REDUCE(all,      ReduceAll)
+
+#undef BZ_DECL_PLAN_REDUCE
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/indexplan.cc>
+
+#endif // BZ_ARRAY_INDEXPLAN_H
@@ -56,11 +56,11 @@ protected:
 // Forward declarations
 template<typename T_array, typename T_arrayiter, typename T_subdomain, typename T_expr>
 inline void applyOverSubdomain(const T_array& array, T_arrayiter& arrayIter,
-    T_subdomain subdomain, T_expr expr);
+    T_subdomain subdomain, T_expr expr, int& stripDim);
 template<typename T_array, typename T_arrayiter, int N_rank, typename T_expr>
 inline void applyOverSubdomain(const T_array& array, T_arrayiter& arrayIter,
     RectDomain<N_rank> subdomain,
-    T_expr expr);
+    T_expr expr, int& stripDim);
 
 template<typename T_array, typename T_index> template<typename T_rhs>
 void IndirectArray<T_array, T_index>::operator=(T_rhs rhs)
@@ -73,16 +73,20 @@ void IndirectArray<T_array, T_index>::operator=(T_rhs rhs)
     _bz_typename T_index::iterator iter = index_.begin(),
                        end = index_.end();
 
+    // Orientation of the last RectDomain strip, likely to be the same
+    // for all strips within a container
+    int stripDim = 0;
+
     for (; iter != end; ++iter)
     {
         _bz_typename T_index::value_type subdomain = *iter;
-        applyOverSubdomain(array_, arrayIter, subdomain, expr);
+        applyOverSubdomain(array_, arrayIter, subdomain, expr, stripDim);
     }
 }
 
 template<typename T_array, typename T_arrayiter, typename T_subdomain, typename T_expr>
 inline void applyOverSubdomain(const T_array& BZ_DEBUG_PARAM(array), T_arrayiter& arrayIter, 
-    T_subdomain subdomain, T_expr expr)
+    T_subdomain subdomain, T_expr expr, int&)
 {
     BZPRECHECK(array.isInRange(subdomain),
         "In indirection using an STL container of TinyVector<int,"
@@ -101,16 +105,13 @@ inline void applyOverSubdomain(const T_array& BZ_DEBUG_PARAM(array), T_arrayiter
 template<typename T_array, typename T_arrayiter, int N_rank, typename T_expr>
 inline void applyOverSubdomain(const T_array& BZ_DEBUG_PARAM(array), T_arrayiter& arrayIter, 
     RectDomain<N_rank> subdomain,
-    T_expr expr)
+    T_expr expr, int& stripDim)
 {
     typedef _bz_typename T_array::T_numtype T_numtype;
 
     // Assume that the RectDomain<N_rank> is a 1-D strip.
-    // Find the dimension in which the strip is oriented.  This
-    // variable is static so that we cache the value; likely to be
-    // the same for all strips within a container.
-
-    static int stripDim = 0;
+    // Find the dimension in which the strip is oriented, starting
+    // from the caller's cached value.
 
     if (subdomain.lbound(stripDim) == subdomain.ubound(stripDim))
     {
@@ -156,6 +157,9 @@ inline void applyOverSubdomain(const T_array& BZ_DEBUG_PARAM(array), T_arrayiter
     arrayIter.moveTo(subdomain.lbound());
     expr.moveTo(subdomain.lbound());
 
+    arrayIter.loadStride(stripDim);
+    expr.loadStride(stripDim);
+
     // Loop through the strip
 
 #ifdef BZ_USE_FAST_READ_ARRAY_EXPR
@@ -177,9 +181,6 @@ inline void applyOverSubdomain(const T_array& BZ_DEBUG_PARAM(array), T_arrayiter
     else {
 #endif
 
-    arrayIter.loadStride(stripDim);
-    expr.loadStride(stripDim);
-
     for (int i=lbound; i <= ubound; ++i)
     {
         *const_cast<_bz_typename T_arrayiter::T_numtype*>(arrayIter.data()) 
@@ -610,4 +611,7 @@ indexSet(const T1& c1, const T2& c2, const T3& c3, const T4& c4, const T5& c5,
 
 BZ_NAMESPACE_END
 
+#include <blitz/array/indexplan.h>
+#include <blitz/array/scatteradd.h>
+
 #endif // BZ_ARRAY_INDIRECT_H
@@ -291,6 +291,332 @@ ConstArrayIterator<T,N>& ConstArrayIterator<T,N>::operator--() {
     return *this;
 }
 
+/*
+ * Random-access iterators, visiting the elements in the same order as
+ * ArrayIterator, i.e. by storage order.  The ranks that follow one
+ * another in memory are treated as one, which leaves segments of equally
+ * strided elements; a contiguous array is a single segment.  Within a
+ * segment, ++ and -- only move a pointer; between segments, and for
+ * jumps out of the current segment, the position is recomputed from the
+ * element number.  These iterators can be used with the algorithms
+ * needing random access, such as std::sort and std::nth_element, and
+ * with the C++17 parallel algorithms:
+ *
+ *   std::sort(A.beginSegmented(), A.endSegmented());
+ *   double s = std::reduce(std::execution::par,
+ *       A.beginSegmented(), A.endSegmented());
+ *
+ * Like ArrayIterator, they are invalidated by anything that reallocates
+ * the array.  for_each_segment() gives the segments themselves to a
+ * kernel.
+ */
+
+template<int N>
+class _bz_SegmentLayout {
+public:
+    template<typename T>
+    void init(const Array<T,N>& array)
+    {
+        const TinyVector<int,N> order = array.ordering();
+        stride = array.stride(order(0));
+        length = array.extent(order(0));
+
+        int k = 1;
+        while ((k < N) && (array.stride(order(k)) == stride * length))
+            length *= array.extent(order(k++));
+
+        numOuter = N - k;
+        for (int j=0; j < numOuter; ++j)
+        {
+            outerExtent(j) = array.extent(order(k + j));
+            outerStride(j) = array.stride(order(k + j));
+        }
+        size = array.numElements();
+    }
+
+    // The offset of the first element of segment q from the first element
+    diffType offset(diffType q) const
+    {
+        diffType off = 0;
+        for (int j=0; j < numOuter; ++j)
+        {
+            off += (q % outerExtent(j)) * outerStride(j);
+            q /= outerExtent(j);
+        }
+        return off;
+    }
+
+    diffType size, length, stride;
+    int numOuter;
+    TinyVector<diffType,N> outerExtent, outerStride;
+};
+
+template<typename T, int N>
+class ConstSegmentedArrayIterator {
+public:
+    ConstSegmentedArrayIterator()
+      : data_(0), first_(0), index_(0), segBegin_(0), segEnd_(1)
+    {
+        layout_.size = 0;
+    }
+
+    // The iterator to element number index, in storage order
+    ConstSegmentedArrayIterator(const Array<T,N>& array, diffType index)
+      : first_(const_cast<T*>(array.data())), index_(index)
+    {
+        layout_.init(array);
+        locate();
+    }
+
+    const T& operator*() const
+    {
+        BZPRECHECK((index_ >= 0) && (index_ < layout_.size),
+            "Attempted to dereference invalid iterator");
+        return *data_;
+    }
+
+    const T* operator->() const
+    {
+        BZPRECHECK((index_ >= 0) && (index_ < layout_.size),
+            "Attempted to dereference invalid iterator");
+        return data_;
+    }
+
+    const T& operator[](diffType n) const
+    { return *(*this + n); }
+
+    ConstSegmentedArrayIterator<T,N>& operator++()
+    {
+        if (++index_ == segEnd_)
+            locate();
+        else
+            data_ += layout_.stride;
+        return *this;
+    }
+
+    ConstSegmentedArrayIterator<T,N>& operator--()
+    {
+        if (index_-- == segBegin_)
+            locate();
+        else
+            data_ -= layout_.stride;
+        return *this;
+    }
+
+    ConstSegmentedArrayIterator<T,N> operator++(int)
+    {
+        ConstSegmentedArrayIterator<T,N> tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    ConstSegmentedArrayIterator<T,N> operator--(int)
+    {
+        ConstSegmentedArrayIterator<T,N> tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    ConstSegmentedArrayIterator<T,N>& operator+=(diffType n)
+    {
+        index_ += n;
+        if ((index_ >= segBegin_) && (index_ < segEnd_))
+            data_ += n * layout_.stride;
+        else
+            locate();
+        return *this;
+    }
+
+    ConstSegmentedArrayIterator<T,N>& operator-=(diffType n)
+    { return *this += -n; }
+
+    ConstSegmentedArrayIterator<T,N> operator+(diffType n) const
+    {
+        ConstSegmentedArrayIterator<T,N> tmp = *this;
+        return tmp += n;
+    }
+
+    ConstSegmentedArrayIterator<T,N> operator-(diffType n) const
+    {
+        ConstSegmentedArrayIterator<T,N> tmp = *this;
+        return tmp += -n;
+    }
+
+    diffType operator-(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ - x.index_; }
+
+    bool operator==(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ == x.index_; }
+    bool operator!=(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ != x.index_; }
+    bool operator<(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ < x.index_; }
+    bool operator>(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ > x.index_; }
+    bool operator<=(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ <= x.index_; }
+    bool operator>=(const ConstSegmentedArrayIterator<T,N>& x) const
+    { return index_ >= x.index_; }
+
+    // The element number, in storage order
+    diffType index() const
+    { return index_; }
+
+protected:
+    // Points data_ at element index_, and finds the extent of its segment.
+    // Outside the array, the segment is just the position, so that any
+    // move comes back here.
+    void locate()
+    {
+        if ((index_ < 0) || (index_ >= layout_.size))
+        {
+            data_ = first_;
+            segBegin_ = index_;
+            segEnd_ = index_ + 1;
+            return;
+        }
+
+        const diffType q = index_ / layout_.length,
+            r = index_ - q * layout_.length;
+        data_ = first_ + layout_.offset(q) + r * layout_.stride;
+        segBegin_ = index_ - r;
+        segEnd_ = segBegin_ + layout_.length;
+    }
+
+    T* data_;
+    T* first_;
+    diffType index_, segBegin_, segEnd_;
+    _bz_SegmentLayout<N> layout_;
+};
+
+template<typename T, int N>
+class SegmentedArrayIterator : public ConstSegmentedArrayIterator<T,N> {
+private:
+    typedef ConstSegmentedArrayIterator<T,N> T_base;
+    using T_base::data_;
+
+public:
+    SegmentedArrayIterator() { }
+
+    SegmentedArrayIterator(Array<T,N>& array, diffType index)
+      : T_base(array, index) { }
+
+    T& operator*() const
+    {
+        BZPRECHECK((this->index_ >= 0) && (this->index_ < this->layout_.size),
+            "Attempted to dereference invalid iterator");
+        return *data_;
+    }
+
+    T* operator->() const
+    { return &**this; }
+
+    T& operator[](diffType n) const
+    { return *(*this + n); }
+
+    SegmentedArrayIterator<T,N>& operator++()
+    {
+        T_base::operator++();
+        return *this;
+    }
+
+    SegmentedArrayIterator<T,N>& operator--()
+    {
+        T_base::operator--();
+        return *this;
+    }
+
+    SegmentedArrayIterator<T,N> operator++(int)
+    {
+        SegmentedArrayIterator<T,N> tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    SegmentedArrayIterator<T,N> operator--(int)
+    {
+        SegmentedArrayIterator<T,N> tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    SegmentedArrayIterator<T,N>& operator+=(diffType n)
+    {
+        T_base::operator+=(n);
+        return *this;
+    }
+
+    SegmentedArrayIterator<T,N>& operator-=(diffType n)
+    { return *this += -n; }
+
+    SegmentedArrayIterator<T,N> operator+(diffType n) const
+    {
+        SegmentedArrayIterator<T,N> tmp = *this;
+        return tmp += n;
+    }
+
+    SegmentedArrayIterator<T,N> operator-(diffType n) const
+    {
+        SegmentedArrayIterator<T,N> tmp = *this;
+        return tmp += -n;
+    }
+
+    using T_base::operator-;
+};
+
+template<typename T, int N>
+inline ConstSegmentedArrayIterator<T,N> operator+(diffType n,
+    const ConstSegmentedArrayIterator<T,N>& iter)
+{ return iter + n; }
+
+template<typename T, int N>
+inline SegmentedArrayIterator<T,N> operator+(diffType n,
+    const SegmentedArrayIterator<T,N>& iter)
+{ return iter + n; }
+
+/*
+ * for_each_segment(A, kernel) calls kernel(first, length, stride) for
+ * each segment of A, in storage order: first points to its first
+ * element, and the others follow stride apart.  The stride is 1 for a
+ * contiguous array in the default storage order, which is then a single
+ * segment.  For example,
+ *
+ *   for_each_segment(A, [](double* x, diffType n, diffType s) {
+ *       for (diffType i=0; i < n; ++i)
+ *           x[i*s] = std::max(x[i*s], 0.);
+ *   });
+ *
+ * The kernel may be a function or any object callable like one.
+ */
+
+template<typename T, int N, typename T_kernel>
+void for_each_segment(Array<T,N>& array, T_kernel kernel)
+{
+    if (array.numElements() == 0)
+        return;
+
+    _bz_SegmentLayout<N> layout;
+    layout.init(array);
+    T* first = array.data();
+    const diffType numSegments = layout.size / layout.length;
+    for (diffType q=0; q < numSegments; ++q)
+        kernel(first + layout.offset(q), layout.length, layout.stride);
+}
+
+template<typename T, int N, typename T_kernel>
+void for_each_segment(const Array<T,N>& array, T_kernel kernel)
+{
+    if (array.numElements() == 0)
+        return;
+
+    _bz_SegmentLayout<N> layout;
+    layout.init(array);
+    const T* first = array.data();
+    const diffType numSegments = layout.size / layout.length;
+    for (diffType q=0; q < numSegments; ++q)
+        kernel(first + layout.offset(q), layout.length, layout.stride);
+}
+
 BZ_NAMESPACE_END
 
 
@@ -316,6 +642,24 @@ struct iterator_traits< BZ_BLITZ_SCOPE(ArrayIterator)<T,N> > {
     typedef T&                                 reference;
 };
 
+template <typename T, int N>
+struct iterator_traits< BZ_BLITZ_SCOPE(ConstSegmentedArrayIterator)<T,N> > {
+    typedef random_access_iterator_tag         iterator_category;
+    typedef T                                  value_type;
+    typedef blitz::diffType                    difference_type;
+    typedef const T*                           pointer;
+    typedef const T&                           reference;
+};
+
+template <typename T, int N>
+struct iterator_traits< BZ_BLITZ_SCOPE(SegmentedArrayIterator)<T,N> > {
+    typedef random_access_iterator_tag         iterator_category;
+    typedef T                                  value_type;
+    typedef blitz::diffType                    difference_type;
+    typedef T*                                 pointer;
+    typedef T&                                 reference;
+};
+
 BZ_NAMESPACE_END
 
 #endif // BZ_HAVE_STL
@@ -378,16 +378,16 @@ public:
     ArrayIndexMapping(const ArrayIndexMapping<T_expr,N_map0,
         N_map1,N_map2,N_map3,N_map4,N_map5,N_map6,N_map7,N_map8,N_map9,
         N_map10>& z)
-        : iter_(z.iter_)
+        : iter_(z.iter_), stride_(z.stride_)
     { 
     }
 
   ArrayIndexMapping(BZ_ETPARM(T_expr) a)
-        : iter_(a)
+        : iter_(a), stride_(0)
     { }
 
   ArrayIndexMapping(_bz_typename T_expr::T_ctorArg1 a)
-        : iter_(a)
+        : iter_(a), stride_(0)
     { }
 
   // these bypass the FAI and go directly to the array. That should
@@ -495,82 +495,83 @@ public:
     return RectDomain<rank>(lb,ub);
   }
 
-    // If you have a precondition failure on this routine, it means
-    // you are trying to use stack iteration mode on an expression
-    // which contains an index placeholder.  You must use index
-    // iteration mode instead.
-  // (no -- added to support stencils /PJ)
+    /*
+     * In a stack traversal the mapped operand is stepped through by
+     * stride, like an Array operand: the stride along rank r is the
+     * stride of the operand's rank mapped to r, or the sum of the
+     * strides if several ranks map to r (as for a diagonal, A(i,i)),
+     * or zero if none does.  The loops are counted in steps rather than
+     * elements, so fastRead(i) reads i steps ahead and the unit stride
+     * loop applies whatever the layout of the operand.
+     */
     T_numtype operator*() const
     {
       return *iter_;
     }
 
-    // See operator*() note
-    void push(int)
+    void push(int position)
     {
-        BZPRECONDITION(0);
+        stack_[position] = iter_.data();
     }
 
-    // See operator*() note
-    void pop(int)
+    void pop(int position)
     {
-        BZPRECONDITION(0);
+        iter_._bz_setData(stack_[position]);
     }
 
-    // See operator*() note
     void advance()
     {
-        BZPRECONDITION(0);
+        iter_._bz_setData(iter_.data() + stride_);
     }
 
-    // See operator*() note
-    void advance(int)
+    void advance(int n)
     {
-        BZPRECONDITION(0);
+        iter_._bz_setData(iter_.data() + n * stride_);
     }
 
-    // See operator*() note
-    void loadStride(int)
+    void loadStride(int r)
     {
-        BZPRECONDITION(0);
+        stride_ = mappedStride(r);
     }
 
-    bool isUnitStride(int) const
+    // fastRead() steps by the mapped stride, so any stride will do
+    // once loadStride(r) has loaded it
+    bool isUnitStride(int r) const
     {
-        BZPRECONDITION(0);
-        return false;
+        return stride_ == mappedStride(r);
     }
 
     void advanceUnitStride()
     {
-        BZPRECONDITION(0);
+        advance();
     }
 
-    bool canCollapse(int,int) const
-    {   BZPRECONDITION(0);  return false; }
+    bool canCollapse(int outerLoopRank, int innerLoopRank) const
+    {
+        const int d = map_dim(innerLoopRank);
+        const diffType extent = (d >= 0) ? iter_.array().extent(d) : 0;
+        return mappedStride(innerLoopRank) * extent
+            == mappedStride(outerLoopRank);
+    }
 
-    T_numtype operator[](int)
+    T_numtype operator[](int i) const
     {   
-        BZPRECONDITION(0);
-        return T_numtype();
+        return iter_.data()[i * stride_];
     }
 
-    T_numtype fastRead(int) const
+    T_numtype fastRead(int i) const
     {
-        BZPRECONDITION(0);
-        return T_numtype();
+        return iter_.data()[i * stride_];
     }
 
     int suggestStride(int) const
     {
-        BZPRECONDITION(0);
-        return 0;
+        return 1;
     }
 
-    bool isStride(int,int) const
+    bool isStride(int, diffType stride) const
     {
-        BZPRECONDITION(0);
-        return true;
+        return stride == 1;
     }
 
 #ifdef BZ_ARRAY_EXPR_PASS_INDEX_BY_VALUE
@@ -607,7 +608,8 @@ public:
     return iter_.shift(offset1, d1, offset2, d2);
   }
 
-  void _bz_offsetData(sizeType i) { BZPRECONDITION(0); }
+  void _bz_offsetData(sizeType i)
+  { iter_._bz_setData(iter_.data() + diffType(i) * stride_); }
 
   template<int N>
   T_range_result operator()(RectDomain<N> d) const
@@ -659,9 +661,24 @@ public:
     }
 
 private:
-    ArrayIndexMapping() : iter_( Array<T_numtype, exprRank>() ) { }
+    ArrayIndexMapping() : iter_( Array<T_numtype, exprRank>() ), stride_(0) { }
+
+    // Stride of the mapped operand along rank r of this expression
+    diffType mappedStride(int r) const
+    {
+        const int map[] = { N_map0, N_map1, N_map2, N_map3, N_map4, N_map5,
+            N_map6, N_map7, N_map8, N_map9, N_map10 };
+        diffType stride = 0;
+        for (int d=0; d < exprRank; ++d)
+            if (map[d] == r)
+                stride += iter_.array().stride(d);
+        return stride;
+    }
 
     T_expr iter_;
+    diffType stride_;
+    // Blitz++ arrays have at most 11 ranks, and so at most 11 loops
+    const T_numtype* stack_[11];
 };
 
 BZ_NAMESPACE_END
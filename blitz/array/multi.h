@@ -62,6 +62,16 @@ struct multicomponent_traits<TinyVector<T_numtype,N_rank> > {
     static const int numComponents = N_rank;
 };
 
+// TinyMatrix, whose components are its elements in row-major order
+template<typename T_numtype, int N_rows, int N_columns>
+class TinyMatrix;
+
+template<typename T_numtype, int N_rows, int N_columns>
+struct multicomponent_traits<TinyMatrix<T_numtype,N_rows,N_columns> > {
+    typedef T_numtype T_element;
+    static const int numComponents = N_rows * N_columns;
+};
+
 #ifdef BZ_HAVE_COMPLEX
 // complex<T>
 template<typename T>
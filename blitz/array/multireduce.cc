@@ -0,0 +1,387 @@
+/***************************************************************************
+ * blitz/array/multireduce.cc  Several reductions in one pass over an
+ *                             array expression
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_MULTIREDUCE_CC
+#define BZ_ARRAY_MULTIREDUCE_CC
+
+#ifndef BZ_ARRAY_MULTIREDUCE_H
+ #error <blitz/array/multireduce.cc> must be included via <blitz/array/multireduce.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+// Adding a block of values to a reduction: one at a time, unless the
+// reduction has something better
+
+template<typename T_reduction, typename T_numtype>
+inline void _bz_reduceBlock(const T_reduction& reduction,
+    const T_numtype* restrict x, int n, int position)
+{
+    for (int i=0; i < n; ++i)
+        reduction(x[i], position + i);
+}
+
+// The mean and squared deviations of the block are found in two passes,
+// then merged into the running values
+template<typename T_sourcetype, typename T_resulttype, typename T_numtype>
+inline void _bz_reduceBlock(
+    const ReduceVariance<T_sourcetype,T_resulttype>& reduction,
+    const T_numtype* restrict x, int n, int)
+{
+    // Not a constant, so that the compiler vectorizes the loops over the
+    // lanes rather than unrolling them
+    const int numLanes = (n < BZ_REDUCE_LANES) ? n : BZ_REDUCE_LANES;
+    T_resulttype lanes[BZ_REDUCE_LANES];
+
+    for (int k=0; k < numLanes; ++k)
+        lanes[k] = zero(T_resulttype());
+    int i = 0;
+    for (; i + numLanes <= n; i += numLanes)
+        for (int k=0; k < numLanes; ++k)
+            lanes[k] += T_resulttype(x[i + k]);
+    T_resulttype sum = zero(T_resulttype());
+    for (; i < n; ++i)
+        sum += T_resulttype(x[i]);
+    for (int k=0; k < numLanes; ++k)
+        sum += lanes[k];
+    const T_resulttype mean = sum / T_resulttype(n);
+
+    for (int k=0; k < numLanes; ++k)
+        lanes[k] = zero(T_resulttype());
+    for (i=0; i + numLanes <= n; i += numLanes)
+        for (int k=0; k < numLanes; ++k)
+        {
+            const T_resulttype d = T_resulttype(x[i + k]) - mean;
+            lanes[k] += d * d;
+        }
+    T_resulttype m2 = zero(T_resulttype());
+    for (; i < n; ++i)
+    {
+        const T_resulttype d = T_resulttype(x[i]) - mean;
+        m2 += d * d;
+    }
+    for (int k=0; k < numLanes; ++k)
+        m2 += lanes[k];
+
+    reduction.merge(sizeType(n), mean, m2);
+}
+
+// Starting a reduction, with or without a first value
+
+template<bool needInit>
+struct _bz_MultiReduceInit {
+    template<typename T_reduction>
+    static void reset(const T_reduction& reduction)
+    { reduction.reset(); }
+
+    template<typename T_reduction, typename T_numtype>
+    static void start(const T_reduction& reduction, const T_numtype&)
+    { reduction.reset(); }
+};
+
+template<>
+struct _bz_MultiReduceInit<true> {
+    // There is nothing to start from
+    template<typename T_reduction>
+    static void reset(const T_reduction&)
+    { }
+
+    template<typename T_reduction, typename T_numtype>
+    static void start(const T_reduction& reduction,
+        const T_numtype& firstValue)
+    { reduction.reset(firstValue); }
+};
+
+// Where the results go: the whole reduction, or its result() into an
+// array element
+
+template<typename T_reduction, typename T_index>
+inline void _bz_storeReduction(T_reduction* result,
+    const T_reduction& reduction, const T_index&, int)
+{
+    *result = reduction;
+}
+
+template<typename T_numtype, int N_rank, typename T_reduction>
+inline void _bz_storeReduction(Array<T_numtype,N_rank>* result,
+    const T_reduction& reduction, const TinyVector<int,N_rank>& index,
+    int count)
+{
+    BZPRECONDITION(result->isInRange(index));
+    (*result)(index) = reduction.result(count);
+}
+
+template<typename P_reduction, typename P_result, typename P_next>
+void _bz_ReduceList<P_reduction,P_result,P_next>::reset() const
+{
+    _bz_MultiReduceInit<T_reduction::needInit>::reset(reduction_);
+    next_.reset();
+}
+
+template<typename P_reduction, typename P_result, typename P_next>
+template<typename T_numtype>
+void _bz_ReduceList<P_reduction,P_result,P_next>::start(
+    const T_numtype& firstValue) const
+{
+    _bz_MultiReduceInit<T_reduction::needInit>::start(reduction_,
+        firstValue);
+    next_.start(firstValue);
+}
+
+template<typename P_reduction, typename P_result, typename P_next>
+template<typename T_numtype>
+void _bz_ReduceList<P_reduction,P_result,P_next>::addBlock(
+    const T_numtype* restrict x, int n, int position) const
+{
+    _bz_reduceBlock(reduction_, x, n, position);
+    next_.addBlock(x, n, position);
+}
+
+template<typename P_reduction, typename P_result, typename P_next>
+void _bz_ReduceList<P_reduction,P_result,P_next>::merge(
+    const _bz_ReduceList& x) const
+{
+    reduction_.merge(x.reduction_);
+    next_.merge(x.next_);
+}
+
+template<typename P_reduction, typename P_result, typename P_next>
+template<typename T_index>
+void _bz_ReduceList<P_reduction,P_result,P_next>::store(
+    const T_index& index, int count) const
+{
+    _bz_storeReduction(result_, reduction_, index, count);
+    next_.store(index, count);
+}
+
+// Sets index to the start of row number row; the rows are numbered with
+// the last rank but one varying fastest.
+template<int N_rank>
+inline void _bz_multiReduceRowIndex(TinyVector<int,N_rank>& index,
+    const TinyVector<int,N_rank>& first, const TinyVector<int,N_rank>& last,
+    sizeType row)
+{
+    index(N_rank-1) = first(N_rank-1);
+    for (int r=N_rank-2; r >= 0; --r)
+    {
+        const sizeType extent = last(r) - first(r);
+        index(r) = first(r) + int(row % extent);
+        row /= extent;
+    }
+}
+
+// Passes elements [begin, end) of the row starting at index to the
+// reductions, a block at a time
+template<typename T_expr, typename T_list>
+void _bz_multiReduceRow(T_expr& expr, const T_list& list,
+    TinyVector<int,T_expr::rank>& index, int begin, int end)
+{
+    typedef _bz_typename T_expr::T_numtype T_numtype;
+
+    const int innerRank = T_expr::rank - 1;
+    const int base = index(innerRank);
+    T_numtype block[BZ_MULTI_REDUCE_BLOCK];
+
+#ifdef BZ_USE_FAST_READ_ARRAY_EXPR
+    bool unitStride = false;
+    if (T_expr::numIndexPlaceholders == 0)
+    {
+        expr.moveTo(index);
+        unitStride = expr.isUnitStride(innerRank);
+    }
+#endif
+
+    for (int j0=begin; j0 < end; j0 += BZ_MULTI_REDUCE_BLOCK)
+    {
+        const int n = (end - j0 > BZ_MULTI_REDUCE_BLOCK)
+            ? BZ_MULTI_REDUCE_BLOCK : end - j0;
+
+#ifdef BZ_USE_FAST_READ_ARRAY_EXPR
+        if (unitStride)
+        {
+            for (int j=0; j < n; ++j)
+                block[j] = expr.fastRead(j0 + j);
+        }
+        else
+#endif
+        {
+            for (int j=0; j < n; ++j)
+            {
+                index(innerRank) = base + j0 + j;
+                block[j] = expr(index);
+            }
+            index(innerRank) = base;
+        }
+
+        list.addBlock(block, n, base + j0);
+    }
+}
+
+template<typename T_expr, typename T_list>
+sizeType _bz_multiReduce(T_expr expr, const T_list& list)
+{
+    const int rank = T_expr::rank;
+    const int innerRank = rank - 1;
+
+    TinyVector<int,rank> first, last;
+    sizeType count = 1;
+    for (int i=0; i < rank; ++i)
+    {
+        first(i) = expr.lbound(i);
+        last(i) = expr.ubound(i) + 1;
+        count *= last(i) - first(i);
+    }
+
+    if (count == 0)
+    {
+        list.reset();
+        list.store(first, 0);
+        return 0;
+    }
+
+    const _bz_typename T_expr::T_numtype firstValue = expr(first);
+    const int length = last(innerRank) - first(innerRank);
+    const sizeType numRows = count / length;
+
+    int numParts = 1;
+#ifdef _OPENMP
+    if (count >= BZ_MULTI_REDUCE_PARALLEL_THRESHOLD)
+        numParts = omp_get_max_threads();
+#endif
+
+    // When there are too few rows to go round, the rows are cut into
+    // pieces of at least a block
+    int numPieces = 1;
+    if (numRows < sizeType(numParts))
+    {
+        const int maxPieces = (length + BZ_MULTI_REDUCE_BLOCK - 1)
+            / BZ_MULTI_REDUCE_BLOCK;
+        numPieces = int((numParts + numRows - 1) / numRows);
+        if (numPieces > maxPieces)
+            numPieces = maxPieces;
+    }
+    const sizeType numUnits = numRows * numPieces;
+    if (sizeType(numParts) > numUnits)
+        numParts = int(numUnits);
+
+    // Part p takes a contiguous run of pieces into its own copy of the
+    // reductions
+    std::vector<T_list> parts(numParts, list);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) if (numParts > 1)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        T_expr partExpr(expr);
+        TinyVector<int,rank> index;
+        const sizeType u0 = numUnits * p / numParts,
+            u1 = numUnits * (p+1) / numParts;
+
+        parts[p].start(firstValue);
+        for (sizeType u=u0; u < u1; ++u)
+        {
+            const sizeType piece = u % numPieces;
+            _bz_multiReduceRowIndex(index, first, last, u / numPieces);
+            _bz_multiReduceRow(partExpr, parts[p], index,
+                int(length * piece / numPieces),
+                int(length * (piece+1) / numPieces));
+        }
+    }
+
+    for (int p=1; p < numParts; ++p)
+        parts[0].merge(parts[p]);
+    parts[0].store(first, int(count));
+    return count;
+}
+
+template<typename T_expr, typename T_list>
+void _bz_multiReducePartial(T_expr expr, const T_list& list)
+{
+    const int rank = T_expr::rank;
+    const int innerRank = rank - 1;
+
+    TinyVector<int,rank> first, last;
+    sizeType numRows = 1;
+    for (int i=0; i < rank; ++i)
+    {
+        first(i) = expr.lbound(i);
+        last(i) = expr.ubound(i) + 1;
+        if (i < innerRank)
+            numRows *= last(i) - first(i);
+    }
+
+    const int length = last(innerRank) - first(innerRank);
+
+    int numParts = 1;
+#ifdef _OPENMP
+    if (numRows * length >= BZ_MULTI_REDUCE_PARALLEL_THRESHOLD)
+        numParts = omp_get_max_threads();
+#endif
+    if (sizeType(numParts) > numRows)
+        numParts = int(numRows);
+
+    // Each destination element is written by one part
+    std::vector<T_list> parts(numParts, list);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) if (numParts > 1)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        T_expr partExpr(expr);
+        TinyVector<int,rank> index;
+        TinyVector<int,innerRank> destination;
+        const sizeType row0 = numRows * p / numParts,
+            row1 = numRows * (p+1) / numParts;
+
+        for (sizeType row=row0; row < row1; ++row)
+        {
+            _bz_multiReduceRowIndex(index, first, last, row);
+            for (int r=0; r < innerRank; ++r)
+                destination(r) = index(r);
+
+            if (length == 0)
+            {
+                parts[p].reset();
+                parts[p].store(destination, 0);
+                continue;
+            }
+
+            parts[p].start(partExpr(index));
+            _bz_multiReduceRow(partExpr, parts[p], index, 0, length);
+            parts[p].store(destination, length);
+        }
+    }
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_MULTIREDUCE_CC
@@ -0,0 +1,262 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/multireduce.h  Several reductions in one pass over an
+ *                            array expression
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_MULTIREDUCE_H
+#define BZ_ARRAY_MULTIREDUCE_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/multireduce.h> must be included via <blitz/array.h>
+#endif
+
+#include <vector>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// The expression is evaluated into blocks of this many elements, which
+// are then handed to each reduction in turn.
+#ifndef BZ_MULTI_REDUCE_BLOCK
+ #define BZ_MULTI_REDUCE_BLOCK 256
+#endif
+
+// Expressions with fewer elements than this are reduced by one thread.
+#ifndef BZ_MULTI_REDUCE_PARALLEL_THRESHOLD
+ #ifdef BZ_RUNTIME_TUNING
+  #define BZ_MULTI_REDUCE_PARALLEL_THRESHOLD \
+      (TuningParameters::instance().parallelThreshold())
+ #else
+  #define BZ_MULTI_REDUCE_PARALLEL_THRESHOLD 65536
+ #endif
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * multiReduce() applies up to four reductions to an expression while
+ * evaluating it once:
+ *
+ *   ReduceVariance<double> moments;
+ *   ReduceMinMax<double> range;
+ *   ReduceHistogram<double> hist(0., 1., 100);
+ *   multiReduce(A * B, moments, range, hist);
+ *   cout << moments.mean() << moments.variance() << range.result(0)
+ *        << hist.result(0) << hist.overflow();
+ *
+ * The reductions passed are overwritten with the reduced state, and the
+ * number of elements is returned for result(count).  The partial form
+ * reduces along the last rank, like sum(expr, j), into one array per
+ * reduction:
+ *
+ *   Array<double,2> M(nx,ny), V(nx,ny);
+ *   multiReduce(A(i,j,k), k, M, ReduceMean<double>(),
+ *       V, ReduceVariance<double>());
+ *
+ * The expression is evaluated a block of BZ_MULTI_REDUCE_BLOCK elements
+ * at a time, with the unit-stride fast reads where it can be, and each
+ * block is passed to every reduction.  With OpenMP, large expressions
+ * are split between threads, each with its own copy of the reductions;
+ * the copies are combined with their merge() member, in a fixed order.
+ *
+ * A reduction used here needs merge(), and either reset() or, if
+ * needInit is true, reset(firstValue).  The reductions which need the
+ * index (minIndex, maxIndex, first, last) cannot be used.  A faster
+ * update of a whole block may be given by overloading
+ *
+ *   template<typename T_numtype>
+ *   void _bz_reduceBlock(const MyReduction& r, const T_numtype* x,
+ *       int n, int position);
+ */
+
+// The end of a list of reductions
+struct _bz_ReduceNil {
+    void reset() const { }
+
+    template<typename T_numtype>
+    void start(const T_numtype&) const { }
+
+    template<typename T_numtype>
+    void addBlock(const T_numtype*, int, int) const { }
+
+    void merge(const _bz_ReduceNil&) const { }
+
+    template<typename T_index>
+    void store(const T_index&, int) const { }
+};
+
+// A reduction, where its result goes, and the rest of the list.  The
+// result is either a reduction of the same type, which is assigned the
+// whole state, or an array, whose element at the destination index is
+// assigned result(count).
+template<typename P_reduction, typename P_result, typename P_next>
+class _bz_ReduceList {
+public:
+    typedef P_reduction T_reduction;
+    typedef P_result T_result;
+    typedef P_next T_next;
+
+    _bz_ReduceList(const T_reduction& reduction, T_result* result,
+        const T_next& next)
+      : reduction_(reduction), result_(result), next_(next)
+    { }
+
+    // Prepares for an empty traversal
+    void reset() const;
+
+    // Prepares for a traversal whose first element is firstValue
+    template<typename T_numtype>
+    void start(const T_numtype& firstValue) const;
+
+    // Adds x[0], ..., x[n-1], which are at position, ..., position+n-1
+    // along the reduced rank
+    template<typename T_numtype>
+    void addBlock(const T_numtype* restrict x, int n, int position) const;
+
+    void merge(const _bz_ReduceList& x) const;
+
+    // Writes the results, for count elements, to their destinations
+    template<typename T_index>
+    void store(const T_index& index, int count) const;
+
+private:
+    T_reduction reduction_;
+    T_result* result_;
+    T_next next_;
+};
+
+template<typename T_expr, typename T_list>
+sizeType _bz_multiReduce(T_expr expr, const T_list& list);
+
+template<typename T_expr, typename T_list>
+void _bz_multiReducePartial(T_expr expr, const T_list& list);
+
+// Full reductions
+
+template<typename T_expr, typename R1>
+inline sizeType multiReduce(const ETBase<T_expr>& expr, R1& r1)
+{
+    typedef _bz_ReduceList<R1, R1, _bz_ReduceNil> T_list1;
+    return _bz_multiReduce(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &r1, _bz_ReduceNil()));
+}
+
+template<typename T_expr, typename R1, typename R2>
+inline sizeType multiReduce(const ETBase<T_expr>& expr, R1& r1, R2& r2)
+{
+    typedef _bz_ReduceList<R2, R2, _bz_ReduceNil> T_list2;
+    typedef _bz_ReduceList<R1, R1, T_list2> T_list1;
+    return _bz_multiReduce(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &r1, T_list2(r2, &r2, _bz_ReduceNil())));
+}
+
+template<typename T_expr, typename R1, typename R2, typename R3>
+inline sizeType multiReduce(const ETBase<T_expr>& expr, R1& r1, R2& r2,
+    R3& r3)
+{
+    typedef _bz_ReduceList<R3, R3, _bz_ReduceNil> T_list3;
+    typedef _bz_ReduceList<R2, R2, T_list3> T_list2;
+    typedef _bz_ReduceList<R1, R1, T_list2> T_list1;
+    return _bz_multiReduce(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &r1, T_list2(r2, &r2, T_list3(r3, &r3,
+        _bz_ReduceNil()))));
+}
+
+template<typename T_expr, typename R1, typename R2, typename R3,
+    typename R4>
+inline sizeType multiReduce(const ETBase<T_expr>& expr, R1& r1, R2& r2,
+    R3& r3, R4& r4)
+{
+    typedef _bz_ReduceList<R4, R4, _bz_ReduceNil> T_list4;
+    typedef _bz_ReduceList<R3, R3, T_list4> T_list3;
+    typedef _bz_ReduceList<R2, R2, T_list3> T_list2;
+    typedef _bz_ReduceList<R1, R1, T_list2> T_list1;
+    return _bz_multiReduce(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &r1, T_list2(r2, &r2, T_list3(r3, &r3,
+        T_list4(r4, &r4, _bz_ReduceNil())))));
+}
+
+// Partial reductions over the last rank.  A single one is written
+// sum(expr, k) etc.; starting at two keeps these apart from the full
+// reductions above.
+
+template<typename T_expr, int N_index, typename T1, typename R1,
+    typename T2, typename R2>
+inline void multiReduce(const ETBase<T_expr>& expr,
+    const IndexPlaceholder<N_index>&,
+    Array<T1,N_index>& result1, const R1& r1,
+    Array<T2,N_index>& result2, const R2& r2)
+{
+    typedef _bz_ReduceList<R2, Array<T2,N_index>, _bz_ReduceNil> T_list2;
+    typedef _bz_ReduceList<R1, Array<T1,N_index>, T_list2> T_list1;
+    _bz_multiReducePartial(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &result1, T_list2(r2, &result2, _bz_ReduceNil())));
+}
+
+template<typename T_expr, int N_index, typename T1, typename R1,
+    typename T2, typename R2, typename T3, typename R3>
+inline void multiReduce(const ETBase<T_expr>& expr,
+    const IndexPlaceholder<N_index>&,
+    Array<T1,N_index>& result1, const R1& r1,
+    Array<T2,N_index>& result2, const R2& r2,
+    Array<T3,N_index>& result3, const R3& r3)
+{
+    typedef _bz_ReduceList<R3, Array<T3,N_index>, _bz_ReduceNil> T_list3;
+    typedef _bz_ReduceList<R2, Array<T2,N_index>, T_list3> T_list2;
+    typedef _bz_ReduceList<R1, Array<T1,N_index>, T_list2> T_list1;
+    _bz_multiReducePartial(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &result1, T_list2(r2, &result2, T_list3(r3, &result3,
+        _bz_ReduceNil()))));
+}
+
+template<typename T_expr, int N_index, typename T1, typename R1,
+    typename T2, typename R2, typename T3, typename R3,
+    typename T4, typename R4>
+inline void multiReduce(const ETBase<T_expr>& expr,
+    const IndexPlaceholder<N_index>&,
+    Array<T1,N_index>& result1, const R1& r1,
+    Array<T2,N_index>& result2, const R2& r2,
+    Array<T3,N_index>& result3, const R3& r3,
+    Array<T4,N_index>& result4, const R4& r4)
+{
+    typedef _bz_ReduceList<R4, Array<T4,N_index>, _bz_ReduceNil> T_list4;
+    typedef _bz_ReduceList<R3, Array<T3,N_index>, T_list4> T_list3;
+    typedef _bz_ReduceList<R2, Array<T2,N_index>, T_list3> T_list2;
+    typedef _bz_ReduceList<R1, Array<T1,N_index>, T_list2> T_list1;
+    _bz_multiReducePartial(asExpr<T_expr>::getExpr(expr.unwrap()),
+        T_list1(r1, &result1, T_list2(r2, &result2, T_list3(r3, &result3,
+        T_list4(r4, &result4, _bz_ReduceNil())))));
+}
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/multireduce.cc>
+
+#endif // BZ_ARRAY_MULTIREDUCE_H
@@ -55,8 +55,9 @@ template<typename P_numtype, int N_rank> template<typename T_expr>
 inline Array<P_numtype,N_rank>&
 Array<P_numtype,N_rank>::operator=(const ETBase<T_expr>& expr)
 {
-    evaluate(expr.unwrap(), 
-        _bz_update<T_numtype, _bz_typename T_expr::T_numtype>());
+    evaluate(_bz_typename asExpr<T_expr>::T_expr(expr.unwrap()), 
+        _bz_update<T_numtype, 
+        _bz_typename asExpr<T_expr>::T_expr::T_numtype>());
     return *this;
 }
 
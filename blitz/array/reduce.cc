@@ -150,5 +150,92 @@ _bz_reduceWithIndexVectorTraversal(T_expr expr, T_reduction reduction)
     return _bz_reduceWithIndexTraversalGeneric<TinyVector<int,T_expr::rank> >(expr,reduction);
 }
 
+// Complete reductions with an accumulation policy.  Unit-stride rows
+// are cut into blocks of BZ_REDUCE_PAIRWISE_BLOCK elements, and each
+// block is spread over BZ_REDUCE_LANES independent accumulators, whose
+// updates the compiler can do in one vector instruction.  Other rows,
+// and expressions with index placeholders, are taken one element at a
+// time.
+
+template<typename T_expr, typename T_reduction>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceAccumulated(T_expr expr, T_reduction reduction)
+{
+    typedef _bz_typename T_reduction::T_acc T_acc;
+    typedef _bz_typename T_reduction::T_lanes T_lanes;
+
+    const int rank = T_expr::rank;
+    const int innerRank = rank - 1;
+
+    TinyVector<int,T_expr::rank> index, first, last;
+    unsigned long count = 1;
+    for (int i=0; i < rank; ++i)
+    {
+        first(i) = expr.lbound(i);
+        last(i) = expr.ubound(i) + 1;
+        index(i) = first(i);
+        count *= last(i) - first(i);
+    }
+
+    reduction.reset();
+    if (count == 0)
+        return reduction.result(0);
+
+    const int length = last(innerRank) - first(innerRank);
+    // Not a constant, so that the compiler vectorizes the loop over the
+    // lanes rather than unrolling it
+    const int numLanes = (length < BZ_REDUCE_LANES) ? length : BZ_REDUCE_LANES;
+    T_lanes lanes;
+
+    while (true)
+    {
+#ifdef BZ_USE_FAST_READ_ARRAY_EXPR
+        bool unitStride = false;
+        if (T_expr::numIndexPlaceholders == 0)
+        {
+            expr.moveTo(index);
+            unitStride = expr.isUnitStride(innerRank);
+        }
+
+        if (unitStride)
+        {
+            for (int j0=0; j0 < length; j0 += BZ_REDUCE_PAIRWISE_BLOCK)
+            {
+                const int j1 = (length - j0 > BZ_REDUCE_PAIRWISE_BLOCK)
+                    ? j0 + BZ_REDUCE_PAIRWISE_BLOCK : length;
+
+                lanes.reset();
+                int j = j0;
+                for (; j + numLanes <= j1; j += numLanes)
+                    for (int k=0; k < numLanes; ++k)
+                        lanes.add(k, T_acc(expr.fastRead(j + k)));
+                for (; j < j1; ++j)
+                    lanes.add(0, T_acc(expr.fastRead(j)));
+                reduction.addLanes(lanes);
+            }
+        }
+        else
+#endif
+        {
+            for (index(innerRank)=first(innerRank);
+                index(innerRank) < last(innerRank); ++index(innerRank))
+                reduction(expr(index));
+            index(innerRank) = first(innerRank);
+        }
+
+        // Next row
+        int r = innerRank - 1;
+        while ((r >= 0) && (++index(r) >= last(r)))
+        {
+            index(r) = first(r);
+            --r;
+        }
+        if (r < 0)
+            break;
+    }
+
+    return reduction.result(count);
+}
+
 BZ_NAMESPACE_END
 
@@ -90,10 +90,11 @@ public:
         rank = T_expr::rank - 1;
 
     _bz_ArrayExprReduce(const _bz_ArrayExprReduce& reduce)
-        : reduce_(reduce.reduce_), iter_(reduce.iter_), ordering_(reduce.ordering_) { }
+        : reduce_(reduce.reduce_), iter_(reduce.iter_), ordering_(reduce.ordering_),
+          index_(reduce.index_), loopRank_(reduce.loopRank_) { }
 
     _bz_ArrayExprReduce(T_expr expr)
-        : iter_(expr)
+        : iter_(expr), index_(0), loopRank_(N_index)
     { computeOrdering(); }
 
 #if 0
@@ -122,52 +123,51 @@ public:
         _bz_meta_vecAssign<N_index, 0>::assign(index, destIndex, 
             _bz_update<int,int>());
 
-        int lbound = iter_.lbound(N_index);
-        int ubound = iter_.ubound(N_index);
-
-        BZPRECHECK((lbound != tiny(int())) && (ubound != huge(int())),
-           "Array reduction performed over rank " << N_index
-           << " is unbounded." << endl 
-           << "There must be an array object in the expression being reduced"
-           << endl << "which provides a bound in rank " << N_index << ".");
-
-        // If we are doing minIndex/maxIndex, initialize with lower bound
-
-        _bz_ReduceReset<T_reduction::needIndex,T_reduction::needInit> reset;
-        reset(reduce_,lbound,iter_);
-
-        for (index[N_index]=lbound; index[N_index]<=ubound; ++index[N_index]) {
-            if (!reduce_(iter_(index), index[N_index]))
-                break;
-        }
-
-        return reduce_.result(ubound-lbound+1);
+        return reduceAt(index);
     }
 
-    // If you have a precondition failure on these routines, it means
-    // you are trying to use stack iteration mode on an expression
-    // which contains an index placeholder.  You must use index
-    // iteration mode instead.
+    /*
+     * In a stack traversal the reduction keeps the index of the element
+     * it is at, and advances it with the loops like an IndexPlaceholder.
+     * Each element is still reduced by index.
+     */
 
-    int operator*()        const { BZPRECONDITION(0); return 0; }
-    int suggestStride(int) const { BZPRECONDITION(0); return 0; }
+    T_numtype operator*() const { return reduceAt(index_); }
+    int suggestStride(int) const { return 1; }
 
-    void push(int)           const { BZPRECONDITION(0); }
-    void pop(int)            const { BZPRECONDITION(0); }
-    void advance()           const { BZPRECONDITION(0); }
-    void advance(int)        const { BZPRECONDITION(0); }
-    void loadStride(int)     const { BZPRECONDITION(0); }
-    void advanceUnitStride() const { BZPRECONDITION(0); }
+    void push(int position) { stack_[position] = index_; }
+    void pop(int position)  { index_ = stack_[position]; }
+    void advance()          { ++index_[loopRank_]; }
+    void advance(int n)     { index_[loopRank_] += n; }
+    void advanceUnitStride() { ++index_[loopRank_]; }
+
+    // Loops over ranks beyond the result advance the unused last
+    // element of index_, which reduceAt() overwrites
+    void loadStride(int r)  { loopRank_ = (r < N_index) ? r : N_index; }
 
     template<int N_rank>
-    void moveTo(const TinyVector<int,N_rank>&) const { BZPRECONDITION(0); }
+    void moveTo(const TinyVector<int,N_rank>& i)
+    {
+        BZPRECHECK(N_rank == N_index,
+            "Array reduction performed over rank " << N_index
+            << " to produce a rank " << N_rank << " expression.");
+        for (int r=0; r < N_index; ++r)
+            index_[r] = i[r];
+    }
 
-    bool isUnitStride(int)    const { BZPRECONDITION(0); return false; }
-    bool canCollapse(int,int) const { BZPRECONDITION(0); return false; }
-    bool isStride(int,int)    const { BZPRECONDITION(0); return true;  }
+    bool isUnitStride(int r) const
+    { return loopRank_ == ((r < N_index) ? r : N_index); }
+    bool canCollapse(int outerLoopRank, int innerLoopRank) const
+    { return (outerLoopRank >= N_index) && (innerLoopRank >= N_index); }
+    bool isStride(int, diffType stride) const { return stride == 1; }
 
-    T_numtype operator[](int) const { BZPRECONDITION(0); return T_numtype(); }
-    T_numtype fastRead(int)   const { BZPRECONDITION(0); return T_numtype(); }
+    T_numtype operator[](int i) const { return fastRead(i); }
+    T_numtype fastRead(int i) const
+    {
+        TinyVector<int, N_index + 1> index(index_);
+        index[loopRank_] += i;
+        return reduceAt(index);
+    }
 
     // don't know how to define these, so stencil expressions won't work
     T_numtype shift(int offset, int dim) const
@@ -220,7 +220,7 @@ public:
     }
 
 private: 
-    _bz_ArrayExprReduce() { }
+    _bz_ArrayExprReduce() : index_(0), loopRank_(N_index) { }
 // method for properly initializing the ordering values
     void computeOrdering()
     {
@@ -246,9 +246,39 @@ private:
         }
     }
 
+    // Reduces the expression over rank N_index at index
+    template<int N>
+    T_numtype reduceAt(TinyVector<int, N> index) const
+    {
+        int lbound = iter_.lbound(N_index);
+        int ubound = iter_.ubound(N_index);
+
+        BZPRECHECK((lbound != tiny(int())) && (ubound != huge(int())),
+           "Array reduction performed over rank " << N_index
+           << " is unbounded." << endl 
+           << "There must be an array object in the expression being reduced"
+           << endl << "which provides a bound in rank " << N_index << ".");
+
+        // If we are doing minIndex/maxIndex, initialize with lower bound
+
+        _bz_ReduceReset<T_reduction::needIndex,T_reduction::needInit> reset;
+        reset(reduce_,lbound,iter_);
+
+        for (index[N_index]=lbound; index[N_index]<=ubound; ++index[N_index]) {
+            if (!reduce_(iter_(index), index[N_index]))
+                break;
+        }
+
+        return reduce_.result(ubound-lbound+1);
+    }
+
     T_reduction reduce_;
     T_expr iter_;
     TinyVector<int,rank> ordering_;
+    TinyVector<int,N_index+1> index_;
+    int loopRank_;
+    // Blitz++ arrays have at most 11 ranks, and so at most 11 loops
+    TinyVector<int,N_index+1> stack_[11];
 };
 
 #define BZ_DECL_ARRAY_PARTIAL_REDUCE(fn,reduction)                      \
@@ -285,6 +315,38 @@ BZ_DECL_ARRAY_PARTIAL_REDUCE(any,      ReduceAny)
 BZ_DECL_ARRAY_PARTIAL_REDUCE(all,      ReduceAll)
 BZ_DECL_ARRAY_PARTIAL_REDUCE(first,    ReduceFirst)
 BZ_DECL_ARRAY_PARTIAL_REDUCE(last,     ReduceLast)
+BZ_DECL_ARRAY_PARTIAL_REDUCE(variance, ReduceVariance)
+
+// Partial reductions with an accumulation policy (see <blitz/reduce.h>)
+
+#define BZ_DECL_ARRAY_PARTIAL_REDUCE_ACCUMULATED(fn,reduction)          \
+template<typename T_expr, int N_index, typename T_accumulation>         \
+inline                                                                  \
+_bz_ArrayExpr<_bz_ArrayExprReduce<_bz_ArrayExpr<T_expr>, N_index,       \
+    reduction<_bz_typename T_expr::T_numtype, T_accumulation> > >       \
+fn(_bz_ArrayExpr<T_expr> expr, const IndexPlaceholder<N_index>&,       \
+    _bz_accumulationTag<T_accumulation>)                                \
+{                                                                       \
+    return _bz_ArrayExprReduce<_bz_ArrayExpr<T_expr>, N_index,          \
+        reduction<_bz_typename T_expr::T_numtype, T_accumulation> >(expr); \
+}                                                                       \
+                                                                        \
+template<typename T_numtype, int N_rank, int N_index,                   \
+    typename T_accumulation>                                            \
+inline                                                                  \
+_bz_ArrayExpr<_bz_ArrayExprReduce<FastArrayIterator<T_numtype,N_rank>,  \
+    N_index, reduction<T_numtype, T_accumulation> > >                   \
+fn(const Array<T_numtype, N_rank>& array,                               \
+    const IndexPlaceholder<N_index>&, _bz_accumulationTag<T_accumulation>) \
+{                                                                       \
+    return _bz_ArrayExprReduce<FastArrayIterator<T_numtype,N_rank>,     \
+        N_index, reduction<T_numtype, T_accumulation> >                 \
+        (array.beginFast());                                            \
+}
+
+BZ_DECL_ARRAY_PARTIAL_REDUCE_ACCUMULATED(sum,     ReduceSumAccumulated)
+BZ_DECL_ARRAY_PARTIAL_REDUCE_ACCUMULATED(mean,    ReduceMeanAccumulated)
+BZ_DECL_ARRAY_PARTIAL_REDUCE_ACCUMULATED(product, ReduceProductAccumulated)
 
 /*
  * Complete reductions
@@ -303,6 +365,10 @@ template<typename T_expr, typename T_reduction>
 _bz_typename T_reduction::T_resulttype
 _bz_reduceWithIndexVectorTraversal(T_expr expr, T_reduction reduction);
 
+template<typename T_expr, typename T_reduction>
+_bz_typename T_reduction::T_resulttype
+_bz_reduceAccumulated(T_expr expr, T_reduction reduction);
+
 #define BZ_DECL_ARRAY_FULL_REDUCE(fn,reduction)                         \
 template<typename T_expr>                                               \
 inline                                                                  \
@@ -333,6 +399,34 @@ BZ_DECL_ARRAY_FULL_REDUCE(any,      ReduceAny)
 BZ_DECL_ARRAY_FULL_REDUCE(all,      ReduceAll)
 BZ_DECL_ARRAY_FULL_REDUCE(first,    ReduceFirst)
 BZ_DECL_ARRAY_FULL_REDUCE(last,     ReduceLast)
+BZ_DECL_ARRAY_FULL_REDUCE(variance, ReduceVariance)
+
+// Complete reductions with an accumulation policy
+
+#define BZ_DECL_ARRAY_FULL_REDUCE_ACCUMULATED(fn,reduction)             \
+template<typename T_expr, typename T_accumulation>                      \
+inline                                                                  \
+_bz_typename reduction<_bz_typename T_expr::T_numtype,                  \
+    T_accumulation>::T_resulttype                                       \
+fn(_bz_ArrayExpr<T_expr> expr, _bz_accumulationTag<T_accumulation>)     \
+{                                                                       \
+    return _bz_reduceAccumulated(expr,                                  \
+        reduction<_bz_typename T_expr::T_numtype, T_accumulation>());   \
+}                                                                       \
+                                                                        \
+template<typename T_numtype, int N_rank, typename T_accumulation>       \
+inline                                                                  \
+_bz_typename reduction<T_numtype, T_accumulation>::T_resulttype         \
+fn(const Array<T_numtype, N_rank>& array,                               \
+    _bz_accumulationTag<T_accumulation>)                                \
+{                                                                       \
+    return _bz_reduceAccumulated(array.beginFast(),                     \
+        reduction<T_numtype, T_accumulation>());                        \
+}
+
+BZ_DECL_ARRAY_FULL_REDUCE_ACCUMULATED(sum,     ReduceSumAccumulated)
+BZ_DECL_ARRAY_FULL_REDUCE_ACCUMULATED(mean,    ReduceMeanAccumulated)
+BZ_DECL_ARRAY_FULL_REDUCE_ACCUMULATED(product, ReduceProductAccumulated)
 
 // Special versions of complete reductions: minIndex and
 // maxIndex
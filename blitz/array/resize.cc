@@ -35,6 +35,13 @@
 #endif
 
 #include <blitz/minmax.h>
+#include <climits>
+
+// Growing an array beyond its capacity along the slowest-varying rank
+// multiplies the capacity by at least this.
+#ifndef BZ_ARRAY_GROWTH_FACTOR
+ #define BZ_ARRAY_GROWTH_FACTOR 1.5
+#endif
 
 BZ_NAMESPACE(blitz)
 
@@ -572,35 +579,7 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0)
     BZPRECONDITION(length0 > 0);
     BZPRECONDITION(N_rank == 1);
 
-    if (length0 != length_[firstRank])
-    {
-#if defined(__KCC) || defined(__DECCXX)
-        // NEEDS_WORK: have to discard the base() parameter for EDG,
-        // because it gives the following bizarre error:
-
-/*
- * "blitz/tinyvec.h", line 421: error: the size of an array must be greater
- *         than zero
- *     T_numtype data_[N_length];
- *                     ^
- *         detected during:
- *           instantiation of class "blitz::TinyVector<int, 0>" at line 273 of
- *                     "./../blitz/array/resize.cc"
- *           instantiation of
- *                     "void blitz::Array<int, 1>::resizeAndPreserve(int)" 
- */
-        T_array B(length0, storage_);
-#else
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0), storage_);  // line 273
-#endif
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-              ubound(0)));
-            B(overlap0) = (*this)(overlap0);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0));
 }
 
 template<typename T_numtype, int N_rank>
@@ -609,20 +588,7 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1)
     BZPRECONDITION((length0 > 0) && (length1 > 0));
     BZPRECONDITION(N_rank == 2);
 
-    if ((length0 != length_[0]) || (length1 != length_[1]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-                ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-                ubound(1)));
-            B(overlap0, overlap1) = (*this)(overlap0, overlap1);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1));
 }
 
 template<typename T_numtype, int N_rank>
@@ -632,24 +598,7 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     BZPRECONDITION((length0 > 0) && (length1 > 0) && (length2 > 0));
     BZPRECONDITION(N_rank == 3);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2), 
-            storage_);
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-                ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-                ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-                ubound(2)));
-            B(overlap0, overlap1, overlap2) = (*this)(overlap0, overlap1, 
-                overlap2);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2));
 }
 
 template<typename T_numtype, int N_rank>
@@ -660,23 +609,8 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length3 > 0));
     BZPRECONDITION(N_rank == 4);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1,
-            length2, length3), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), ubound(3)));
-            B(overlap0, overlap1, overlap2, overlap3) = (*this)(overlap0,
-                overlap1, overlap2, overlap3);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3));
 }
 
 template<typename T_numtype, int N_rank>
@@ -687,25 +621,8 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length3 > 0) && (length4 > 0));
     BZPRECONDITION(N_rank == 5);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, 
-            length2, length3, length4), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), ubound(4)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4) = (*this)
-                (overlap0, overlap1, overlap2, overlap3, overlap4);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4));
 }
 
 template<typename T_numtype, int N_rank>
@@ -716,30 +633,10 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length3 > 0) && (length4 > 0) && (length5 > 0));
     BZPRECONDITION(N_rank == 6);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2, 
-            length3, length4, length5), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), ubound(5)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4, overlap5)
-                = (*this)(overlap0, overlap1, overlap2, overlap3, overlap4,
-                overlap5);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5));
 }
 
-/* Added by Julian Cummings */
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     int length2, int length3, int length4, int length5, int length6)
@@ -748,40 +645,10 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length3 > 0) && (length4 > 0) && (length5 > 0) && (length6 > 0));
     BZPRECONDITION(N_rank == 7);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5])
-        || (length6 != length_[6]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
-            length3, length4, length5, length6), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-               ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-               ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-               ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), 
-               ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), 
-               ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), 
-               ubound(5)));
-            Range overlap6 = Range(fromStart, (extrema::min)(B.ubound(6), 
-               ubound(6)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4, overlap5,
-              overlap6)
-                = (*this)(overlap0, overlap1, overlap2, overlap3, overlap4,
-                overlap5, overlap6);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5, length6));
 }
 
-/* Added by Julian Cummings */
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     int length2, int length3, int length4, int length5, int length6,
@@ -792,42 +659,10 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length7 > 0));
     BZPRECONDITION(N_rank == 8);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5])
-        || (length6 != length_[6]) || (length7 != length_[7]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
-            length3, length4, length5, length6, length7), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-               ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-               ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-               ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), 
-               ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), 
-               ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), 
-               ubound(5)));
-            Range overlap6 = Range(fromStart, (extrema::min)(B.ubound(6), 
-               ubound(6)));
-            Range overlap7 = Range(fromStart, (extrema::min)(B.ubound(7), 
-               ubound(7)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4, overlap5,
-              overlap6, overlap7)
-                = (*this)(overlap0, overlap1, overlap2, overlap3, overlap4,
-                overlap5, overlap6, overlap7);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5, length6, length7));
 }
 
-/* Added by Julian Cummings */
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     int length2, int length3, int length4, int length5, int length6,
@@ -838,45 +673,10 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length7 > 0) && (length8 > 0));
     BZPRECONDITION(N_rank == 9);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5])
-        || (length6 != length_[6]) || (length7 != length_[7])
-        || (length8 != length_[8]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
-            length3, length4, length5, length6, length7, length8), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-               ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-               ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-               ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), 
-               ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), 
-               ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), 
-               ubound(5)));
-            Range overlap6 = Range(fromStart, (extrema::min)(B.ubound(6), 
-               ubound(6)));
-            Range overlap7 = Range(fromStart, (extrema::min)(B.ubound(7), 
-               ubound(7)));
-            Range overlap8 = Range(fromStart, (extrema::min)(B.ubound(8), 
-               ubound(8)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4, overlap5,
-              overlap6, overlap7, overlap8)
-                = (*this)(overlap0, overlap1, overlap2, overlap3, overlap4,
-                overlap5, overlap6, overlap7, overlap8);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5, length6, length7, length8));
 }
 
-/* Added by Julian Cummings */
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     int length2, int length3, int length4, int length5, int length6,
@@ -887,48 +687,10 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length7 > 0) && (length8 > 0) && (length9 > 0));
     BZPRECONDITION(N_rank == 10);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5])
-        || (length6 != length_[6]) || (length7 != length_[7])
-        || (length8 != length_[8]) || (length9 != length_[9]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
-            length3, length4, length5, length6, length7, length8, length9),
-            storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-               ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-               ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-               ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), 
-               ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), 
-               ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), 
-               ubound(5)));
-            Range overlap6 = Range(fromStart, (extrema::min)(B.ubound(6), 
-               ubound(6)));
-            Range overlap7 = Range(fromStart, (extrema::min)(B.ubound(7), 
-               ubound(7)));
-            Range overlap8 = Range(fromStart, (extrema::min)(B.ubound(8), 
-               ubound(8)));
-            Range overlap9 = Range(fromStart, (extrema::min)(B.ubound(9), 
-               ubound(9)));
-            B(overlap0, overlap1, overlap2, overlap3, overlap4, overlap5,
-              overlap6, overlap7, overlap8, overlap9)
-                = (*this)(overlap0, overlap1, overlap2, overlap3, overlap4,
-                overlap5, overlap6, overlap7, overlap8, overlap9);
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5, length6, length7, length8, length9));
 }
 
-/* Added by Julian Cummings */
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
     int length2, int length3, int length4, int length5, int length6,
@@ -939,44 +701,9 @@ void Array<T_numtype, N_rank>::resizeAndPreserve(int length0, int length1,
         && (length7 > 0) && (length8 > 0) && (length9 > 0) && (length10 > 0));
     BZPRECONDITION(N_rank == 11);
 
-    if ((length0 != length_[0]) || (length1 != length_[1])
-        || (length2 != length_[2]) || (length3 != length_[3])
-        || (length4 != length_[4]) || (length5 != length_[5])
-        || (length6 != length_[6]) || (length7 != length_[7])
-        || (length8 != length_[8]) || (length9 != length_[9])
-        || (length10 != length_[10]))
-    {
-        T_array B(base(), BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
-            length3, length4, length5, length6, length7, length8, length9,
-            length10), storage_);
-
-        if (numElements())
-        {
-            Range overlap0 = Range(fromStart, (extrema::min)(B.ubound(0), 
-               ubound(0)));
-            Range overlap1 = Range(fromStart, (extrema::min)(B.ubound(1), 
-               ubound(1)));
-            Range overlap2 = Range(fromStart, (extrema::min)(B.ubound(2), 
-               ubound(2)));
-            Range overlap3 = Range(fromStart, (extrema::min)(B.ubound(3), 
-               ubound(3)));
-            Range overlap4 = Range(fromStart, (extrema::min)(B.ubound(4), 
-               ubound(4)));
-            Range overlap5 = Range(fromStart, (extrema::min)(B.ubound(5), 
-               ubound(5)));
-            Range overlap6 = Range(fromStart, (extrema::min)(B.ubound(6), 
-               ubound(6)));
-            Range overlap7 = Range(fromStart, (extrema::min)(B.ubound(7), 
-               ubound(7)));
-            Range overlap8 = Range(fromStart, (extrema::min)(B.ubound(8), 
-               ubound(8)));
-            Range overlap9 = Range(fromStart, (extrema::min)(B.ubound(9), 
-               ubound(9)));
-            Range overlap10 = Range(fromStart, (extrema::min)(B.ubound(10), 
-               ubound(10)));
-        }
-        reference(B);
-    }
+    resizeAndPreserve(BZ_BLITZ_SCOPE(shape)(length0, length1, length2,
+        length3, length4, length5, length6, length7, length8, length9,
+        length10));
 }
 
 template<typename T_numtype, int N_rank>
@@ -991,27 +718,182 @@ void Array<T_numtype, N_rank>::resize(const TinyVector<int,N_rank>& extent)
 //    }
 }
 
-/* Added by Julian Cummings */
+/*
+ * resizeAndPreserve() along the slowest-varying rank alone reuses the
+ * block when it can.  An array laid out as setupStorage() lays it out,
+ * with that rank stored ascending, only needs more room at the end of its
+ * block to grow along that rank; nothing else moves.  Shrinking never
+ * reallocates, and growth within the capacity doesn't either.  Beyond the
+ * capacity a large block is remapped where the system allows it (see
+ * <blitz/memblock.h>), and otherwise the array is copied into a block
+ * with BZ_ARRAY_GROWTH_FACTOR times the capacity, so that appending a
+ * little at a time copies each element a bounded number of times.
+ */
+
+template<typename T_numtype, int N_rank>
+int Array<T_numtype, N_rank>::capacity() const
+{
+    const int outer = ordering(N_rank - 1);
+    if (!isLaidOutForGrowth() || (stride_[outer] == 0))
+        return length_[outer];
+
+    const sizeType room = T_base::blockCapacity(firstInMemory());
+    const sizeType extent = room / stride_[outer];
+    return (extent > sizeType(length_[outer])) ? int(extent)
+        : length_[outer];
+}
+
+template<typename T_numtype, int N_rank>
+void Array<T_numtype, N_rank>::reserve(int extent)
+{
+    const int outer = ordering(N_rank - 1);
+    if (extent <= capacity())
+        return;
+
+    if (isLaidOutForGrowth() && (stride_[outer] > 0)
+        && T_base::reserveBlock(firstInMemory(),
+            sizeType(extent) * stride_[outer]))
+        return;
+
+    T_array B(storage_);
+    B.length_ = length_;
+    B.setupStorageWithCapacity(extent);
+    if (numElements())
+        B = *this;
+    reference(B);
+}
+
 template<typename T_numtype, int N_rank>
 void Array<T_numtype, N_rank>::resizeAndPreserve(
     const TinyVector<int,N_rank>& extent)
 {
-// NEEDS_WORK -- don't resize if unnecessary
-//    BZPRECONDITION(all(extent > 0));
-//    if (any(extent != length_))
-//    {
-        T_array B(base(), extent, storage_);
+    const int outer = ordering(N_rank - 1);
+    bool outerOnly = true, unchanged = true;
+    for (int d=0; d < N_rank; ++d)
+    {
+        if (extent(d) != length_[d])
+        {
+            unchanged = false;
+            if (d != outer)
+                outerOnly = false;
+        }
+    }
 
-        if (numElements())
+    if (unchanged)
+        return;
+
+    int capacity = extent(outer);
+    if (outerOnly)
+    {
+        if (resizeInPlace(extent(outer)))
+            return;
+
+        if ((extent(outer) > length_[outer]) && isRankStoredAscending(outer))
         {
-          TinyVector<int,N_rank> ub;
-          for (int d=0; d < N_rank; ++d)
-            ub(d) = (extrema::min)(B.ubound(d),ubound(d));
-          RectDomain<N_rank> overlap(lbound(),ub);
-          B(overlap) = (*this)(overlap);
+            const double grown = BZ_ARRAY_GROWTH_FACTOR * this->capacity();
+            if (grown > capacity)
+                capacity = (grown < double(INT_MAX)) ? int(grown) : INT_MAX;
         }
-        reference(B);
-//    }
+    }
+
+    T_array B(storage_);
+    B.length_ = extent;
+    B.setupStorageWithCapacity(capacity);
+
+    if (numElements() && B.numElements())
+    {
+        TinyVector<int,N_rank> ub;
+        for (int d=0; d < N_rank; ++d)
+            ub(d) = (extrema::min)(B.ubound(d),ubound(d));
+        RectDomain<N_rank> overlap(lbound(),ub);
+        B(overlap) = (*this)(overlap);
+    }
+    reference(B);
+}
+
+// As setupStorage(), for an array that is growing: if the slowest-varying
+// rank is stored ascending, the block has room for it to grow to capacity,
+// and may be mapped so as to grow further without copying
+template<typename T_numtype, int N_rank>
+void Array<T_numtype, N_rank>::setupStorageWithCapacity(int capacity)
+{
+    computeStrides();
+
+    const int outer = ordering(N_rank - 1);
+    const sizeType numElem = numElements();
+    if ((capacity >= length_[outer]) && isRankStoredAscending(outer))
+    {
+        const sizeType room = sizeType(capacity) * stride_[outer];
+        if (room == 0)
+            T_base::changeToNullBlock();
+        else
+            T_base::newBlock(numElem, room);
+    }
+    else if (numElem == 0)
+        T_base::changeToNullBlock();
+    else
+        T_base::newBlock(numElem);
+
+    data_ += zeroOffset_;
+}
+
+// True if the strides are those computeStrides() gives, with the
+// slowest-varying rank stored ascending
+template<typename T_numtype, int N_rank>
+bool Array<T_numtype, N_rank>::isLaidOutForGrowth() const
+{
+    if (!isRankStoredAscending(ordering(N_rank - 1)))
+        return false;
+
+    diffType stride = 1;
+    for (int n=0; n < N_rank; ++n)
+    {
+        const int r = ordering(n);
+        if (stride_[r] != (isRankStoredAscending(r) ? stride : -stride))
+            return false;
+        stride *= length_[r];
+    }
+    return true;
+}
+
+// The element at the lowest address
+template<typename T_numtype, int N_rank>
+const T_numtype* Array<T_numtype, N_rank>::firstInMemory() const
+{
+    const T_numtype* p = data_;
+    for (int r=0; r < N_rank; ++r)
+        p += ((stride_[r] > 0) ? base(r) : base(r) + length_[r] - 1)
+            * stride_[r];
+    return p;
+}
+
+// Gives the slowest-varying rank the given extent without copying the
+// elements, if the array is laid out for it and its block is not shared.
+// The strides and zero offset stay the same.
+template<typename T_numtype, int N_rank>
+bool Array<T_numtype, N_rank>::resizeInPlace(int extent)
+{
+    const int outer = ordering(N_rank - 1);
+    if (!isLaidOutForGrowth() || (stride_[outer] == 0))
+        return false;
+
+    const T_numtype* first = firstInMemory();
+    const sizeType slice = stride_[outer], room = T_base::blockCapacity(first);
+    if (room == 0)
+        return false;
+
+    if (room < sizeType(extent) * slice)
+    {
+        const double grown = BZ_ARRAY_GROWTH_FACTOR * (room / slice);
+        const sizeType want = (grown > extent) ? sizeType(grown) : extent;
+        if (!T_base::reserveBlock(first, want * slice))
+            return false;
+        first = firstInMemory();
+    }
+
+    T_base::setBlockLength(first, sizeType(extent) * slice);
+    length_[outer] = extent;
+    return true;
 }
 
 BZ_NAMESPACE_END
@@ -0,0 +1,269 @@
+/***************************************************************************
+ * blitz/array/scan.cc  Cumulative sums and other scans along a rank
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_SCAN_CC
+#define BZ_ARRAY_SCAN_CC
+
+#ifndef BZ_ARRAY_SCAN_H
+ #error <blitz/array/scan.cc> must be included via <blitz/array/scan.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+// Scans one line of length elements, continuing from state, which holds
+// the reduction of the count elements before it.  An element is read
+// before its result is written, so out may be in.
+template<typename T_reduction, typename T_result, typename T_source>
+void _bz_scanLine(const T_reduction& state, int count,
+    T_result* out, diffType outStride,
+    const T_source* in, diffType inStride, int length, ScanKind kind)
+{
+    if (kind == inclusiveScan)
+    {
+        for (int k=0; k < length; ++k)
+        {
+            state(in[k * inStride]);
+            out[k * outStride] = state.result(count + k + 1);
+        }
+    }
+    else
+    {
+        for (int k=0; k < length; ++k)
+        {
+            const T_source x = in[k * inStride];
+            out[k * outStride] = state.result(count + k);
+            state(x);
+        }
+    }
+}
+
+// Scans one line using numParts threads: reduce the parts, scan their
+// totals, then scan the parts from those
+template<typename T_reduction, typename T_result, typename T_source>
+void _bz_scanLineParallel(const T_reduction& empty,
+    T_result* out, diffType outStride,
+    const T_source* in, diffType inStride, int length, ScanKind kind,
+    int numParts)
+{
+    std::vector<T_reduction> totals(numParts, empty);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        const int k0 = int(diffType(length) * p / numParts),
+            k1 = int(diffType(length) * (p+1) / numParts);
+        for (int k=k0; k < k1; ++k)
+            totals[p](in[k * inStride]);
+    }
+
+    std::vector<T_reduction> starts(numParts, empty);
+    for (int p=1; p < numParts; ++p)
+    {
+        starts[p] = starts[p-1];
+        starts[p].merge(totals[p-1]);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        const int k0 = int(diffType(length) * p / numParts),
+            k1 = int(diffType(length) * (p+1) / numParts);
+        _bz_scanLine(starts[p], k0, out + k0 * outStride, outStride,
+            in + k0 * inStride, inStride, k1 - k0, kind);
+    }
+}
+
+// Scans width neighbouring lines, lineStride apart, together
+template<typename T_reduction, typename T_result, typename T_source>
+void _bz_scanPanel(const T_reduction& empty,
+    T_result* out, diffType outStride, diffType outLineStride,
+    const T_source* in, diffType inStride, diffType inLineStride,
+    int length, int width, ScanKind kind)
+{
+    T_reduction state[BZ_SCAN_PANEL];
+    for (int l=0; l < width; ++l)
+        state[l] = empty;
+
+    const bool unitStride = (outLineStride == 1) && (inLineStride == 1);
+
+    for (int k=0; k < length; ++k)
+    {
+        T_result* y = out + k * outStride;
+        const T_source* x = in + k * inStride;
+        const int count = (kind == inclusiveScan) ? k + 1 : k;
+
+        if (kind == inclusiveScan)
+        {
+            if (unitStride)
+            {
+                for (int l=0; l < width; ++l)
+                {
+                    state[l](x[l]);
+                    y[l] = state[l].result(count);
+                }
+            }
+            else
+            {
+                for (int l=0; l < width; ++l)
+                {
+                    state[l](x[l * inLineStride]);
+                    y[l * outLineStride] = state[l].result(count);
+                }
+            }
+        }
+        else
+        {
+            for (int l=0; l < width; ++l)
+            {
+                const T_source v = x[l * inLineStride];
+                y[l * outLineStride] = state[l].result(count);
+                state[l](v);
+            }
+        }
+    }
+}
+
+// The offsets of the first element of line number line, where the
+// lines are numbered over the ranks other than skip1 and skip2, the last
+// varying fastest
+template<int N_rank>
+inline void _bz_scanLineStart(sizeType line,
+    const TinyVector<int,N_rank>& extent, int skip1, int skip2,
+    const TinyVector<diffType,N_rank>& resultStride,
+    const TinyVector<diffType,N_rank>& sourceStride,
+    diffType& resultOffset, diffType& sourceOffset)
+{
+    resultOffset = sourceOffset = 0;
+    for (int r=N_rank-1; r >= 0; --r)
+    {
+        if ((r == skip1) || (r == skip2))
+            continue;
+        const diffType i = line % extent(r);
+        line /= extent(r);
+        resultOffset += i * resultStride(r);
+        sourceOffset += i * sourceStride(r);
+    }
+}
+
+template<typename T_result, typename T_source, int N_rank,
+    typename T_reduction>
+void scan(Array<T_result,N_rank> result, const Array<T_source,N_rank>& source,
+    int rank, const T_reduction& reduction, ScanKind kind)
+{
+    BZPRECONDITION((rank >= 0) && (rank < N_rank));
+    BZPRECONDITION(areShapesConformable(result.shape(), source.shape()));
+
+    const sizeType numElements = source.numElements();
+    if (numElements == 0)
+        return;
+
+    const TinyVector<int,N_rank> extent = source.extent();
+    const TinyVector<diffType,N_rank> resultStride = result.stride(),
+        sourceStride = source.stride();
+    const int length = extent(rank);
+
+    T_reduction empty(reduction);
+    empty.reset();
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    if (numElements >= BZ_SCAN_PARALLEL_THRESHOLD)
+        numThreads = omp_get_max_threads();
+#endif
+
+    const int fast = source.ordering(0);
+    if (fast == rank)
+    {
+        // Lines along the contiguous rank
+        const diffType numLines = numElements / length;
+
+        if ((numThreads > 1) && (numLines < numThreads))
+        {
+            for (diffType line=0; line < numLines; ++line)
+            {
+                diffType resultOffset, sourceOffset;
+                _bz_scanLineStart(line, extent, rank, rank,
+                    resultStride, sourceStride, resultOffset, sourceOffset);
+                _bz_scanLineParallel(empty,
+                    result.data() + resultOffset, resultStride(rank),
+                    source.data() + sourceOffset, sourceStride(rank),
+                    length, kind, numThreads);
+            }
+            return;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (numThreads > 1)
+#endif
+        for (diffType line=0; line < numLines; ++line)
+        {
+            diffType resultOffset, sourceOffset;
+            _bz_scanLineStart(line, extent, rank, rank,
+                resultStride, sourceStride, resultOffset, sourceOffset);
+            _bz_scanLine(T_reduction(empty), 0,
+                result.data() + resultOffset, resultStride(rank),
+                source.data() + sourceOffset, sourceStride(rank),
+                length, kind);
+        }
+        return;
+    }
+
+    // Panels of lines, side by side along the contiguous rank
+    const int width = extent(fast);
+    const diffType numChunks = (width + BZ_SCAN_PANEL - 1) / BZ_SCAN_PANEL,
+        numPanels = numElements / (diffType(length) * width) * numChunks;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (numThreads > 1)
+#endif
+    for (diffType panel=0; panel < numPanels; ++panel)
+    {
+        const int l0 = int(panel % numChunks) * BZ_SCAN_PANEL;
+        diffType resultOffset, sourceOffset;
+        _bz_scanLineStart(panel / numChunks, extent, rank, fast,
+            resultStride, sourceStride, resultOffset, sourceOffset);
+        resultOffset += l0 * resultStride(fast);
+        sourceOffset += l0 * sourceStride(fast);
+
+        _bz_scanPanel(empty,
+            result.data() + resultOffset, resultStride(rank),
+            resultStride(fast),
+            source.data() + sourceOffset, sourceStride(rank),
+            sourceStride(fast), length,
+            (width - l0 < BZ_SCAN_PANEL) ? width - l0 : BZ_SCAN_PANEL, kind);
+    }
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_SCAN_CC
@@ -0,0 +1,155 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/scan.h  Cumulative sums and other scans along a rank
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_SCAN_H
+#define BZ_ARRAY_SCAN_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/scan.h> must be included via <blitz/array.h>
+#endif
+
+#include <vector>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Scans of fewer elements than this are done by one thread.
+#ifndef BZ_SCAN_PARALLEL_THRESHOLD
+ #ifdef BZ_RUNTIME_TUNING
+  #define BZ_SCAN_PARALLEL_THRESHOLD \
+      (TuningParameters::instance().parallelThreshold())
+ #else
+  #define BZ_SCAN_PARALLEL_THRESHOLD 65536
+ #endif
+#endif
+
+// Scans along a strided rank advance this many neighbouring lines
+// together, one element of each at a time.
+#ifndef BZ_SCAN_PANEL
+ #define BZ_SCAN_PANEL 256
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * A scan replaces each element by the reduction of the elements up to
+ * it along one rank: up to and including it for an inclusive scan, up
+ * to but excluding it for an exclusive one.
+ *
+ *   Array<double,2> A(nx,ny), C(nx,ny);
+ *   C = cumsum(A, secondDim);                 // C(i,j) = sum of A(i,0..j)
+ *   C = cumsum(A, secondDim, exclusiveScan);  // sum of A(i,0..j-1)
+ *   C = cummax(A * B, firstDim);
+ *
+ * cumsum, cumprod, cummin and cummax return a new array.  scan() writes
+ * into a given one, which may be a view, or the source itself:
+ *
+ *   scan(A, A, firstDim, ReduceSum<double>());
+ *   scan(C(Range(0,9), Range::all()), A(Range(0,9), Range::all()),
+ *       secondDim, ReduceMean<double>());     // running means
+ *
+ * Any reduction with reset(), merge() and needInit false may be used;
+ * element k (counting from 0) of an inclusive scan is result(k+1).
+ *
+ * When the scan rank is the one stored contiguously, each line is
+ * scanned in order.  With OpenMP the lines are shared between threads;
+ * when there are fewer lines than threads, each line is cut into one
+ * part per thread, the parts are reduced in parallel, their totals are
+ * scanned, and the parts are then scanned in parallel starting from
+ * them, which is about twice the work of the serial scan.  When the scan
+ * rank is strided, BZ_SCAN_PANEL neighbouring lines along the contiguous
+ * rank are scanned together, so that the inner loop runs over
+ * consecutive elements and vectorizes.
+ */
+
+enum ScanKind {
+    inclusiveScan,
+    exclusiveScan
+};
+
+// result = the scan of source along rank.  result is passed by value:
+// like any Array copy, it refers to the caller's data.  It must have the
+// same shape as source, and may be source, but must not otherwise
+// overlap it.
+template<typename T_result, typename T_source, int N_rank,
+    typename T_reduction>
+void scan(Array<T_result,N_rank> result, const Array<T_source,N_rank>& source,
+    int rank, const T_reduction& reduction, ScanKind kind = inclusiveScan);
+
+// The element-type scans, returning a new array with the bounds and
+// storage order of the source
+
+template<typename T_numtype, int N_rank, typename T_reduction>
+Array<_bz_typename T_reduction::T_resulttype, N_rank>
+_bz_scanToNew(const Array<T_numtype,N_rank>& source, int rank,
+    const T_reduction& reduction, ScanKind kind)
+{
+    Array<_bz_typename T_reduction::T_resulttype, N_rank> result(
+        source.lbound(), source.extent(),
+        GeneralArrayStorage<N_rank>(source.ordering(),
+        TinyVector<bool,N_rank>(true)));
+    scan(result, source, rank, reduction, kind);
+    return result;
+}
+
+#define BZ_DECL_ARRAY_SCAN(fn,reduction)                                \
+template<typename T_numtype, int N_rank>                                \
+inline                                                                  \
+Array<_bz_typename reduction<T_numtype>::T_resulttype, N_rank>          \
+fn(const Array<T_numtype,N_rank>& array, int rank,                      \
+    ScanKind kind = inclusiveScan)                                      \
+{                                                                       \
+    return _bz_scanToNew(array, rank, reduction<T_numtype>(), kind);    \
+}                                                                       \
+                                                                        \
+template<typename T_expr>                                               \
+inline                                                                  \
+Array<_bz_typename reduction<_bz_typename T_expr::T_numtype>            \
+    ::T_resulttype, T_expr::rank>                                       \
+fn(_bz_ArrayExpr<T_expr> expr, int rank, ScanKind kind = inclusiveScan) \
+{                                                                       \
+    typedef _bz_typename T_expr::T_numtype T_numtype;                   \
+    Array<T_numtype, T_expr::rank> source(expr);                        \
+    return _bz_scanToNew(source, rank, reduction<T_numtype>(), kind);   \
+}
+
+BZ_DECL_ARRAY_SCAN(cumsum,  ReduceSum)
+BZ_DECL_ARRAY_SCAN(cumprod, ReduceProduct)
+BZ_DECL_ARRAY_SCAN(cummin,  ReduceMin)
+BZ_DECL_ARRAY_SCAN(cummax,  ReduceMax)
+
+#undef BZ_DECL_ARRAY_SCAN
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/scan.cc>
+
+#endif // BZ_ARRAY_SCAN_H
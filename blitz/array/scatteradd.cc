@@ -0,0 +1,454 @@
+/***************************************************************************
+ * blitz/array/scatteradd.cc  Concurrent scatter-accumulate into arrays
+ *                            (histograms, particle deposition)
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_SCATTERADD_CC
+#define BZ_ARRAY_SCATTERADD_CC
+
+#ifndef BZ_ARRAY_SCATTERADD_H
+ #error <blitz/array/scatteradd.cc> must be included via <blitz/array/scatteradd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+BZ_NAMESPACE(blitz)
+
+// Random access to the entries of an index container
+
+template<int N_rank>
+inline const TinyVector<int,N_rank>& _bz_scatterPoint(
+    const Array<TinyVector<int,N_rank>,1>& index, sizeType k)
+{
+    return index.data()[k * index.stride(firstDim)];
+}
+
+template<int N_rank>
+inline const TinyVector<int,N_rank>& _bz_scatterPoint(
+    const std::vector<TinyVector<int,N_rank> >& index, sizeType k)
+{
+    return index[k];
+}
+
+inline TinyVector<int,1> _bz_scatterPoint(const Array<int,1>& index,
+    sizeType k)
+{
+    return TinyVector<int,1>(index.data()[k * index.stride(firstDim)]);
+}
+
+inline TinyVector<int,1> _bz_scatterPoint(const std::vector<int>& index,
+    sizeType k)
+{
+    return TinyVector<int,1>(index[k]);
+}
+
+template<typename T_index>
+inline sizeType _bz_scatterSize(const Array<T_index,1>& index)
+{
+    return index.numElements();
+}
+
+template<typename T_index>
+inline sizeType _bz_scatterSize(const std::vector<T_index>& index)
+{
+    return index.size();
+}
+
+template<int N_rank>
+inline diffType _bz_scatterOffset(const TinyVector<diffType,N_rank>& stride,
+    const TinyVector<int,N_rank>& i)
+{
+    diffType offset = 0;
+    for (int r=0; r < N_rank; ++r)
+        offset += stride(r) * i(r);
+    return offset;
+}
+
+// Weight of entry k: one per entry, or the same for all
+
+template<typename T_numtype>
+class _bz_ScatterWeights {
+public:
+    _bz_ScatterWeights(const Array<T_numtype,1>& weight)
+      : data_(weight.data()), stride_(weight.stride(firstDim))
+    { }
+
+    T_numtype operator()(sizeType k) const
+    { return data_[k * stride_]; }
+
+private:
+    const T_numtype* data_;
+    diffType stride_;
+};
+
+template<typename T_numtype>
+class _bz_ScatterConstant {
+public:
+    _bz_ScatterConstant(T_numtype value)
+      : value_(value)
+    { }
+
+    T_numtype operator()(sizeType) const
+    { return value_; }
+
+private:
+    T_numtype value_;
+};
+
+// Types for which "#pragma omp atomic" supports +=
+
+template<typename T_numtype>
+struct _bz_hasAtomicAdd {
+    static const bool value = false;
+};
+
+#define BZ_DECL_ATOMIC_ADD(T)                                 \
+  template<>                                                  \
+  struct _bz_hasAtomicAdd<T> {                                \
+    static const bool value = true;                           \
+  };
+
+BZ_DECL_ATOMIC_ADD(int)
+BZ_DECL_ATOMIC_ADD(unsigned int)
+BZ_DECL_ATOMIC_ADD(long)
+BZ_DECL_ATOMIC_ADD(unsigned long)
+BZ_DECL_ATOMIC_ADD(float)
+BZ_DECL_ATOMIC_ADD(double)
+
+#undef BZ_DECL_ATOMIC_ADD
+
+template<int N_rank> template<typename T_numtype, typename T_container>
+void ScatterPlan<N_rank>::build(const Array<T_numtype,N_rank>& array,
+    const T_container& index)
+{
+    stride_ = array.stride();
+    lbound_ = 0;
+    ubound_ = -1;
+
+    const sizeType n = _bz_scatterSize(index);
+    std::vector<std::pair<diffType,sizeType> > order(n);
+    for (sizeType k=0; k < n; ++k)
+    {
+        const T_index& i = _bz_scatterPoint(index, k);
+        order[k] = std::make_pair(_bz_scatterOffset(stride_, i), k);
+        for (int r=0; r < N_rank; ++r)
+        {
+            lbound_(r) = (k == 0) ? i(r) : std::min(lbound_(r), i(r));
+            ubound_(r) = (k == 0) ? i(r) : std::max(ubound_(r), i(r));
+        }
+    }
+
+    // Sort by cell, keeping the entries of a cell in their original order
+    std::sort(order.begin(), order.end());
+
+    entries_.resize(n);
+    offsets_.clear();
+    cells_.clear();
+    for (sizeType j=0; j < n; ++j)
+    {
+        entries_[j] = order[j].second;
+        if ((j == 0) || (order[j].first != order[j-1].first))
+        {
+            offsets_.push_back(order[j].first);
+            cells_.push_back(j);
+        }
+    }
+    cells_.push_back(n);
+
+    // Parts: one per thread, whole cells, about the same number of entries
+    int numParts = 1;
+#ifdef _OPENMP
+    numParts = omp_get_max_threads();
+#endif
+    numParts = std::max(1, std::min(numParts, numCells()));
+
+    parts_.clear();
+    parts_.push_back(0);
+    int c = 0;
+    for (int p=1; p < numParts; ++p)
+    {
+        sizeType target = n * p / numParts;
+        while ((c < numCells()) && (cells_[c] < target))
+            ++c;
+        parts_.push_back(c);
+    }
+    parts_.push_back(numCells());
+}
+
+template<int N_rank> template<typename T_numtype>
+bool ScatterPlan<N_rank>::conforms(const Array<T_numtype,N_rank>& array) const
+{
+    if (size() == 0)
+        return true;
+    for (int r=0; r < N_rank; ++r)
+        if (array.stride(r) != stride_(r))
+            return false;
+    return array.isInRange(lbound_) && array.isInRange(ubound_);
+}
+
+template<typename T_numtype, int N_rank>
+ScatterAddStrategy chooseScatterAdd(const Array<T_numtype,N_rank>& A,
+    sizeType numEntries)
+{
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+
+    if ((numThreads == 1) || (numEntries < BZ_SCATTER_ADD_PARALLEL_THRESHOLD))
+        return scatterAddSerial;
+
+    // Dense: the copies cost less than the collisions they avoid
+    if (A.isStorageContiguous() && (A.numElements() * numThreads
+        <= BZ_SCATTER_ADD_PRIVATE_RATIO * numEntries))
+        return scatterAddPrivate;
+
+    // Sparse: collisions are rare, atomics are nearly free
+    if (_bz_hasAtomicAdd<T_numtype>::value)
+        return scatterAddAtomic;
+
+    return scatterAddSorted;
+}
+
+// The strategies
+
+template<typename T_numtype, int N_rank, typename T_container,
+    typename T_weight>
+void _bz_scatterAddSerial(Array<T_numtype,N_rank>& A,
+    const T_container& index, const T_weight& weight)
+{
+    const TinyVector<diffType,N_rank> stride = A.stride();
+    T_numtype* restrict dataZero = A.dataZero();
+    const sizeType n = _bz_scatterSize(index);
+
+    for (sizeType k=0; k < n; ++k)
+        dataZero[_bz_scatterOffset(stride, _bz_scatterPoint(index, k))]
+            += weight(k);
+}
+
+template<typename T_numtype, int N_rank, typename T_weight>
+void _bz_scatterAddPlan(Array<T_numtype,N_rank>& A,
+    const ScatterPlan<N_rank>& plan, const T_weight& weight)
+{
+    BZPRECHECK(plan.conforms(A),
+        "ScatterPlan<" << N_rank << "> applied to an array with different "
+        "strides," << endl << "or which does not contain all its entries")
+
+    T_numtype* restrict dataZero = A.dataZero();
+    const int numParts = plan.numParts();
+
+    // Each cell belongs to one part, so the parts write disjoint elements
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,1) \
+    if (plan.size() >= BZ_SCATTER_ADD_PARALLEL_THRESHOLD)
+#endif
+    for (int p=0; p < numParts; ++p)
+    {
+        for (int c=plan.firstCell(p); c < plan.firstCell(p+1); ++c)
+        {
+            const sizeType last = plan.cellEnd(c);
+            sizeType j = plan.cellBegin(c);
+            T_numtype sum = weight(plan.entry(j));
+            for (++j; j < last; ++j)
+                sum += weight(plan.entry(j));
+            dataZero[plan.offset(c)] += sum;
+        }
+    }
+}
+
+template<typename T_numtype, int N_rank, typename T_container,
+    typename T_weight>
+void _bz_scatterAddPrivate(Array<T_numtype,N_rank>& A,
+    const T_container& index, const T_weight& weight)
+{
+#ifdef _OPENMP
+    BZPRECONDITION(A.isStorageContiguous());
+
+    const TinyVector<diffType,N_rank> stride = A.stride();
+    T_numtype* restrict dataZero = A.dataZero();
+    const diffType n = _bz_scatterSize(index);
+
+    // The elements are the span [first, first + numElements) of offsets
+    diffType first = 0;
+    for (int r=0; r < N_rank; ++r)
+        first += stride(r) * ((stride(r) >= 0) ? A.lbound(r) : A.ubound(r));
+    const diffType span = A.numElements();
+    T_numtype* restrict base = dataZero + first;
+
+    T_numtype* copies = new T_numtype[omp_get_max_threads() * span];
+
+#pragma omp parallel
+    {
+        const int numThreads = omp_get_num_threads();
+        const int t = omp_get_thread_num();
+
+        // Each thread zeroes the copy it writes
+        T_numtype* restrict mine = copies + t * span;
+        for (diffType e=0; e < span; ++e)
+            mine[e] = T_numtype(0);
+
+#pragma omp for schedule(static)
+        for (diffType k=0; k < n; ++k)
+            mine[_bz_scatterOffset(stride, _bz_scatterPoint(index, k))
+                - first] += weight(k);
+
+        // Each thread sums its slice of the array over all the copies
+        const diffType lo = span * t / numThreads,
+            hi = span * (t + 1) / numThreads;
+        for (int c=0; c < numThreads; ++c)
+        {
+            const T_numtype* restrict copy = copies + c * span;
+            for (diffType e=lo; e < hi; ++e)
+                base[e] += copy[e];
+        }
+    }
+
+    delete [] copies;
+#else
+    _bz_scatterAddSerial(A, index, weight);
+#endif
+}
+
+// Atomic adds for the types which have them, sorted entries otherwise
+
+template<bool N_hasAtomicAdd>
+struct _bz_scatterAddAtomic {
+    template<typename T_numtype, int N_rank, typename T_container,
+        typename T_weight>
+    static void apply(Array<T_numtype,N_rank>& A, const T_container& index,
+        const T_weight& weight)
+    {
+        _bz_scatterAddPlan(A, ScatterPlan<N_rank>(A, index), weight);
+    }
+};
+
+template<>
+struct _bz_scatterAddAtomic<true> {
+    template<typename T_numtype, int N_rank, typename T_container,
+        typename T_weight>
+    static void apply(Array<T_numtype,N_rank>& A, const T_container& index,
+        const T_weight& weight)
+    {
+        const TinyVector<diffType,N_rank> stride = A.stride();
+        T_numtype* dataZero = A.dataZero();
+        const diffType n = _bz_scatterSize(index);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (diffType k=0; k < n; ++k)
+        {
+            T_numtype* x = dataZero
+                + _bz_scatterOffset(stride, _bz_scatterPoint(index, k));
+            const T_numtype w = weight(k);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            *x += w;
+        }
+    }
+};
+
+template<typename T_numtype, int N_rank, typename T_container,
+    typename T_weight>
+void _bz_scatterAdd(Array<T_numtype,N_rank>& A, const T_container& index,
+    const T_weight& weight, ScatterAddStrategy strategy)
+{
+#ifdef BZ_DEBUG
+    for (sizeType k=0; k < _bz_scatterSize(index); ++k)
+        BZPRECHECK(A.isInRange(_bz_scatterPoint(index, k)),
+            "scatterAdd() entry " << k << " at "
+            << _bz_scatterPoint(index, k) << " is outside the array domain "
+            << A.lbound() << " to " << A.ubound())
+#endif
+
+    if (strategy == scatterAddAuto)
+        strategy = chooseScatterAdd(A, _bz_scatterSize(index));
+    if ((strategy == scatterAddPrivate) && !A.isStorageContiguous())
+        strategy = scatterAddSorted;
+
+    switch (strategy)
+    {
+    case scatterAddPrivate:
+        _bz_scatterAddPrivate(A, index, weight);
+        break;
+    case scatterAddAtomic:
+        _bz_scatterAddAtomic<_bz_hasAtomicAdd<T_numtype>::value>::apply(
+            A, index, weight);
+        break;
+    case scatterAddSorted:
+        _bz_scatterAddPlan(A, ScatterPlan<N_rank>(A, index), weight);
+        break;
+    default:
+        _bz_scatterAddSerial(A, index, weight);
+    }
+}
+
+template<typename T_numtype, int N_rank, typename T_container>
+void scatterAdd(Array<T_numtype,N_rank>& A, const T_container& index,
+    const Array<T_numtype,1>& weight, ScatterAddStrategy strategy)
+{
+    BZPRECHECK(weight.numElements() == _bz_scatterSize(index),
+        "scatterAdd() of " << weight.numElements() << " weights at "
+        << _bz_scatterSize(index) << " positions")
+
+    _bz_scatterAdd(A, index, _bz_ScatterWeights<T_numtype>(weight), strategy);
+}
+
+template<typename T_numtype, int N_rank, typename T_container,
+    typename T_weight>
+void scatterAdd(Array<T_numtype,N_rank>& A, const T_container& index,
+    T_weight weight, ScatterAddStrategy strategy)
+{
+    _bz_scatterAdd(A, index,
+        _bz_ScatterConstant<T_numtype>(T_numtype(weight)), strategy);
+}
+
+template<typename T_numtype, int N_rank>
+void scatterAdd(Array<T_numtype,N_rank>& A, const ScatterPlan<N_rank>& plan,
+    const Array<T_numtype,1>& weight)
+{
+    BZPRECHECK(weight.numElements() == plan.size(),
+        "scatterAdd() of " << weight.numElements() << " weights through "
+        "a plan of " << plan.size() << " entries")
+
+    _bz_scatterAddPlan(A, plan, _bz_ScatterWeights<T_numtype>(weight));
+}
+
+template<typename T_numtype, int N_rank, typename T_weight>
+void scatterAdd(Array<T_numtype,N_rank>& A, const ScatterPlan<N_rank>& plan,
+    T_weight weight)
+{
+    _bz_scatterAddPlan(A, plan,
+        _bz_ScatterConstant<T_numtype>(T_numtype(weight)));
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_SCATTERADD_CC
@@ -0,0 +1,192 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/scatteradd.h  Concurrent scatter-accumulate into arrays
+ *                           (histograms, particle deposition)
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_SCATTERADD_H
+#define BZ_ARRAY_SCATTERADD_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/scatteradd.h> must be included via <blitz/array.h>
+#endif
+
+#include <vector>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Scatters of fewer entries than this are done by one thread.
+#ifndef BZ_SCATTER_ADD_PARALLEL_THRESHOLD
+ #define BZ_SCATTER_ADD_PARALLEL_THRESHOLD 16384
+#endif
+
+// The automatic choice uses per-thread copies of the array when all the
+// copies together hold at most this many elements per entry scattered.
+#ifndef BZ_SCATTER_ADD_PRIVATE_RATIO
+ #define BZ_SCATTER_ADD_PRIVATE_RATIO 4
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * scatterAdd() accumulates weights into an array at a list of positions
+ * which may repeat, i.e. A(index(k)) += weight(k) for all k:
+ *
+ *   Array<TinyVector<int,3>,1> cell(n);   // or std::vector<...>, or
+ *   Array<double,1> charge(n);            // Array<int,1> for rank 1
+ *   scatterAdd(rho, cell, charge);        // deposit
+ *   scatterAdd(hist, bin, 1);             // histogram
+ *
+ * With OpenMP the entries are split between threads, and the collisions
+ * are handled by one of
+ *
+ *   scatterAddPrivate  each thread adds into a zeroed copy of the array,
+ *                      then the copies are summed into it in parallel;
+ *                      best when there are many entries per element
+ *   scatterAddAtomic   atomic adds straight into the array; best when
+ *                      entries are sparse and seldom collide (built-in
+ *                      arithmetic types only)
+ *   scatterAddSorted   the entries are sorted by cell and the cells
+ *                      dealt out to threads, so that no two threads
+ *                      write the same element
+ *
+ * scatterAddAuto picks one from the number of entries per element.  The
+ * sort is worth keeping when the same positions are deposited more than
+ * once; a ScatterPlan holds it:
+ *
+ *   ScatterPlan<3> plan(rho, cell);
+ *   scatterAdd(rho, plan, charge);
+ *   scatterAdd(current, plan, velocity);
+ *
+ * The sums are formed in a different order from a serial loop, so
+ * floating-point results may differ in the last bits.
+ */
+
+enum ScatterAddStrategy {
+    scatterAddAuto,
+    scatterAddSerial,
+    scatterAddPrivate,
+    scatterAddAtomic,
+    scatterAddSorted
+};
+
+template<int N_rank>
+class ScatterPlan {
+
+public:
+    typedef TinyVector<int,N_rank> T_index;
+
+    ScatterPlan()
+      : stride_(0), lbound_(0), ubound_(-1)
+    { cells_.push_back(0); parts_.push_back(0); }
+
+    template<typename T_numtype, typename T_container>
+    ScatterPlan(const Array<T_numtype,N_rank>& array,
+        const T_container& index)
+    { build(array, index); }
+
+    // Sort the entries of index by the element of array they fall on
+    template<typename T_numtype, typename T_container>
+    void build(const Array<T_numtype,N_rank>& array,
+        const T_container& index);
+
+    // Number of entries, including repeats
+    sizeType size() const
+    { return entries_.size(); }
+
+    // Entries [cellBegin(c), cellEnd(c)) in sorted order fall on the
+    // element at offset(c) from dataZero(); entry(j) is the position of
+    // sorted entry j in the original container.
+    int numCells() const
+    { return offsets_.size(); }
+
+    const diffType& offset(int c) const
+    { return offsets_[c]; }
+
+    sizeType cellBegin(int c) const
+    { return cells_[c]; }
+
+    sizeType cellEnd(int c) const
+    { return cells_[c+1]; }
+
+    sizeType entry(sizeType j) const
+    { return entries_[j]; }
+
+    // Part p is cells [firstCell(p), firstCell(p+1))
+    int numParts() const
+    { return parts_.size() - 1; }
+
+    int firstCell(int p) const
+    { return parts_[p]; }
+
+    // True if the plan may be applied to array
+    template<typename T_numtype>
+    bool conforms(const Array<T_numtype,N_rank>& array) const;
+
+private:
+    TinyVector<diffType,N_rank> stride_;
+    T_index lbound_, ubound_;
+    std::vector<sizeType> entries_;
+    std::vector<diffType> offsets_;
+    std::vector<sizeType> cells_;
+    std::vector<int> parts_;
+};
+
+// The strategy scatterAddAuto uses for numEntries entries into A
+template<typename T_numtype, int N_rank>
+ScatterAddStrategy chooseScatterAdd(const Array<T_numtype,N_rank>& A,
+    sizeType numEntries);
+
+// A(index(k)) += weight(k)
+template<typename T_numtype, int N_rank, typename T_container>
+void scatterAdd(Array<T_numtype,N_rank>& A, const T_container& index,
+    const Array<T_numtype,1>& weight,
+    ScatterAddStrategy strategy = scatterAddAuto);
+
+// A(index(k)) += weight
+template<typename T_numtype, int N_rank, typename T_container,
+    typename T_weight>
+void scatterAdd(Array<T_numtype,N_rank>& A, const T_container& index,
+    T_weight weight, ScatterAddStrategy strategy = scatterAddAuto);
+
+// A(index(k)) += weight(k) through a sorted plan
+template<typename T_numtype, int N_rank>
+void scatterAdd(Array<T_numtype,N_rank>& A, const ScatterPlan<N_rank>& plan,
+    const Array<T_numtype,1>& weight);
+
+template<typename T_numtype, int N_rank, typename T_weight>
+void scatterAdd(Array<T_numtype,N_rank>& A, const ScatterPlan<N_rank>& plan,
+    T_weight weight);
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/scatteradd.cc>
+
+#endif // BZ_ARRAY_SCATTERADD_H
@@ -0,0 +1,949 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/soa.h  Structure-of-arrays storage for multicomponent
+ *                    arrays
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_SOA_H
+#define BZ_ARRAY_SOA_H
+
+#ifndef BZ_ARRAY_H
+ #include <blitz/array.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * An Array<TinyVector<double,3>,3> stores its components interleaved,
+ * so A[c] is a view with stride 3 and componentwise loops over it do
+ * not vectorize.  SoAArray<TinyVector<double,3>,3> holds the same data
+ * as one contiguous plane per component:
+ *
+ *   A(i,j,k)       a proxy which converts to and from TinyVector
+ *   A[c]           a unit-stride Array<double,3> view of component c
+ *   A = B + 2.*C   evaluated one component plane at a time, each plane
+ *                  by the ordinary Array expression machinery
+ *
+ * Any type with multicomponent_traits works as the element type.  Only
+ * componentwise operations (+, -, *, / with arrays, scalars and constant
+ * tuples) are provided on whole SoAArrays; anything which mixes
+ * components, such as dot or cross products, is written on the planes.
+ * The exception is complex<T>, stored split into real and imaginary
+ * planes, whose products and quotients are complex ones.
+ */
+
+template<typename P_tuple, int N_rank>
+class SoAArray;
+
+template<typename P_expr>
+struct _bz_SoAOperand;
+
+// Base of everything usable in a whole-vector SoA expression.  Each
+// expression type provides T_tuple, T_element, a type T_plane, and
+// plane(c), which returns an ordinary Array expression for component c.
+template<typename P_expr>
+struct _bz_SoAExprBase {
+    const P_expr& unwrap() const
+    { return static_cast<const P_expr&>(*this); }
+};
+
+// Proxy returned by SoAArray::operator(): the components of one element,
+// one plane apart.
+template<typename P_tuple>
+class _bz_SoAElementRef {
+
+public:
+    typedef P_tuple T_tuple;
+    typedef typename multicomponent_traits<T_tuple>::T_element T_element;
+    static const int numComponents =
+        multicomponent_traits<T_tuple>::numComponents;
+
+    _bz_SoAElementRef(T_element* restrict data, diffType planeStride)
+      : data_(data), planeStride_(planeStride)
+    { }
+
+    T_element& operator[](int c) const
+    {
+        BZPRECONDITION((c >= 0) && (c < numComponents));
+        return data_[c * planeStride_];
+    }
+
+    operator T_tuple() const
+    {
+        T_tuple x;
+        T_element* restrict p = reinterpret_cast<T_element*>(&x);
+        for (int c=0; c < numComponents; ++c)
+            p[c] = data_[c * planeStride_];
+        return x;
+    }
+
+    const _bz_SoAElementRef& operator=(const T_tuple& x) const
+    {
+        const T_element* restrict p = reinterpret_cast<const T_element*>(&x);
+        for (int c=0; c < numComponents; ++c)
+            data_[c * planeStride_] = p[c];
+        return *this;
+    }
+
+    const _bz_SoAElementRef& operator=(const _bz_SoAElementRef& x) const
+    { return *this = T_tuple(x); }
+
+private:
+    T_element* restrict data_;
+    diffType planeStride_;
+};
+
+template<typename P_tuple, int N_rank>
+class SoAArray : public _bz_SoAExprBase<SoAArray<P_tuple,N_rank> > {
+
+public:
+    typedef P_tuple T_tuple;
+    typedef typename multicomponent_traits<T_tuple>::T_element T_element;
+    typedef Array<T_element,N_rank> T_plane;
+    typedef _bz_SoAElementRef<T_tuple> T_reference;
+    static const int numComponents =
+        multicomponent_traits<T_tuple>::numComponents;
+
+    SoAArray()
+    { }
+
+    explicit SoAArray(int extent0)
+    { setup(TinyVector<int,1>(extent0), GeneralArrayStorage<N_rank>()); }
+
+    SoAArray(int extent0, int extent1)
+    { setup(TinyVector<int,2>(extent0, extent1),
+        GeneralArrayStorage<N_rank>()); }
+
+    SoAArray(int extent0, int extent1, int extent2)
+    { setup(TinyVector<int,3>(extent0, extent1, extent2),
+        GeneralArrayStorage<N_rank>()); }
+
+    explicit SoAArray(const TinyVector<int,N_rank>& extent,
+        GeneralArrayStorage<N_rank> storage = GeneralArrayStorage<N_rank>())
+    { setup(extent, storage); }
+
+    // Copy of an interleaved array, with the same shape and storage order
+    explicit SoAArray(const Array<T_tuple,N_rank>& x)
+    {
+        setup(x.extent(), storageOf(x));
+        *this = x;
+    }
+
+    // Like Array, copy construction shares the data
+    SoAArray(const SoAArray& x)
+      : _bz_SoAExprBase<SoAArray>()
+    { reference(x); }
+
+    void reference(const SoAArray& x)
+    {
+        data_.reference(x.data_);
+        for (int c=0; c < numComponents; ++c)
+        {
+            planes_[c].reference(x.planes_[c]);
+            scratch_[c].free();
+        }
+    }
+
+    // Discards the contents, like Array::resize()
+    void resize(const TinyVector<int,N_rank>& extent)
+    {
+        setup(extent, storageOf(planes_[0]));
+    }
+
+    const TinyVector<int,N_rank>& extent() const
+    { return planes_[0].extent(); }
+
+    int extent(int rank) const
+    { return planes_[0].extent(rank); }
+
+    const TinyVector<int,N_rank>& shape() const
+    { return planes_[0].shape(); }
+
+    const TinyVector<int,N_rank>& lbound() const
+    { return planes_[0].lbound(); }
+
+    int lbound(int rank) const
+    { return planes_[0].lbound(rank); }
+
+    int ubound(int rank) const
+    { return planes_[0].ubound(rank); }
+
+    sizeType numElements() const
+    { return planes_[0].numElements(); }
+
+    // Distance in elements between the planes of consecutive components
+    diffType planeStride() const
+    { return data_.stride(0); }
+
+    // The component planes.  operator[] returns a view sharing the data;
+    // plane() is the same array without the reference count traffic.
+    T_plane operator[](int c)
+    {
+        BZPRECONDITION((c >= 0) && (c < numComponents));
+        return planes_[c];
+    }
+
+    const T_plane& plane(int c) const
+    {
+        BZPRECONDITION((c >= 0) && (c < numComponents));
+        return planes_[c];
+    }
+
+    T_reference operator()(const TinyVector<int,N_rank>& index)
+    { return T_reference(&planes_[0](index), planeStride()); }
+
+    T_tuple operator()(const TinyVector<int,N_rank>& index) const
+    { return T_reference(const_cast<T_element*>(&planes_[0](index)),
+        planeStride()); }
+
+    T_reference operator()(int i0)
+    { return T_reference(&planes_[0](i0), planeStride()); }
+
+    T_tuple operator()(int i0) const
+    { return operator()(TinyVector<int,1>(i0)); }
+
+    T_reference operator()(int i0, int i1)
+    { return T_reference(&planes_[0](i0, i1), planeStride()); }
+
+    T_tuple operator()(int i0, int i1) const
+    { return operator()(TinyVector<int,2>(i0, i1)); }
+
+    T_reference operator()(int i0, int i1, int i2)
+    { return T_reference(&planes_[0](i0, i1, i2), planeStride()); }
+
+    T_tuple operator()(int i0, int i1, int i2) const
+    { return operator()(TinyVector<int,3>(i0, i1, i2)); }
+
+    // Componentwise assignment, one plane at a time.  Constant tuples
+    // are accepted by every assignment operator below, and a scalar x
+    // stands for T_tuple(x).
+    SoAArray& operator=(const SoAArray& x)
+    {
+        for (int c=0; c < numComponents; ++c)
+            planes_[c] = x.planes_[c];
+        return *this;
+    }
+
+    SoAArray& operator=(const Array<T_tuple,N_rank>& x)
+    {
+        for (int c=0; c < numComponents; ++c)
+            planes_[c] = x.extractComponent(T_element(), c, numComponents);
+        return *this;
+    }
+
+    // Copies into an interleaved array of the same shape
+    void copyTo(Array<T_tuple,N_rank>& x) const
+    {
+        for (int c=0; c < numComponents; ++c)
+            x.extractComponent(T_element(), c, numComponents) = planes_[c];
+    }
+
+#define BZ_SOA_ASSIGN(op)                                                 \
+    template<typename T_expr>                                             \
+    SoAArray& operator op(const _bz_SoAExprBase<T_expr>& expr)            \
+    {                                                                     \
+        typedef _bz_SoAOperand<T_expr> T_operand;                         \
+        typename T_operand::T_expr x = T_operand::get(expr.unwrap());     \
+        if (T_operand::T_expr::mixesPlanes)                               \
+        {                                                                 \
+            /* x may read this array: no plane is updated before */       \
+            /* every plane has been evaluated. */                         \
+            for (int c=0; c < numComponents-1; ++c)                       \
+                scratch(c) = x.plane(c);                                  \
+            planes_[numComponents-1] op x.plane(numComponents-1);         \
+            for (int c=0; c < numComponents-1; ++c)                       \
+                planes_[c] op scratch_[c];                                \
+        }                                                                 \
+        else                                                              \
+        {                                                                 \
+            for (int c=0; c < numComponents; ++c)                         \
+                planes_[c] op x.plane(c);                                 \
+        }                                                                 \
+        return *this;                                                     \
+    }                                                                     \
+                                                                          \
+    SoAArray& operator op(const T_tuple& x)                               \
+    {                                                                     \
+        const T_element* p = reinterpret_cast<const T_element*>(&x);      \
+        for (int c=0; c < numComponents; ++c)                             \
+            planes_[c] op p[c];                                           \
+        return *this;                                                     \
+    }                                                                     \
+                                                                          \
+    SoAArray& operator op(T_element x)                                    \
+    { return *this op T_tuple(x); }
+
+    BZ_SOA_ASSIGN(=)
+    BZ_SOA_ASSIGN(+=)
+    BZ_SOA_ASSIGN(-=)
+
+#undef BZ_SOA_ASSIGN
+
+    // Multiplication and division need not be componentwise (complex
+    // elements), so they are written out as A = A * x.
+#define BZ_SOA_UPDATE(op, binop)                                          \
+    template<typename T_expr>                                             \
+    SoAArray& operator op(const _bz_SoAExprBase<T_expr>& expr)            \
+    { return *this = *this binop expr; }                                  \
+                                                                          \
+    SoAArray& operator op(const T_tuple& x)                               \
+    { return *this = *this binop x; }                                     \
+                                                                          \
+    SoAArray& operator op(T_element x)                                    \
+    {                                                                     \
+        for (int c=0; c < numComponents; ++c)                             \
+            planes_[c] op x;                                              \
+        return *this;                                                     \
+    }
+
+    BZ_SOA_UPDATE(*=, *)
+    BZ_SOA_UPDATE(/=, /)
+
+#undef BZ_SOA_UPDATE
+
+private:
+    template<typename T_array>
+    static GeneralArrayStorage<N_rank> storageOf(const T_array& x)
+    {
+        GeneralArrayStorage<N_rank> storage;
+        storage.ordering() = x.ordering();
+        storage.base() = x.base();
+        for (int r=0; r < N_rank; ++r)
+            storage.ascendingFlag()(r) = x.isRankStoredAscending(r);
+        return storage;
+    }
+
+    void setup(const TinyVector<int,N_rank>& extent,
+        const GeneralArrayStorage<N_rank>& storage);
+
+    // Temporary plane c, allocated on first use
+    T_plane& scratch(int c)
+    {
+        if (scratch_[c].data() == 0)
+            scratch_[c].reference(T_plane(extent(), storageOf(planes_[0])));
+        return scratch_[c];
+    }
+
+    // All planes live in one array whose first rank, the component, is
+    // stored slowest; planes_ are the slices of data_.
+    Array<T_element,N_rank+1> data_;
+    T_plane planes_[numComponents];
+    T_plane scratch_[numComponents];
+};
+
+// Slice arguments selecting one component plane: Range::all() for the
+// N_rank spatial ranks, nilArraySection() for the rest.
+template<bool>
+struct _bz_SoASliceArg {
+    static nilArraySection get()
+    { return nilArraySection(); }
+};
+
+template<>
+struct _bz_SoASliceArg<true> {
+    static Range get()
+    { return Range::all(); }
+};
+
+template<typename P_tuple, int N_rank>
+void SoAArray<P_tuple,N_rank>::setup(const TinyVector<int,N_rank>& extent,
+    const GeneralArrayStorage<N_rank>& storage)
+{
+    TinyVector<int,N_rank+1> extent2;
+    GeneralArrayStorage<N_rank+1> storage2;
+    extent2(0) = numComponents;
+    storage2.base()(0) = 0;
+    storage2.ascendingFlag()(0) = true;
+    storage2.ordering()(N_rank) = 0;
+    for (int r=0; r < N_rank; ++r)
+    {
+        extent2(r+1) = extent(r);
+        storage2.base()(r+1) = storage.base()(r);
+        storage2.ascendingFlag()(r+1) = storage.ascendingFlag()(r);
+        storage2.ordering()(r) = storage.ordering()(r) + 1;
+    }
+
+    data_.reference(Array<T_element,N_rank+1>(extent2, storage2));
+    for (int c=0; c < numComponents; ++c)
+        scratch_[c].free();
+
+#define BZ_SOA_SLICE_ARG(k) _bz_SoASliceArg<(k <= N_rank)>::get()
+    for (int c=0; c < numComponents; ++c)
+        planes_[c].reference(T_plane(data_, c, BZ_SOA_SLICE_ARG(1),
+            BZ_SOA_SLICE_ARG(2), BZ_SOA_SLICE_ARG(3), BZ_SOA_SLICE_ARG(4),
+            BZ_SOA_SLICE_ARG(5), BZ_SOA_SLICE_ARG(6), BZ_SOA_SLICE_ARG(7),
+            BZ_SOA_SLICE_ARG(8), BZ_SOA_SLICE_ARG(9), BZ_SOA_SLICE_ARG(10)));
+#undef BZ_SOA_SLICE_ARG
+}
+
+/*
+ * Expression nodes.  _bz_SoAOperand<T>::T_expr is what a node stores for
+ * an operand of type T: SoAArrays by pointer, everything else by value.
+ * Besides plane(c), every node says whether it is the same in all
+ * planes (isBroadcast), and whether a plane of the result depends on
+ * other planes of the operands (mixesPlanes).
+ */
+
+// Builds the Array expression a OP b from two plane operands
+template<template<typename T1, typename T2> class OP,
+         typename T_plane1, typename T_plane2>
+inline typename BzBinaryExprResult<OP,T_plane1,T_plane2>::T_result
+_bz_SoAPlaneOp(const T_plane1& a, const T_plane2& b)
+{
+    return typename BzBinaryExprResult<OP,T_plane1,T_plane2>::T_result(
+        asExpr<T_plane1>::getExpr(a), asExpr<T_plane2>::getExpr(b));
+}
+
+template<typename P_tuple, int N_rank>
+class _bz_SoAArrayOperand {
+public:
+    typedef P_tuple T_tuple;
+    typedef typename SoAArray<P_tuple,N_rank>::T_element T_element;
+    typedef typename SoAArray<P_tuple,N_rank>::T_plane T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = false;
+
+    _bz_SoAArrayOperand(const SoAArray<P_tuple,N_rank>& array)
+      : array_(&array)
+    { }
+
+    const T_plane& plane(int c) const
+    { return array_->plane(c); }
+
+private:
+    const SoAArray<P_tuple,N_rank>* array_;
+};
+
+template<typename P_expr>
+struct _bz_SoAOperand {
+    typedef P_expr T_expr;
+    static const T_expr& get(const P_expr& x)
+    { return x; }
+};
+
+template<typename P_tuple, int N_rank>
+struct _bz_SoAOperand<SoAArray<P_tuple,N_rank> > {
+    typedef _bz_SoAArrayOperand<P_tuple,N_rank> T_expr;
+    static T_expr get(const SoAArray<P_tuple,N_rank>& x)
+    { return T_expr(x); }
+};
+
+// A scalar, the same in every plane
+template<typename P_tuple>
+class _bz_SoAExprConstant {
+public:
+    typedef P_tuple T_tuple;
+    typedef typename multicomponent_traits<T_tuple>::T_element T_element;
+    typedef T_element T_plane;
+    static const bool isBroadcast = true;
+    static const bool mixesPlanes = false;
+
+    _bz_SoAExprConstant(T_element value)
+      : value_(value)
+    { }
+
+    T_plane plane(int) const
+    { return value_; }
+
+private:
+    T_element value_;
+};
+
+// A constant tuple: component c in plane c
+template<typename P_tuple>
+class _bz_SoAExprTupleConstant {
+public:
+    typedef P_tuple T_tuple;
+    typedef typename multicomponent_traits<T_tuple>::T_element T_element;
+    typedef T_element T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = false;
+
+    _bz_SoAExprTupleConstant(const T_tuple& value)
+      : value_(value)
+    { }
+
+    T_plane plane(int c) const
+    { return reinterpret_cast<const T_element*>(&value_)[c]; }
+
+private:
+    T_tuple value_;
+};
+
+// An ordinary array, e.g. a real field scaling a complex one, used as
+// every plane
+template<typename P_tuple, int N_rank>
+class _bz_SoAExprBroadcast {
+public:
+    typedef P_tuple T_tuple;
+    typedef typename multicomponent_traits<T_tuple>::T_element T_element;
+    typedef Array<T_element,N_rank> T_plane;
+    static const bool isBroadcast = true;
+    static const bool mixesPlanes = false;
+
+    _bz_SoAExprBroadcast(const T_plane& array)
+      : array_(array)
+    { }
+
+    const T_plane& plane(int) const
+    { return array_; }
+
+private:
+    T_plane array_;
+};
+
+template<typename P_expr1, typename P_expr2,
+         template<typename T1, typename T2> class OP>
+class _bz_SoAExprBinaryOp
+  : public _bz_SoAExprBase<_bz_SoAExprBinaryOp<P_expr1,P_expr2,OP> > {
+public:
+    typedef typename P_expr1::T_tuple T_tuple;
+    typedef typename P_expr1::T_element T_element;
+    typedef typename P_expr1::T_plane T_plane1;
+    typedef typename P_expr2::T_plane T_plane2;
+    typedef typename BzBinaryExprResult<OP,T_plane1,T_plane2>::T_result
+        T_plane;
+    static const bool isBroadcast = P_expr1::isBroadcast
+        && P_expr2::isBroadcast;
+    static const bool mixesPlanes = P_expr1::mixesPlanes
+        || P_expr2::mixesPlanes;
+
+    _bz_SoAExprBinaryOp(const P_expr1& a, const P_expr2& b)
+      : a_(a), b_(b)
+    { }
+
+    T_plane plane(int c) const
+    { return _bz_SoAPlaneOp<OP>(a_.plane(c), b_.plane(c)); }
+
+private:
+    P_expr1 a_;
+    P_expr2 b_;
+};
+
+#ifdef BZ_HAVE_COMPLEX
+
+/*
+ * Complex elements are stored as a real and an imaginary plane.  Sums,
+ * differences and scaling by reals are componentwise; products and
+ * quotients of two complex operands get their own nodes, which use the
+ * limited-range formulas (no C99 NaN recovery, no overflow scaling in
+ * the division).  To keep one plane type, the sign which differs between
+ * the real and imaginary parts is applied as a multiplication.
+ */
+
+// (a0 b0 - a1 b1, a0 b1 + a1 b0)
+template<typename P_expr1, typename P_expr2>
+class _bz_SoAComplexMultiply
+  : public _bz_SoAExprBase<_bz_SoAComplexMultiply<P_expr1,P_expr2> > {
+public:
+    typedef typename P_expr1::T_tuple T_tuple;
+    typedef typename P_expr1::T_element T_element;
+    typedef typename P_expr1::T_plane T_plane1;
+    typedef typename P_expr2::T_plane T_plane2;
+    typedef typename BzBinaryExprResult<Multiply,T_plane1,T_plane2>::T_result
+        T_product;
+    typedef typename BzBinaryExprResult<Multiply,T_element,T_product>::T_result
+        T_signed;
+    typedef typename BzBinaryExprResult<Add,T_product,T_signed>::T_result
+        T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = true;
+
+    _bz_SoAComplexMultiply(const P_expr1& a, const P_expr2& b)
+      : a_(a), b_(b)
+    { }
+
+    T_plane plane(int c) const
+    {
+        const T_element sign = c ? 1 : -1;
+        return _bz_SoAPlaneOp<Add>(
+            _bz_SoAPlaneOp<Multiply>(a_.plane(0), b_.plane(c)),
+            _bz_SoAPlaneOp<Multiply>(sign,
+                _bz_SoAPlaneOp<Multiply>(a_.plane(1), b_.plane(1-c))));
+    }
+
+private:
+    P_expr1 a_;
+    P_expr2 b_;
+};
+
+// (a0 b0 + a1 b1, a1 b0 - a0 b1) / (b0^2 + b1^2)
+template<typename P_expr1, typename P_expr2>
+class _bz_SoAComplexDivide
+  : public _bz_SoAExprBase<_bz_SoAComplexDivide<P_expr1,P_expr2> > {
+public:
+    typedef typename P_expr1::T_tuple T_tuple;
+    typedef typename P_expr1::T_element T_element;
+    typedef typename P_expr1::T_plane T_plane1;
+    typedef typename P_expr2::T_plane T_plane2;
+    typedef typename BzBinaryExprResult<Multiply,T_plane1,T_plane2>::T_result
+        T_product;
+    typedef typename BzBinaryExprResult<Multiply,T_element,T_product>::T_result
+        T_signed;
+    typedef typename BzBinaryExprResult<Add,T_product,T_signed>::T_result
+        T_numerator;
+    typedef typename BzBinaryExprResult<Multiply,T_plane2,T_plane2>::T_result
+        T_square;
+    typedef typename BzBinaryExprResult<Add,T_square,T_square>::T_result
+        T_denominator;
+    typedef typename BzBinaryExprResult<Divide,T_numerator,
+        T_denominator>::T_result T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = true;
+
+    _bz_SoAComplexDivide(const P_expr1& a, const P_expr2& b)
+      : a_(a), b_(b)
+    { }
+
+    T_plane plane(int c) const
+    {
+        const T_element sign = c ? -1 : 1;
+        return _bz_SoAPlaneOp<Divide>(
+            _bz_SoAPlaneOp<Add>(
+                _bz_SoAPlaneOp<Multiply>(a_.plane(c), b_.plane(0)),
+                _bz_SoAPlaneOp<Multiply>(sign,
+                    _bz_SoAPlaneOp<Multiply>(a_.plane(1-c), b_.plane(1)))),
+            _bz_SoAPlaneOp<Add>(
+                _bz_SoAPlaneOp<Multiply>(b_.plane(0), b_.plane(0)),
+                _bz_SoAPlaneOp<Multiply>(b_.plane(1), b_.plane(1))));
+    }
+
+private:
+    P_expr1 a_;
+    P_expr2 b_;
+};
+
+// Real a over complex b: (a b0, -a b1) / (b0^2 + b1^2)
+template<typename P_expr1, typename P_expr2>
+class _bz_SoAComplexInverse
+  : public _bz_SoAExprBase<_bz_SoAComplexInverse<P_expr1,P_expr2> > {
+public:
+    typedef typename P_expr1::T_tuple T_tuple;
+    typedef typename P_expr1::T_element T_element;
+    typedef typename P_expr1::T_plane T_plane1;
+    typedef typename P_expr2::T_plane T_plane2;
+    typedef typename BzBinaryExprResult<Multiply,T_plane1,T_plane2>::T_result
+        T_product;
+    typedef typename BzBinaryExprResult<Multiply,T_element,T_product>::T_result
+        T_numerator;
+    typedef typename BzBinaryExprResult<Multiply,T_plane2,T_plane2>::T_result
+        T_square;
+    typedef typename BzBinaryExprResult<Add,T_square,T_square>::T_result
+        T_denominator;
+    typedef typename BzBinaryExprResult<Divide,T_numerator,
+        T_denominator>::T_result T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = true;
+
+    _bz_SoAComplexInverse(const P_expr1& a, const P_expr2& b)
+      : a_(a), b_(b)
+    { }
+
+    T_plane plane(int c) const
+    {
+        const T_element sign = c ? -1 : 1;
+        return _bz_SoAPlaneOp<Divide>(
+            _bz_SoAPlaneOp<Multiply>(sign,
+                _bz_SoAPlaneOp<Multiply>(a_.plane(c), b_.plane(c))),
+            _bz_SoAPlaneOp<Add>(
+                _bz_SoAPlaneOp<Multiply>(b_.plane(0), b_.plane(0)),
+                _bz_SoAPlaneOp<Multiply>(b_.plane(1), b_.plane(1))));
+    }
+
+private:
+    P_expr1 a_;
+    P_expr2 b_;
+};
+
+// (a0, -a1)
+template<typename P_expr>
+class _bz_SoAComplexConj
+  : public _bz_SoAExprBase<_bz_SoAComplexConj<P_expr> > {
+public:
+    typedef typename P_expr::T_tuple T_tuple;
+    typedef typename P_expr::T_element T_element;
+    typedef typename P_expr::T_plane T_plane1;
+    typedef typename BzBinaryExprResult<Multiply,T_element,T_plane1>::T_result
+        T_plane;
+    static const bool isBroadcast = false;
+    static const bool mixesPlanes = P_expr::mixesPlanes;
+
+    _bz_SoAComplexConj(const P_expr& a)
+      : a_(a)
+    { }
+
+    T_plane plane(int c) const
+    {
+        const T_element sign = c ? -1 : 1;
+        return _bz_SoAPlaneOp<Multiply>(sign, a_.plane(c));
+    }
+
+private:
+    P_expr a_;
+};
+
+#endif // BZ_HAVE_COMPLEX
+
+template<typename T>
+struct _bz_SoAIsComplex {
+    static const bool value = false;
+};
+
+#ifdef BZ_HAVE_COMPLEX
+template<typename T>
+struct _bz_SoAIsComplex<complex<T> > {
+    static const bool value = true;
+};
+#endif
+
+template<bool, typename T_true, typename T_false>
+struct _bz_SoASelect {
+    typedef T_true T_result;
+};
+
+template<typename T_true, typename T_false>
+struct _bz_SoASelect<false,T_true,T_false> {
+    typedef T_false T_result;
+};
+
+// The node for a OP b: componentwise unless both operands are complex
+template<typename P_expr1, typename P_expr2,
+         template<typename T1, typename T2> class OP>
+struct _bz_SoABinaryResult {
+    typedef _bz_SoAExprBinaryOp<P_expr1,P_expr2,OP> T_result;
+};
+
+#ifdef BZ_HAVE_COMPLEX
+
+template<typename P_expr1, typename P_expr2>
+struct _bz_SoABinaryResult<P_expr1,P_expr2,Multiply> {
+    static const bool isComplex =
+        _bz_SoAIsComplex<typename P_expr1::T_tuple>::value
+        && !P_expr1::isBroadcast && !P_expr2::isBroadcast;
+    typedef typename _bz_SoASelect<isComplex,
+        _bz_SoAComplexMultiply<P_expr1,P_expr2>,
+        _bz_SoAExprBinaryOp<P_expr1,P_expr2,Multiply> >::T_result T_result;
+};
+
+template<typename P_expr1, typename P_expr2>
+struct _bz_SoABinaryResult<P_expr1,P_expr2,Divide> {
+    static const bool isComplex =
+        _bz_SoAIsComplex<typename P_expr1::T_tuple>::value
+        && !P_expr2::isBroadcast;
+    typedef typename _bz_SoASelect<isComplex,
+        typename _bz_SoASelect<P_expr1::isBroadcast,
+            _bz_SoAComplexInverse<P_expr1,P_expr2>,
+            _bz_SoAComplexDivide<P_expr1,P_expr2> >::T_result,
+        _bz_SoAExprBinaryOp<P_expr1,P_expr2,Divide> >::T_result T_result;
+};
+
+#endif // BZ_HAVE_COMPLEX
+
+// Scalar operands: the same in every plane, except that a real added
+// to a complex array only changes the real plane
+template<typename P_tuple, template<typename T1, typename T2> class OP>
+struct _bz_SoAScalar {
+    typedef _bz_SoAExprConstant<P_tuple> T_expr;
+};
+
+#ifdef BZ_HAVE_COMPLEX
+
+template<typename T>
+struct _bz_SoAScalar<complex<T>,Add> {
+    typedef _bz_SoAExprTupleConstant<complex<T> > T_expr;
+};
+
+template<typename T>
+struct _bz_SoAScalar<complex<T>,Subtract> {
+    typedef _bz_SoAExprTupleConstant<complex<T> > T_expr;
+};
+
+#endif // BZ_HAVE_COMPLEX
+
+#define BZ_SOA_OPERAND(T) typename _bz_SoAOperand<T>::T_expr
+#define BZ_SOA_SCALAR(T, functor)                                         \
+    typename _bz_SoAScalar<typename T::T_tuple, functor>::T_expr
+#define BZ_SOA_BROADCAST(T) _bz_SoAExprBroadcast<typename T::T_tuple, N_rank>
+#define BZ_SOA_RESULT(T1, T2, functor)                                    \
+    typename _bz_SoABinaryResult<T1, T2, functor>::T_result
+
+#define BZ_DECLARE_SOA_BINARY_OP(name, functor)                           \
+template<typename T1, typename T2>                                        \
+inline BZ_SOA_RESULT(BZ_SOA_OPERAND(T1), BZ_SOA_OPERAND(T2), functor)     \
+name(const _bz_SoAExprBase<T1>& a, const _bz_SoAExprBase<T2>& b)          \
+{                                                                         \
+    return BZ_SOA_RESULT(BZ_SOA_OPERAND(T1), BZ_SOA_OPERAND(T2),          \
+        functor)(_bz_SoAOperand<T1>::get(a.unwrap()),                     \
+                 _bz_SoAOperand<T2>::get(b.unwrap()));                    \
+}                                                                         \
+                                                                          \
+template<typename T1>                                                     \
+inline BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),                                  \
+    BZ_SOA_SCALAR(T1, functor), functor)                   \
+name(const _bz_SoAExprBase<T1>& a, typename T1::T_element b)              \
+{                                                                         \
+    return BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),                              \
+        BZ_SOA_SCALAR(T1, functor), functor)(              \
+        _bz_SoAOperand<T1>::get(a.unwrap()),                              \
+        BZ_SOA_SCALAR(T1, functor)(b));                    \
+}                                                                         \
+                                                                          \
+template<typename T2>                                                     \
+inline BZ_SOA_RESULT(BZ_SOA_SCALAR(T2, functor),           \
+    BZ_SOA_OPERAND(T2), functor)                                          \
+name(typename T2::T_element a, const _bz_SoAExprBase<T2>& b)              \
+{                                                                         \
+    return BZ_SOA_RESULT(BZ_SOA_SCALAR(T2, functor),       \
+        BZ_SOA_OPERAND(T2), functor)(                                     \
+        BZ_SOA_SCALAR(T2, functor)(a),                     \
+        _bz_SoAOperand<T2>::get(b.unwrap()));                             \
+}                                                                         \
+                                                                          \
+template<typename T1>                                                     \
+inline BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),                                  \
+    _bz_SoAExprTupleConstant<typename T1::T_tuple>, functor)              \
+name(const _bz_SoAExprBase<T1>& a, const typename T1::T_tuple& b)         \
+{                                                                         \
+    return BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),                              \
+        _bz_SoAExprTupleConstant<typename T1::T_tuple>, functor)(         \
+        _bz_SoAOperand<T1>::get(a.unwrap()),                              \
+        _bz_SoAExprTupleConstant<typename T1::T_tuple>(b));               \
+}                                                                         \
+                                                                          \
+template<typename T2>                                                     \
+inline BZ_SOA_RESULT(_bz_SoAExprTupleConstant<typename T2::T_tuple>,      \
+    BZ_SOA_OPERAND(T2), functor)                                          \
+name(const typename T2::T_tuple& a, const _bz_SoAExprBase<T2>& b)         \
+{                                                                         \
+    return BZ_SOA_RESULT(_bz_SoAExprTupleConstant<typename T2::T_tuple>,  \
+        BZ_SOA_OPERAND(T2), functor)(                                     \
+        _bz_SoAExprTupleConstant<typename T2::T_tuple>(a),                \
+        _bz_SoAOperand<T2>::get(b.unwrap()));                             \
+}
+
+BZ_DECLARE_SOA_BINARY_OP(operator+, Add)
+BZ_DECLARE_SOA_BINARY_OP(operator-, Subtract)
+BZ_DECLARE_SOA_BINARY_OP(operator*, Multiply)
+BZ_DECLARE_SOA_BINARY_OP(operator/, Divide)
+
+// Scaling by an ordinary array of elements: the same array multiplies
+// or divides every plane.
+template<typename T1, int N_rank>
+inline BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),
+    BZ_SOA_BROADCAST(T1), Multiply)
+operator*(const _bz_SoAExprBase<T1>& a,
+    const Array<typename T1::T_element,N_rank>& b)
+{
+    return BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),
+        BZ_SOA_BROADCAST(T1),
+        Multiply)(_bz_SoAOperand<T1>::get(a.unwrap()),
+        BZ_SOA_BROADCAST(T1)(b));
+}
+
+template<typename T2, int N_rank>
+inline BZ_SOA_RESULT(
+    BZ_SOA_BROADCAST(T2),
+    BZ_SOA_OPERAND(T2), Multiply)
+operator*(const Array<typename T2::T_element,N_rank>& a,
+    const _bz_SoAExprBase<T2>& b)
+{
+    return BZ_SOA_RESULT(
+        BZ_SOA_BROADCAST(T2),
+        BZ_SOA_OPERAND(T2), Multiply)(
+        BZ_SOA_BROADCAST(T2)(a),
+        _bz_SoAOperand<T2>::get(b.unwrap()));
+}
+
+template<typename T1, int N_rank>
+inline BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),
+    BZ_SOA_BROADCAST(T1), Divide)
+operator/(const _bz_SoAExprBase<T1>& a,
+    const Array<typename T1::T_element,N_rank>& b)
+{
+    return BZ_SOA_RESULT(BZ_SOA_OPERAND(T1),
+        BZ_SOA_BROADCAST(T1),
+        Divide)(_bz_SoAOperand<T1>::get(a.unwrap()),
+        BZ_SOA_BROADCAST(T1)(b));
+}
+
+#ifdef BZ_HAVE_COMPLEX
+
+// Split-complex arrays: real() and imag() are the planes themselves, so
+// these are views without copies or strides.
+template<typename T_numtype, int N_rank>
+inline Array<T_numtype,N_rank> real(
+    const SoAArray<complex<T_numtype>,N_rank>& A)
+{
+    return A.plane(0);
+}
+
+template<typename T_numtype, int N_rank>
+inline Array<T_numtype,N_rank> imag(
+    const SoAArray<complex<T_numtype>,N_rank>& A)
+{
+    return A.plane(1);
+}
+
+template<typename T>
+inline _bz_SoAComplexConj<BZ_SOA_OPERAND(T)> conj(
+    const _bz_SoAExprBase<T>& a)
+{
+    return _bz_SoAComplexConj<BZ_SOA_OPERAND(T)>(
+        _bz_SoAOperand<T>::get(a.unwrap()));
+}
+
+// |a|^2 as an ordinary Array expression, e.g. for sum(norm(A))
+template<typename T_plane>
+struct _bz_SoANormResult {
+    typedef typename BzBinaryExprResult<Multiply,T_plane,T_plane>::T_result
+        T_square;
+    typedef typename BzBinaryExprResult<Add,T_square,T_square>::T_result
+        T_result;
+};
+
+template<typename T>
+inline typename _bz_SoANormResult<
+    typename _bz_SoAOperand<T>::T_expr::T_plane>::T_result
+norm(const _bz_SoAExprBase<T>& a)
+{
+    typename _bz_SoAOperand<T>::T_expr x = _bz_SoAOperand<T>::get(a.unwrap());
+    return _bz_SoAPlaneOp<Add>(
+        _bz_SoAPlaneOp<Multiply>(x.plane(0), x.plane(0)),
+        _bz_SoAPlaneOp<Multiply>(x.plane(1), x.plane(1)));
+}
+
+#endif // BZ_HAVE_COMPLEX
+
+#undef BZ_SOA_OPERAND
+#undef BZ_SOA_SCALAR
+#undef BZ_SOA_BROADCAST
+#undef BZ_SOA_RESULT
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_SOA_H
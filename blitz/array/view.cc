@@ -0,0 +1,264 @@
+/***************************************************************************
+ * blitz/array/view.cc  Non-owning views of array data
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_VIEW_CC
+#define BZ_ARRAY_VIEW_CC
+
+#ifndef BZ_ARRAY_VIEW_H
+ #error <blitz/array/view.cc> must be included via <blitz/array/view.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+template<typename P_numtype, int N_rank, typename P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::ArrayView(T_numtype* dataFirst,
+    const TinyVector<int,N_rank>& extent)
+  : data_(dataFirst)
+{
+    diffType stride = 1;
+    for (int r=N_rank-1; r >= 0; --r)
+    {
+        base_[r] = 0;
+        extent_[r] = extent(r);
+        setStride(r, stride);
+        stride *= extent(r);
+    }
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+TinyVector<int,N_rank> ArrayView<P_numtype,N_rank,P_stride>::lbound() const
+{
+    TinyVector<int,N_rank> x;
+    for (int r=0; r < N_rank; ++r)
+        x(r) = base_[r];
+    return x;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+TinyVector<int,N_rank> ArrayView<P_numtype,N_rank,P_stride>::ubound() const
+{
+    TinyVector<int,N_rank> x;
+    for (int r=0; r < N_rank; ++r)
+        x(r) = ubound(r);
+    return x;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+TinyVector<int,N_rank> ArrayView<P_numtype,N_rank,P_stride>::extent() const
+{
+    TinyVector<int,N_rank> x;
+    for (int r=0; r < N_rank; ++r)
+        x(r) = extent_[r];
+    return x;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+TinyVector<diffType,N_rank> ArrayView<P_numtype,N_rank,P_stride>::stride()
+    const
+{
+    TinyVector<diffType,N_rank> x;
+    for (int r=0; r < N_rank; ++r)
+        x(r) = stride_[r];
+    return x;
+}
+
+/*
+ * Subviews.  A Range keeps the base of the rank, as Array::slice() does,
+ * so that element base of the subview is element r.first() of the view.
+ */
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<int N_rank2>
+void ArrayView<P_numtype,N_rank,P_stride>::slice(int& setRank, Range r,
+    ArrayView<T_numtype,N_rank2,P_stride>& view, int sourceRank) const
+{
+    const int first = r.first(lbound(sourceRank)),
+        last = r.last(ubound(sourceRank));
+    const diffType stride = r.stride();
+
+    BZPRECHECK((first >= lbound(sourceRank)) && (first <= ubound(sourceRank))
+        && (last >= lbound(sourceRank)) && (last <= ubound(sourceRank)),
+        "ArrayView subview out of range: " << r << " in rank "
+        << sourceRank);
+
+    view.base_[setRank] = base_[sourceRank];
+    view.extent_[setRank] = int((last - first) / stride + 1);
+    view.setStride(setRank, stride_[sourceRank] * stride);
+    view.data_ += (first - base_[sourceRank] * stride) * stride_[sourceRank];
+    ++setRank;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<int N_rank2>
+void ArrayView<P_numtype,N_rank,P_stride>::slice(int&, int i,
+    ArrayView<T_numtype,N_rank2,P_stride>& view, int sourceRank) const
+{
+    BZPRECHECK((i >= lbound(sourceRank)) && (i <= ubound(sourceRank)),
+        "ArrayView subview out of range: " << i << " in rank "
+        << sourceRank);
+
+    view.data_ += i * stride_[sourceRank];
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+ArrayView<P_numtype,N_rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(
+    const RectDomain<N_rank>& subdomain) const
+{
+    T_view view;
+    view.data_ = data_;
+    int setRank = 0;
+    for (int r=0; r < N_rank; ++r)
+        slice(setRank, Range(subdomain.lbound(r), subdomain.ubound(r)),
+            view, r);
+    return view;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+ArrayView<P_numtype,N_rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(
+    const StridedDomain<N_rank>& subdomain) const
+{
+    T_view view;
+    view.data_ = data_;
+    int setRank = 0;
+    for (int r=0; r < N_rank; ++r)
+        slice(setRank, Range(subdomain.lbound(r), subdomain.ubound(r),
+            subdomain.stride(r)), view, r);
+    return view;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<typename T1>
+ArrayView<P_numtype,SliceInfo<P_numtype,T1>::rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(T1 r1) const
+{
+    BZPRECONDITION(N_rank == 1);
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1>::rank,P_stride> view;
+    view.data_ = data_;
+    int setRank = 0;
+    slice(setRank, r1, view, 0);
+    return view;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<typename T1, typename T2>
+ArrayView<P_numtype,SliceInfo<P_numtype,T1,T2>::rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(T1 r1, T2 r2) const
+{
+    BZPRECONDITION(N_rank == 2);
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2>::rank,P_stride> view;
+    view.data_ = data_;
+    int setRank = 0;
+    slice(setRank, r1, view, 0);
+    slice(setRank, r2, view, 1);
+    return view;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<typename T1, typename T2, typename T3>
+ArrayView<P_numtype,SliceInfo<P_numtype,T1,T2,T3>::rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(T1 r1, T2 r2, T3 r3) const
+{
+    BZPRECONDITION(N_rank == 3);
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2,T3>::rank,P_stride> view;
+    view.data_ = data_;
+    int setRank = 0;
+    slice(setRank, r1, view, 0);
+    slice(setRank, r2, view, 1);
+    slice(setRank, r3, view, 2);
+    return view;
+}
+
+template<typename P_numtype, int N_rank, typename P_stride>
+template<typename T1, typename T2, typename T3, typename T4>
+ArrayView<P_numtype,SliceInfo<P_numtype,T1,T2,T3,T4>::rank,P_stride>
+ArrayView<P_numtype,N_rank,P_stride>::operator()(T1 r1, T2 r2, T3 r3,
+    T4 r4) const
+{
+    BZPRECONDITION(N_rank == 4);
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2,T3,T4>::rank,P_stride> view;
+    view.data_ = data_;
+    int setRank = 0;
+    slice(setRank, r1, view, 0);
+    slice(setRank, r2, view, 1);
+    slice(setRank, r3, view, 2);
+    slice(setRank, r4, view, 3);
+    return view;
+}
+
+/*
+ * The Array is built on the element at the lowest address, with the
+ * ranks whose stride is negative stored descending, and the ranks ordered
+ * by the size of their strides, so that it finds the same element
+ * (0,...,0) and the same layout as the view.  Its memory policy is
+ * neverDeleteData, so it has no MemoryBlock to count references in.
+ */
+
+template<typename P_numtype, int N_rank, typename P_stride>
+Array<P_numtype,N_rank> ArrayView<P_numtype,N_rank,P_stride>::asArray() const
+{
+    GeneralArrayStorage<N_rank> storage;
+    T_numtype* dataFirst = data_;
+    TinyVector<int,N_rank> extent;
+    TinyVector<diffType,N_rank> stride;
+
+    for (int r=0; r < N_rank; ++r)
+    {
+        extent(r) = extent_[r];
+        stride(r) = stride_[r];
+        storage.setBase(r, base_[r]);
+        storage.ascendingFlag()(r) = (stride_[r] >= 0);
+        if (stride_[r] >= 0)
+            dataFirst += base_[r] * stride(r);
+        else
+            dataFirst += (base_[r] + extent_[r] - 1) * stride(r);
+    }
+
+    // Smallest stride first; on ties, the last rank first, as in C
+    for (int i=0; i < N_rank; ++i)
+    {
+        int r = N_rank - 1 - i;
+        int j = i;
+        for (; j > 0; --j)
+        {
+            const int q = storage.ordering()(j-1);
+            if (std::abs(stride(q)) <= std::abs(stride(r)))
+                break;
+            storage.ordering()(j) = q;
+        }
+        storage.ordering()(j) = r;
+    }
+
+    return T_array(dataFirst, extent, stride, neverDeleteData, storage);
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_ARRAY_VIEW_CC
@@ -0,0 +1,379 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/array/view.h  Non-owning views of array data
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_ARRAY_VIEW_H
+#define BZ_ARRAY_VIEW_H
+
+#ifndef BZ_ARRAY_H
+ #error <blitz/array/view.h> must be included via <blitz/array.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+/*
+ * An ArrayView refers to the elements of an Array, or of any strided block
+ * of memory, without owning them.  It holds only a pointer, and the
+ * bases, extents and strides of its ranks, so it can be copied with
+ * memcpy, and making one, or a subview of one, never touches a reference
+ * count.  The strides are stored as P_stride, which may be int to make
+ * the view smaller when no stride exceeds the range of an int.
+ *
+ *   Array<double,3> A(nx,ny,nz);
+ *   ArrayView<double,3> v(A);
+ *   for (int i=0; i < nx; ++i)
+ *       for (int j=0; j < ny; ++j)
+ *       {
+ *           ArrayView<double,1> pencil = v(i, j, Range::all());
+ *           pencil = pencil * 2 + 1;
+ *       }
+ *
+ * A view may appear anywhere an Array may appear in an expression, and
+ * an expression may be assigned to it.  asArray(), or the conversion to
+ * Array, gives an Array sharing the elements, with no reference count,
+ * for functions that take Arrays.  Assigning one view to another of the
+ * same type, however, copies the view, like a pointer, and not the
+ * elements; use assign() for that.  The view must not outlive the data:
+ * nothing keeps it alive.
+ */
+
+template<typename P_numtype, int N_rank, typename P_stride = diffType>
+class ArrayView
+#ifdef BZ_NEW_EXPRESSION_TEMPLATES
+    : public ETBase<ArrayView<P_numtype,N_rank,P_stride> >
+#endif
+{
+public:
+    typedef P_numtype                        T_numtype;
+    typedef P_stride                         T_stride;
+    typedef Array<P_numtype,N_rank>          T_array;
+    typedef ArrayView<P_numtype,N_rank,P_stride> T_view;
+
+    static const int rank = N_rank;
+
+    ArrayView()
+      : data_(0)
+    {
+        for (int r=0; r < N_rank; ++r)
+        {
+            base_[r] = 0;
+            extent_[r] = 0;
+            stride_[r] = 0;
+        }
+    }
+
+    ArrayView(const T_array& array)
+      : data_(const_cast<T_numtype*>(array.dataZero()))
+    {
+        for (int r=0; r < N_rank; ++r)
+        {
+            base_[r] = array.base(r);
+            extent_[r] = array.extent(r);
+            setStride(r, array.stride(r));
+        }
+    }
+
+    // A view of memory in which element (0,...,0) is at dataFirst
+    ArrayView(T_numtype* dataFirst, const TinyVector<int,N_rank>& extent,
+        const TinyVector<diffType,N_rank>& stride)
+      : data_(dataFirst)
+    {
+        for (int r=0; r < N_rank; ++r)
+        {
+            base_[r] = 0;
+            extent_[r] = extent(r);
+            setStride(r, stride(r));
+        }
+    }
+
+    // As above, with element (0,...,0) at dataFirst laid out in the C
+    // storage order
+    ArrayView(T_numtype* dataFirst, const TinyVector<int,N_rank>& extent);
+
+    //////////////////////////////////////////////
+    // Shape and storage
+    //////////////////////////////////////////////
+
+    int lbound(int r) const
+    { return base_[r]; }
+
+    int ubound(int r) const
+    { return base_[r] + extent_[r] - 1; }
+
+    int extent(int r) const
+    { return extent_[r]; }
+
+    int base(int r) const
+    { return base_[r]; }
+
+    diffType stride(int r) const
+    { return stride_[r]; }
+
+    TinyVector<int,N_rank> lbound() const;
+    TinyVector<int,N_rank> ubound() const;
+    TinyVector<int,N_rank> extent() const;
+    TinyVector<int,N_rank> shape() const
+    { return extent(); }
+    TinyVector<diffType,N_rank> stride() const;
+
+    RectDomain<N_rank> domain() const
+    { return RectDomain<N_rank>(lbound(), ubound()); }
+
+    sizeType numElements() const
+    {
+        sizeType n = 1;
+        for (int r=0; r < N_rank; ++r)
+            n *= extent_[r];
+        return n;
+    }
+
+    // The first element, and element (0,...,0), which need not be in the
+    // view
+    T_numtype* data() const
+    {
+        T_numtype* p = data_;
+        for (int r=0; r < N_rank; ++r)
+            p += base_[r] * stride_[r];
+        return p;
+    }
+
+    T_numtype* dataZero() const
+    { return data_; }
+
+    bool isInRange(const TinyVector<int,N_rank>& index) const
+    {
+        for (int r=0; r < N_rank; ++r)
+            if ((index(r) < base_[r]) || (index(r) - base_[r] >= extent_[r]))
+                return false;
+        return true;
+    }
+
+    //////////////////////////////////////////////
+    // Elements
+    //////////////////////////////////////////////
+
+    T_numtype& operator()(int i0) const
+    {
+        BZPRECHECK(isInRange(TinyVector<int,1>(i0)),
+            "ArrayView index out of range: " << i0);
+        return data_[i0 * stride_[0]];
+    }
+
+    T_numtype& operator()(int i0, int i1) const
+    {
+        BZPRECHECK(isInRange(TinyVector<int,2>(i0, i1)),
+            "ArrayView index out of range: (" << i0 << ", " << i1 << ")");
+        return data_[i0 * stride_[0] + i1 * stride_[1]];
+    }
+
+    T_numtype& operator()(int i0, int i1, int i2) const
+    {
+        BZPRECHECK(isInRange(TinyVector<int,3>(i0, i1, i2)),
+            "ArrayView index out of range: (" << i0 << ", " << i1 << ", "
+            << i2 << ")");
+        return data_[i0 * stride_[0] + i1 * stride_[1] + i2 * stride_[2]];
+    }
+
+    T_numtype& operator()(int i0, int i1, int i2, int i3) const
+    {
+        BZPRECHECK(isInRange(TinyVector<int,4>(i0, i1, i2, i3)),
+            "ArrayView index out of range: (" << i0 << ", " << i1 << ", "
+            << i2 << ", " << i3 << ")");
+        return data_[i0 * stride_[0] + i1 * stride_[1] + i2 * stride_[2]
+            + i3 * stride_[3]];
+    }
+
+    T_numtype& operator()(const TinyVector<int,N_rank>& index) const
+    {
+        BZPRECHECK(isInRange(index), "ArrayView index out of range: "
+            << index);
+        diffType offset = 0;
+        for (int r=0; r < N_rank; ++r)
+            offset += index(r) * stride_[r];
+        return data_[offset];
+    }
+
+    //////////////////////////////////////////////
+    // Subviews
+    //////////////////////////////////////////////
+
+    // The elements in a domain, keeping the bases
+    T_view operator()(const RectDomain<N_rank>& subdomain) const;
+    T_view operator()(const StridedDomain<N_rank>& subdomain) const;
+
+    // A mixture of Ranges, which keep their rank, and ints, which drop it
+    template<typename T1>
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1>::rank,P_stride>
+    operator()(T1 r1) const;
+
+    template<typename T1, typename T2>
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2>::rank,P_stride>
+    operator()(T1 r1, T2 r2) const;
+
+    template<typename T1, typename T2, typename T3>
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2,T3>::rank,P_stride>
+    operator()(T1 r1, T2 r2, T3 r3) const;
+
+    template<typename T1, typename T2, typename T3, typename T4>
+    ArrayView<T_numtype,SliceInfo<T_numtype,T1,T2,T3,T4>::rank,P_stride>
+    operator()(T1 r1, T2 r2, T3 r3, T4 r4) const;
+
+    //////////////////////////////////////////////
+    // Assignment
+    //////////////////////////////////////////////
+
+    // An Array sharing the elements, without a reference count, through
+    // which expressions read and write the view
+    T_array asArray() const;
+
+    operator T_array() const
+    { return asArray(); }
+
+    template<typename T_expr>
+    T_view& operator=(const ETBase<T_expr>& expr)
+    {
+        T_array array(asArray());
+        array = expr;
+        return *this;
+    }
+
+    T_view& operator=(T_numtype x)
+    {
+        T_array array(asArray());
+        array = x;
+        return *this;
+    }
+
+    // Copies the elements of another view
+    template<typename P_stride2>
+    void assign(const ArrayView<T_numtype,N_rank,P_stride2>& x) const
+    {
+        T_array array(asArray());
+        array = x.asArray();
+    }
+
+#define BZ_ARRAY_VIEW_UPDATE(op)                                        \
+    template<typename T_expr>                                           \
+    T_view& operator op(const ETBase<T_expr>& expr)                     \
+    {                                                                   \
+        T_array array(asArray());                                       \
+        array op expr.unwrap();                                         \
+        return *this;                                                   \
+    }                                                                   \
+                                                                        \
+    T_view& operator op(T_numtype x)                                    \
+    {                                                                   \
+        T_array array(asArray());                                       \
+        array op x;                                                     \
+        return *this;                                                   \
+    }
+
+    BZ_ARRAY_VIEW_UPDATE(+=)
+    BZ_ARRAY_VIEW_UPDATE(-=)
+    BZ_ARRAY_VIEW_UPDATE(*=)
+    BZ_ARRAY_VIEW_UPDATE(/=)
+
+#undef BZ_ARRAY_VIEW_UPDATE
+
+    // Used by the subviews of views of other ranks
+    template<typename, int, typename> friend class ArrayView;
+
+private:
+    void setStride(int r, diffType stride)
+    {
+        stride_[r] = T_stride(stride);
+        BZPRECHECK(diffType(stride_[r]) == stride,
+            "ArrayView stride " << stride << " does not fit its stride type");
+    }
+
+    template<int N_rank2>
+    void slice(int& setRank, Range r,
+        ArrayView<T_numtype,N_rank2,P_stride>& view, int sourceRank) const;
+
+    template<int N_rank2>
+    void slice(int& setRank, int i,
+        ArrayView<T_numtype,N_rank2,P_stride>& view, int sourceRank) const;
+
+    template<int N_rank2>
+    void slice(int&, nilArraySection,
+        ArrayView<T_numtype,N_rank2,P_stride>&, int) const
+    { }
+
+    T_numtype* data_;              // element (0,...,0)
+    int base_[N_rank];
+    int extent_[N_rank];
+    T_stride stride_[N_rank];
+};
+
+//  A view in an expression is read through an Array sharing its elements
+
+template<typename T, int N, typename S>
+struct asExpr<ArrayView<T,N,S> > {
+    typedef FastArrayCopyIterator<T,N> T_expr;
+    static T_expr getExpr(const ArrayView<T,N,S>& x)
+    { return T_expr(x.asArray()); }
+};
+
+// The complete reductions take Arrays and expressions by type, so views
+// need their own
+
+#define BZ_DECL_ARRAY_VIEW_FULL_REDUCE(fn,reduction)                    \
+template<typename T_numtype, int N_rank, typename T_stride>             \
+inline                                                                  \
+_bz_typename reduction<T_numtype>::T_resulttype                         \
+fn(const ArrayView<T_numtype,N_rank,T_stride>& view)                    \
+{                                                                       \
+    return _bz_ArrayExprFullReduce(view.asArray().beginFast(),          \
+        reduction<T_numtype>());                                        \
+}
+
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(sum,      ReduceSum)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(mean,     ReduceMean)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE((min),    ReduceMin)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE((max),    ReduceMax)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE((minmax), ReduceMinMax)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(product,  ReduceProduct)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(count,    ReduceCount)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(any,      ReduceAny)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(all,      ReduceAll)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(first,    ReduceFirst)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(last,     ReduceLast)
+BZ_DECL_ARRAY_VIEW_FULL_REDUCE(variance, ReduceVariance)
+
+#undef BZ_DECL_ARRAY_VIEW_FULL_REDUCE
+
+template<typename T, int N, typename S>
+ostream& operator<<(ostream& os, const ArrayView<T,N,S>& x)
+{ return os << x.asArray(); }
+
+BZ_NAMESPACE_END
+
+#include <blitz/array/view.cc>
+
+#endif // BZ_ARRAY_VIEW_H
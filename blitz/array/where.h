@@ -37,6 +37,90 @@
 
 BZ_NAMESPACE(blitz)
 
+// Types for which where(X,Y,Z) evaluates both Y and Z and then selects
+// one, without a branch, so the loop can be vectorized with blends.
+// This is only safe when computing the unused value cannot trap, which
+// rules out integers (where(b != 0, a / b, 0)).
+template<typename T>
+struct _bz_whereBlend {
+    static const bool value = false;
+};
+
+#ifndef BZ_DISABLE_WHERE_BLEND
+template<> struct _bz_whereBlend<float> { static const bool value = true; };
+template<> struct _bz_whereBlend<double> { static const bool value = true; };
+template<> struct _bz_whereBlend<long double>
+{ static const bool value = true; };
+#endif
+
+// Whether every node of a branch, operands and operations alike, is of
+// such a type: cast<double>(a / b) of integers is not.  Other kinds of
+// nodes (index placeholders, mappings, reductions, ...) are not blended.
+template<typename T_expr>
+struct _bz_whereBlendExpr {
+    static const bool value = false;
+};
+
+template<typename T, int N>
+struct _bz_whereBlendExpr<FastArrayIterator<T,N> > {
+    static const bool value = _bz_whereBlend<T>::value;
+};
+
+template<typename T, int N>
+struct _bz_whereBlendExpr<FastArrayCopyIterator<T,N> > {
+    static const bool value = _bz_whereBlend<T>::value;
+};
+
+template<typename T>
+struct _bz_whereBlendExpr<_bz_ArrayExprConstant<T> > {
+    static const bool value = _bz_whereBlend<T>::value;
+};
+
+template<typename T_expr>
+struct _bz_whereBlendExpr<_bz_ArrayExpr<T_expr> > {
+    static const bool value = _bz_whereBlendExpr<T_expr>::value;
+};
+
+template<typename T_expr, typename T_op>
+struct _bz_whereBlendExpr<_bz_ArrayExprUnaryOp<T_expr,T_op> > {
+    static const bool value = _bz_whereBlend<_bz_typename
+        _bz_ArrayExprUnaryOp<T_expr,T_op>::T_numtype>::value
+        && _bz_whereBlendExpr<T_expr>::value;
+};
+
+template<typename T_expr1, typename T_expr2, typename T_op>
+struct _bz_whereBlendExpr<_bz_ArrayExprBinaryOp<T_expr1,T_expr2,T_op> > {
+    static const bool value = _bz_whereBlend<_bz_typename
+        _bz_ArrayExprBinaryOp<T_expr1,T_expr2,T_op>::T_numtype>::value
+        && _bz_whereBlendExpr<T_expr1>::value
+        && _bz_whereBlendExpr<T_expr2>::value;
+};
+
+template<typename T_expr1, typename T_expr2, typename T_expr3,
+    typename T_op>
+struct _bz_whereBlendExpr<
+    _bz_ArrayExprTernaryOp<T_expr1,T_expr2,T_expr3,T_op> > {
+    static const bool value = _bz_whereBlend<_bz_typename
+        _bz_ArrayExprTernaryOp<T_expr1,T_expr2,T_expr3,
+            T_op>::T_numtype>::value
+        && _bz_whereBlendExpr<T_expr1>::value
+        && _bz_whereBlendExpr<T_expr2>::value
+        && _bz_whereBlendExpr<T_expr3>::value;
+};
+
+template<typename T_expr1, typename T_expr2, typename T_expr3,
+    typename T_expr4, typename T_op>
+struct _bz_whereBlendExpr<
+    _bz_ArrayExprQuaternaryOp<T_expr1,T_expr2,T_expr3,T_expr4,T_op> > {
+    static const bool value = _bz_whereBlend<_bz_typename
+        _bz_ArrayExprQuaternaryOp<T_expr1,T_expr2,T_expr3,T_expr4,
+            T_op>::T_numtype>::value
+        && _bz_whereBlendExpr<T_expr1>::value
+        && _bz_whereBlendExpr<T_expr2>::value
+        && _bz_whereBlendExpr<T_expr3>::value
+        && _bz_whereBlendExpr<T_expr4>::value;
+};
+
 template<typename P_expr1, typename P_expr2, typename P_expr3>
 class _bz_ArrayWhere {
 
@@ -64,6 +148,9 @@ public:
         rank = _bz_meta_max<_bz_meta_max<P_expr1::rank,P_expr2::rank>::max,
                             P_expr3::rank>::max;
 
+    static const bool blend = _bz_whereBlendExpr<T_expr2>::value
+                           && _bz_whereBlendExpr<T_expr3>::value;
+
     _bz_ArrayWhere(const _bz_ArrayWhere<T_expr1,T_expr2,T_expr3>& a)
       : iter1_(a.iter1_), iter2_(a.iter2_), iter3_(a.iter3_)
     { }
@@ -74,11 +161,18 @@ public:
     { }
 
     T_numtype operator*() const
-    { return (*iter1_) ? (*iter2_) : (*iter3_); }
+    {
+        if (blend)
+        {
+            const T_numtype x = *iter2_, y = *iter3_;
+            return (*iter1_) ? x : y;
+        }
+        return (*iter1_) ? T_numtype(*iter2_) : T_numtype(*iter3_);
+    }
 
     template<int N_rank>
     T_numtype operator()(const TinyVector<int, N_rank>& i) const
-    { return iter1_(i) ? iter2_(i) : iter3_(i); }
+    { return iter1_(i) ? T_numtype(iter2_(i)) : T_numtype(iter3_(i)); }
 
     T_range_result operator()(const RectDomain<rank>& d) const
   { return T_range_result(iter1_(d), iter2_(d), iter3_(d)); }
@@ -188,22 +282,37 @@ public:
     T_numtype shift(int offset, int dim) const
     {
       return iter1_.shift(offset, dim) ? 
-	iter2_.shift(offset, dim) : 
-	iter3_.shift(offset, dim);
+	T_numtype(iter2_.shift(offset, dim)) : 
+	T_numtype(iter3_.shift(offset, dim));
     }
 
     T_numtype shift(int offset1, int dim1,int offset2, int dim2) const
     {
       return iter1_.shift(offset1, dim1, offset2, dim2) ? 
-	iter2_.shift(offset1, dim1, offset2, dim2) : 
-	iter3_.shift(offset1, dim1, offset2, dim2);
+	T_numtype(iter2_.shift(offset1, dim1, offset2, dim2)) : 
+	T_numtype(iter3_.shift(offset1, dim1, offset2, dim2));
     }
 
     T_numtype operator[](int i) const
-    { return iter1_[i] ? iter2_[i] : iter3_[i]; }
+    {
+        if (blend)
+        {
+            const T_numtype x = iter2_[i], y = iter3_[i];
+            return iter1_[i] ? x : y;
+        }
+        return iter1_[i] ? T_numtype(iter2_[i]) : T_numtype(iter3_[i]);
+    }
 
     T_numtype fastRead(int i) const
-    { return iter1_.fastRead(i) ? iter2_.fastRead(i) : iter3_.fastRead(i); }
+    {
+        if (blend)
+        {
+            const T_numtype x = iter2_.fastRead(i), y = iter3_.fastRead(i);
+            return iter1_.fastRead(i) ? x : y;
+        }
+        return iter1_.fastRead(i) ? T_numtype(iter2_.fastRead(i))
+            : T_numtype(iter3_.fastRead(i));
+    }
 
   // this is needed for the stencil expression fastRead to work
   void _bz_offsetData(sizeType i)
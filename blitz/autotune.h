@@ -0,0 +1,308 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/autotune.h   Measure the tuning parameters of this machine
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+/*
+ * autoTune() times array evaluations on this machine and leaves the
+ * fastest settings in TuningParameters::instance():
+ *
+ *   - the tile height and width of 2D stencils, on arrays much larger
+ *     than the L2 cache;
+ *   - the cache a stencil may use before it is tiled, from the shortest
+ *     rows from which the tiled traversal is 5% faster than the stack
+ *     traversal;
+ *   - the order and size of the tiles of 3D stencils, or that they are
+ *     not tiled if no tiling is 5% faster than the stack traversal;
+ *   - with OpenMP, the number of elements from which a parallel loop is
+ *     faster than a serial one.
+ *
+ * It takes some seconds.  Progress is written to the log, if one is
+ * given.  To keep the results, save the parameters as the tuning file:
+ *
+ *   autoTune(&cout);
+ *   TuningParameters::instance().save(TuningParameters::defaultFile());
+ *
+ * which is what benchmarks/autotune does.
+ */
+
+#ifndef BZ_AUTOTUNE_H
+#define BZ_AUTOTUNE_H
+
+#ifndef BZ_ARRAY_H
+ #include <blitz/array.h>
+#endif
+
+#ifndef BZ_TIMER_H
+ #include <blitz/timer.h>
+#endif
+
+#ifndef BZ_RUNTIME_TUNING
+ #error <blitz/autotune.h> requires BZ_RUNTIME_TUNING
+#endif
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+#include <limits>
+#include <cmath>
+
+BZ_NAMESPACE(blitz)
+
+// Seconds of the fastest of reps evaluations of a 5-point 2D stencil
+inline double _bz_timeStencil(Array<double,2>& A, const Array<double,2>& B,
+    int reps)
+{
+    const Range I(1, A.extent(0) - 2), J(1, A.extent(1) - 2);
+    double best = std::numeric_limits<double>::max();
+    for (int r=0; r < reps; ++r)
+    {
+        const long double start = Timer::wallClockTime();
+        A(I,J) = B(I,J) + B(I-1,J) + B(I+1,J) + B(I,J-1) + B(I,J+1);
+        const double t = Timer::wallClockTime() - start;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+// The same for a 7-point 3D stencil
+inline double _bz_timeStencil(Array<double,3>& A, const Array<double,3>& B,
+    int reps)
+{
+    const Range I(1, A.extent(0) - 2), J(1, A.extent(1) - 2),
+        K(1, A.extent(2) - 2);
+    double best = std::numeric_limits<double>::max();
+    for (int r=0; r < reps; ++r)
+    {
+        const long double start = Timer::wallClockTime();
+        A(I,J,K) = B(I,J,K) + B(I+1,J,K) + B(I-1,J,K) + B(I,J+1,K)
+            + B(I,J-1,K) + B(I,J,K+1) + B(I,J,K-1);
+        const double t = Timer::wallClockTime() - start;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+// Seconds of the fastest of reps passes of y += a*x over n elements
+inline double _bz_timeDaxpy(double* y, const double* x, int n, int reps,
+    bool parallel)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r=0; r < reps; ++r)
+    {
+        const long double start = Timer::wallClockTime();
+        if (parallel)
+        {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (int i=0; i < n; ++i)
+                y[i] += 1.0001 * x[i];
+        }
+        else
+        {
+            for (int i=0; i < n; ++i)
+                y[i] += 1.0001 * x[i];
+        }
+        const double t = Timer::wallClockTime() - start;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+inline void autoTune(ostream* log = 0)
+{
+    TuningParameters& params = TuningParameters::instance();
+    const MachineInfo& m = params.machine();
+    const sizeType never = std::numeric_limits<sizeType>::max();
+
+    if (log)
+        *log << "L1 " << m.l1CacheSize << ", L2 " << m.l2CacheSize
+             << ", L3 " << m.l3CacheSize << " bytes; " << m.numPackages
+             << " packages, " << m.numCores << " cores, " << m.numThreads
+             << " threads" << endl;
+
+    // Tile sizes, on two arrays of about four times the L2 cache each, with
+    // rows longer than the L1 cache
+    sizeType elements = 4 * m.l2CacheSize / sizeof(double);
+    if (elements < (sizeType(1) << 18))
+        elements = sizeType(1) << 18;
+    if (elements > (sizeType(1) << 22))
+        elements = sizeType(1) << 22;
+    int columns = 4 * m.l1CacheSize / sizeof(double);
+    if (columns < 1024)
+        columns = 1024;
+    const int rows = elements / columns + 2;
+    {
+        Array<double,2> A(rows, columns), B(rows, columns);
+        A = 0;
+        B = tensor::i + 0.5 * tensor::j;
+
+        params.setTiledStencilCache(0);
+        const int heights[] = { 4, 8, 16, 32, 64 };
+        const int widths[] = { 16, 64, 256, 1024, 4096, 16384 };
+        double best = std::numeric_limits<double>::max();
+        int bestHeight = params.stencilTileHeight(),
+            bestWidth = params.stencilTileWidth();
+        for (unsigned h=0; h < sizeof(heights) / sizeof(int); ++h)
+            for (unsigned w=0; w < sizeof(widths) / sizeof(int); ++w)
+            {
+                if (widths[w] > 2 * columns)
+                    continue;
+                params.setStencilTile(heights[h], widths[w]);
+                const double t = _bz_timeStencil(A, B, 10);
+                if (log)
+                    *log << "tile " << heights[h] << "x" << widths[w]
+                         << ": " << t * 1e3 << " ms" << endl;
+                if (t < best)
+                {
+                    best = t;
+                    bestHeight = heights[h];
+                    bestWidth = widths[w];
+                }
+            }
+        params.setStencilTile(bestHeight, bestWidth);
+    }
+
+    // The tiling threshold: the stencil needs 72 bytes per column, for
+    // three rows of three double operands
+    sizeType threshold = never;
+    for (int length=64; length <= 65536; length *= 2)
+    {
+        Array<double,2> A(elements / length + 2, length + 2),
+            B(elements / length + 2, length + 2);
+        A = 0;
+        B = tensor::i + 0.5 * tensor::j;
+        params.setTiledStencilCache(never);
+        const double stack = _bz_timeStencil(A, B, 10);
+        params.setTiledStencilCache(0);
+        const double tiled = _bz_timeStencil(A, B, 10);
+        if (log)
+            *log << "rows of " << length << ": stack " << stack * 1e3
+                 << " ms, tiled " << tiled * 1e3 << " ms" << endl;
+        if (tiled * 1.05 < stack)
+        {
+            if (threshold == never)
+                threshold = 72 * sizeType(length / 2);
+        }
+        else
+            threshold = never;
+    }
+    params.setTiledStencilCache(threshold);
+
+    // Tiles of 3D stencils, on 64 planes which need about 8 times the
+    // L2 cache for the stack traversal
+    int n = int(std::sqrt(8.0 * m.l2CacheSize / 72));
+    if (n < 128)
+        n = 128;
+    if (n > 512)
+        n = 512;
+    {
+        Array<double,3> A(64, n, n), B(64, n, n);
+        A = 0;
+        B = tensor::i + 0.5 * tensor::j + 0.25 * tensor::k;
+
+        const sizeType curveCache = params.curveStencilCache();
+        params.setCurveStencilCache(never);
+        const double stack = _bz_timeStencil(A, B, 3);
+        if (log)
+            *log << "3D stencil of 64x" << n << "x" << n << ": stack "
+                 << stack * 1e3 << " ms" << endl;
+
+        params.setCurveStencilCache(0);
+        const TileOrder orders[] = { storageTileOrder, mortonTileOrder,
+            hilbertTileOrder };
+        const char* names[] = { "storage", "Morton", "Hilbert" };
+        const int sizes[] = { 8, 16, 32, 64 };
+        double best = std::numeric_limits<double>::max();
+        int bestSize = params.curveTileSize();
+        TileOrder bestOrder = params.tileOrder();
+        for (int o=0; o < 3; ++o)
+            for (int t=0; t < 4; ++t)
+            {
+                params.setCurveTile(sizes[t], orders[o]);
+                const double time = _bz_timeStencil(A, B, 3);
+                if (log)
+                    *log << names[o] << " order, tiles of " << sizes[t]
+                         << ": " << time * 1e3 << " ms" << endl;
+                if (time < best)
+                {
+                    best = time;
+                    bestSize = sizes[t];
+                    bestOrder = orders[o];
+                }
+            }
+        params.setCurveTile(bestSize, bestOrder);
+        params.setCurveStencilCache((best * 1.05 < stack) ? curveCache
+            : never);
+    }
+
+    // The parallel threshold: the first size from which parallel loops
+    // are at least 1.25 times faster
+    sizeType parallelThreshold = never;
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1)
+    {
+        const int maxN = 1 << 24;
+        Array<double,1> x(maxN), y(maxN);
+        x = 1;
+        y = 0;
+        for (int n=1 << 10; n <= maxN; n *= 2)
+        {
+            const int reps = 3 + (1 << 24) / n / 64;
+            const double serial = _bz_timeDaxpy(y.data(), x.data(), n, reps,
+                false);
+            const double parallel = _bz_timeDaxpy(y.data(), x.data(), n, reps,
+                true);
+            if (log)
+                *log << n << " elements: serial " << serial * 1e6
+                     << " us, parallel " << parallel * 1e6 << " us" << endl;
+            if (parallel * 1.25 <= serial)
+            {
+                if (parallelThreshold == never)
+                    parallelThreshold = n;
+            }
+            else
+                parallelThreshold = never;
+        }
+    }
+#endif
+    params.setParallelThreshold(parallelThreshold);
+
+    if (log)
+        params.write(*log);
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_AUTOTUNE_H
@@ -44,6 +44,12 @@
  #include <string.h>
 #endif
 
+#include <stdlib.h>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
 BZ_NAMESPACE(blitz)
 
 template<typename P_parameter>
@@ -91,9 +97,18 @@ void BenchmarkExt<P_parameter>::setNumParameters(int numParameters)
     parameters_.resize(numParameters_);
     iterations_.resize(numParameters_);
     flopsPerIteration_.resize(numParameters_);
+    bytesPerIteration_.resize(numParameters_);
+    bytesPerIteration_ = 0.0;
 
     // Set up timer and Mflops array
     times_.resize(numImplementations_, numParameters_);
+    for (int i=0; i < Timer::numCounters; ++i)
+    {
+        counts_[i].resize(numImplementations_, numParameters_);
+        for (unsigned j=0; j < numImplementations_; ++j)
+            for (unsigned k=0; k < numParameters_; ++k)
+                counts_[i](j,k) = -1.0;
+    }
 }
 
 template<typename P_parameter>
@@ -142,12 +157,28 @@ void BenchmarkExt<P_parameter>::setFlopsPerIteration(Vector<double>
         flopsPerIteration_[i] = flopsPerIteration[i];
 }
 
+template<typename P_parameter>
+void BenchmarkExt<P_parameter>::setBytesPerIteration(Vector<double> 
+    bytesPerIteration)
+{
+    BZPRECONDITION(bytesPerIteration_.length() == bytesPerIteration.length());
+
+    for (int i=0; i < bytesPerIteration_.length(); ++i)
+        bytesPerIteration_[i] = bytesPerIteration[i];
+}
+
 template<typename P_parameter>
 void BenchmarkExt<P_parameter>::setRateDescription(const char* string)
 {
     rateDescription_ = string;
 }
 
+template<typename P_parameter>
+bool BenchmarkExt<P_parameter>::enableCounters(int counters)
+{
+    return timer_.enableCounters(counters);
+}
+
 template<typename P_parameter>
 void BenchmarkExt<P_parameter>::beginBenchmarking()
 {
@@ -198,6 +229,7 @@ inline void BenchmarkExt<P_parameter>::start()
     BZPRECONDITION(state_ == benchmarkingImplementation);
     BZPRECONDITION(parameterNumber_ < numParameters_);
     state_ = running;
+    timer_.reset();
     timer_.start();
 }
 
@@ -210,6 +242,12 @@ inline void BenchmarkExt<P_parameter>::stop()
     
     times_(implementationNumber_, parameterNumber_) = timer_.elapsedSeconds();
 
+    const Timer::Counter counters[Timer::numCounters] = { Timer::cycles,
+        Timer::instructions, Timer::cacheReferences, Timer::cacheMisses };
+    for (int i=0; i < Timer::numCounters; ++i)
+        counts_[i](implementationNumber_, parameterNumber_) = 
+            timer_.counter(counters[i]);
+
     ++parameterNumber_;
 }
 
@@ -252,6 +290,10 @@ void BenchmarkExt<P_parameter>::endBenchmarking()
     BZPRECONDITION(implementationNumber_ == numImplementations_);
     
     state_ = done;
+
+    const char* csv = getenv("BZ_BENCHMARK_CSV");
+    if (csv && *csv)
+        saveCSV(csv);
 }
 
 template<typename P_parameter>
@@ -265,6 +307,42 @@ double BenchmarkExt<P_parameter>::getMflops(unsigned implementation,
         / times_(implementation, parameterNum) / 1.0e+6;
 }
 
+template<typename P_parameter>
+double BenchmarkExt<P_parameter>::getBandwidth(unsigned implementation,
+    unsigned parameterNum) const
+{
+    BZPRECONDITION(state_ == done);
+    BZPRECONDITION(implementation < numImplementations_);
+    BZPRECONDITION(parameterNum < numParameters_);
+    return iterations_(parameterNum) * bytesPerIteration_(parameterNum)
+        / times_(implementation, parameterNum) / 1.0e+6;
+}
+
+template<typename P_parameter>
+double BenchmarkExt<P_parameter>::getCounter(Timer::Counter counter,
+    unsigned implementation, unsigned parameterNum) const
+{
+    BZPRECONDITION(implementation < numImplementations_);
+    BZPRECONDITION(parameterNum < numParameters_);
+    int i = 0;
+    while ((1 << i) != counter)
+        ++i;
+    return counts_[i](implementation, parameterNum);
+}
+
+template<typename P_parameter>
+double BenchmarkExt<P_parameter>::getMeasuredBandwidth(
+    unsigned implementation, unsigned parameterNum) const
+{
+    BZPRECONDITION(state_ == done);
+    double misses = getCounter(Timer::cacheMisses, implementation,
+        parameterNum);
+    if (misses < 0)
+        return -1.0;
+    return misses * Timer::cacheLineSize
+        / times_(implementation, parameterNum) / 1.0e+6;
+}
+
 template<typename P_parameter>
 void BenchmarkExt<P_parameter>::saveMatlabGraph(const char* filename, const char* graphType) const
 {
@@ -309,6 +387,19 @@ void BenchmarkExt<P_parameter>::saveMatlabGraph(const char* filename, const char
     }
     ofs << "] ;" << endl << endl;
 
+    if (any(bytesPerIteration_ > 0.0))
+    {
+        ofs << "MBs = [ ";
+        for (i=0; i < numParameters_; ++i)
+        {
+            for (unsigned j=0; j < numImplementations_; ++j)
+                ofs << setprecision(12) << getBandwidth(j,i) << " ";
+            if (i != numParameters_ - 1)
+                ofs << ";" << endl;
+        }
+        ofs << "] ;" << endl << endl;
+    }
+
     ofs << graphType << "(parm,Mf), title('" << description_ << "'), " << endl
         << "    xlabel('" << parameterDescription_ << "'), "
         << "ylabel('" << rateDescription_ << "')" << endl
@@ -325,6 +416,66 @@ void BenchmarkExt<P_parameter>::saveMatlabGraph(const char* filename, const char
 }
 
 
+template<typename P_parameter>
+int BenchmarkExt<P_parameter>::numThreads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Quotes a CSV field, doubling embedded quotes
+inline void _bz_writeCSVField(ostream& os, const char* str)
+{
+    os << '"';
+    for (; *str; ++str)
+    {
+        if (*str == '"')
+            os << '"';
+        os << *str;
+    }
+    os << '"';
+}
+
+template<typename P_parameter>
+void BenchmarkExt<P_parameter>::saveCSV(const char* filename) const
+{
+    BZPRECONDITION(state_ == done);
+
+    bool isNew;
+    {
+        ifstream ifs(filename);
+        isNew = !ifs.good()
+            || (ifs.peek() == ifstream::traits_type::eof());
+    }
+
+    ofstream ofs(filename, ios::app);
+    assert(ofs.good());
+
+    if (isNew)
+        ofs << "benchmark,implementation,parameter,threads,iterations,"
+            << "seconds,mflops,mbytes_per_s,measured_mbytes_per_s" << endl;
+
+    const int threads = numThreads();
+    for (unsigned j=0; j < numImplementations_; ++j)
+    {
+        for (unsigned i=0; i < numParameters_; ++i)
+        {
+            _bz_writeCSVField(ofs, description_);
+            ofs << ",";
+            _bz_writeCSVField(ofs, implementationDescriptions_(j));
+            ofs << "," << setprecision(12) << double(parameters_[i])
+                << "," << threads << "," << iterations_[i]
+                << "," << times_(j,i)
+                << "," << getMflops(j,i)
+                << "," << getBandwidth(j,i)
+                << "," << getMeasuredBandwidth(j,i) << endl;
+        }
+    }
+}
+
 template<typename P_parameter>
 void BenchmarkExt<P_parameter>::savePylabGraph(const char* filename, const char* graphType) const
 {
@@ -365,6 +516,22 @@ void BenchmarkExt<P_parameter>::savePylabGraph(const char* filename, const char*
     }
     ofs << "])" << endl << endl;
 
+    if (any(bytesPerIteration_ > 0.0))
+    {
+        ofs << "MBs = array([[ ";
+        for (i=0; i < numParameters_; ++i)
+        {
+            if(i>0) ofs << ", [ ";
+            for (unsigned j=0; j < numImplementations_; ++j)
+            {
+                ofs << setprecision(12) << getBandwidth(j,i);
+                if(j<numImplementations_-1) ofs << ", ";
+            }
+            ofs << "]";
+        }
+        ofs << "])" << endl << endl;
+    }
+
     ofs << graphType << "(parm,Mf)\ntitle('" << description_ << "')\n"
         << "xlabel('" << parameterDescription_ << "')\n"
         << "ylabel('" << rateDescription_ << "')\n"
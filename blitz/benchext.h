@@ -68,8 +68,14 @@ public:
     void setParameterDescription(const char* string);
     void setIterations(Vector<long> iters);
     void setFlopsPerIteration(Vector<double> flopsPerIteration);
+    void setBytesPerIteration(Vector<double> bytesPerIteration);
     void setRateDescription(const char* string);
 
+    // Also read hardware counters (see Timer::enableCounters) while
+    // timing; returns false if they are not available.
+    bool enableCounters(int counters = Timer::cycles | Timer::instructions
+        | Timer::cacheMisses);
+
     void beginBenchmarking();
 
     void beginImplementation(const char* description);
@@ -91,9 +97,33 @@ public:
  
     double getMflops(unsigned implementation, unsigned parameterNum) const;
 
+    // Nominal bandwidth in Mbytes/s, from setBytesPerIteration()
+    double getBandwidth(unsigned implementation, unsigned parameterNum) const;
+
+    // Memory bandwidth in Mbytes/s estimated from last-level cache
+    // misses, or -1 without hardware counters
+    double getMeasuredBandwidth(unsigned implementation,
+        unsigned parameterNum) const;
+
+    // Hardware counter value for one timed run, or -1 if not available
+    double getCounter(Timer::Counter counter, unsigned implementation,
+        unsigned parameterNum) const;
+
+    double getSeconds(unsigned implementation, unsigned parameterNum) const
+    { return times_(implementation, parameterNum); }
+
     void saveMatlabGraph(const char* filename, const char* graphType="semilogx") const;
     void savePylabGraph(const char* filename, const char* graphType="semilogx") const;
 
+    // Appends one row per implementation and parameter to a CSV file
+    // (writing the header if the file is new), as read by the roofline
+    // driver in benchmarks/.  endBenchmarking() does this automatically
+    // when the environment variable BZ_BENCHMARK_CSV names a file.
+    void saveCSV(const char* filename) const;
+
+    // Number of threads the kernels were run with
+    static int numThreads();
+
 protected:
     BenchmarkExt(const BenchmarkExt<P_parameter>&) { }
     void operator=(const BenchmarkExt<P_parameter>&) { }
@@ -108,10 +138,12 @@ protected:
     Vector<const char*> implementationDescriptions_;
 
     Matrix<double,RowMajor> times_;       // Elapsed time
+    Matrix<double,RowMajor> counts_[Timer::numCounters];
 
     Vector<T_parameter> parameters_;
     Vector<long> iterations_;
     Vector<double> flopsPerIteration_;
+    Vector<double> bytesPerIteration_;
 
     Timer timer_;
     Timer overheadTimer_;
@@ -175,5 +175,16 @@
 #define BZ_LIKELY(x)   (x)
 #define BZ_UNLIKELY(x) (x)
 
+//  Forces inlining where the compiler's size heuristics would stop short:
+//  the vecmath functions only vectorize once inlined, through the
+//  expression nodes around them, into the evaluation loop.  Without
+//  BZ_VECMATH it is plain inline.
+
+#if defined(__GNUC__) && defined(BZ_VECMATH)
+  #define BZ_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+  #define BZ_ALWAYS_INLINE inline
+#endif
+
 #endif // BZ_COMPILER_H
 
@@ -38,6 +38,10 @@
 
 #include <cstdlib>
 
+#ifdef BZ_VECMATH
+#include <blitz/vecmath.h>
+#endif
+
 BZ_NAMESPACE(blitz)
     
 /* Helper functions */
@@ -751,6 +755,70 @@ struct Max {
     }
 };
 
+/*
+ * With BZ_VECMATH, exp(), log(), sin(), cos() and pow() of float and
+ * double arrays are computed by the functions of <blitz/vecmath.h>, which
+ * vectorize.  See there for their accuracy.
+ */
+
+#ifdef BZ_VECMATH
+
+#define BZ_DEFINE_VECMATH_FUNC(name,fun,vfun,type)                   \
+template<>                                                           \
+struct name<type> {                                                  \
+    typedef type T_numtype;                                          \
+                                                                     \
+    static BZ_ALWAYS_INLINE T_numtype                                 \
+    apply(const type a)                                              \
+    { return _bz_vecmathTier::vfun(a); }                             \
+                                                                     \
+    template<typename T1>                                            \
+    static inline void prettyPrint(BZ_STD_SCOPE(string) &str,        \
+        BZ_BLITZ_SCOPE(prettyPrintFormat) &format, const T1& t1)     \
+    {                                                                \
+        str += #fun;                                                 \
+        str += "(";                                                  \
+        t1.prettyPrint(str, format);                                 \
+        str += ")";                                                  \
+    }                                                                \
+};
+
+#define BZ_DEFINE_VECMATH_BINARY_FUNC(name,fun,vfun,type)            \
+template<>                                                           \
+struct name<type,type> {                                             \
+    typedef type T_numtype;                                          \
+                                                                     \
+    static BZ_ALWAYS_INLINE T_numtype                                 \
+    apply(type a, type b)                                            \
+    { return _bz_vecmathTier::vfun(a,b); }                           \
+                                                                     \
+    template<typename T1, typename T2>                               \
+    static inline void prettyPrint(BZ_STD_SCOPE(string) &str,        \
+        BZ_BLITZ_SCOPE(prettyPrintFormat) &format, const T1& t1,     \
+        const T2& t2)                                                \
+    {                                                                \
+        str += #fun;                                                 \
+        str += "(";                                                  \
+        t1.prettyPrint(str, format);                                 \
+        str += ",";                                                  \
+        t2.prettyPrint(str, format);                                 \
+        str += ")";                                                  \
+    }                                                                \
+};
+
+BZ_DEFINE_VECMATH_FUNC(Fn_cos,BZ_MATHFN_SCOPE(cos),cos,float)
+BZ_DEFINE_VECMATH_FUNC(Fn_cos,BZ_MATHFN_SCOPE(cos),cos,double)
+BZ_DEFINE_VECMATH_FUNC(Fn_exp,BZ_MATHFN_SCOPE(exp),exp,float)
+BZ_DEFINE_VECMATH_FUNC(Fn_exp,BZ_MATHFN_SCOPE(exp),exp,double)
+BZ_DEFINE_VECMATH_FUNC(Fn_log,BZ_MATHFN_SCOPE(log),log,float)
+BZ_DEFINE_VECMATH_FUNC(Fn_log,BZ_MATHFN_SCOPE(log),log,double)
+BZ_DEFINE_VECMATH_FUNC(Fn_sin,BZ_MATHFN_SCOPE(sin),sin,float)
+BZ_DEFINE_VECMATH_FUNC(Fn_sin,BZ_MATHFN_SCOPE(sin),sin,double)
+BZ_DEFINE_VECMATH_BINARY_FUNC(Fn_pow,BZ_MATHFN_SCOPE(pow),pow,float)
+BZ_DEFINE_VECMATH_BINARY_FUNC(Fn_pow,BZ_MATHFN_SCOPE(pow),pow,double)
+
+#endif // BZ_VECMATH
+
 BZ_NAMESPACE_END
 
 #endif // BZ_FUNCS_H
@@ -0,0 +1,285 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/half.h      Reduced-precision storage types half and bfloat16
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+/*
+ * half (IEEE 754 binary16) and bfloat16 (the upper half of a float) are
+ * storage types: an Array<half,N> takes a quarter of the memory of an
+ * Array<double,N>, but arithmetic is never done in 16 bits.  Both types
+ * convert implicitly to float, and promote to float (or to double, when
+ * combined with a double) in expressions, so that
+ *
+ *     Array<half,3> h(n,n,n);
+ *     Array<double,3> u(n,n,n);
+ *     h = u;                  // rounded to nearest, ties to even
+ *     u += 0.5 * h;           // computed in double
+ *     double s = sum(h);      // accumulated in double
+ *
+ * The conversions are branch-free bit manipulations, so the inner loops
+ * of the unit-stride traversal vectorize.  Functions which return their
+ * argument type, such as sin(h), round their result back to half; write
+ * sin(cast<float>(h)) to keep it in float.
+ */
+
+#ifndef BZ_HALF_H
+#define BZ_HALF_H
+
+#ifndef BZ_BLITZ_H
+ #include <blitz/blitz.h>
+#endif
+
+#ifndef BZ_PROMOTE_H
+ #include <blitz/promote.h>
+#endif
+
+#ifndef BZ_NUMTRAIT_H
+ #include <blitz/numtrait.h>
+#endif
+
+#include <limits>
+#include <cstring>
+
+BZ_NAMESPACE(blitz)
+
+// Bit-level conversions between float and the 16-bit formats.  The
+// selects are written so that every path is computed, which lets the
+// compiler turn them into vector blends.
+
+struct _bz_halfbits {
+    typedef unsigned short T_bits;
+    typedef unsigned int T_word;     // Must hold the 32 bits of a float
+
+    static inline T_word asWord(float x)
+    {
+        T_word w;
+        std::memcpy(&w, &x, sizeof(float));
+        return w;
+    }
+
+    static inline float asFloat(T_word w)
+    {
+        float x;
+        std::memcpy(&x, &w, sizeof(float));
+        return x;
+    }
+
+    static inline float halfToFloat(T_bits h)
+    {
+        const T_word sign = T_word(h & 0x8000) << 16;
+        const T_word bits = T_word(h & 0x7fff) << 13;
+        const T_word exponent = bits & 0x0f800000;
+
+        // Normal numbers: rebias the exponent from 15 to 127
+        const T_word normal = bits + ((127 - 15) << 23);
+        // Inf and NaN: the exponent is all ones in both formats
+        const T_word special = normal + ((128 - 16) << 23);
+        // Subnormals: let the FPU renormalize them
+        const T_word subnormal = asWord(asFloat(normal + (1 << 23))
+            - asFloat(113 << 23));
+
+        const T_word magnitude = (exponent == 0x0f800000) ? special
+            : ((exponent == 0) ? subnormal : normal);
+        return asFloat(magnitude | sign);
+    }
+
+    static inline T_bits floatToHalf(float x)
+    {
+        const T_word f32infinity = 255 << 23, f16overflow = (127 + 16) << 23,
+            denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+        T_word w = asWord(x);
+        const T_word sign = w & 0x80000000;
+        w ^= sign;
+
+        // Too large: Inf, or a quiet NaN
+        const T_word overflow = (w > f32infinity) ? 0x7e00 : 0x7c00;
+        // Too small for a normal half: the addition does the rounding
+        const T_word subnormal = asWord(asFloat(w) + asFloat(denormMagic))
+            - denormMagic;
+        // Normal: rebias, and round to nearest with ties to even
+        const T_word normal = (w - (T_word(127 - 15) << 23) + 0xfff
+            + ((w >> 13) & 1)) >> 13;
+
+        const T_word magnitude = (w >= f16overflow) ? overflow
+            : ((w < (113 << 23)) ? subnormal : normal);
+        return T_bits(magnitude | (sign >> 16));
+    }
+
+    static inline float bfloat16ToFloat(T_bits b)
+    {
+        return asFloat(T_word(b) << 16);
+    }
+
+    static inline T_bits floatToBfloat16(float x)
+    {
+        const T_word w = asWord(x);
+        // Round to nearest with ties to even; keep NaNs quiet
+        const T_word rounded = (w + 0x7fff + ((w >> 16) & 1)) >> 16;
+        const T_word nan = (w >> 16) | 0x0040;
+        return T_bits(((w & 0x7fffffff) > 0x7f800000) ? nan : rounded);
+    }
+};
+
+// The element types.  Default construction leaves the value undefined,
+// as it does for float.
+
+class half {
+public:
+    typedef _bz_halfbits::T_bits T_bits;
+
+    half() { }
+    half(float x) : bits_(_bz_halfbits::floatToHalf(x)) { }
+
+    operator float() const { return _bz_halfbits::halfToFloat(bits_); }
+
+    // Exact, and keeps -huge(half()) a half
+    half operator-() const { return fromBits(T_bits(bits_ ^ 0x8000)); }
+
+    static half fromBits(T_bits bits) { half x; x.bits_ = bits; return x; }
+    T_bits bits() const { return bits_; }
+
+private:
+    T_bits bits_;
+};
+
+class bfloat16 {
+public:
+    typedef _bz_halfbits::T_bits T_bits;
+
+    bfloat16() { }
+    bfloat16(float x) : bits_(_bz_halfbits::floatToBfloat16(x)) { }
+
+    operator float() const { return _bz_halfbits::bfloat16ToFloat(bits_); }
+
+    bfloat16 operator-() const { return fromBits(T_bits(bits_ ^ 0x8000)); }
+
+    static bfloat16 fromBits(T_bits bits)
+    { bfloat16 x; x.bits_ = bits; return x; }
+    T_bits bits() const { return bits_; }
+
+private:
+    T_bits bits_;
+};
+
+inline ostream& operator<<(ostream& os, const half& x)
+{ return os << float(x); }
+
+inline ostream& operator<<(ostream& os, const bfloat16& x)
+{ return os << float(x); }
+
+inline istream& operator>>(istream& is, half& x)
+{
+    float y;
+    if (is >> y)
+        x = y;
+    return is;
+}
+
+inline istream& operator>>(istream& is, bfloat16& x)
+{
+    float y;
+    if (is >> y)
+        x = y;
+    return is;
+}
+
+// Arithmetic on the 16-bit types is done in float, in the same way
+// that arithmetic on short is done in int
+
+#if defined(BZ_HAVE_PARTIAL_SPECIALIZATION) && !defined(BZ_DISABLE_NEW_PROMOTE)
+BZ_DECLARE_AUTOPROMOTE(half, float)
+BZ_DECLARE_AUTOPROMOTE(bfloat16, float)
+#endif
+
+#ifdef BZ_USE_NUMTRAIT
+BZDECLNUMTRAIT(half, double, float, float, float);
+BZDECLNUMTRAIT(bfloat16, double, float, float, float);
+#endif
+
+BZ_NAMESPACE_END
+
+// numeric_limits, so that huge(), epsilon() and the min and max
+// reductions know the range of the types
+
+BZ_NAMESPACE(std)
+
+template<>
+class numeric_limits<BZ_BLITZ_SCOPE(half)> : public numeric_limits<float> {
+public:
+    typedef BZ_BLITZ_SCOPE(half) T_half;
+
+    static const int digits = 11;
+    static const int digits10 = 3;
+    static const int max_digits10 = 5;
+    static const int min_exponent = -13;
+    static const int min_exponent10 = -4;
+    static const int max_exponent = 16;
+    static const int max_exponent10 = 4;
+
+    static T_half min() throw() { return T_half::fromBits(0x0400); }
+    static T_half max() throw() { return T_half::fromBits(0x7bff); }
+    static T_half lowest() throw() { return T_half::fromBits(0xfbff); }
+    static T_half epsilon() throw() { return T_half::fromBits(0x1400); }
+    static T_half round_error() throw() { return T_half::fromBits(0x3800); }
+    static T_half infinity() throw() { return T_half::fromBits(0x7c00); }
+    static T_half quiet_NaN() throw() { return T_half::fromBits(0x7e00); }
+    static T_half signaling_NaN() throw() { return T_half::fromBits(0x7d00); }
+    static T_half denorm_min() throw() { return T_half::fromBits(0x0001); }
+};
+
+template<>
+class numeric_limits<BZ_BLITZ_SCOPE(bfloat16)> : public numeric_limits<float> {
+public:
+    typedef BZ_BLITZ_SCOPE(bfloat16) T_bfloat16;
+
+    static const int digits = 8;
+    static const int digits10 = 2;
+    static const int max_digits10 = 4;
+
+    static T_bfloat16 min() throw() { return T_bfloat16::fromBits(0x0080); }
+    static T_bfloat16 max() throw() { return T_bfloat16::fromBits(0x7f7f); }
+    static T_bfloat16 lowest() throw() { return T_bfloat16::fromBits(0xff7f); }
+    static T_bfloat16 epsilon() throw()
+    { return T_bfloat16::fromBits(0x3c00); }
+    static T_bfloat16 round_error() throw()
+    { return T_bfloat16::fromBits(0x3f00); }
+    static T_bfloat16 infinity() throw()
+    { return T_bfloat16::fromBits(0x7f80); }
+    static T_bfloat16 quiet_NaN() throw()
+    { return T_bfloat16::fromBits(0x7fc0); }
+    static T_bfloat16 signaling_NaN() throw()
+    { return T_bfloat16::fromBits(0x7fa0); }
+    static T_bfloat16 denorm_min() throw()
+    { return T_bfloat16::fromBits(0x0001); }
+};
+
+BZ_NAMESPACE_END
+
+#endif // BZ_HALF_H
@@ -40,6 +40,14 @@
 
 BZ_NAMESPACE(blitz)
 
+/*
+ * An IndexPlaceholder evaluates to the index along rank N.  It is
+ * traversed like an Array operand: moveTo() sets the index, and the
+ * index advances by one with each step of the loop over rank N and
+ * stays put in the loops over the other ranks.  Reading i steps ahead,
+ * with fastRead(i), gives a ramp which the compiler can vectorize.
+ */
+
 template<int N>
 class IndexPlaceholder 
 #ifdef BZ_NEW_EXPRESSION_TEMPLATES
@@ -48,14 +56,16 @@ class IndexPlaceholder
 {
 public:
     IndexPlaceholder()
+      : index_(0), step_(0)
     { }
 
 #ifdef BZ_NEW_EXPRESSION_TEMPLATES
     IndexPlaceholder(const IndexPlaceholder<N>& x)
-        : ETBase< IndexPlaceholder<N> >(x)
+        : ETBase< IndexPlaceholder<N> >(x), index_(x.index_), step_(x.step_)
     { }
 #else
-    IndexPlaceholder(const IndexPlaceholder<N>&)
+    IndexPlaceholder(const IndexPlaceholder<N>& x)
+        : index_(x.index_), step_(x.step_)
     { }
 #endif
 
@@ -75,14 +85,7 @@ public:
         numIndexPlaceholders = 1,
         rank = N+1;
 
-    // If you have a precondition failure on this routine, it means
-    // you are trying to use stack iteration mode on an expression
-    // which contains an index placeholder.  You must use index 
-    // iteration mode instead.
-    int operator*() const { 
-        BZPRECONDITION(0); 
-        return 0;
-    }
+    int operator*() const { return index_; }
 
 #ifdef BZ_ARRAY_EXPR_PASS_INDEX_BY_VALUE
     template<int N_rank>
@@ -103,47 +106,33 @@ public:
     return RectDomain<rank>(lb,ub);
   }
 
-    // See operator*() note
+    void push(int position) { stack_[position] = index_; }
+    void pop(int position)  { index_ = stack_[position]; }
+    void advance()          { index_ += step_; }
+    void advance(int n)     { index_ += n * step_; }
+    void loadStride(int r)  { step_ = (r == N); }
 
-    void push(int)       { BZPRECONDITION(0); }
-    void pop(int)        { BZPRECONDITION(0); }
-    void advance()       { BZPRECONDITION(0); }
-    void advance(int)    { BZPRECONDITION(0); }
-    void loadStride(int) { BZPRECONDITION(0); }
     template<int N_rank>
-    void moveTo(const TinyVector<int,N_rank>& i) { BZPRECONDITION(0); }
+    void moveTo(const TinyVector<int,N_rank>& i) { index_ = i[N]; }
 
-    bool isUnitStride(int) const { 
-        BZPRECONDITION(0);
-        return false;
-    }
+    // The index is counted in steps of the loop, whatever the stride
+    // of the other operands, so the unit stride loop applies once
+    // loadStride(r) has set the step for rank r
+    bool isUnitStride(int r) const { return step_ == (r == N); }
 
-    void advanceUnitStride() { BZPRECONDITION(0); }
+    void advanceUnitStride() { index_ += step_; }
 
-    bool canCollapse(int,int) const {   
-        BZPRECONDITION(0); 
-        return false; 
-    }
+    // The index wraps around when the loop over rank N ends
+    bool canCollapse(int outerLoopRank, int innerLoopRank) const
+    { return (outerLoopRank != N) && (innerLoopRank != N); }
 
-    T_numtype operator[](int) const {
-        BZPRECONDITION(0);
-        return T_numtype();
-    }
+    T_numtype operator[](int i) const { return index_ + i * step_; }
 
-    T_numtype fastRead(int) const {
-        BZPRECONDITION(0);
-        return T_numtype();
-    }
+    T_numtype fastRead(int i) const { return index_ + i * step_; }
 
-    diffType suggestStride(int) const {
-        BZPRECONDITION(0);
-        return 0;
-    }
+    diffType suggestStride(int) const { return 1; }
 
-    bool isStride(int,diffType) const {
-        BZPRECONDITION(0);
-        return true;
-    }
+    bool isStride(int, diffType stride) const { return stride == 1; }
 
   // don't know how to define shift, as it relies on having an
   // implicit position. thus stencils won't work
@@ -200,6 +189,11 @@ public:
       // placeholder should start from a nonzero value.
       BZPRECONDITION(0);
     }
+
+private:
+    // Blitz++ arrays have at most 11 ranks, and so at most 11 loops
+    int index_, step_;
+    int stack_[11];
 };
 
 typedef IndexPlaceholder<0> firstIndex;
@@ -0,0 +1,496 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/machine.h   Cache and core detection, and tuning parameters
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+/*
+ * MachineInfo::detect() finds the data cache sizes and the number of
+ * packages, cores and hardware threads of the machine: from sysfs on
+ * Linux, otherwise from sysconf() and, on x86, cpuid.  Whatever cannot
+ * be found keeps the estimate from <blitz/tuning.h>.
+ *
+ * TuningParameters holds the values behind the choices made when
+ * arrays are evaluated: the cache a 2D stencil may use before it is
+ * tiled, the tile size, the same for the space-filling curve traversal
+ * of stencils of rank 3 and more, and the number of elements from which
+ * scans and multi-reductions are shared among threads.  With BZ_RUNTIME_TUNING
+ * these are read from TuningParameters::instance(), which starts from
+ * the detected caches and then reads the tuning file of the machine, if
+ * there is one.  The file is named by the environment variable
+ * BZ_TUNING_FILE (set it empty to read none), and is otherwise
+ * $HOME/.blitz-tuning.<hostname>.  It holds one "name value" pair per
+ * line, as written by write(); lines starting with '#' are comments.
+ * Machine values in the file override the detected ones.
+ *
+ * autoTune(), in <blitz/autotune.h>, measures the parameters on the
+ * machine.  benchmarks/autotune runs it and writes the tuning file.
+ */
+
+#ifndef BZ_MACHINE_H
+#define BZ_MACHINE_H
+
+#ifndef BZ_BLITZ_H
+ #include <blitz/blitz.h>
+#endif
+
+#ifndef BZ_TRAVERSAL_H
+ #include <blitz/traversal.h>
+#endif
+
+#include <string>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef BZ_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+ #include <cpuid.h>
+ #define BZ_MACHINE_CPUID
+#endif
+
+BZ_NAMESPACE(blitz)
+
+struct MachineInfo {
+    // Data cache sizes and line size in bytes; zero if there is none
+    sizeType l1CacheSize, l2CacheSize, l3CacheSize, cacheLineSize;
+    int numPackages, numCores, numThreads;
+
+    MachineInfo()
+      : l1CacheSize(BZ_L1_CACHE_ESTIMATED_SIZE),
+        l2CacheSize(BZ_L2_CACHE_ESTIMATED_SIZE), l3CacheSize(0),
+        cacheLineSize(64), numPackages(1), numCores(1), numThreads(1)
+    { }
+
+    static MachineInfo detect();
+
+private:
+    static bool readFile(const char* name, std::string& value);
+    static void setCache(MachineInfo& m, bool found[], int level,
+        sizeType size, sizeType lineSize);
+    static void detectSysfs(MachineInfo& m, bool found[]);
+    static void detectSysconf(MachineInfo& m, bool found[]);
+    static void detectCpuid(MachineInfo& m, bool found[]);
+};
+
+class TuningParameters {
+
+public:
+    static TuningParameters& instance()
+    {
+        static TuningParameters params(true);
+        return params;
+    }
+
+    // Detected machine and default parameters, without a tuning file
+    TuningParameters()
+    { setDefaults(); }
+
+    const MachineInfo& machine() const
+    { return machine_; }
+
+    MachineInfo& machine()
+    { return machine_; }
+
+    // A 2D stencil expression is tiled if the three rows of each operand
+    // it reads need more than this many bytes
+    sizeType tiledStencilCache() const
+    { return tiledStencilCache_; }
+
+    void setTiledStencilCache(sizeType bytes)
+    { tiledStencilCache_ = bytes; }
+
+    // Tiles are this many rows (outer rank) by columns (inner rank)
+    int stencilTileHeight() const
+    { return stencilTileHeight_; }
+
+    int stencilTileWidth() const
+    { return stencilTileWidth_; }
+
+    void setStencilTile(int height, int width)
+    {
+        BZPRECONDITION((height > 0) && (width > 0));
+        stencilTileHeight_ = height;
+        stencilTileWidth_ = width;
+    }
+
+    // A stencil of rank 3 or more is traversed in tiles if three planes
+    // of each operand it reads need more than this many bytes
+    sizeType curveStencilCache() const
+    { return curveStencilCache_; }
+
+    void setCurveStencilCache(sizeType bytes)
+    { curveStencilCache_ = bytes; }
+
+    // The tiles span this many rows along each rank but the innermost,
+    // and are visited in this order
+    int curveTileSize() const
+    { return curveTileSize_; }
+
+    TileOrder tileOrder() const
+    { return tileOrder_; }
+
+    void setCurveTile(int size, TileOrder order)
+    {
+        BZPRECONDITION(size > 0);
+        curveTileSize_ = size;
+        tileOrder_ = order;
+    }
+
+    // Scans and multi-reductions of fewer elements use one thread
+    sizeType parallelThreshold() const
+    { return parallelThreshold_; }
+
+    void setParallelThreshold(sizeType numElements)
+    { parallelThreshold_ = numElements; }
+
+    // The tuning file read by instance(), or "" if there was none
+    const std::string& file() const
+    { return file_; }
+
+    static std::string defaultFile();
+
+    // Reads parameters in the format of write(); false on a bad line
+    bool read(istream& is);
+    void write(ostream& os) const;
+
+    bool load(const std::string& name);
+    bool save(const std::string& name) const;
+
+private:
+    explicit TuningParameters(bool readFile);
+
+    void setDefaults();
+    bool set(const std::string& name, sizeType value);
+
+    MachineInfo machine_;
+    sizeType tiledStencilCache_, curveStencilCache_, parallelThreshold_;
+    int stencilTileHeight_, stencilTileWidth_, curveTileSize_;
+    TileOrder tileOrder_;
+    std::string file_;
+};
+
+inline bool MachineInfo::readFile(const char* name, std::string& value)
+{
+    ifstream ifs(name);
+    return (ifs >> value) ? true : false;
+}
+
+inline void MachineInfo::setCache(MachineInfo& m, bool found[], int level,
+    sizeType size, sizeType lineSize)
+{
+    if ((level < 1) || (level > 3) || found[level] || !size)
+        return;
+    found[level] = true;
+    if (level == 1)
+        m.l1CacheSize = size;
+    else if (level == 2)
+        m.l2CacheSize = size;
+    else
+        m.l3CacheSize = size;
+    if (lineSize)
+        m.cacheLineSize = lineSize;
+}
+
+// Caches of cpu0 and the topology of the online cpus, from sysfs
+inline void MachineInfo::detectSysfs(MachineInfo& m, bool found[])
+{
+    char name[128];
+    std::string value;
+    for (int index=0; index < 16; ++index)
+    {
+        const int len = sprintf(name,
+            "/sys/devices/system/cpu/cpu0/cache/index%d/", index);
+        if (!readFile(strcat(name, "level"), value))
+            break;
+        const int level = atoi(value.c_str());
+        name[len] = '\0';
+        if (!readFile(strcat(name, "type"), value)
+            || (value == "Instruction"))
+            continue;
+        name[len] = '\0';
+        if (!readFile(strcat(name, "size"), value))
+            continue;
+        sizeType size = strtoul(value.c_str(), 0, 10);
+        const char unit = value[value.length() - 1];
+        if ((unit == 'K') || (unit == 'k'))
+            size *= 1024;
+        else if (unit == 'M')
+            size *= 1024 * 1024;
+        name[len] = '\0';
+        sizeType lineSize = 0;
+        if (readFile(strcat(name, "coherency_line_size"), value))
+            lineSize = strtoul(value.c_str(), 0, 10);
+        setCache(m, found, level, size, lineSize);
+    }
+
+    std::set<int> packages;
+    std::set<std::pair<int,int> > cores;
+    int threads = 0;
+    for (int cpu=0; cpu < 65536; ++cpu)
+    {
+        sprintf(name, "/sys/devices/system/cpu/cpu%d/topology/"
+            "physical_package_id", cpu);
+        if (!readFile(name, value))
+        {
+            // Offline cpus have no topology, so look for the next one
+            sprintf(name, "/sys/devices/system/cpu/cpu%d", cpu);
+            ifstream exists(name);
+            if (!exists && (cpu >= threads + 64))
+                break;
+            continue;
+        }
+        const int package = atoi(value.c_str());
+        sprintf(name, "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        const int core = readFile(name, value) ? atoi(value.c_str()) : cpu;
+        packages.insert(package);
+        cores.insert(std::make_pair(package, core));
+        ++threads;
+    }
+    if (threads)
+    {
+        m.numPackages = packages.size();
+        m.numCores = cores.size();
+        m.numThreads = threads;
+        found[0] = true;
+    }
+}
+
+inline void MachineInfo::detectSysconf(MachineInfo& m, bool found[])
+{
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    long lineSize = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (lineSize < 0)
+        lineSize = 0;
+    long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (size > 0)
+        setCache(m, found, 1, size, lineSize);
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0)
+        setCache(m, found, 2, size, 0);
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size > 0)
+        setCache(m, found, 3, size, 0);
+#endif
+#ifdef _SC_NPROCESSORS_ONLN
+    if (!found[0])
+    {
+        const long threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads > 0)
+            m.numThreads = m.numCores = threads;
+    }
+#endif
+}
+
+// Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD
+inline void MachineInfo::detectCpuid(MachineInfo& m, bool found[])
+{
+#ifdef BZ_MACHINE_CPUID
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0, &a, &b, &c, &d))
+        return;
+    unsigned leaf = 4;
+    if (b == 0x68747541)         // "AuthenticAMD"
+    {
+        if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || (a < 0x8000001D))
+            return;
+        leaf = 0x8000001D;
+    }
+    else if (a < 4)
+        return;
+
+    for (unsigned i=0; i < 16; ++i)
+    {
+        __cpuid_count(leaf, i, a, b, c, d);
+        const unsigned type = a & 0x1f;
+        if (type == 0)
+            break;
+        if (type == 2)           // instruction cache
+            continue;
+        const sizeType lineSize = (b & 0xfff) + 1,
+            partitions = ((b >> 12) & 0x3ff) + 1,
+            ways = ((b >> 22) & 0x3ff) + 1,
+            sets = sizeType(c) + 1;
+        setCache(m, found, (a >> 5) & 7, ways * partitions * lineSize * sets,
+            lineSize);
+    }
+#endif
+}
+
+inline MachineInfo MachineInfo::detect()
+{
+    MachineInfo m;
+    // found[0] is the topology, found[1..3] the caches
+    bool found[4] = { false, false, false, false };
+    detectSysfs(m, found);
+    detectSysconf(m, found);
+    detectCpuid(m, found);
+    return m;
+}
+
+inline TuningParameters::TuningParameters(bool readFile)
+{
+    setDefaults();
+    if (!readFile)
+        return;
+    const char* env = getenv("BZ_TUNING_FILE");
+    const std::string name = env ? std::string(env) : defaultFile();
+    if (!name.empty() && load(name))
+        file_ = name;
+}
+
+inline void TuningParameters::setDefaults()
+{
+    machine_ = MachineInfo::detect();
+    tiledStencilCache_ = machine_.l1CacheSize;
+    stencilTileHeight_ = stencilTileWidth_ = BZ_ARRAY_2D_STENCIL_TILE_SIZE;
+    curveStencilCache_ = 2 * (machine_.l2CacheSize ? machine_.l2CacheSize
+        : machine_.l1CacheSize);
+    curveTileSize_ = BZ_ARRAY_SPACE_FILLING_TILE_SIZE;
+    tileOrder_ = BZ_ARRAY_SPACE_FILLING_ORDER;
+    parallelThreshold_ = 65536;
+    file_.clear();
+}
+
+inline std::string TuningParameters::defaultFile()
+{
+    const char* home = getenv("HOME");
+    if (!home || !*home)
+        return std::string();
+    char host[256] = "localhost";
+#ifdef BZ_HAVE_UNISTD_H
+    if (gethostname(host, sizeof(host)) != 0)
+        strcpy(host, "localhost");
+    host[sizeof(host) - 1] = '\0';
+#endif
+    return std::string(home) + "/.blitz-tuning." + host;
+}
+
+inline bool TuningParameters::set(const std::string& name, sizeType value)
+{
+    if (name == "l1_cache_size")
+        machine_.l1CacheSize = value;
+    else if (name == "l2_cache_size")
+        machine_.l2CacheSize = value;
+    else if (name == "l3_cache_size")
+        machine_.l3CacheSize = value;
+    else if (name == "cache_line_size")
+        machine_.cacheLineSize = value;
+    else if (name == "packages")
+        machine_.numPackages = value;
+    else if (name == "cores")
+        machine_.numCores = value;
+    else if (name == "threads")
+        machine_.numThreads = value;
+    else if (name == "tiled_stencil_cache")
+        tiledStencilCache_ = value;
+    else if ((name == "stencil_tile_height") && value)
+        stencilTileHeight_ = value;
+    else if ((name == "stencil_tile_width") && value)
+        stencilTileWidth_ = value;
+    else if (name == "curve_stencil_cache")
+        curveStencilCache_ = value;
+    else if ((name == "curve_tile_size") && value)
+        curveTileSize_ = value;
+    else if ((name == "tile_order") && (value <= hilbertTileOrder))
+        tileOrder_ = TileOrder(value);
+    else if (name == "parallel_threshold")
+        parallelThreshold_ = value;
+    else
+        return false;
+    return true;
+}
+
+inline bool TuningParameters::read(istream& is)
+{
+    bool ok = true;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name) || (name[0] == '#'))
+            continue;
+        std::string text;
+        char* end = 0;
+        if (fields >> text)
+        {
+            const sizeType value = strtoul(text.c_str(), &end, 10);
+            if ((text[0] == '-') || *end || !set(name, value))
+                end = 0;
+        }
+        if (!end)
+            ok = false;
+    }
+    return ok;
+}
+
+inline void TuningParameters::write(ostream& os) const
+{
+    os << "# Blitz++ tuning parameters" << endl
+       << "l1_cache_size " << machine_.l1CacheSize << endl
+       << "l2_cache_size " << machine_.l2CacheSize << endl
+       << "l3_cache_size " << machine_.l3CacheSize << endl
+       << "cache_line_size " << machine_.cacheLineSize << endl
+       << "packages " << machine_.numPackages << endl
+       << "cores " << machine_.numCores << endl
+       << "threads " << machine_.numThreads << endl
+       << "tiled_stencil_cache " << tiledStencilCache_ << endl
+       << "stencil_tile_height " << stencilTileHeight_ << endl
+       << "stencil_tile_width " << stencilTileWidth_ << endl
+       << "curve_stencil_cache " << curveStencilCache_ << endl
+       << "curve_tile_size " << curveTileSize_ << endl
+       << "# 0 storage order, 1 Morton, 2 Hilbert" << endl
+       << "tile_order " << tileOrder_ << endl
+       << "parallel_threshold " << parallelThreshold_ << endl;
+}
+
+inline bool TuningParameters::load(const std::string& name)
+{
+    ifstream ifs(name.c_str());
+    return ifs && read(ifs);
+}
+
+inline bool TuningParameters::save(const std::string& name) const
+{
+    ofstream ofs(name.c_str());
+    if (!ofs)
+        return false;
+    write(ofs);
+    return ofs ? true : false;
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_MACHINE_H
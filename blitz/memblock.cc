@@ -37,11 +37,19 @@ BZ_NAMESPACE(blitz)
 template<typename P_type>
 void MemoryBlock<P_type>::deallocate()
 {
+#ifdef BZ_MEMBLOCK_USE_MREMAP
+    if (mapped_)
+    {
+        munmap(dataBlockAddress_, capacity_ * sizeof(T_type));
+        return;
+    }
+#endif
+
 #ifndef BZ_ALIGN_BLOCKS_ON_CACHELINE_BOUNDARY
     delete [] dataBlockAddress_;
 #else
     if (!NumericTypeTraits<T_type>::hasTrivialCtor) {
-        for (int i=0; i < length_; ++i)
+        for (sizeType i=0; i < capacity_; ++i)
             data_[i].~T_type();
         delete [] reinterpret_cast<char*>(dataBlockAddress_);
     }
@@ -101,6 +109,55 @@ inline void MemoryBlock<P_type>::allocate(sizeType length)
 #endif
 }
 
+// Maps a zero-filled block of capacity items, if it is large enough and
+// the type has a trivial constructor
+template<typename P_type>
+inline bool MemoryBlock<P_type>::map(sizeType capacity)
+{
+#ifdef BZ_MEMBLOCK_USE_MREMAP
+    if (!NumericTypeTraits<T_type>::hasTrivialCtor
+        || (capacity * sizeof(T_type) < BZ_MREMAP_THRESHOLD))
+        return false;
+
+    void* p = mmap(0, capacity * sizeof(T_type), PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return false;
+    dataBlockAddress_ = data_ = static_cast<T_type*>(p);
+    mapped_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+template<typename P_type>
+inline bool MemoryBlock<P_type>::reserve(sizeType capacity)
+{
+    if (capacity <= capacity_)
+        return true;
+
+#ifdef BZ_MEMBLOCK_USE_MREMAP
+    if (mapped_)
+    {
+        void* p = mremap(dataBlockAddress_, capacity_ * sizeof(T_type),
+            capacity * sizeof(T_type), MREMAP_MAYMOVE);
+        if (p == MAP_FAILED)
+            return false;
+
+#ifdef BZ_DEBUG_LOG_ALLOCATIONS
+    cout << "MemoryBlock:  remapped " << setw(8) << capacity
+         << " from " << ((void *)dataBlockAddress_) << " to " << p << endl;
+#endif
+
+        dataBlockAddress_ = data_ = static_cast<T_type*>(p);
+        capacity_ = capacity;
+        return true;
+    }
+#endif
+
+    return false;
+}
 
 BZ_NAMESPACE_END
 
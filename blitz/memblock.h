@@ -36,6 +36,20 @@
 
 #include <stddef.h>     // diffType
 
+// Blocks allocated with spare capacity are mapped with mmap when they are
+// at least this many bytes, so that they can later grow with mremap
+// instead of being copied.
+#ifndef BZ_MREMAP_THRESHOLD
+ #define BZ_MREMAP_THRESHOLD (1 << 20)
+#endif
+
+#if defined(__linux__) && !defined(BZ_DISABLE_MREMAP)
+ #include <sys/mman.h>
+ #ifdef MREMAP_MAYMOVE
+  #define BZ_MEMBLOCK_USE_MREMAP
+ #endif
+#endif
+
 BZ_NAMESPACE(blitz)
 
 enum preexistingMemoryPolicy { 
@@ -76,6 +90,8 @@ protected:
     explicit MemoryBlock(sizeType items)
     {
         length_ = items;
+        capacity_ = items;
+        mapped_ = false;
         allocate(length_);
 
 #ifdef BZ_DEBUG_LOG_ALLOCATIONS
@@ -90,9 +106,34 @@ protected:
         BZ_MUTEX_INIT(mutex)
     }
 
+    // Allocates room for capacity items, of which the first length are
+    // in use
+    MemoryBlock(sizeType length, sizeType capacity)
+    {
+        BZPRECONDITION(capacity >= length);
+        length_ = length;
+        capacity_ = capacity;
+        mapped_ = false;
+        if (!map(capacity_))
+            allocate(capacity_);
+
+#ifdef BZ_DEBUG_LOG_ALLOCATIONS
+    cout << "MemoryBlock: allocated " << setw(8) << length_ << " of "
+         << capacity_ << " at " << ((void *)dataBlockAddress_) << endl;
+#endif
+
+        BZASSERT(dataBlockAddress_ != 0);
+
+        references_ = 1;
+
+        BZ_MUTEX_INIT(mutex)
+    }
+
     MemoryBlock(sizeType length, T_type* data)
     {
         length_ = length;
+        capacity_ = length;
+        mapped_ = false;
         data_ = data;
         dataBlockAddress_ = data;
         references_ = 1;
@@ -172,6 +213,21 @@ protected:
         return length_; 
     }
 
+    sizeType        capacity()  const
+    {
+        return capacity_;
+    }
+
+    void          setLength(sizeType length)
+    {
+        BZPRECONDITION(length <= capacity_);
+        length_ = length;
+    }
+
+    // Makes room for capacity items.  A mapped block is remapped, and
+    // may move; otherwise this fails unless there is room already.
+    inline bool reserve(sizeType capacity);
+
     int           removeReference()
     {
 
@@ -199,6 +255,7 @@ protected:
 protected:
     inline void allocate(sizeType length);
     void deallocate();
+    inline bool map(sizeType capacity);
 
 private:   // Disabled member functions
     MemoryBlock(const MemoryBlock<T_type>&)
@@ -211,6 +268,8 @@ private:   // Data members
     T_type * restrict     data_;
     T_type *              dataBlockAddress_;
     sizeType              length_;
+    sizeType              capacity_;
+    bool                  mapped_;
 
 #if defined(BZ_THREADSAFE) && !defined(BZ_THREADSAFE_USE_ATOMIC)
     // with atomic reference counts, there is no locking
@@ -354,6 +413,45 @@ public:
 #endif
     }
 
+    // As newBlock(items), with room for capacity items
+    void newBlock(sizeType items, sizeType capacity)
+    {
+        blockRemoveReference();
+        block_ = new MemoryBlock<T_type>(items, capacity);
+        data_ = block_->data();
+    }
+
+    // The number of items the block has room for from first, or 0 if
+    // the block is shared or was not allocated here
+    sizeType blockCapacity(const T_type* first) const
+    {
+        if (!block_ || (block_->references() != 1))
+            return 0;
+        return block_->capacity() - (first - block_->data());
+    }
+
+    // Makes room for capacity items from first without copying them; if
+    // the block moves, data_ moves with it.  Fails if the block is shared,
+    // or has to be reallocated.
+    bool reserveBlock(const T_type* first, sizeType capacity)
+    {
+        if (!block_ || (block_->references() != 1))
+            return false;
+
+        T_type* oldData = block_->data();
+        if (!block_->reserve((first - oldData) + capacity))
+            return false;
+        data_ = block_->data() + (data_ - oldData);
+        return true;
+    }
+
+    // Records that items are in use from first
+    void setBlockLength(const T_type* first, sizeType items)
+    {
+        if (block_)
+            block_->setLength((first - block_->data()) + items);
+    }
+
 private:
     void blockRemoveReference()
     {
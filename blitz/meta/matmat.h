@@ -122,6 +122,21 @@ product(const TinyMatrix<T_numtype1, N_rows1, N_columns1>& a,
     return _bz_tinyMatExpr<T_expr>(T_expr(a.data(), b.data()));
 }
 
+// A product with an expression operand evaluates the operand first, as
+// the product reads each of its elements several times.
+template<typename T1, typename T2>
+inline TinyMatrix<BZ_PROMOTE(_bz_typename T1::T_numtype,
+    _bz_typename T2::T_numtype), T1::rows, T2::columns>
+product(const _bz_tinyMatBase<T1>& a, const _bz_tinyMatBase<T2>& b)
+{
+    const TinyMatrix<_bz_typename T1::T_numtype, T1::rows,
+        _bz_tinyMatSameShape<T1::columns, 1, T2::rows, 1>::rows>
+        a2(a.unwrap());
+    const TinyMatrix<_bz_typename T2::T_numtype, T2::rows, T2::columns>
+        b2(b.unwrap());
+    return product(a2, b2);
+}
+
 BZ_NAMESPACE_END
 
 #endif // BZ_META_MATMAT_H
@@ -131,6 +131,42 @@ product(const TinyMatrix<T_numtype1, N_rows, N_columns>& matrix,
     return _bz_VecExpr<T_expr>(T_expr(matrix.data(), vector.data()));
 }
 
+// Vector-matrix product: the matrix is read as its transpose
+template<typename T_numtype1, typename T_numtype2, int N_rows, int N_columns>
+inline _bz_VecExpr<_bz_tinyMatrixVectorProduct<T_numtype1, T_numtype2,
+    N_columns, N_rows, 1, N_columns, 1> >
+product(const TinyVector<T_numtype2, N_rows>& vector,
+    const TinyMatrix<T_numtype1, N_rows, N_columns>& matrix)
+{
+    typedef _bz_tinyMatrixVectorProduct<T_numtype1, T_numtype2, N_columns,
+        N_rows, 1, N_columns, 1> T_expr;
+    return _bz_VecExpr<T_expr>(T_expr(matrix.data(), vector.data()));
+}
+
+template<typename T1, typename T_numtype2, int N_columns>
+inline TinyVector<BZ_PROMOTE(_bz_typename T1::T_numtype, T_numtype2),
+    T1::rows>
+product(const _bz_tinyMatBase<T1>& matrix,
+    const TinyVector<T_numtype2, N_columns>& vector)
+{
+    const TinyMatrix<_bz_typename T1::T_numtype, T1::rows,
+        _bz_tinyMatSameShape<T1::columns, 1, N_columns, 1>::rows>
+        matrix2(matrix.unwrap());
+    return product(matrix2, vector);
+}
+
+template<typename T_numtype1, typename T2, int N_rows>
+inline TinyVector<BZ_PROMOTE(_bz_typename T2::T_numtype, T_numtype1),
+    T2::columns>
+product(const TinyVector<T_numtype1, N_rows>& vector,
+    const _bz_tinyMatBase<T2>& matrix)
+{
+    const TinyMatrix<_bz_typename T2::T_numtype,
+        _bz_tinyMatSameShape<T2::rows, 1, N_rows, 1>::rows, T2::columns>
+        matrix2(matrix.unwrap());
+    return product(vector, matrix2);
+}
+
 // Template metaprogram for matrix-vector multiplication
 
 template<int N_rows, int N_columns, int N_rowStride, int N_colStride,
@@ -185,7 +185,63 @@ BZ_DEFINE_BINARY_OP_RET(NotEqual,!=,bool)
 BZ_DEFINE_BINARY_OP_RET(LogicalAnd,&&,bool)
 BZ_DEFINE_BINARY_OP_RET(LogicalOr,||,bool)
     
-    
+
+/*
+ * std::complex multiply and divide follow C99 Annex G, which adds
+ * branches (and a library call) to recover infinities from NaN results
+ * and to avoid overflow in the division.  Defining BZ_FAST_COMPLEX
+ * replaces them in array expressions and updates by the textbook
+ * limited-range formulas, the equivalent of -fcx-limited-range.
+ */
+
+#if defined(BZ_FAST_COMPLEX) && defined(BZ_HAVE_COMPLEX)
+
+struct _bz_fastComplex {
+    template<typename T>
+    static inline complex<T> multiply(const complex<T>& a,
+        const complex<T>& b)
+    {
+        return complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                          a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    template<typename T>
+    static inline complex<T> divide(const complex<T>& a,
+        const complex<T>& b)
+    {
+        T d = T(1) / (b.real() * b.real() + b.imag() * b.imag());
+        return complex<T>((a.real() * b.real() + a.imag() * b.imag()) * d,
+                          (a.imag() * b.real() - a.real() * b.imag()) * d);
+    }
+};
+
+#define BZ_DEFINE_FAST_COMPLEX_OP(name,op,fn)                     \
+template<typename T>                                              \
+struct name<complex<T>, complex<T> > {                            \
+    typedef complex<T> T_numtype;                                 \
+                                                                  \
+    static inline T_numtype                                       \
+    apply(const complex<T>& a, const complex<T>& b)               \
+    { return _bz_fastComplex::fn(a, b); }                         \
+                                                                  \
+    template<typename T1, typename T2>                            \
+    static inline void prettyPrint(BZ_STD_SCOPE(string) &str,     \
+        prettyPrintFormat& format, const T1& t1,                  \
+        const T2& t2)                                             \
+    {                                                             \
+        str += "(";                                               \
+        t1.prettyPrint(str, format);                              \
+        str += #op;                                               \
+        t2.prettyPrint(str, format);                              \
+        str += ")";                                               \
+    }                                                             \
+};
+
+BZ_DEFINE_FAST_COMPLEX_OP(Multiply,*,multiply)
+BZ_DEFINE_FAST_COMPLEX_OP(Divide,/,divide)
+
+#endif // BZ_FAST_COMPLEX
+
 BZ_NAMESPACE_END
 
 #endif // BZ_OPS_H
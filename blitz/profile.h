@@ -0,0 +1,479 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/profile.h   Built-in profiler for array expression evaluation
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+/*
+ * Compiling with -DBZ_PROFILE_EXPRESSIONS makes every array assignment
+ * record, per expression (as printed by prettyPrint) and call site:
+ * the number of calls, elements processed, wall-clock time (inclusive
+ * of nested evaluations), the traversal used and whether the inner loop
+ * ran with unit stride, common stride or general strides.  Without the
+ * macro all of this compiles away.
+ *
+ * Call sites are named by putting BZ_PROFILE_SITE("name") in a scope;
+ * assignments in that scope are recorded under that name.  Results are
+ * printed with ExpressionProfiler::instance().printTable(os), or with
+ * writeChromeTrace(os) as a trace for chrome://tracing (tracing must
+ * be switched on with setTracing(true) first).  If the environment
+ * variable BZ_PROFILE_REPORT is set, a report is written at program
+ * exit: a Chrome trace if the name ends in ".json", otherwise a table
+ * ("-" for standard error).
+ *
+ * Only evaluations made outside OpenMP parallel regions are recorded.
+ */
+
+#ifndef BZ_PROFILE_H
+#define BZ_PROFILE_H
+
+#ifdef BZ_PROFILE_EXPRESSIONS
+
+#ifndef BZ_TIMER_H
+ #include <blitz/timer.h>
+#endif
+
+#include <string>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+// Largest number of individual evaluations kept for the Chrome trace
+#ifndef BZ_PROFILE_MAX_TRACE_EVENTS
+ #define BZ_PROFILE_MAX_TRACE_EVENTS 1000000
+#endif
+
+BZ_NAMESPACE(blitz)
+
+enum ExpressionTraversal {
+    indexTraversal,          // each element evaluated by index
+    stackTraversal,          // nested loops in storage order
+    collapsedTraversal,      // stack traversal with collapsed loops
+    tiledTraversal,          // 2D stencil tiling
+    spaceFillingTraversal,   // space-filling curve (3D stencils)
+    numTraversals
+};
+
+enum ExpressionInnerLoop {
+    unitStrideLoop,
+    commonStrideLoop,
+    generalStrideLoop,
+    numInnerLoops
+};
+
+struct ExpressionProfileEntry {
+    ExpressionProfileEntry(const char* site, const std::string& expression)
+      : site(site ? site : ""), expression(expression), calls(0),
+        elements(0), seconds(0)
+    {
+        for (int i=0; i < numTraversals; ++i)
+            traversals[i] = 0;
+        for (int i=0; i < numInnerLoops; ++i)
+            innerLoops[i] = 0;
+    }
+
+    // The traversal used most often
+    ExpressionTraversal traversal() const
+    {
+        return ExpressionTraversal(std::max_element(traversals,
+            traversals + numTraversals) - traversals);
+    }
+
+    std::string site, expression;
+    long calls;
+    double elements, seconds;
+    long traversals[numTraversals];
+    long innerLoops[numInnerLoops];
+};
+
+// Per-evaluate() cache of the entry, so the table is searched only when
+// the call site changes.
+struct _bz_expressionProfileKey {
+    _bz_expressionProfileKey()
+      : site(0), entry(0), generation(0)
+    { }
+
+    std::string expression;
+    const char* site;
+    ExpressionProfileEntry* entry;
+    unsigned generation;
+};
+
+class ExpressionProfiler {
+
+public:
+    static ExpressionProfiler& instance()
+    {
+        static ExpressionProfiler profiler;
+        return profiler;
+    }
+
+    ~ExpressionProfiler();
+
+    // Recording can be paused, e.g. to skip initialization
+    void setEnabled(bool enabled)
+    { enabled_ = enabled; }
+
+    bool enabled() const
+    { return enabled_; }
+
+    // Keep every evaluation for writeChromeTrace()
+    void setTracing(bool tracing)
+    { tracing_ = tracing; }
+
+    bool tracing() const
+    { return tracing_; }
+
+    // Name under which evaluations are recorded; see BZ_PROFILE_SITE
+    const char* site() const
+    { return site_; }
+
+    void setSite(const char* site)
+    { site_ = site; }
+
+    // Discards everything recorded so far
+    void reset()
+    {
+        for (unsigned i=0; i < entries_.size(); ++i)
+            delete entries_[i];
+        entries_.clear();
+        index_.clear();
+        events_.clear();
+        ++generation_;
+    }
+
+    ExpressionProfileEntry* entry(_bz_expressionProfileKey& key)
+    {
+        if (!key.entry || (key.site != site_)
+            || (key.generation != generation_))
+        {
+            std::pair<const char*, std::string> k(site_, key.expression);
+            T_index::iterator iter = index_.find(k);
+            if (iter == index_.end())
+            {
+                entries_.push_back(
+                    new ExpressionProfileEntry(site_, key.expression));
+                iter = index_.insert(std::make_pair(k,
+                    entries_.size() - 1)).first;
+            }
+            key.entry = entries_[iter->second];
+            key.site = site_;
+            key.generation = generation_;
+        }
+        return key.entry;
+    }
+
+    void addEvent(const ExpressionProfileEntry* entry, long double start,
+        long double seconds, int traversal, int innerLoop)
+    {
+        if (events_.size() < BZ_PROFILE_MAX_TRACE_EVENTS)
+        {
+            TraceEvent e = { entry, double(start - origin_), double(seconds),
+                traversal, innerLoop };
+            events_.push_back(e);
+        }
+    }
+
+    const std::vector<ExpressionProfileEntry*>& entries() const
+    { return entries_; }
+
+    // One line per expression and call site, most expensive first
+    void printTable(ostream& os) const;
+
+    // All evaluations since setTracing(true) in the Chrome trace event
+    // format (load with chrome://tracing or https://ui.perfetto.dev)
+    void writeChromeTrace(ostream& os) const;
+
+    static const char* traversalName(int traversal)
+    {
+        static const char* names[] = { "index", "stack", "collapsed",
+            "tiled", "space-filling" };
+        return ((traversal >= 0) && (traversal < numTraversals))
+            ? names[traversal] : "none";
+    }
+
+    static const char* innerLoopName(int innerLoop)
+    {
+        static const char* names[] = { "unit stride", "common stride",
+            "general stride" };
+        return ((innerLoop >= 0) && (innerLoop < numInnerLoops))
+            ? names[innerLoop] : "none";
+    }
+
+private:
+    ExpressionProfiler();
+    ExpressionProfiler(const ExpressionProfiler&) { }
+    void operator=(const ExpressionProfiler&) { }
+
+    static void writeJSONString(ostream& os, const std::string& str);
+
+    struct TraceEvent {
+        const ExpressionProfileEntry* entry;
+        double start, seconds;
+        int traversal, innerLoop;
+    };
+
+    typedef std::map<std::pair<const char*, std::string>, unsigned>
+        T_index;
+
+    bool enabled_, tracing_;
+    const char* site_;
+    unsigned generation_;
+    long double origin_;
+    std::vector<ExpressionProfileEntry*> entries_;
+    T_index index_;
+    std::vector<TraceEvent> events_;
+};
+
+/*
+ * One evaluation in progress.  The traversal routines report their
+ * choices to the innermost active evaluation through the static hooks.
+ */
+class _bz_evaluationProfile {
+
+public:
+    _bz_evaluationProfile(_bz_expressionProfileKey& key, double elements)
+      : entry_(0), elements_(elements), traversal_(-1), innerLoop_(-1)
+    {
+        if (!active())
+            return;
+
+        entry_ = ExpressionProfiler::instance().entry(key);
+        previous_ = current();
+        current() = this;
+        start_ = Timer::wallClockTime();
+    }
+
+    // Whether an evaluation starting now is recorded: the profiler is
+    // enabled and this is not a thread of a parallel region.  Callers
+    // fill in the expression of the key only then.
+    static bool active()
+    {
+#ifdef _OPENMP
+        if (omp_in_parallel())
+            return false;
+#endif
+        return ExpressionProfiler::instance().enabled();
+    }
+
+    ~_bz_evaluationProfile()
+    {
+        if (!entry_)
+            return;
+
+        long double seconds = Timer::wallClockTime() - start_;
+        current() = previous_;
+
+        ++entry_->calls;
+        entry_->elements += elements_;
+        entry_->seconds += seconds;
+        if (traversal_ >= 0)
+            ++entry_->traversals[traversal_];
+        if (innerLoop_ >= 0)
+            ++entry_->innerLoops[innerLoop_];
+
+        ExpressionProfiler& profiler = ExpressionProfiler::instance();
+        if (profiler.tracing())
+            profiler.addEvent(entry_, start_, seconds, traversal_,
+                innerLoop_);
+    }
+
+    static void setTraversal(ExpressionTraversal traversal)
+    {
+        if (current())
+            current()->traversal_ = traversal;
+    }
+
+    static void setInnerLoop(bool useUnitStride, bool useCommonStride)
+    {
+        if (current())
+            current()->innerLoop_ = useUnitStride ? unitStrideLoop
+                : (useCommonStride ? commonStrideLoop : generalStrideLoop);
+    }
+
+private:
+    _bz_evaluationProfile(const _bz_evaluationProfile&) { }
+    void operator=(const _bz_evaluationProfile&) { }
+
+    static _bz_evaluationProfile*& current()
+    {
+        static _bz_evaluationProfile* current = 0;
+        return current;
+    }
+
+    ExpressionProfileEntry* entry_;
+    _bz_evaluationProfile* previous_;
+    long double start_;
+    double elements_;
+    int traversal_, innerLoop_;
+};
+
+// Sets the call-site name for the enclosing scope
+class _bz_profileSite {
+
+public:
+    explicit _bz_profileSite(const char* name)
+      : previous_(ExpressionProfiler::instance().site())
+    { ExpressionProfiler::instance().setSite(name); }
+
+    ~_bz_profileSite()
+    { ExpressionProfiler::instance().setSite(previous_); }
+
+private:
+    const char* previous_;
+};
+
+inline ExpressionProfiler::ExpressionProfiler()
+  : enabled_(true), tracing_(false), site_(0), generation_(1),
+    origin_(Timer::wallClockTime())
+{
+    const char* report = getenv("BZ_PROFILE_REPORT");
+    if (report && (strlen(report) > 5)
+        && !strcmp(report + strlen(report) - 5, ".json"))
+        tracing_ = true;
+}
+
+inline ExpressionProfiler::~ExpressionProfiler()
+{
+    const char* report = getenv("BZ_PROFILE_REPORT");
+    if (report && *report)
+    {
+        if (!strcmp(report, "-"))
+            printTable(cerr);
+        else {
+            ofstream ofs(report);
+            if (tracing_)
+                writeChromeTrace(ofs);
+            else
+                printTable(ofs);
+        }
+    }
+    reset();
+}
+
+inline bool _bz_compareProfileEntries(const ExpressionProfileEntry* a,
+    const ExpressionProfileEntry* b)
+{
+    return a->seconds > b->seconds;
+}
+
+inline void ExpressionProfiler::printTable(ostream& os) const
+{
+    std::vector<ExpressionProfileEntry*> sorted(entries_);
+    std::sort(sorted.begin(), sorted.end(), _bz_compareProfileEntries);
+
+    os << setw(10) << "calls" << setw(14) << "elements" << setw(12)
+       << "seconds" << setw(10) << "Melem/s" << "  " << setw(14)
+       << std::left << "traversal" << setw(8) << "unit%"
+       << "site / expression" << std::right << endl;
+
+    for (unsigned i=0; i < sorted.size(); ++i)
+    {
+        const ExpressionProfileEntry& e = *sorted[i];
+        long loops = 0;
+        for (int j=0; j < numInnerLoops; ++j)
+            loops += e.innerLoops[j];
+
+        os << setw(10) << e.calls << setw(14) << e.elements << setw(12)
+           << e.seconds << setw(10)
+           << (e.seconds > 0 ? e.elements / e.seconds / 1.0e6 : 0.0)
+           << "  " << setw(14) << std::left << traversalName(e.traversal())
+           << setw(8);
+        if (loops > 0)
+            os << int(100.0 * e.innerLoops[unitStrideLoop] / loops + 0.5);
+        else
+            os << "-";
+        if (e.site.length())
+            os << e.site << ": ";
+        os << e.expression << std::right << endl;
+    }
+}
+
+inline void ExpressionProfiler::writeJSONString(ostream& os,
+    const std::string& str)
+{
+    os << '"';
+    for (unsigned i=0; i < str.length(); ++i)
+    {
+        if ((str[i] == '"') || (str[i] == '\\'))
+            os << '\\';
+        os << str[i];
+    }
+    os << '"';
+}
+
+inline void ExpressionProfiler::writeChromeTrace(ostream& os) const
+{
+    os << "{\"traceEvents\":[" << endl;
+    os.setf(ios::fixed);
+    os << setprecision(3);
+    for (unsigned i=0; i < events_.size(); ++i)
+    {
+        const TraceEvent& e = events_[i];
+        os << "{\"name\":";
+        writeJSONString(os, e.entry->site.length()
+            ? e.entry->site + ": " + e.entry->expression
+            : e.entry->expression);
+        os << ",\"cat\":\"blitz\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+           << ",\"ts\":" << e.start * 1.0e6 << ",\"dur\":" << e.seconds * 1.0e6
+           << ",\"args\":{\"traversal\":\"" << traversalName(e.traversal)
+           << "\",\"inner_loop\":\"" << innerLoopName(e.innerLoop) << "\"}}"
+           << (i+1 < events_.size() ? "," : "") << endl;
+    }
+    os << "]}" << endl;
+    os.unsetf(ios::fixed);
+}
+
+BZ_NAMESPACE_END
+
+#define BZ_PROFILE_JOIN2(a, b) a##b
+#define BZ_PROFILE_JOIN(a, b) BZ_PROFILE_JOIN2(a, b)
+#define BZ_PROFILE_SITE(name) \
+    BZ_BLITZ_SCOPE(_bz_profileSite) BZ_PROFILE_JOIN(_bz_profileSite, __LINE__)(name)
+#define BZ_PROFILE_TRAVERSAL(traversal) \
+    _bz_evaluationProfile::setTraversal(traversal)
+#define BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride) \
+    _bz_evaluationProfile::setInnerLoop(useUnitStride, useCommonStride)
+
+#else // !BZ_PROFILE_EXPRESSIONS
+
+#define BZ_PROFILE_SITE(name)
+#define BZ_PROFILE_TRAVERSAL(traversal)
+#define BZ_PROFILE_INNER_LOOP(useUnitStride, useCommonStride)
+
+#endif // BZ_PROFILE_EXPRESSIONS
+
+#endif // BZ_PROFILE_H
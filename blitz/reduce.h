@@ -45,6 +45,12 @@
  #include <blitz/numinquire.h>
 #endif
 
+#ifndef BZ_PROMOTE_H
+ #include <blitz/promote.h>
+#endif
+
+#include <vector>
+
 //  The various reduce classes.
 //  The prototype of the reset method is mandated by the class _bz_ReduceReset
 //  in file array/reduce.h
@@ -61,7 +67,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceSum() { }
+    ReduceSum() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const { 
         sum_ += x; 
@@ -72,6 +78,8 @@ public:
 
     void reset() const { sum_ = zero(T_resulttype()); }
  
+    void merge(const ReduceSum& x) const { sum_ += x.sum_; }
+
     static const char* name() { return "sum"; }
  
 protected:
@@ -89,7 +97,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceMean() { }
+    ReduceMean() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const { 
         sum_ += x; 
@@ -100,6 +108,8 @@ public:
 
     void reset() const { sum_ = zero(T_resulttype()); }
 
+    void merge(const ReduceMean& x) const { sum_ += x.sum_; }
+
     static const char* name() { return "mean"; }
 
 protected:
@@ -117,7 +127,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceMin() { }
+    ReduceMin() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const {
         if (x < min_)
@@ -129,6 +139,11 @@ public:
 
     void reset() const { min_ = huge(P_sourcetype()); }
 
+    void merge(const ReduceMin& x) const {
+        if (x.min_ < min_)
+            min_ = x.min_;
+    }
+
     static const char* name() { return "min"; }
 
 protected:
@@ -146,7 +161,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceMax() { }
+    ReduceMax() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const {
         if (x > max_)
@@ -158,6 +173,11 @@ public:
 
     void reset() const { max_ = neghuge(P_sourcetype()); }
 
+    void merge(const ReduceMax& x) const {
+        if (x.max_ > max_)
+            max_ = x.max_;
+    }
+
     static const char* name() { return "max"; }
 
 protected:
@@ -182,7 +202,7 @@ public:
 
     static const bool needIndex = false, needInit = true;
 
-    ReduceMinMax() { }
+    ReduceMinMax() { reset(zero(P_sourcetype())); }
 
     bool operator()(T_sourcetype x,const int=0) const {
         if (x > minmax_.max)
@@ -192,10 +212,17 @@ public:
         return true;
     }
 
-    T_resulttype result(int) { return minmax_; }
+    T_resulttype result(int) const { return minmax_; }
 
     void reset(P_sourcetype initialValue) const { minmax_ = initialValue; }
 
+    void merge(const ReduceMinMax& x) const {
+        if (x.minmax_.max > minmax_.max)
+            minmax_.max = x.minmax_.max;
+        if (x.minmax_.min < minmax_.min)
+            minmax_.min = x.minmax_.min;
+    }
+
     static const char* name() { return "minmax"; }
 
 protected:
@@ -353,7 +380,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceFirst() { }
+    ReduceFirst() { reset(); }
 
     bool operator()(const T_sourcetype& x,const T_resulttype& index) const {
         if (x) {
@@ -384,7 +411,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceLast() { }
+    ReduceLast() { reset(); }
 
     bool operator()(const T_sourcetype& x,const T_resulttype& index) const {
         if (x) {
@@ -415,7 +442,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceProduct() { }
+    ReduceProduct() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const { 
         product_ *= x; 
@@ -426,6 +453,8 @@ public:
 
     void reset() const { product_ = one(T_resulttype()); }
 
+    void merge(const ReduceProduct& x) const { product_ *= x.product_; }
+
     static const char* name() { return "product"; }
 
 protected:
@@ -443,7 +472,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceCount() { }
+    ReduceCount() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const {
         if (bool(x))
@@ -455,6 +484,8 @@ public:
 
     void reset() const { count_ = zero(T_resulttype()); }
 
+    void merge(const ReduceCount& x) const { count_ += x.count_; }
+
     static const char* name() { return "count"; }
 
 protected:
@@ -472,7 +503,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceAny() { }
+    ReduceAny() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const {
         if (bool(x)) {
@@ -487,6 +518,8 @@ public:
 
     void reset() const { any_ = false; }
 
+    void merge(const ReduceAny& x) const { any_ = any_ || x.any_; }
+
     static const char* name() { return "any"; }
 
 protected:
@@ -504,7 +537,7 @@ public:
 
     static const bool needIndex = false, needInit = false;
 
-    ReduceAll() { }
+    ReduceAll() { reset(); }
 
     bool operator()(const T_sourcetype& x,const int=0) const {
         if (!bool(x)) {
@@ -518,6 +551,8 @@ public:
 
     void reset() const { all_ = true; }
 
+    void merge(const ReduceAll& x) const { all_ = all_ && x.all_; }
+
     static const char* name() { return "all"; }
 
 protected:
@@ -525,6 +560,628 @@ protected:
     mutable T_resulttype all_;
 }; 
 
+// Welford's running mean and variance.  result() is the population
+// variance; merge() combines two partial results with the update of
+// Chan, Golub and LeVeque.
+
+template<typename P_sourcetype, typename P_resulttype = BZ_FLOATTYPE(P_sourcetype)>
+class ReduceVariance {
+public:
+
+    typedef P_sourcetype T_sourcetype;
+    typedef P_resulttype T_resulttype;
+    typedef T_resulttype T_numtype;
+
+    static const bool needIndex = false, needInit = false;
+
+    ReduceVariance() { reset(); }
+
+    bool operator()(const T_sourcetype& x,const int=0) const {
+        const T_resulttype y = x, d = y - mean_;
+        ++count_;
+        mean_ += d / T_resulttype(count_);
+        m2_ += d * (y - mean_);
+        return true;
+    }
+
+    T_resulttype result(const int) const { return variance(); }
+
+    void reset() const {
+        count_ = 0;
+        mean_ = m2_ = zero(T_resulttype());
+    }
+
+    void merge(const ReduceVariance& x) const
+    { merge(x.count_, x.mean_, x.m2_); }
+
+    // Adds count values with the given mean and sum of squared
+    // deviations from it
+    void merge(sizeType count, T_resulttype mean, T_resulttype m2) const {
+        if (count == 0)
+            return;
+        const T_resulttype d = mean - mean_,
+            w = T_resulttype(count) / T_resulttype(count_ + count);
+        mean_ += d * w;
+        m2_ += m2 + d * d * T_resulttype(count_) * w;
+        count_ += count;
+    }
+
+    sizeType count() const { return count_; }
+    T_resulttype mean() const { return mean_; }
+
+    T_resulttype variance() const
+    { return count_ ? m2_ / T_resulttype(count_) : zero(T_resulttype()); }
+
+    T_resulttype sampleVariance() const
+    { return (count_ > 1) ? m2_ / T_resulttype(count_ - 1) : zero(T_resulttype()); }
+
+    static const char* name() { return "variance"; }
+
+protected:
+
+    mutable sizeType count_;
+    mutable T_resulttype mean_, m2_;
+};
+
+// Counts in numBins equal bins covering [lo, hi).  Values below lo, and
+// values at or above hi (or NaN), are counted by underflow() and
+// overflow().
+
+template<typename P_sourcetype>
+class ReduceHistogram {
+public:
+
+    typedef P_sourcetype T_sourcetype;
+    typedef Array<int,1> T_resulttype;
+    typedef T_resulttype T_numtype;
+    typedef BZ_FLOATTYPE(P_sourcetype) T_floattype;
+
+    static const bool needIndex = false, needInit = false;
+
+    ReduceHistogram(T_sourcetype lo, T_sourcetype hi, int numBins)
+      : lo_(lo), scale_(numBins / (T_floattype(hi) - T_floattype(lo))),
+        bins_(numBins), underflow_(0), overflow_(0)
+    {
+        BZPRECONDITION(numBins > 0);
+        BZPRECONDITION(hi > lo);
+    }
+
+    bool operator()(const T_sourcetype& x,const int=0) const {
+        const T_floattype position = (T_floattype(x) - lo_) * scale_;
+        if ((position >= 0) && (position < numBins()))
+            ++bins_[int(position)];
+        else if (position < 0)
+            ++underflow_;
+        else
+            ++overflow_;
+        return true;
+    }
+
+    T_resulttype result(const int) const {
+        T_resulttype counts(numBins());
+        for (int b=0; b < numBins(); ++b)
+            counts(b) = bins_[b];
+        return counts;
+    }
+
+    void reset() const {
+        for (int b=0; b < numBins(); ++b)
+            bins_[b] = 0;
+        underflow_ = overflow_ = 0;
+    }
+
+    void merge(const ReduceHistogram& x) const {
+        for (int b=0; b < numBins(); ++b)
+            bins_[b] += x.bins_[b];
+        underflow_ += x.underflow_;
+        overflow_ += x.overflow_;
+    }
+
+    int numBins() const { return int(bins_.size()); }
+    int underflow() const { return underflow_; }
+    int overflow() const { return overflow_; }
+
+    static const char* name() { return "histogram"; }
+
+protected:
+
+    T_floattype lo_, scale_;
+    mutable std::vector<int> bins_;
+    mutable int underflow_, overflow_;
+};
+
+/*
+ * Accumulation policies for sum(), mean() and product().  The policy is
+ * given as an extra argument, for example
+ *
+ *     double s = sum(A, compensatedAccumulation);
+ *     B = mean(A(tensor::i, tensor::j), tensor::j, pairwiseAccumulation);
+ *
+ * naiveAccumulation        adds in the result type (BZ_SUMTYPE for sum
+ *                          and product, BZ_FLOATTYPE for mean)
+ * pairwiseAccumulation     adds blocks of BZ_REDUCE_PAIRWISE_BLOCK
+ *                          elements, and combines the block results in a
+ *                          binary tree: the error grows as log(n)
+ * compensatedAccumulation  carries the rounding error of every addition
+ *                          (or multiplication) in a second term: the
+ *                          error does not grow with n
+ * wideAccumulation         adds in a wider type: double for float, long
+ *                          double for double
+ * nativeAccumulation       adds in the element type, so that float
+ *                          is summed in float
+ *
+ * The result has the same type as for the default reduction.  The full
+ * reductions split unit-stride rows into BZ_REDUCE_LANES independent
+ * partial results, which the compiler vectorizes; so, unlike the default
+ * reduction, they do not add the elements in order.  The partial
+ * reductions take the elements one at a time.
+ */
+
+#ifndef BZ_REDUCE_LANES
+ #define BZ_REDUCE_LANES  16
+#endif
+
+#ifndef BZ_REDUCE_PAIRWISE_BLOCK
+ #define BZ_REDUCE_PAIRWISE_BLOCK  256
+#endif
+
+class _bz_naiveAccumulation { };
+class _bz_pairwiseAccumulation { };
+class _bz_compensatedAccumulation { };
+class _bz_wideAccumulation { };
+class _bz_nativeAccumulation { };
+
+// The argument passed to the reductions
+template<typename P_accumulation>
+class _bz_accumulationTag { };
+
+const _bz_accumulationTag<_bz_naiveAccumulation> naiveAccumulation
+    = _bz_accumulationTag<_bz_naiveAccumulation>();
+const _bz_accumulationTag<_bz_pairwiseAccumulation> pairwiseAccumulation
+    = _bz_accumulationTag<_bz_pairwiseAccumulation>();
+const _bz_accumulationTag<_bz_compensatedAccumulation> compensatedAccumulation
+    = _bz_accumulationTag<_bz_compensatedAccumulation>();
+const _bz_accumulationTag<_bz_wideAccumulation> wideAccumulation
+    = _bz_accumulationTag<_bz_wideAccumulation>();
+const _bz_accumulationTag<_bz_nativeAccumulation> nativeAccumulation
+    = _bz_accumulationTag<_bz_nativeAccumulation>();
+
+template<typename T>
+struct _bz_widen {
+    typedef T T_wide;
+};
+
+template<>
+struct _bz_widen<float> {
+    typedef double T_wide;
+};
+
+template<>
+struct _bz_widen<double> {
+    typedef long double T_wide;
+};
+
+#ifdef BZ_HAVE_COMPLEX
+template<>
+struct _bz_widen<complex<float> > {
+    typedef complex<double> T_wide;
+};
+
+template<>
+struct _bz_widen<complex<double> > {
+    typedef complex<long double> T_wide;
+};
+#endif
+
+// The type in which a policy accumulates
+
+template<typename P_accumulation, typename T_source, typename T_result>
+struct _bz_accumulationType {
+    typedef T_result T_acc;
+};
+
+template<typename T_source, typename T_result>
+struct _bz_accumulationType<_bz_wideAccumulation, T_source, T_result> {
+    typedef _bz_typename _bz_widen<T_result>::T_wide T_acc;
+};
+
+template<typename T_source, typename T_result>
+struct _bz_accumulationType<_bz_nativeAccumulation, T_source, T_result> {
+    typedef BZ_PROMOTE(T_source, T_source) T_acc;
+};
+
+struct _bz_sumOp {
+    template<typename T>
+    static inline T identity(T) { return zero(T()); }
+
+    template<typename T>
+    static inline T apply(T a, T b) { return a + b; }
+};
+
+struct _bz_productOp {
+    template<typename T>
+    static inline T identity(T) { return one(T()); }
+
+    template<typename T>
+    static inline T apply(T a, T b) { return a * b; }
+};
+
+// The rounding error of s = a + b (Knuth's TwoSum).  It has no branch,
+// and works on complex numbers component by component.
+
+template<typename T>
+inline T _bz_sumError(T a, T b, T s)
+{
+    const T bb = s - a;
+    return (a - (s - bb)) + (b - bb);
+}
+
+// The rounding error of p = a * b, using a fused multiply-add.  It is
+// zero for the types without one.
+
+template<typename T>
+inline T _bz_productError(T, T, T)
+{ return zero(T()); }
+
+#if __cplusplus >= 201103L
+inline float _bz_productError(float a, float b, float p)
+{ return std::fma(a, b, -p); }
+
+inline double _bz_productError(double a, double b, double p)
+{ return std::fma(a, b, -p); }
+
+inline long double _bz_productError(long double a, long double b,
+    long double p)
+{ return std::fma(a, b, -p); }
+#else
+// Without fma, Dekker's product: split the factors into halves whose
+// products are exact
+template<typename T>
+inline T _bz_dekkerError(T a, T b, T p, T splitter)
+{
+    const T ca = splitter * a, cb = splitter * b;
+    const T ah = ca - (ca - a), al = a - ah;
+    const T bh = cb - (cb - b), bl = b - bh;
+    return (((ah * bh - p) + ah * bl) + al * bh) + al * bl;
+}
+
+inline float _bz_productError(float a, float b, float p)
+{ return _bz_dekkerError(a, b, p, 4097.f); }
+
+inline double _bz_productError(double a, double b, double p)
+{ return _bz_dekkerError(a, b, p, 134217729.); }
+#endif
+
+/*
+ * Accumulators.  add() takes one element.  T_lanes holds the state of
+ * BZ_REDUCE_LANES independent accumulators as arrays, so that updating
+ * all of them is a loop the compiler can vectorize; addLanes() folds
+ * them into the accumulator.
+ */
+
+template<typename P_acc, typename P_op>
+class _bz_NaiveLanes {
+public:
+    typedef P_acc T_acc;
+
+    void reset()
+    {
+        for (int k=0; k < BZ_REDUCE_LANES; ++k)
+            value_[k] = P_op::identity(T_acc());
+    }
+
+    void add(int k, T_acc x) { value_[k] = P_op::apply(value_[k], x); }
+
+    T_acc value() const
+    {
+        T_acc x = value_[0];
+        for (int k=1; k < BZ_REDUCE_LANES; ++k)
+            x = P_op::apply(x, value_[k]);
+        return x;
+    }
+
+private:
+    T_acc value_[BZ_REDUCE_LANES];
+};
+
+template<typename P_acc, typename P_op>
+class _bz_NaiveAccumulator {
+public:
+    typedef P_acc T_acc;
+    typedef _bz_NaiveLanes<P_acc, P_op> T_lanes;
+
+    void reset() { value_ = P_op::identity(T_acc()); }
+    void add(T_acc x) { value_ = P_op::apply(value_, x); }
+    void addLanes(const T_lanes& x) { add(x.value()); }
+    void merge(const _bz_NaiveAccumulator& x) { add(x.value_); }
+    T_acc value() const { return value_; }
+
+private:
+    T_acc value_;
+};
+
+template<typename P_acc>
+class _bz_CompensatedSumLanes {
+public:
+    typedef P_acc T_acc;
+
+    void reset()
+    {
+        for (int k=0; k < BZ_REDUCE_LANES; ++k)
+            sum_[k] = error_[k] = zero(T_acc());
+    }
+
+    void add(int k, T_acc x)
+    {
+        const T_acc s = sum_[k] + x;
+        error_[k] += _bz_sumError(sum_[k], x, s);
+        sum_[k] = s;
+    }
+
+    T_acc sum(int k) const { return sum_[k]; }
+    T_acc error(int k) const { return error_[k]; }
+
+private:
+    T_acc sum_[BZ_REDUCE_LANES], error_[BZ_REDUCE_LANES];
+};
+
+template<typename P_acc>
+class _bz_CompensatedSum {
+public:
+    typedef P_acc T_acc;
+    typedef _bz_CompensatedSumLanes<P_acc> T_lanes;
+
+    void reset() { sum_ = error_ = zero(T_acc()); }
+
+    void add(T_acc x)
+    {
+        const T_acc s = sum_ + x;
+        error_ += _bz_sumError(sum_, x, s);
+        sum_ = s;
+    }
+
+    void addLanes(const T_lanes& x)
+    {
+        for (int k=0; k < BZ_REDUCE_LANES; ++k)
+        {
+            add(x.sum(k));
+            error_ += x.error(k);
+        }
+    }
+
+    void merge(const _bz_CompensatedSum& x)
+    {
+        add(x.sum_);
+        error_ += x.error_;
+    }
+
+    T_acc value() const { return sum_ + error_; }
+
+private:
+    T_acc sum_, error_;
+};
+
+// Graillat's compensated product: the error term is carried to first
+// order, which makes the result as accurate as if it had been computed
+// in twice the working precision.
+
+template<typename P_acc>
+class _bz_CompensatedProductLanes {
+public:
+    typedef P_acc T_acc;
+
+    void reset()
+    {
+        for (int k=0; k < BZ_REDUCE_LANES; ++k)
+        {
+            product_[k] = one(T_acc());
+            error_[k] = zero(T_acc());
+        }
+    }
+
+    void add(int k, T_acc x)
+    {
+        const T_acc p = product_[k] * x;
+        error_[k] = error_[k] * x + _bz_productError(product_[k], x, p);
+        product_[k] = p;
+    }
+
+    T_acc product(int k) const { return product_[k]; }
+    T_acc error(int k) const { return error_[k]; }
+
+private:
+    T_acc product_[BZ_REDUCE_LANES], error_[BZ_REDUCE_LANES];
+};
+
+template<typename P_acc>
+class _bz_CompensatedProduct {
+public:
+    typedef P_acc T_acc;
+    typedef _bz_CompensatedProductLanes<P_acc> T_lanes;
+
+    void reset() { product_ = one(T_acc()); error_ = zero(T_acc()); }
+
+    void add(T_acc x)
+    {
+        const T_acc p = product_ * x;
+        error_ = error_ * x + _bz_productError(product_, x, p);
+        product_ = p;
+    }
+
+    void addLanes(const T_lanes& x)
+    {
+        for (int k=0; k < BZ_REDUCE_LANES; ++k)
+            multiply(x.product(k), x.error(k));
+    }
+
+    void merge(const _bz_CompensatedProduct& x)
+    { multiply(x.product_, x.error_); }
+
+    T_acc value() const { return product_ + error_; }
+
+private:
+    // Multiply by q + e, where e is small
+    void multiply(T_acc q, T_acc e)
+    {
+        const T_acc p = product_ * q;
+        error_ = error_ * q + product_ * e + _bz_productError(product_, q, p);
+        product_ = p;
+    }
+
+    T_acc product_, error_;
+};
+
+// Blocks are combined like the digits of a binary counter, so that the
+// stack holds at most one partial result for each power of two.
+
+template<typename P_acc, typename P_op>
+class _bz_PairwiseAccumulator {
+public:
+    typedef P_acc T_acc;
+    typedef _bz_NaiveLanes<P_acc, P_op> T_lanes;
+
+    void reset()
+    {
+        block_ = P_op::identity(T_acc());
+        blockSize_ = 0;
+        depth_ = 0;
+    }
+
+    void add(T_acc x)
+    {
+        block_ = P_op::apply(block_, x);
+        if (++blockSize_ == BZ_REDUCE_PAIRWISE_BLOCK)
+        {
+            push(block_);
+            block_ = P_op::identity(T_acc());
+            blockSize_ = 0;
+        }
+    }
+
+    void addLanes(const T_lanes& x) { push(x.value()); }
+    void merge(const _bz_PairwiseAccumulator& x) { push(x.value()); }
+
+    T_acc value() const
+    {
+        T_acc x = block_;
+        for (int d=depth_-1; d >= 0; --d)
+            x = P_op::apply(stack_[d], x);
+        return x;
+    }
+
+private:
+    void push(T_acc x)
+    {
+        BZPRECONDITION(depth_ < maxDepth);
+        stack_[depth_] = x;
+        level_[depth_++] = 0;
+        while ((depth_ > 1) && (level_[depth_-1] == level_[depth_-2]))
+        {
+            --depth_;
+            stack_[depth_-1] = P_op::apply(stack_[depth_-1], stack_[depth_]);
+            ++level_[depth_-1];
+        }
+    }
+
+    static const int maxDepth = 8 * sizeof(sizeType);
+
+    T_acc block_;
+    int blockSize_, depth_;
+    T_acc stack_[maxDepth];
+    int level_[maxDepth];
+};
+
+template<typename P_acc, typename P_op, typename P_accumulation>
+struct _bz_accumulatorFor {
+    typedef _bz_NaiveAccumulator<P_acc, P_op> T_accumulator;
+};
+
+template<typename P_acc, typename P_op>
+struct _bz_accumulatorFor<P_acc, P_op, _bz_pairwiseAccumulation> {
+    typedef _bz_PairwiseAccumulator<P_acc, P_op> T_accumulator;
+};
+
+template<typename P_acc>
+struct _bz_accumulatorFor<P_acc, _bz_sumOp, _bz_compensatedAccumulation> {
+    typedef _bz_CompensatedSum<P_acc> T_accumulator;
+};
+
+template<typename P_acc>
+struct _bz_accumulatorFor<P_acc, _bz_productOp, _bz_compensatedAccumulation> {
+    typedef _bz_CompensatedProduct<P_acc> T_accumulator;
+};
+
+// The reductions themselves
+
+template<typename P_sourcetype, typename P_resulttype, typename P_op,
+    typename P_accumulation>
+class _bz_ReduceAccumulated {
+public:
+
+    typedef P_sourcetype T_sourcetype;
+    typedef P_resulttype T_resulttype;
+    typedef T_resulttype T_numtype;
+    typedef _bz_typename _bz_accumulationType<P_accumulation, P_sourcetype,
+        P_resulttype>::T_acc T_acc;
+    typedef _bz_typename _bz_accumulatorFor<T_acc, P_op,
+        P_accumulation>::T_accumulator T_accumulator;
+    typedef _bz_typename T_accumulator::T_lanes T_lanes;
+
+    static const bool needIndex = false, needInit = false;
+
+    bool operator()(const T_sourcetype& x,const int=0) const {
+        accumulator_.add(T_acc(x));
+        return true;
+    }
+
+    void addLanes(const T_lanes& x) const { accumulator_.addLanes(x); }
+
+    void merge(const _bz_ReduceAccumulated& x) const
+    { accumulator_.merge(x.accumulator_); }
+
+    void reset() const { accumulator_.reset(); }
+
+protected:
+
+    mutable T_accumulator accumulator_;
+};
+
+template<typename P_sourcetype, typename P_accumulation,
+    typename P_resulttype = BZ_SUMTYPE(P_sourcetype)>
+class ReduceSumAccumulated : public _bz_ReduceAccumulated<P_sourcetype,
+    P_resulttype, _bz_sumOp, P_accumulation> {
+public:
+
+    P_resulttype result(const int) const
+    { return P_resulttype(this->accumulator_.value()); }
+
+    static const char* name() { return "sum"; }
+};
+
+template<typename P_sourcetype, typename P_accumulation,
+    typename P_resulttype = BZ_FLOATTYPE(P_sourcetype)>
+class ReduceMeanAccumulated : public _bz_ReduceAccumulated<P_sourcetype,
+    P_resulttype, _bz_sumOp, P_accumulation> {
+public:
+
+    P_resulttype result(const int count) const
+    { return P_resulttype(this->accumulator_.value()) / count; }
+
+    static const char* name() { return "mean"; }
+};
+
+template<typename P_sourcetype, typename P_accumulation,
+    typename P_resulttype = BZ_SUMTYPE(P_sourcetype)>
+class ReduceProductAccumulated : public _bz_ReduceAccumulated<P_sourcetype,
+    P_resulttype, _bz_productOp, P_accumulation> {
+public:
+
+    P_resulttype result(const int) const
+    { return P_resulttype(this->accumulator_.value()); }
+
+    static const char* name() { return "product"; }
+};
+
 BZ_NAMESPACE_END
 
 #endif // BZ_REDUCE_H
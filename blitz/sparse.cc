@@ -0,0 +1,309 @@
+/***************************************************************************
+ * blitz/sparse.cc      Member functions of SparseMatrix<T>
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ****************************************************************************/
+#ifndef BZ_SPARSE_CC
+#define BZ_SPARSE_CC
+
+#ifndef BZ_SPARSE_H
+ #error <blitz/sparse.cc> must be included via <blitz/sparse.h>
+#endif
+
+BZ_NAMESPACE(blitz)
+
+template<typename P_numtype> template<typename T_iterator>
+void SparseMatrix<P_numtype>::setFromTriplets(T_iterator first,
+    T_iterator last)
+{
+    clearEll();
+    clearTranspose();
+    layout_ = csr;
+
+    // Counting sort on the row index, then sort each row by column
+    // and merge duplicates.
+    std::vector<int> count(rows_+1, 0);
+    int n = 0;
+    for (T_iterator iter = first; iter != last; ++iter, ++n)
+    {
+        BZPRECHECK((iter->row >= 0) && (iter->row < rows_)
+            && (iter->col >= 0) && (iter->col < cols_),
+            "SparseMatrix::setFromTriplets: entry (" << iter->row << ","
+            << iter->col << ") is outside a " << rows_ << " x " << cols_
+            << " matrix");
+        ++count[iter->row + 1];
+    }
+
+    for (int i=0; i < rows_; ++i)
+        count[i+1] += count[i];
+
+    std::vector<int> cols(n);
+    std::vector<T_numtype> vals(n);
+    std::vector<int> next(count.begin(), count.end() - 1);
+    for (T_iterator iter = first; iter != last; ++iter)
+    {
+        int pos = next[iter->row]++;
+        cols[pos] = iter->col;
+        vals[pos] = iter->value;
+    }
+
+    rowPtr_.assign(rows_+1, 0);
+    colIdx_.clear();
+    values_.clear();
+    colIdx_.reserve(n);
+    values_.reserve(n);
+
+    std::vector<std::pair<int,int> > order;
+    for (int i=0; i < rows_; ++i)
+    {
+        const int begin = count[i], end = count[i+1];
+        order.resize(end - begin);
+        for (int k=begin; k < end; ++k)
+            order[k-begin] = std::make_pair(cols[k], k);
+        std::sort(order.begin(), order.end());
+
+        for (int k=0; k < end - begin; ++k)
+        {
+            const int j = order[k].first;
+            const T_numtype v = vals[order[k].second];
+            if ((int(colIdx_.size()) > rowPtr_[i]) && (colIdx_.back() == j))
+                values_.back() += v;
+            else {
+                colIdx_.push_back(j);
+                values_.push_back(v);
+            }
+        }
+        rowPtr_[i+1] = colIdx_.size();
+    }
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::setFromTriplets(const Array<int,1>& rowIndices,
+    const Array<int,1>& colIndices, const Array<T_numtype,1>& values)
+{
+    BZPRECHECK((rowIndices.extent(0) == colIndices.extent(0))
+        && (rowIndices.extent(0) == values.extent(0)),
+        "SparseMatrix::setFromTriplets: index and value arrays must have "
+        "the same length");
+
+    const int n = values.extent(0);
+    std::vector<T_triplet> triplets(n);
+    for (int k=0; k < n; ++k)
+        triplets[k] = T_triplet(rowIndices(rowIndices.lbound(0) + k),
+            colIndices(colIndices.lbound(0) + k),
+            values(values.lbound(0) + k));
+    setFromTriplets(triplets.begin(), triplets.end());
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::useSlicedEll()
+{
+    const int C = BZ_SPARSE_ELL_SLICE_HEIGHT;
+    const int numSlices = (rows_ + C - 1) / C;
+
+    ellSlicePtr_.assign(numSlices + 1, 0);
+    for (int s=0; s < numSlices; ++s)
+    {
+        int width = 0;
+        for (int r=s*C; r < std::min(s*C + C, rows_); ++r)
+            width = std::max(width, rowPtr_[r+1] - rowPtr_[r]);
+        ellSlicePtr_[s+1] = ellSlicePtr_[s] + width * C;
+    }
+
+    ellColIdx_.assign(ellSlicePtr_[numSlices], 0);
+    ellValues_.assign(ellSlicePtr_[numSlices], T_numtype(0));
+
+    for (int s=0; s < numSlices; ++s)
+    {
+        const int base = ellSlicePtr_[s];
+        const int width = (ellSlicePtr_[s+1] - base) / C;
+        for (int r=0; r < C; ++r)
+        {
+            const int row = s*C + r;
+            const int len = (row < rows_) ? rowPtr_[row+1] - rowPtr_[row] : 0;
+            // Padding points at a column already used by the row (or
+            // column 0 for empty rows) so it stays cache-friendly.  A
+            // matrix without columns has no column to point at, and is
+            // not padded.
+            const int pad = (len > 0) ? colIdx_[rowPtr_[row] + len - 1] : 0;
+            for (int k=0; k < width; ++k)
+            {
+                if (k < len) {
+                    ellColIdx_[base + k*C + r] = colIdx_[rowPtr_[row] + k];
+                    ellValues_[base + k*C + r] = values_[rowPtr_[row] + k];
+                }
+                else if (cols_ > 0)
+                    ellColIdx_[base + k*C + r] = pad;
+            }
+        }
+    }
+
+    layout_ = slicedEll;
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::prepareTranspose() const
+{
+    if (haveTranspose_)
+        return;
+
+    const int nnz = nonZeros();
+    tRowPtr_.assign(cols_+1, 0);
+    tColIdx_.resize(nnz);
+    tValues_.resize(nnz);
+
+    for (int k=0; k < nnz; ++k)
+        ++tRowPtr_[colIdx_[k] + 1];
+    for (int j=0; j < cols_; ++j)
+        tRowPtr_[j+1] += tRowPtr_[j];
+
+    // Walking the rows in order keeps each transposed row sorted.
+    std::vector<int> next(tRowPtr_.begin(), tRowPtr_.end() - 1);
+    for (int i=0; i < rows_; ++i)
+    {
+        for (int k=rowPtr_[i]; k < rowPtr_[i+1]; ++k)
+        {
+            const int pos = next[colIdx_[k]]++;
+            tColIdx_[pos] = i;
+            tValues_[pos] = values_[k];
+        }
+    }
+
+    haveTranspose_ = true;
+}
+
+template<typename P_numtype>
+P_numtype SparseMatrix<P_numtype>::operator()(int i, int j) const
+{
+    BZPRECONDITION((i >= 0) && (i < rows_) && (j >= 0) && (j < cols_));
+    if (colIdx_.empty())
+        return T_numtype(0);
+    const int* begin = &colIdx_[0] + rowPtr_[i];
+    const int* end = &colIdx_[0] + rowPtr_[i+1];
+    const int* pos = std::lower_bound(begin, end, j);
+    if ((pos != end) && (*pos == j))
+        return values_[pos - &colIdx_[0]];
+    return T_numtype(0);
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::csrProduct(int rows,
+    const int* restrict rowPtr, const int* restrict colIdx,
+    const T_numtype* restrict values, const T_numtype* restrict x,
+    diffType xstride, T_numtype* restrict y, diffType ystride)
+{
+    if (xstride == 1)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i=0; i < rows; ++i)
+        {
+            T_numtype sum = 0;
+            for (int k=rowPtr[i]; k < rowPtr[i+1]; ++k)
+                sum += values[k] * x[colIdx[k]];
+            y[i*ystride] = sum;
+        }
+    }
+    else {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i=0; i < rows; ++i)
+        {
+            T_numtype sum = 0;
+            for (int k=rowPtr[i]; k < rowPtr[i+1]; ++k)
+                sum += values[k] * x[colIdx[k]*xstride];
+            y[i*ystride] = sum;
+        }
+    }
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::ellProduct(const T_numtype* restrict x,
+    diffType xstride, T_numtype* restrict y, diffType ystride) const
+{
+    const int C = BZ_SPARSE_ELL_SLICE_HEIGHT;
+    const int numSlices = (rows_ + C - 1) / C;
+    const int* restrict slicePtr = &ellSlicePtr_[0];
+    const int* restrict colIdx = ellColIdx_.empty() ? 0 : &ellColIdx_[0];
+    const T_numtype* restrict values =
+        ellValues_.empty() ? 0 : &ellValues_[0];
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int s=0; s < numSlices; ++s)
+    {
+        T_numtype sum[BZ_SPARSE_ELL_SLICE_HEIGHT];
+        for (int r=0; r < C; ++r)
+            sum[r] = 0;
+
+        // The inner loop runs over C consecutive rows with unit stride
+        // in the value and index arrays, which vectorizes as a gather.
+        for (int k=slicePtr[s]; k < slicePtr[s+1]; k += C)
+        {
+            const int* restrict col = colIdx + k;
+            const T_numtype* restrict val = values + k;
+            if (xstride == 1)
+                for (int r=0; r < C; ++r)
+                    sum[r] += val[r] * x[col[r]];
+            else
+                for (int r=0; r < C; ++r)
+                    sum[r] += val[r] * x[col[r]*xstride];
+        }
+
+        const int rows = std::min(C, rows_ - s*C);
+        T_numtype* restrict ys = y + diffType(s)*C*ystride;
+        for (int r=0; r < rows; ++r)
+            ys[r*ystride] = sum[r];
+    }
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::multiply(const T_numtype* restrict x,
+    diffType xstride, T_numtype* restrict y, diffType ystride) const
+{
+    if (layout_ == slicedEll)
+        ellProduct(x, xstride, y, ystride);
+    else
+        csrProduct(rows_, &rowPtr_[0], colIdx_.empty() ? 0 : &colIdx_[0],
+            values_.empty() ? 0 : &values_[0], x, xstride, y, ystride);
+}
+
+template<typename P_numtype>
+void SparseMatrix<P_numtype>::multiplyTranspose(const T_numtype* restrict x,
+    diffType xstride, T_numtype* restrict y, diffType ystride) const
+{
+    prepareTranspose();
+    csrProduct(cols_, &tRowPtr_[0], tColIdx_.empty() ? 0 : &tColIdx_[0],
+        tValues_.empty() ? 0 : &tValues_[0], x, xstride, y, ystride);
+}
+
+BZ_NAMESPACE_END
+
+#endif // BZ_SPARSE_CC
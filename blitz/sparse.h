@@ -0,0 +1,301 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/sparse.h      Sparse matrices (CSR and sliced-ELL layouts) with
+ *                     sparse matrix-vector products into Array<T,1>
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+#ifndef BZ_SPARSE_H
+#define BZ_SPARSE_H
+
+#ifndef BZ_ARRAY_H
+ #include <blitz/array.h>
+#endif
+
+#include <vector>
+#include <algorithm>
+
+// Number of rows in one slice of the sliced-ELL layout.  Rows within a
+// slice are stored interleaved, so the inner loop of the product runs
+// over this many consecutive rows with unit stride.  It should be a
+// multiple of the SIMD width.
+#ifndef BZ_SPARSE_ELL_SLICE_HEIGHT
+ #define BZ_SPARSE_ELL_SLICE_HEIGHT 8
+#endif
+
+BZ_NAMESPACE(blitz)
+
+// One (row, column, value) entry used to assemble a SparseMatrix.
+template<typename P_numtype>
+struct SparseTriplet {
+    SparseTriplet() : row(0), col(0), value(0) { }
+    SparseTriplet(int i, int j, P_numtype v) : row(i), col(j), value(v) { }
+
+    int row, col;
+    P_numtype value;
+};
+
+/*
+ * SparseMatrix<T> holds a rows x cols matrix with zero-based indices.
+ * It is always assembled into compressed sparse row (CSR) form;
+ * useSlicedEll() additionally builds a sliced-ELL (SELL-C) copy which
+ * is then used by multiply().  CSR is the better choice for irregular
+ * row lengths, sliced-ELL for stencil-like matrices where every row
+ * has about the same number of entries.
+ *
+ * The products run multithreaded when compiled with OpenMP.
+ * multiplyTranspose() uses a transposed CSR copy which is built on
+ * first use (or by prepareTranspose()); call prepareTranspose() before
+ * sharing a matrix between threads.
+ */
+template<typename P_numtype>
+class SparseMatrix {
+
+public:
+    typedef P_numtype T_numtype;
+    typedef SparseTriplet<T_numtype> T_triplet;
+
+    enum Layout { csr, slicedEll };
+
+    SparseMatrix()
+      : rows_(0), cols_(0), layout_(csr), rowPtr_(1, 0),
+        haveTranspose_(false)
+    { }
+
+    SparseMatrix(int rows, int cols)
+      : rows_(rows), cols_(cols), layout_(csr), rowPtr_(rows+1, 0),
+        haveTranspose_(false)
+    {
+        BZPRECONDITION((rows >= 0) && (cols >= 0));
+    }
+
+    int rows() const
+    { return rows_; }
+
+    int cols() const
+    { return cols_; }
+
+    int columns() const
+    { return cols_; }
+
+    int nonZeros() const
+    { return rowPtr_[rows_]; }
+
+    Layout layout() const
+    { return layout_; }
+
+    // Discards all entries and sets a new shape.
+    void resize(int rows, int cols)
+    {
+        BZPRECONDITION((rows >= 0) && (cols >= 0));
+        rows_ = rows;
+        cols_ = cols;
+        rowPtr_.assign(rows+1, 0);
+        colIdx_.clear();
+        values_.clear();
+        clearEll();
+        clearTranspose();
+        layout_ = csr;
+    }
+
+    // Assembles the matrix from (i,j,v) triplets.  Entries with the
+    // same (i,j) are summed, which is what finite element and finite
+    // volume assembly expects.
+    template<typename T_iterator>
+    void setFromTriplets(T_iterator first, T_iterator last);
+
+    void setFromTriplets(const Array<int,1>& rowIndices,
+        const Array<int,1>& colIndices, const Array<T_numtype,1>& values);
+
+    // Builds the sliced-ELL copy and uses it for multiply().
+    void useSlicedEll();
+
+    // Drops the sliced-ELL copy and goes back to CSR products.
+    void useCsr()
+    {
+        clearEll();
+        layout_ = csr;
+    }
+
+    // Builds the transposed CSR copy used by multiplyTranspose().
+    void prepareTranspose() const;
+
+    // Element lookup (zero for entries not stored).  O(log(row length)).
+    T_numtype operator()(int i, int j) const;
+
+    // y = A x
+    void multiply(const Array<T_numtype,1>& x, Array<T_numtype,1>& y) const
+    {
+        BZPRECHECK(x.extent(0) == cols_ && y.extent(0) == rows_,
+            "SparseMatrix::multiply: shape mismatch; matrix is " << rows_
+            << " x " << cols_ << ", x has " << x.extent(0)
+            << " elements and y has " << y.extent(0));
+        multiply(x.data(), x.stride(0), y.data(), y.stride(0));
+    }
+
+    // y = A^T x
+    void multiplyTranspose(const Array<T_numtype,1>& x,
+        Array<T_numtype,1>& y) const
+    {
+        BZPRECHECK(x.extent(0) == rows_ && y.extent(0) == cols_,
+            "SparseMatrix::multiplyTranspose: shape mismatch; matrix is "
+            << rows_ << " x " << cols_ << ", x has " << x.extent(0)
+            << " elements and y has " << y.extent(0));
+        multiplyTranspose(x.data(), x.stride(0), y.data(), y.stride(0));
+    }
+
+    // Raw kernels.  x and y must not overlap.
+    void multiply(const T_numtype* restrict x, diffType xstride,
+        T_numtype* restrict y, diffType ystride) const;
+
+    void multiplyTranspose(const T_numtype* restrict x, diffType xstride,
+        T_numtype* restrict y, diffType ystride) const;
+
+    // Direct access to the CSR arrays
+    const std::vector<int>& rowPointers() const
+    { return rowPtr_; }
+
+    const std::vector<int>& columnIndices() const
+    { return colIdx_; }
+
+    const std::vector<T_numtype>& values() const
+    { return values_; }
+
+protected:
+    void clearEll()
+    {
+        std::vector<int>().swap(ellSlicePtr_);
+        std::vector<int>().swap(ellColIdx_);
+        std::vector<T_numtype>().swap(ellValues_);
+    }
+
+    void clearTranspose()
+    {
+        std::vector<int>().swap(tRowPtr_);
+        std::vector<int>().swap(tColIdx_);
+        std::vector<T_numtype>().swap(tValues_);
+        haveTranspose_ = false;
+    }
+
+    static void csrProduct(int rows, const int* restrict rowPtr,
+        const int* restrict colIdx, const T_numtype* restrict values,
+        const T_numtype* restrict x, diffType xstride,
+        T_numtype* restrict y, diffType ystride);
+
+    void ellProduct(const T_numtype* restrict x, diffType xstride,
+        T_numtype* restrict y, diffType ystride) const;
+
+    int rows_, cols_;
+    Layout layout_;
+
+    // CSR storage
+    std::vector<int> rowPtr_;
+    std::vector<int> colIdx_;
+    std::vector<T_numtype> values_;
+
+    // Sliced-ELL storage: slice s holds rows [s*C, s*C+C) and occupies
+    // ellSlicePtr_[s] .. ellSlicePtr_[s+1] in the arrays below, stored
+    // so that the C rows of one column position are contiguous.
+    // Padding entries have value zero and a valid column index.
+    std::vector<int> ellSlicePtr_;
+    std::vector<int> ellColIdx_;
+    std::vector<T_numtype> ellValues_;
+
+    // Transposed CSR, built on demand
+    mutable std::vector<int> tRowPtr_;
+    mutable std::vector<int> tColIdx_;
+    mutable std::vector<T_numtype> tValues_;
+    mutable bool haveTranspose_;
+};
+
+/*
+ * SparseOperator adapts a SparseMatrix to the operator-callback form
+ * used by the iterative solvers: op(x, y) computes y = A x (or A^T x).
+ * It accepts arrays of any rank as long as their storage is
+ * contiguous, so a 3D field can be handed to the solver directly
+ * without copying into a vector.
+ */
+template<typename P_numtype>
+class SparseOperator {
+
+public:
+    typedef P_numtype T_numtype;
+
+    explicit SparseOperator(const SparseMatrix<T_numtype>& A,
+        bool transpose = false)
+      : A_(A), transpose_(transpose)
+    { }
+
+    void operator()(const Array<T_numtype,1>& x, Array<T_numtype,1>& y) const
+    {
+        if (transpose_)
+            A_.multiplyTranspose(x, y);
+        else
+            A_.multiply(x, y);
+    }
+
+    template<int N_rank>
+    void operator()(const Array<T_numtype,N_rank>& x,
+        Array<T_numtype,N_rank>& y) const
+    {
+        BZPRECHECK(x.isStorageContiguous() && y.isStorageContiguous(),
+            "SparseOperator: arrays of rank > 1 must be stored contiguously");
+        BZPRECHECK(x.numElements()
+                == sizeType(transpose_ ? A_.rows() : A_.cols())
+            && y.numElements()
+                == sizeType(transpose_ ? A_.cols() : A_.rows()),
+            "SparseOperator: array sizes do not match the matrix");
+        if (transpose_)
+            A_.multiplyTranspose(x.dataFirst(), 1, y.dataFirst(), 1);
+        else
+            A_.multiply(x.dataFirst(), 1, y.dataFirst(), 1);
+    }
+
+    const SparseMatrix<T_numtype>& matrix() const
+    { return A_; }
+
+private:
+    const SparseMatrix<T_numtype>& A_;
+    bool transpose_;
+};
+
+template<typename T_numtype>
+inline SparseOperator<T_numtype>
+sparseOperator(const SparseMatrix<T_numtype>& A)
+{ return SparseOperator<T_numtype>(A); }
+
+template<typename T_numtype>
+inline SparseOperator<T_numtype>
+sparseOperatorTranspose(const SparseMatrix<T_numtype>& A)
+{ return SparseOperator<T_numtype>(A, true); }
+
+BZ_NAMESPACE_END
+
+#include <blitz/sparse.cc>
+
+#endif // BZ_SPARSE_H
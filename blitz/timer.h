@@ -29,9 +29,15 @@
  *
  ***************************************************************************/
 
-// This class is not portable to non System V platforms.
-// It will need to be rewritten for Windows, NT, Mac.
-// NEEDS_WORK
+// Timer measures elapsed wall-clock time by default, using a monotonic
+// clock where one is available, so it gives meaningful numbers for
+// multithreaded code.  Timer(Timer::cpuTime) gives the old behaviour:
+// user+system CPU time of the process (summed over all its threads).
+//
+// On Linux the timer can also read hardware performance counters
+// (cycles, instructions, last-level cache misses) through
+// perf_event_open; see enableCounters().  Define
+// BZ_DISABLE_PERF_COUNTERS to leave this out.
 
 #ifndef BZ_TIMER_H
 #define BZ_TIMER_H
@@ -42,8 +48,34 @@
 
 #ifdef BZ_HAVE_RUSAGE
  #include <sys/resource.h>
+#endif
+
+#include <time.h>
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <Windows.h>
+#elif defined(__APPLE__)
+ #include <mach/mach_time.h>
+#elif defined(CLOCK_MONOTONIC)
+ #define BZ_TIMER_USE_CLOCK_GETTIME
 #else
- #include <time.h>
+ #include <sys/time.h>
+#endif
+
+#if defined(__linux__) && !defined(BZ_DISABLE_PERF_COUNTERS)
+ #define BZ_TIMER_PERF_COUNTERS
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #include <string.h>
+ #include <vector>
+ #ifdef _OPENMP
+  #include <omp.h>
+ #endif
 #endif
 
 BZ_NAMESPACE(blitz)
@@ -51,22 +83,70 @@ BZ_NAMESPACE(blitz)
 class Timer {
 
 public:
-    Timer() 
+    enum Clock { wallClock, cpuTime };
+
+    // Hardware counters, selected with a bitwise or of these flags
+    enum Counter {
+        cycles           = 1,
+        instructions     = 2,
+        cacheReferences  = 4,     // last-level cache references
+        cacheMisses      = 8      // last-level cache misses
+    };
+    static const int numCounters = 4;
+
+    // Bytes moved per last-level cache miss, used by memoryBytes()
+    enum { cacheLineSize = 64 };
+
+    Timer(Clock clock = wallClock)
+      : clock_(clock)
     { 
         state_ = uninitialized;
+        t1_ = t2_ = lap_ = accumulated_ = 0;
+        intervals_ = 0;
+        for (int i=0; i < numCounters; ++i)
+            count_[i] = 0;
+    }
+
+    ~Timer()
+    {
+        disableCounters();
     }
 
     void start()
     { 
         state_ = running;
-        t1_ = systemTime();
+        startCounters();
+        t1_ = lap_ = systemTime();
     }
 
     void stop()
     {
         t2_ = systemTime();
+        stopCounters();
         BZPRECONDITION(state_ == running);
         state_ = stopped;
+        accumulated_ += t2_ - t1_;
+        ++intervals_;
+    }
+
+    // Seconds since start() or the previous lap(), without stopping.
+    double lap()
+    {
+        BZPRECONDITION(state_ == running);
+        long double now = systemTime();
+        double t = now - lap_;
+        lap_ = now;
+        return t;
+    }
+
+    // Clears the accumulated time and counts.
+    void reset()
+    {
+        state_ = uninitialized;
+        accumulated_ = 0;
+        intervals_ = 0;
+        for (int i=0; i < numCounters; ++i)
+            count_[i] = 0;
     }
     
 /* Compaq cxx compiler in ansi mode cannot print out long double type! */
@@ -80,34 +160,273 @@ public:
         return t2_ - t1_;
     }
 
+    // Total over all start()/stop() intervals since construction or
+    // reset(), and the number of such intervals.
+    double accumulatedSeconds() const
+    { return accumulated_; }
+
+    int intervals() const
+    { return intervals_; }
+
+    // Resolution of the underlying clock in seconds
+    double resolution() const;
+
+    // Monotonic wall-clock time in seconds from an arbitrary origin
+    static long double wallClockTime()
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER count, frequency;
+        QueryPerformanceCounter(&count);
+        QueryPerformanceFrequency(&frequency);
+        return count.QuadPart / (long double) frequency.QuadPart;
+#elif defined(__APPLE__)
+        static mach_timebase_info_data_t timebase;
+        if (timebase.denom == 0)
+            mach_timebase_info(&timebase);
+        return mach_absolute_time() * (long double) timebase.numer
+            / timebase.denom * 1.0e-9;
+#elif defined(BZ_TIMER_USE_CLOCK_GETTIME)
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * (long double) 1.0e-9;
+#else
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + tv.tv_usec * (long double) 1.0e-6;
+#endif
+    }
+
+    // Opens the requested hardware counters for the calling thread and,
+    // with OpenMP, for each thread of the thread pool; the counts are
+    // summed over them.  Other threads are counted from the calling
+    // thread's counters when they exit.  Returns false (and counts
+    // nothing) if the platform or the kernel's perf_event_paranoid
+    // setting does not allow it; individual counters may also be
+    // unavailable.  Pool threads added by raising the number of threads
+    // later are not counted until they exit.
+    bool enableCounters(int counters = cycles | instructions | cacheMisses);
+
+    void disableCounters();
+
+    bool hasCounter(Counter c) const;
+
+    // Counts accumulated over all intervals, or -1 if not available
+    long long counter(Counter c) const
+    { return hasCounter(c) ? count_[counterIndex(c)] : -1; }
+
+    // Estimate of the bytes moved to and from memory, from the
+    // last-level cache misses
+    double memoryBytes() const
+    {
+        return hasCounter(cacheMisses) 
+            ? double(count_[counterIndex(cacheMisses)]) * cacheLineSize : -1;
+    }
+
 private:
     Timer(Timer&) { }
     void operator=(Timer&) { }
 
+    static int counterIndex(Counter c)
+    {
+        switch (c) {
+        case cycles: return 0;
+        case instructions: return 1;
+        case cacheReferences: return 2;
+        default: return 3;
+        }
+    }
+
+    void startCounters();
+    void stopCounters();
+
+#ifdef BZ_TIMER_PERF_COUNTERS
+    static int openCounter(unsigned long long config);
+#endif
+
     long double systemTime()
     {
+        if (clock_ == cpuTime)
+        {
 #ifdef BZ_HAVE_RUSAGE
-        getrusage(RUSAGE_SELF, &resourceUsage_);
-        double seconds = resourceUsage_.ru_utime.tv_sec 
-            + resourceUsage_.ru_stime.tv_sec;
-        double micros  = resourceUsage_.ru_utime.tv_usec 
-            + resourceUsage_.ru_stime.tv_usec;
-        return seconds + micros/1.0e6;
+            getrusage(RUSAGE_SELF, &resourceUsage_);
+            double seconds = resourceUsage_.ru_utime.tv_sec 
+                + resourceUsage_.ru_stime.tv_sec;
+            double micros  = resourceUsage_.ru_utime.tv_usec 
+                + resourceUsage_.ru_stime.tv_usec;
+            return seconds + micros/1.0e6;
 #else
-        return clock() / (long double) CLOCKS_PER_SEC;
+            return clock() / (long double) CLOCKS_PER_SEC;
 #endif
+        }
+
+        return wallClockTime();
     }
 
+    Clock clock_;
     enum { uninitialized, running, stopped } state_;
 
 #ifdef BZ_HAVE_RUSAGE
     struct rusage resourceUsage_;
 #endif
 
-    long double t1_, t2_;
+    long double t1_, t2_, lap_;
+    double accumulated_;
+    int intervals_;
+
+#ifdef BZ_TIMER_PERF_COUNTERS
+    std::vector<int> fd_[numCounters];    // One per thread, or -1
+#endif
+    long long count_[numCounters];
 };
 
+inline double Timer::resolution() const
+{
+    if (clock_ == cpuTime)
+#ifdef BZ_HAVE_RUSAGE
+        return 1.0e-6;
+#else
+        return 1.0 / CLOCKS_PER_SEC;
+#endif
+
+#if defined(BZ_TIMER_USE_CLOCK_GETTIME)
+    struct timespec ts;
+    clock_getres(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+#elif defined(_WIN32)
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return 1.0 / frequency.QuadPart;
+#elif defined(__APPLE__)
+    return 1.0e-9;
+#else
+    return 1.0e-6;
+#endif
+}
+
+#ifdef BZ_TIMER_PERF_COUNTERS
+
+inline int Timer::openCounter(unsigned long long config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // Counts the calling thread, wherever it runs
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+inline bool Timer::enableCounters(int counters)
+{
+    disableCounters();
+
+    static const unsigned long long config[numCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES
+    };
+
+#ifdef _OPENMP
+    const int numThreads = omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+    const int numThreads = 1;
+#endif
+    for (int i=0; i < numCounters; ++i)
+        if (counters & (1 << i))
+            fd_[i].assign(numThreads, -1);
+
+    // Each thread of the pool opens its own counters
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads) if (numThreads > 1)
+#endif
+    {
+#ifdef _OPENMP
+        const int t = omp_get_thread_num();
+#else
+        const int t = 0;
+#endif
+        for (int i=0; i < numCounters; ++i)
+            if (counters & (1 << i))
+                fd_[i][t] = openCounter(config[i]);
+    }
+
+    // A counter is only used if it could be opened for every thread
+    bool any = false;
+    for (int i=0; i < numCounters; ++i)
+    {
+        bool all = !fd_[i].empty();
+        for (unsigned t=0; t < fd_[i].size(); ++t)
+            all = all && (fd_[i][t] >= 0);
+        if (!all)
+        {
+            for (unsigned t=0; t < fd_[i].size(); ++t)
+                if (fd_[i][t] >= 0)
+                    close(fd_[i][t]);
+            fd_[i].clear();
+        }
+        any = any || all;
+    }
+    return any;
+}
+
+inline void Timer::disableCounters()
+{
+    for (int i=0; i < numCounters; ++i)
+    {
+        for (unsigned t=0; t < fd_[i].size(); ++t)
+            close(fd_[i][t]);
+        fd_[i].clear();
+    }
+}
+
+inline bool Timer::hasCounter(Counter c) const
+{ return !fd_[counterIndex(c)].empty(); }
+
+inline void Timer::startCounters()
+{
+    for (int i=0; i < numCounters; ++i)
+        for (unsigned t=0; t < fd_[i].size(); ++t)
+        {
+            ioctl(fd_[i][t], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_[i][t], PERF_EVENT_IOC_ENABLE, 0);
+        }
+}
+
+inline void Timer::stopCounters()
+{
+    for (int i=0; i < numCounters; ++i)
+        for (unsigned t=0; t < fd_[i].size(); ++t)
+        {
+            ioctl(fd_[i][t], PERF_EVENT_IOC_DISABLE, 0);
+            long long value = 0;
+            if (read(fd_[i][t], &value, sizeof(value)) == sizeof(value))
+                count_[i] += value;
+        }
+}
+
+#else
+
+inline bool Timer::enableCounters(int)
+{ return false; }
+
+inline void Timer::disableCounters()
+{ }
+
+inline bool Timer::hasCounter(Counter) const
+{ return false; }
+
+inline void Timer::startCounters()
+{ }
+
+inline void Timer::stopCounters()
+{ }
+
+#endif // BZ_TIMER_PERF_COUNTERS
+
 BZ_NAMESPACE_END
 
 #endif // BZ_TIMER_H
-
@@ -49,15 +49,15 @@
 
 BZ_NAMESPACE(blitz)
 
-// Forward declarations
-template<typename T_expr>
-class _bz_tinyMatExpr;
-
-template<typename T_numtype, int N_rows, int N_columns, int N_rowStride,
+template<typename P_numtype, int N_rows, int N_columns, int N_rowStride,
     int N_colStride>
 class _bz_tinyMatrixRef {
 
 public:
+    typedef P_numtype T_numtype;
+
+    static const int rows = N_rows, columns = N_columns;
+
     _bz_tinyMatrixRef(T_numtype* restrict const data)
         : data_(data)
     { }
@@ -76,7 +76,8 @@ protected:
 };
 
 template<typename P_numtype, int N_rows, int N_columns>
-class TinyMatrix {
+class TinyMatrix
+    : public _bz_tinyMatBase<TinyMatrix<P_numtype, N_rows, N_columns> > {
 
 public:
     typedef P_numtype T_numtype;
@@ -84,8 +85,17 @@ public:
         T_reference;
     typedef TinyMatrix<T_numtype, N_rows, N_columns> T_matrix;
 
+    static const int rows = N_rows, columns = N_columns;
+
     TinyMatrix() { }
 
+    template<typename T_expr>
+    TinyMatrix(_bz_tinyMatExpr<T_expr> expr)
+    {
+        evaluate(expr, _bz_update<T_numtype,
+            _bz_typename T_expr::T_numtype>());
+    }
+
     T_numtype* restrict data()
     { return data_; }
 
@@ -136,11 +146,40 @@ public:
     TinyMatrix<T_numtype, N_rows, N_columns>&
     operator=(_bz_tinyMatExpr<T_expr> expr)
     {
-        _bz_meta_matAssign<N_rows, N_columns, 0>::f(*this, expr,
-            _bz_update<T_numtype, _bz_typename T_expr::T_numtype>());
+        evaluate(expr, _bz_update<T_numtype,
+            _bz_typename T_expr::T_numtype>());
         return *this;
     }
 
+#define BZ_TINYMAT_UPDATE(op,name)                                          \
+    template<typename T_expr>                                               \
+    T_matrix& operator op(_bz_tinyMatExpr<T_expr> expr)                     \
+    {                                                                       \
+        evaluate(expr, name<T_numtype, _bz_typename T_expr::T_numtype>());  \
+        return *this;                                                       \
+    }                                                                       \
+                                                                            \
+    template<typename T_numtype2>                                           \
+    T_matrix& operator op(const TinyMatrix<T_numtype2, N_rows, N_columns>& x) \
+    {                                                                       \
+        evaluate(x.getRef(), name<T_numtype, T_numtype2>());                \
+        return *this;                                                       \
+    }                                                                       \
+                                                                            \
+    T_matrix& operator op(T_numtype x)                                      \
+    {                                                                       \
+        evaluate(_bz_tinyMatExprConstant<T_numtype, N_rows, N_columns>(x),  \
+            name<T_numtype, T_numtype>());                                  \
+        return *this;                                                       \
+    }
+
+    BZ_TINYMAT_UPDATE(+=, _bz_plus_update)
+    BZ_TINYMAT_UPDATE(-=, _bz_minus_update)
+    BZ_TINYMAT_UPDATE(*=, _bz_multiply_update)
+    BZ_TINYMAT_UPDATE(/=, _bz_divide_update)
+
+#undef BZ_TINYMAT_UPDATE
+
     void initialize(T_numtype x)
     { 
         for (int i=0; i < N_rows; ++i)
@@ -152,6 +191,27 @@ public:
     { return dataFirst(); }
 
 protected:
+    /*
+     * The expression is evaluated into a temporary by the unrolled
+     * assignment, then stored with one loop over the elements.  Because
+     * the temporary cannot overlap the operands, the compiler is free to
+     * keep it in vector registers and to use packed loads and stores, and
+     * an operand may read this matrix, as in A = transpose(A) or
+     * A = product(A,B).
+     */
+    template<typename T_expr, typename T_update>
+    void evaluate(T_expr expr, T_update)
+    {
+        typedef _bz_typename T_expr::T_numtype T_result;
+        T_result result[N_rows * N_columns];
+        _bz_tinyMatrixRef<T_result, N_rows, N_columns, N_columns, 1>
+            ref(result);
+        _bz_meta_matAssign<N_rows, N_columns, 0>::f(ref, expr,
+            _bz_update<T_result, T_result>());
+        for (int i=0; i < N_rows * N_columns; ++i)
+            T_update::update(data_[i], result[i]);
+    }
+
     T_numtype data_[N_rows * N_columns];
 };
 
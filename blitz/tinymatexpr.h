@@ -36,10 +36,39 @@
  #error <blitz/tinymatexpr.h> must be included via <blitz/tinymat.h>
 #endif
 
+#include <blitz/ops.h>
+
 BZ_NAMESPACE(blitz)
 
+// Forward declarations
+template<typename P_numtype, int N_rows, int N_columns>
+class TinyMatrix;
+
+template<typename T_numtype, int N_rows, int N_columns, int N_rowStride,
+    int N_colStride>
+class _bz_tinyMatrixRef;
+
+/*
+ * Base class of TinyMatrix and of TinyMatrix expressions.  It plays the
+ * part ETBase plays for Arrays: the operators declared below take their
+ * operands as _bz_tinyMatBase<T>, so that they match matrices and matrix
+ * expressions, and nothing else.
+ */
+
+template<typename T>
+class _bz_tinyMatBase {
+public:
+    _bz_tinyMatBase()
+    { }
+
+    _bz_tinyMatBase(const _bz_tinyMatBase<T>&)
+    { }
+
+    const T& unwrap() const { return static_cast<const T&>(*this); }
+};
+
 template<typename T_expr>
-class _bz_tinyMatExpr {
+class _bz_tinyMatExpr : public _bz_tinyMatBase<_bz_tinyMatExpr<T_expr> > {
 public:
     typedef _bz_typename T_expr::T_numtype T_numtype;
 
@@ -52,7 +81,7 @@ public:
     { }
 
     _bz_tinyMatExpr(const _bz_tinyMatExpr<T_expr>& x)
-        : expr_(x.expr_)
+        : _bz_tinyMatBase<_bz_tinyMatExpr<T_expr> >(x), expr_(x.expr_)
     { }
 
     T_numtype operator()(int i, int j) const
@@ -62,7 +91,239 @@ protected:
     T_expr expr_;
 };
 
+/*
+ * The expression used to read an operand, as asExpr<T> does for Arrays.
+ * A TinyMatrix is read through a _bz_tinyMatrixRef, so that the element
+ * offsets are compile-time constants once the assignment is unrolled.
+ */
+
+template<typename T>
+struct _bz_asTinyMatExpr {
+    typedef T T_expr;
+
+    static const T_expr& getExpr(const T& x)
+    { return x; }
+};
+
+template<typename T_numtype, int N_rows, int N_columns>
+struct _bz_asTinyMatExpr<TinyMatrix<T_numtype,N_rows,N_columns> > {
+    typedef _bz_tinyMatrixRef<T_numtype,N_rows,N_columns,N_columns,1> T_expr;
+
+    static T_expr getExpr(const TinyMatrix<T_numtype,N_rows,N_columns>& x)
+    { return x.getRef(); }
+};
+
+// Operands of an element-wise operation must have the same shape; there
+// is no definition for different shapes, so that they fail to compile.
+template<int N_rows1, int N_columns1, int N_rows2, int N_columns2>
+struct _bz_tinyMatSameShape;
+
+template<int N_rows, int N_columns>
+struct _bz_tinyMatSameShape<N_rows,N_columns,N_rows,N_columns> {
+    static const int rows = N_rows, columns = N_columns;
+};
+
+template<typename P_numtype, int N_rows, int N_columns>
+class _bz_tinyMatExprConstant {
+public:
+    typedef P_numtype T_numtype;
+
+    static const int rows = N_rows, columns = N_columns;
+
+    _bz_tinyMatExprConstant(T_numtype value)
+        : value_(value)
+    { }
+
+    T_numtype operator()(int, int) const
+    { return value_; }
+
+protected:
+    T_numtype value_;
+};
+
+template<typename P_expr, typename P_op>
+class _bz_tinyMatExprUnaryOp {
+public:
+    typedef P_expr T_expr;
+    typedef _bz_typename P_op::T_numtype T_numtype;
+
+    static const int rows = T_expr::rows, columns = T_expr::columns;
+
+    _bz_tinyMatExprUnaryOp(const T_expr& expr)
+        : expr_(expr)
+    { }
+
+    T_numtype operator()(int i, int j) const
+    { return P_op::apply(expr_(i,j)); }
+
+protected:
+    T_expr expr_;
+};
+
+template<typename P_expr1, typename P_expr2, typename P_op>
+class _bz_tinyMatExprBinaryOp
+    : public _bz_tinyMatSameShape<P_expr1::rows, P_expr1::columns,
+        P_expr2::rows, P_expr2::columns> {
+public:
+    typedef P_expr1 T_expr1;
+    typedef P_expr2 T_expr2;
+    typedef _bz_typename P_op::T_numtype T_numtype;
+
+    _bz_tinyMatExprBinaryOp(const T_expr1& expr1, const T_expr2& expr2)
+        : expr1_(expr1), expr2_(expr2)
+    { }
+
+    T_numtype operator()(int i, int j) const
+    { return P_op::apply(expr1_(i,j), expr2_(i,j)); }
+
+protected:
+    T_expr1 expr1_;
+    T_expr2 expr2_;
+};
+
+template<typename P_expr>
+class _bz_tinyMatExprTranspose {
+public:
+    typedef P_expr T_expr;
+    typedef _bz_typename T_expr::T_numtype T_numtype;
+
+    static const int rows = T_expr::columns, columns = T_expr::rows;
+
+    _bz_tinyMatExprTranspose(const T_expr& expr)
+        : expr_(expr)
+    { }
+
+    T_numtype operator()(int i, int j) const
+    { return expr_(j,i); }
+
+protected:
+    T_expr expr_;
+};
+
+/*
+ * TinyMatrix expression templates, declared like the Array ones in
+ * <blitz/array/newet-macros.h> and using the same functors.  The
+ * operations are element-wise; see product() for the matrix product.
+ */
+
+#define BZ_DECLARE_TINYMAT_ET_UNARY(name, functor)                         \
+                                                                           \
+template<typename T1>                                                      \
+inline                                                                     \
+_bz_tinyMatExpr<_bz_tinyMatExprUnaryOp<                                    \
+    _bz_typename _bz_asTinyMatExpr<T1>::T_expr,                            \
+    functor<_bz_typename _bz_asTinyMatExpr<T1>::T_expr::T_numtype> > >     \
+name(const _bz_tinyMatBase<T1>& d1)                                        \
+{                                                                          \
+    typedef _bz_tinyMatExprUnaryOp<                                        \
+        _bz_typename _bz_asTinyMatExpr<T1>::T_expr,                        \
+        functor<_bz_typename _bz_asTinyMatExpr<T1>::T_expr::T_numtype> >   \
+        T_op;                                                              \
+    return _bz_tinyMatExpr<T_op>(T_op(                                     \
+        _bz_asTinyMatExpr<T1>::getExpr(d1.unwrap())));                     \
+}
+
+#define BZ_DECLARE_TINYMAT_ET_BINARY(name, applic)                         \
+                                                                           \
+template<typename T1, typename T2>                                         \
+inline                                                                     \
+_bz_tinyMatExpr<_bz_tinyMatExprBinaryOp<                                   \
+    _bz_typename _bz_asTinyMatExpr<T1>::T_expr,                            \
+    _bz_typename _bz_asTinyMatExpr<T2>::T_expr,                            \
+    applic<_bz_typename _bz_asTinyMatExpr<T1>::T_expr::T_numtype,          \
+    _bz_typename _bz_asTinyMatExpr<T2>::T_expr::T_numtype> > >             \
+name(const _bz_tinyMatBase<T1>& d1, const _bz_tinyMatBase<T2>& d2)         \
+{                                                                          \
+    typedef _bz_tinyMatExprBinaryOp<                                       \
+        _bz_typename _bz_asTinyMatExpr<T1>::T_expr,                        \
+        _bz_typename _bz_asTinyMatExpr<T2>::T_expr,                        \
+        applic<_bz_typename _bz_asTinyMatExpr<T1>::T_expr::T_numtype,      \
+        _bz_typename _bz_asTinyMatExpr<T2>::T_expr::T_numtype> > T_op;     \
+    return _bz_tinyMatExpr<T_op>(T_op(                                     \
+        _bz_asTinyMatExpr<T1>::getExpr(d1.unwrap()),                       \
+        _bz_asTinyMatExpr<T2>::getExpr(d2.unwrap())));                     \
+}
+
+#define BZ_DECLARE_TINYMAT_ET_BINARY_SCALAR(name, applic, sca)             \
+                                                                           \
+template<typename T>                                                       \
+inline                                                                     \
+_bz_tinyMatExpr<_bz_tinyMatExprBinaryOp<                                   \
+    _bz_tinyMatExprConstant<sca, T::rows, T::columns>,                     \
+    _bz_typename _bz_asTinyMatExpr<T>::T_expr,                             \
+    applic<sca, _bz_typename _bz_asTinyMatExpr<T>::T_expr::T_numtype> > >  \
+name(const sca d1, const _bz_tinyMatBase<T>& d2)                           \
+{                                                                          \
+    typedef _bz_tinyMatExprBinaryOp<                                       \
+        _bz_tinyMatExprConstant<sca, T::rows, T::columns>,                 \
+        _bz_typename _bz_asTinyMatExpr<T>::T_expr,                         \
+        applic<sca, _bz_typename _bz_asTinyMatExpr<T>::T_expr::T_numtype> >\
+        T_op;                                                              \
+    return _bz_tinyMatExpr<T_op>(T_op(d1,                                  \
+        _bz_asTinyMatExpr<T>::getExpr(d2.unwrap())));                      \
+}                                                                          \
+                                                                           \
+template<typename T>                                                       \
+inline                                                                     \
+_bz_tinyMatExpr<_bz_tinyMatExprBinaryOp<                                   \
+    _bz_typename _bz_asTinyMatExpr<T>::T_expr,                             \
+    _bz_tinyMatExprConstant<sca, T::rows, T::columns>,                     \
+    applic<_bz_typename _bz_asTinyMatExpr<T>::T_expr::T_numtype, sca> > >  \
+name(const _bz_tinyMatBase<T>& d1, const sca d2)                           \
+{                                                                          \
+    typedef _bz_tinyMatExprBinaryOp<                                       \
+        _bz_typename _bz_asTinyMatExpr<T>::T_expr,                         \
+        _bz_tinyMatExprConstant<sca, T::rows, T::columns>,                 \
+        applic<_bz_typename _bz_asTinyMatExpr<T>::T_expr::T_numtype, sca> >\
+        T_op;                                                              \
+    return _bz_tinyMatExpr<T_op>(T_op(                                     \
+        _bz_asTinyMatExpr<T>::getExpr(d1.unwrap()), d2));                  \
+}
+
+BZ_DECLARE_TINYMAT_ET_UNARY(operator+, UnaryPlus)
+BZ_DECLARE_TINYMAT_ET_UNARY(operator-, UnaryMinus)
+
+BZ_DECLARE_TINYMAT_ET_BINARY(operator+, Add)
+BZ_DECLARE_TINYMAT_ET_BINARY(operator-, Subtract)
+BZ_DECLARE_TINYMAT_ET_BINARY(operator*, Multiply)
+BZ_DECLARE_TINYMAT_ET_BINARY(operator/, Divide)
+
+#define BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(sca)                              \
+BZ_DECLARE_TINYMAT_ET_BINARY_SCALAR(operator+, Add, sca)                   \
+BZ_DECLARE_TINYMAT_ET_BINARY_SCALAR(operator-, Subtract, sca)              \
+BZ_DECLARE_TINYMAT_ET_BINARY_SCALAR(operator*, Multiply, sca)              \
+BZ_DECLARE_TINYMAT_ET_BINARY_SCALAR(operator/, Divide, sca)
+
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(char)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(unsigned char)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(short)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(unsigned short)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(int)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(unsigned int)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(long)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(unsigned long)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(float)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(double)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(long double)
+#ifdef BZ_HAVE_COMPLEX
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(complex<float>)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(complex<double>)
+BZ_DECLARE_TINYMAT_ET_SCALAR_OPS(complex<long double>)
+#endif
+
+// The transpose reads the operand with its indices exchanged, and so
+// costs nothing.
+template<typename T1>
+inline _bz_tinyMatExpr<_bz_tinyMatExprTranspose<
+    _bz_typename _bz_asTinyMatExpr<T1>::T_expr> >
+transpose(const _bz_tinyMatBase<T1>& d1)
+{
+    typedef _bz_tinyMatExprTranspose<
+        _bz_typename _bz_asTinyMatExpr<T1>::T_expr> T_op;
+    return _bz_tinyMatExpr<T_op>(T_op(
+        _bz_asTinyMatExpr<T1>::getExpr(d1.unwrap())));
+}
+
 BZ_NAMESPACE_END
 
 #endif // BZ_TINYMATEXPR_H
-
@@ -27,7 +27,6 @@
  *    https://sourceforge.net/projects/blitz/
  *
  ***************************************************************************/
-
 #ifndef BZ_TRAVERSAL_CC
 #define BZ_TRAVERSAL_CC
 
@@ -37,98 +36,124 @@
 
 BZ_NAMESPACE(blitz)
 
-// Next line is a workaround for Intel C++ V4.0 oddity, due
-// to Allan Stokes.
-static set<TraversalOrder<2> > *_bz_intel_kludge;
-
-//template<int N_dimensions>
-//_bz_typename TraversalOrderCollection<N_dimensions>::T_set
-//    TraversalOrderCollection<N_dimensions>::traversals_;
-
-template<int N>
-void makeHilbert(Vector<TinyVector<int,N> >& coord, 
-    int x0, int y0, int xis, int xjs,
-    int yis, int yjs, int n, int& i)
+template<int N_dimensions>
+TraversalOrder<N_dimensions>::TraversalOrder(const T_coord& size,
+    TileOrder order)
+    : size_(size), order_(order), bits_(0), position_(0)
 {
-    // N != 2 is not yet implemented.
-    BZPRECONDITION(N == 2);
+    if ((N_dimensions != 2) && (order_ == hilbertTileOrder))
+        order_ = mortonTileOrder;
 
-    if (!n)
+    int largest = 0;
+    for (int d=0; d < N_dimensions; ++d)
     {
-        if (i > coord.length())
-        {
-            cerr << "makeHilbert: vector not long enough" << endl;
-            exit(1);
-        }
-        coord[i][0] = x0 + (xis+yis)/2;
-        coord[i][1] = y0 + (xjs+yjs)/2;
-        ++i;
+        BZPRECONDITION(size_[d] >= 0);
+        if (size_[d] > largest)
+            largest = size_[d];
     }
-    else {
-        makeHilbert(coord,x0,y0,yis/2, yjs/2, xis/2, xjs/2, n-1, i);
-        makeHilbert(coord,x0+xis/2,y0+xjs/2,xis/2,xjs/2,yis/2,yjs/2,n-1,i);
-        makeHilbert(coord,x0+xis/2+yis/2,y0+xjs/2+yjs/2,xis/2,xjs/2,yis/2,
-            yjs/2,n-1,i);
-        makeHilbert(coord,x0+xis/2+yis, y0+xjs/2+yjs, -yis/2,-yjs/2,-xis/2,
-            -xjs/2,n-1,i);
+
+    if (order_ == storageTileOrder)
+    {
+        end_ = length();
+        return;
     }
+
+    while ((1 << bits_) < largest)
+        ++bits_;
+    BZPRECONDITION(bits_ * N_dimensions < int(8 * sizeof(sizeType)));
+    end_ = length() ? sizeType(1) << (bits_ * N_dimensions) : 0;
 }
 
 template<int N_dimensions>
-void MakeHilbertTraversal(Vector<TinyVector<int,N_dimensions> >& coord, 
-    int length)
+inline bool TraversalOrder<N_dimensions>::next(T_coord& point)
 {
-    // N_dimensions != 2 not yet implemented
-    BZPRECONDITION(N_dimensions == 2);
-
-    // The constant on the next line is ln(2)
-    int d = (int)(::ceil(::log((double)length) / 0.693147180559945309417));  
-
-    int N = 1 << d;
-    const int Npoints = N*N;
-    Vector<TinyVector<int,2> > coord2(Npoints);
-
-    int i=0;
-    makeHilbert(coord2,0,0,32768,0,0,32768,d,i);
-
-    int xp0 = coord2[0][0];
-    int yp0 = coord2[0][1];
-
-    int j=0;
-
-    coord.resize(length * length);
-
-    for (int i=0; i < Npoints; ++i)
+    while (position_ < end_)
     {
-        coord2[i][0] = (coord2[i][0]-xp0)/(2*xp0);
-        coord2[i][1] = (coord2[i][1]-yp0)/(2*yp0);
-
-        if ((coord2[i][0] < length) && (coord2[i][1] < length) 
-            && (coord2[i][0] >= 0) && (coord2[i][1] >= 0))
+        const sizeType position = position_++;
+        if (order_ == storageTileOrder)
         {
-            coord[j][0] = coord2[i][0];
-            coord[j][1] = coord2[i][1];
-            ++j;
+            storagePoint(position, point);
+            return true;
         }
+
+        if (order_ == mortonTileOrder)
+            mortonPoint(position, point);
+        else
+            hilbertPoint(position, point);
+
+        bool inside = true;
+        for (int d=0; d < N_dimensions; ++d)
+            if (point[d] >= size_[d])
+                inside = false;
+        if (inside)
+            return true;
     }
+    return false;
 }
 
 template<int N_dimensions>
-void generateFastTraversalOrder(const TinyVector<int,N_dimensions>& size)
+inline void TraversalOrder<N_dimensions>::storagePoint(sizeType position,
+    T_coord& point) const
 {
-    BZPRECONDITION(N_dimensions == 2);
-    BZPRECONDITION(size[0] == size[1]);
-
-    TraversalOrderCollection<2> travCol;
-    if (travCol.find(size))
-        return;
+    for (int d=0; d < N_dimensions; ++d)
+    {
+        point[d] = position % size_[d];
+        position /= size_[d];
+    }
+}
 
-    Vector<TinyVector<int,2> > ordering(size[0]);
+// Bit b of coordinate d is bit b*N_dimensions + d of the position
+template<int N_dimensions>
+inline void TraversalOrder<N_dimensions>::mortonPoint(sizeType position,
+    T_coord& point) const
+{
+    point = 0;
+    for (int b=0; b < bits_; ++b)
+        for (int d=0; d < N_dimensions; ++d)
+        {
+            point[d] |= int(position & 1) << b;
+            position >>= 1;
+        }
+}
 
-    MakeHilbertTraversal(ordering, size[0]);
-    travCol.insert(TraversalOrder<2>(size, ordering));
+// The position along a Hilbert curve over a 2^bits_ square, built from
+// the smallest quadrants up: each quadrant is entered at one corner and
+// left at the next, rotating and reflecting the curve inside it.
+template<int N_dimensions>
+inline void TraversalOrder<N_dimensions>::hilbertPoint(sizeType position,
+    T_coord& point) const
+{
+    int x = 0, y = 0;
+    for (int s=1; s < (1 << bits_); s *= 2)
+    {
+        const int rx = 1 & int(position / 2);
+        const int ry = 1 & int(position ^ rx);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            const int t = x;
+            x = y;
+            y = t;
+        }
+        x += s * rx;
+        y += s * ry;
+        position /= 4;
+    }
+    point[0] = x;
+    point[1] = y;
 }
 
+// The curves used to have to be generated before evaluating a stencil.
+// They are now computed during evaluation; this is kept so that such
+// code still compiles.
+template<int N_dimensions>
+inline void generateFastTraversalOrder(const TinyVector<int,N_dimensions>&)
+{ }
+
 BZ_NAMESPACE_END
 
 #endif // BZ_TRAVERSAL_CC
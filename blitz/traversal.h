@@ -29,9 +29,27 @@
  *
  ***************************************************************************/
 
-// Fast traversal orders require the ISO/ANSI C++ standard library
-// (particularly set).
-#ifdef BZ_HAVE_STD
+/*
+ * TraversalOrder<N> visits the points of an N-dimensional grid one at a
+ * time, in one of these orders:
+ *
+ *   storageTileOrder   dimension 0 varies fastest, then dimension 1, ...
+ *   mortonTileOrder    Z-order: the bits of the coordinates interleaved
+ *   hilbertTileOrder   a Hilbert curve; for N != 2, Morton order is used
+ *
+ * Consecutive points of the Morton and Hilbert orders are close to each
+ * other in every dimension.  evaluateWithFastTraversal() in
+ * <blitz/array/eval.cc> uses them to visit tiles of a large stencil, so
+ * that the rows a tile shares with the previous ones are still cached.
+ * The points are computed as they are needed: the curves are laid over
+ * the smallest power-of-two grid which contains the grid, and the points
+ * outside it are skipped.
+ *
+ *   TraversalOrder<2> tiles(shape(4,3), hilbertTileOrder);
+ *   TinyVector<int,2> tile;
+ *   while (tiles.next(tile))
+ *       ...
+ */
 
 #ifndef BZ_TRAVERSAL_H
 #define BZ_TRAVERSAL_H
@@ -40,69 +58,49 @@
  #include <blitz/tinyvec.h>
 #endif
 
-#ifndef BZ_VECTOR_H
- #include <blitz/vector.h>
-#endif
-
-#include <set>
-
 BZ_NAMESPACE(blitz)
 
+enum TileOrder { storageTileOrder, mortonTileOrder, hilbertTileOrder };
+
 template<int N_dimensions>
 class TraversalOrder {
 
 public:
     typedef TinyVector<int, N_dimensions> T_coord;
-    typedef Vector<T_coord>               T_traversal;
 
-    TraversalOrder()
-    {
-        size_ = 0;
-    }
+    TraversalOrder(const T_coord& size, TileOrder order);
 
-    TraversalOrder(const T_coord& size, T_traversal& order)
-        : size_(size), order_(order)
-    { }
+    const T_coord& size() const
+    { return size_; }
 
-    TraversalOrder(const T_coord& size)
-        : size_(size)
-    { }
+    TileOrder order() const
+    { return order_; }
 
-    T_coord operator[](int i) const
-    { return order_[i]; }
-
-    T_coord& operator[](int i)
-    { return order_[i]; }
-
-    int length() const
-    { return order_.length(); }
-
-    bool operator<(const TraversalOrder<N_dimensions>& x) const
+    // Number of points in the grid
+    sizeType length() const
     {
-        for (int i=0; i < N_dimensions; ++i)
-        {
-            if (size_[i] < x.size_[i])
-                return true;
-            else if (size_[i] > x.size_[i])
-                return false;
-        }
-        return false;
+        sizeType n = 1;
+        for (int d=0; d < N_dimensions; ++d)
+            n *= size_[d];
+        return n;
     }
 
-    bool operator==(const TraversalOrder<N_dimensions>& x) const
-    {
-        for (int i=0; i < N_dimensions; ++i)
-        {
-            if (size_[i] != x.size_[i])
-                return false;
-        }
+    // Stores the next point in point; false after the last one
+    bool next(T_coord& point);
 
-        return true;
-    }
+    // Starts again from the first point
+    void reset()
+    { position_ = 0; }
 
-protected:
-    T_traversal order_;
-    T_coord     size_;
+private:
+    void storagePoint(sizeType position, T_coord& point) const;
+    void mortonPoint(sizeType position, T_coord& point) const;
+    void hilbertPoint(sizeType position, T_coord& point) const;
+
+    T_coord   size_;
+    TileOrder order_;
+    int       bits_;        // log2 of the side of the power-of-two grid
+    sizeType  position_, end_;
 };
 
 /*
@@ -115,57 +113,8 @@ public:
      TraversalOrder () {} // AJS
 };
 
-template<int N_dimensions>
-class TraversalOrderCollection {
-public:
-    typedef TraversalOrder<N_dimensions>        T_traversal;
-    typedef _bz_typename T_traversal::T_coord   T_coord;
-    typedef set<T_traversal>                    T_set;
-    typedef _bz_typename set<T_traversal>::const_iterator T_iterator;
-
-    const T_traversal* find(const T_coord& size)
-    {
-        T_iterator iter = traversals_.find(T_traversal(size));
-        if (iter != traversals_.end())
-            return &(*iter);
-        return 0;
-    }
-
-    void insert(T_traversal x)
-    {
-        traversals_.insert(x);
-    }
-
-protected:
-    static T_set traversals_;
-};
-
-template<int N_dimensions>
-_bz_typename TraversalOrderCollection<N_dimensions>::T_set
-    TraversalOrderCollection<N_dimensions>::traversals_;
-
-/*
- * This specialization is provided to avoid problems with zero-length
- * vectors.
- */
-
-template<>
-class TraversalOrderCollection<0> {
-public:
-    typedef int T_traversal;
-    typedef int T_coord;
-    typedef int T_set;
-    typedef int T_iterator;
-
-    const T_traversal* find(const T_coord& size)
-    { return 0; }
-};
-
 BZ_NAMESPACE_END
 
 #include <blitz/traversal.cc>
 
 #endif // BZ_TRAVERSAL_H
-
-#endif // BZ_HAVE_STD
-
@@ -50,12 +50,16 @@
 #define BZ_COLLAPSE_LOOPS
 #define BZ_USE_FAST_READ_ARRAY_EXPR
 #define BZ_ARRAY_EXPR_USE_COMMON_STRIDE
-#undef  BZ_ARRAY_SPACE_FILLING_TRAVERSAL
+#define BZ_ARRAY_SPACE_FILLING_TRAVERSAL
+#define BZ_ARRAY_SPACE_FILLING_TILE_SIZE    32
+#define BZ_ARRAY_SPACE_FILLING_ORDER        mortonTileOrder
 #undef  BZ_ARRAY_FAST_TRAVERSAL_UNROLL
 #undef  BZ_ARRAY_STACK_TRAVERSAL_CSE_AND_ANTIALIAS
 #undef  BZ_ARRAY_STACK_TRAVERSAL_UNROLL
 #define BZ_ARRAY_2D_STENCIL_TILING
-#define BZ_ARRAY_2D_STENCIL_TILE_SIZE       128
+#define BZ_ARRAY_2D_STENCIL_TILE_SIZE       16
+#define BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL
+#define BZ_RUNTIME_TUNING
 #undef  BZ_INTERLACE_ARRAYS
 #undef  BZ_ALIGN_BLOCKS_ON_CACHELINE_BOUNDARY
 #define BZ_FAST_COMPILE
@@ -34,6 +34,10 @@
 
 #include <blitz/blitz.h>
 
+#ifdef BZ_FAST_COMPLEX
+ #include <blitz/ops.h>
+#endif
+
 BZ_NAMESPACE(blitz)
 
 class _bz_updater_base { };
@@ -69,6 +73,26 @@ BZ_DECL_UPDATER(_bz_bitor_update, |=, "|=");
 BZ_DECL_UPDATER(_bz_shiftl_update, <<=, "<<=");
 BZ_DECL_UPDATER(_bz_shiftr_update, >>=, ">>=");
 
+#if defined(BZ_FAST_COMPLEX) && defined(BZ_HAVE_COMPLEX)
+
+// Limited-range complex updates, see <blitz/ops.h>
+#define BZ_DECL_FAST_COMPLEX_UPDATER(name,fn,symbol)        \
+  template<typename T>                                      \
+  class name<complex<T>, complex<T> >                       \
+    : public _bz_updater_base {                             \
+  public:                                                   \
+    static inline void update(complex<T>& restrict x,       \
+      const complex<T>& y)                                  \
+    { x = _bz_fastComplex::fn(x, y); }                      \
+    static void prettyPrint(BZ_STD_SCOPE(string) &str)      \
+    { str += symbol; }                                      \
+  }
+
+BZ_DECL_FAST_COMPLEX_UPDATER(_bz_multiply_update, multiply, "*=");
+BZ_DECL_FAST_COMPLEX_UPDATER(_bz_divide_update, divide, "/=");
+
+#endif // BZ_FAST_COMPLEX
+
 BZ_NAMESPACE_END
 
 #endif // BZ_UPDATE_H
@@ -0,0 +1,507 @@
+// -*- C++ -*-
+/***************************************************************************
+ * blitz/vecmath.h   Vectorizable exp, log, sin, cos and pow
+ *
+ * $Id$
+ *
+ * Copyright (C) 1997-2011 Todd Veldhuizen <tveldhui@acm.org>
+ *
+ * This file is a part of Blitz.
+ *
+ * Blitz is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Blitz is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Blitz.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Suggestions:          blitz-devel@lists.sourceforge.net
+ * Bugs:                 blitz-support@lists.sourceforge.net
+ *
+ * For more information, please see the Blitz++ Home Page:
+ *    https://sourceforge.net/projects/blitz/
+ *
+ ***************************************************************************/
+
+/*
+ * Branch-free exp(), log(), sin(), cos() and pow() for float and double.
+ * They are built from polynomials, bit manipulation and selects, with no
+ * table lookups and no calls.  Inlined into the unit-stride loops of an
+ * expression evaluation, they vectorize for whatever instruction set the
+ * code is compiled for (on x86, SSE4.1 and later).  The libm functions,
+ * which are calls, do not.
+ *
+ * Defining BZ_VECMATH before including any Blitz++ header makes array
+ * expressions use them in place of the libm functions.  An expression
+ * such as
+ *
+ *     q = exp(-w * ds) * q;
+ *
+ * then vectorizes with no change to the source.  Defining BZ_VECMATH_FAST
+ * as well selects the fast tier, which drops the extra-precision steps
+ * and shortens the polynomials.  The errors, measured against long double
+ * libm on random arguments, are
+ *
+ *               BZ_VECMATH         BZ_VECMATH_FAST
+ *     exp       < 1 ulp            < 9 ulp
+ *     log       < 1 ulp            < 1 ulp
+ *     sin, cos  < 1 ulp            < 8 ulp
+ *     pow       < 1 ulp            < 9 ulp + 1.3 |y log x| ulp
+ *
+ * The float versions are computed in double, and have errors < 1 ulp in
+ * both tiers.  Special values (zeros, infinities, NaNs, subnormals)
+ * follow C99 Annex F.  The argument reduction of sin() and cos() is
+ * exact for |x| < 1e8 (1e6 in the fast tier); beyond, it loses accuracy,
+ * and the libm functions should be used.  The code relies on IEEE
+ * arithmetic, and must not be compiled with -ffast-math.
+ */
+
+#ifndef BZ_VECMATH_H
+#define BZ_VECMATH_H
+
+#ifndef BZ_BLITZ_H
+ #include <blitz/blitz.h>
+#endif
+
+#include <limits>
+#include <cstring>
+
+BZ_NAMESPACE(blitz)
+
+enum { _bz_vecmathAccurate, _bz_vecmathFast, _bz_vecmathSingle };
+
+// Bit-level access to doubles, and the error terms of exact arithmetic
+struct _bz_vecmathbits {
+    typedef unsigned long long T_bits;   // Must hold the 64 bits of a double
+
+    static BZ_ALWAYS_INLINE T_bits asBits(double x)
+    {
+        T_bits b;
+        std::memcpy(&b, &x, sizeof(double));
+        return b;
+    }
+
+    static BZ_ALWAYS_INLINE double asDouble(T_bits b)
+    {
+        double x;
+        std::memcpy(&x, &b, sizeof(double));
+        return x;
+    }
+
+    // c ? a : b, as a mask rather than a branch.  The compiler turns the
+    // conditional operator into branches around the code that only one
+    // side needs, and then cannot vectorize the loop.
+    static BZ_ALWAYS_INLINE double select(bool c, double a, double b)
+    {
+        const T_bits mask = T_bits(0) - T_bits(c);
+        return asDouble((asBits(a) & mask) | (asBits(b) & ~mask));
+    }
+
+    static BZ_ALWAYS_INLINE double abs(double x)
+    { return asDouble(asBits(x) & 0x7fffffffffffffffULL); }
+
+    // Adding 1.5 * 2^52 rounds a double below 2^51 in magnitude to an
+    // integer, which is then held in the low bits of the sum.
+    static BZ_ALWAYS_INLINE double shifter()
+    { return 6755399441055744.0; }
+
+    static BZ_ALWAYS_INLINE double infinity()
+    { return std::numeric_limits<double>::infinity(); }
+
+    static BZ_ALWAYS_INLINE double nan()
+    { return std::numeric_limits<double>::quiet_NaN(); }
+
+    // a * b - p exactly, where p is a * b rounded.  Where the compiler may
+    // contract a * b + c into a fused multiply-add, it must use one here,
+    // as the split products would be contracted as well.
+    static BZ_ALWAYS_INLINE double productError(double a, double b,
+        double p)
+    {
+#if defined(__FMA__) || defined(__ARM_FEATURE_FMA)
+        return __builtin_fma(a, b, -p);
+#else
+        const double split = 134217729.0;      // 2^27 + 1
+        double t = split * a;
+        const double ah = t - (t - a), al = a - ah;
+        t = split * b;
+        const double bh = t - (t - b), bl = b - bh;
+        return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+    }
+
+    // a + b - s exactly, where s is a + b rounded
+    static BZ_ALWAYS_INLINE double sumError(double a, double b, double s)
+    {
+        const double bb = s - a;
+        return (a - (s - bb)) + (b - bb);
+    }
+};
+
+/*
+ * The polynomials are Chebyshev interpolants of the remainder of the
+ * Taylor series, close to minimax, of the lowest degree that meets the
+ * accuracy of the tier; _bz_vecmathSingle is the tier used for floats.
+ */
+
+template<int N_tier>
+struct _bz_vecmath : public _bz_vecmathbits {
+
+    // e^r = 1 + r + r^2 q(r), |r| <= ln2/2
+    static BZ_ALWAYS_INLINE double expPoly(double r)
+    {
+        if (N_tier == _bz_vecmathAccurate)
+            return 0.5000000000000001 + r * (0.16666666666666669
+                + r * (0.041666666666624164 + r * (0.008333333333330065
+                + r * (0.0013888888917196719 + r * (0.00019841269863040545
+                + r * (2.4801521322368692e-05 + r * (2.7557268480310024e-06
+                + r * (2.7620075879983367e-07
+                + r * 2.5100375832561234e-08))))))));
+        else if (N_tier == _bz_vecmathFast)
+            return 0.5 + r * (0.16666666666648303
+                + r * (0.041666666666651364 + r * (0.008333333353717156
+                + r * (0.0013888888905871347 + r * (0.0001984120875699232
+                + r * (2.4801536409064087e-05 + r * (2.7625102005388108e-06
+                + r * 2.761379555451986e-07)))))));
+        else
+            return 0.5000000013457727 + r * (0.16666666681614256
+                + r * (0.04166646500604005 + r * (0.008333310934448869
+                + r * (0.0013933641031986701
+                + r * 0.00019890980869750327))));
+    }
+
+    // 2 atanh(s) = 2s + s z q(z), z = s^2 <= (3 - 2 sqrt2)^2
+    static BZ_ALWAYS_INLINE double logPoly(double z)
+    {
+        if (N_tier == _bz_vecmathAccurate)
+            return 0.6666666666666666 + z * (0.3999999999999999
+                + z * (0.2857142857143536 + z * (0.22222222219858734
+                + z * (0.18181818593656762 + z * (0.15384575132330097
+                + z * (0.13335638669839822 + z * (0.1168812364286311
+                + z * 0.11881997202961458)))))));
+        else if (N_tier == _bz_vecmathFast)
+            return 0.666666666666667 + z * (0.39999999999899505
+                + z * (0.28571428625975487 + z * (0.2222221113479508
+                + z * (0.18182889125261723 + z * (0.15331721600556042
+                + z * 0.14616449685043406)))));
+        else
+            return 0.6666666655449709 + z * (0.40000121839806124
+                + z * (0.28550820815960665 + z * 0.23330467216303835));
+    }
+
+    // 2 atanh(s) = 2s + 2/3 s^3 + 2/5 s^5 + s^5 z q2(z), to the accuracy
+    // of a double-double log
+    static BZ_ALWAYS_INLINE double logPoly2(double z)
+    {
+        return 0.285714285714286 + z * (0.22222222222140714
+            + z * (0.18181818226058036 + z * (0.1538460639274099
+            + z * (0.133342017810555 + z * (0.11721820901503831
+            + z * 0.11566250279600705)))));
+    }
+
+    // sin r = r + r z q(z), z = r^2 <= (pi/4)^2
+    static BZ_ALWAYS_INLINE double sinPoly(double z)
+    {
+        if (N_tier != _bz_vecmathSingle)
+            return -0.16666666666666666 + z * (0.008333333333330948
+                + z * (-0.00019841269836758574 + z * (2.755731610255244e-06
+                + z * (-2.5051131845003624e-08
+                + z * 1.5918129294866608e-10))));
+        else
+            return -0.1666666666385529 + z * (0.008333331874710208
+                + z * (-0.00019840086735384846 + z * 2.724992580305979e-06));
+    }
+
+    // cos r = 1 - z/2 + z^2 q(z), z = r^2 <= (pi/4)^2
+    static BZ_ALWAYS_INLINE double cosPoly(double z)
+    {
+        if (N_tier == _bz_vecmathAccurate)
+            return 0.041666666666666664 + z * (-0.0013888888888887398
+                + z * (2.480158729876569e-05 + z * (-2.7557317271729793e-07
+                + z * (2.08761462684032e-09 + z * -1.1382632425521717e-11))));
+        else if (N_tier == _bz_vecmathFast)
+            return 0.04166666666666468 + z * (-0.0013888888887277342
+                + z * (2.4801585210990515e-05 + z * (-2.7556369695573007e-07
+                + z * 2.0700600483433117e-09)));
+        else
+            return 0.0416666666643212 + z * (-0.001388888767201679
+                + z * (2.480060037715673e-05 + z * -2.730095920390147e-07));
+    }
+
+    // e^(x + xlo), where xlo is a correction below the precision of x
+    static BZ_ALWAYS_INLINE double exp(double x, double xlo = 0.0)
+    {
+        const double log2e = 1.4426950408889634;
+        const double ln2hi = 6.93147180369123816490e-01;   // 32 bits
+        const double ln2lo = 1.90821492927058770002e-10;
+
+        // Beyond these bounds the result is 0 or infinity anyway.  A NaN
+        // passes through both comparisons.
+        x = select(x > 710.0, 710.0, x);
+        x = select(x < -746.0, -746.0, x);
+
+        // x = k ln2 + r, |r| <= ln2/2
+        const double t = x * log2e + shifter();
+        const T_bits k = asBits(t) - asBits(shifter());
+        const double kd = t - shifter();
+        double p;
+        if (N_tier == _bz_vecmathAccurate)
+        {
+            // x - k ln2hi is exact; the errors of r and of 1 + r are
+            // added to the polynomial
+            const double rhi = x - kd * ln2hi;
+            const double rlo = xlo - kd * ln2lo;
+            const double r = rhi + rlo;
+            const double one = 1.0 + r;
+            p = one + ((sumError(1.0, r, one) + sumError(rhi, rlo, r))
+                + r * r * expPoly(r));
+        }
+        else
+        {
+            const double r = ((x - kd * ln2hi) - kd * ln2lo) + xlo;
+            p = 1.0 + (r + r * r * expPoly(r));
+        }
+
+        // 2^k as the product of two powers, so that results which are
+        // subnormal or overflow come out right
+        const T_bits k1 = asBits(kd * 0.5 + shifter()) - asBits(shifter());
+        const T_bits k2 = k - k1;
+        return p * asDouble((k1 + 1023) << 52) * asDouble((k2 + 1023) << 52);
+    }
+
+    // x = 2^e m, with sqrt(1/2) <= m < sqrt(2), for x > 0
+    static BZ_ALWAYS_INLINE double decompose(double x, double& e)
+    {
+        const T_bits offset = 0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL;
+
+        // Subnormals are scaled into the normal range
+        const bool subnormal = x < 2.2250738585072014e-308;
+        const T_bits u = asBits(select(subnormal, x * 18014398509481984.0,
+            x)) + offset;
+        e = asDouble(asBits(shifter()) + (u >> 52)) - shifter()
+            - select(subnormal, 1077.0, 1023.0);
+        return asDouble((u & 0x000fffffffffffffULL) + 0x3fe6a09e667f3bcdULL);
+    }
+
+    static BZ_ALWAYS_INLINE double log(double x)
+    {
+        const double ln2hi = 6.93147180369123816490e-01;
+        const double ln2lo = 1.90821492927058770002e-10;
+
+        double e;
+        const double m = decompose(x, e);
+
+        // log m = f - f^2/2 + s (f^2/2 + R), with f = m - 1, s = f/(2 + f)
+        const double f = m - 1.0;
+        const double hfsq = 0.5 * f * f;
+        const double s = f / (2.0 + f);
+        const double z = s * s;
+        const double R = z * logPoly(z);
+        double y = e * ln2hi - ((hfsq - (s * (hfsq + R) + e * ln2lo)) - f);
+
+        y = select(x < 0.0, nan(), y);
+        y = select(x == 0.0, -infinity(), y);
+        return select((x == infinity()) | (x != x), x, y);
+    }
+
+    // log x as hi + lo, for x >= 0
+    static BZ_ALWAYS_INLINE double logExtended(double x, double& lo)
+    {
+        const double ln2hi = 6.93147180369123816490e-01;
+        const double ln2lo = 1.90821492927058770002e-10;
+
+        double e;
+        const double m = decompose(x, e);
+
+        // s = (m - 1)/(m + 1) as s + slo; m - 1 is exact
+        const double f = m - 1.0;
+        const double d = m + 1.0;
+        const double dlo = sumError(m, 1.0, d);
+        const double s = f / d;
+        const double sd = s * d;
+        const double slo = ((f - sd) - productError(s, d, sd) - s * dlo) / d;
+
+        // log m = 2s + 2/3 s^3 + 2/5 s^5 + s^5 z q2(z), with the first
+        // three terms and their sum carried to twice the precision
+        const double c3 = 0.6666666666666666, c3lo = 3.700743415417188e-17;
+        const double c5 = 0.4, c5lo = -2.2204460492503132e-17;
+        const double z = s * s;
+        const double zlo = productError(s, s, z) + 2.0 * s * slo;
+        const double s3 = s * z;
+        const double s3lo = productError(s, z, s3) + s * zlo + z * slo;
+        const double s5 = s3 * z;
+        const double s5lo = productError(s3, z, s5) + s3 * zlo + z * s3lo;
+        const double t3 = c3 * s3;
+        const double t3lo = productError(c3, s3, t3) + c3 * s3lo + c3lo * s3;
+        const double t5 = c5 * s5;
+        const double t5lo = productError(c5, s5, t5) + c5 * s5lo + c5lo * s5;
+
+        const double a = e * ln2hi;
+        const double b = a + 2.0 * s;
+        const double c = b + t3;
+        const double hi = c + t5;
+        const double l = sumError(a, 2.0 * s, b) + sumError(b, t3, c)
+            + sumError(c, t5, hi) + 2.0 * slo + t3lo + t5lo
+            + (s5 * z * logPoly2(z) + e * ln2lo);
+
+        double y = hi + l;
+        lo = (hi - y) + l;
+
+        const bool special = (x == 0.0) | (x == infinity()) | (x != x);
+        y = select(x == 0.0, -infinity(), y);
+        y = select((x == infinity()) | (x != x), x, y);
+        lo = select(special, 0.0, lo);
+        return y;
+    }
+
+    // x = k pi/2 + r + rlo, with the quadrant k mod 4 in q
+    static BZ_ALWAYS_INLINE double reduce(double x, double& rlo, T_bits& q)
+    {
+        const double twoOverPi = 0.6366197723675814;
+        const double t = x * twoOverPi + shifter();
+        q = asBits(t) - asBits(shifter());
+        const double k = t - shifter();
+
+        if (N_tier == _bz_vecmathAccurate)
+        {
+            // pi/2 in four parts; k times each of the first three is
+            // exact for |k| < 2^27
+            const double p1 = 1.5707963109016418;
+            const double p2 = 1.5893254712295857e-08;
+            const double p3 = 6.123233932053594e-17;
+            const double p4 = 6.36831716351095e-25;
+
+            const double a = x - k * p1;
+            const double b = a - k * p2;
+            const double c = b - k * p3;
+            const double clo = sumError(a, -k * p2, b)
+                + sumError(b, -k * p3, c) - k * p4;
+            const double r = c + clo;
+            rlo = (c - r) + clo;
+            return r;
+        }
+        else
+        {
+            // Three parts, exact for |k| < 2^20
+            const double p1 = 1.5707963267341256;
+            const double p2 = 6.077100506303966e-11;
+            const double p3 = 2.0222662487959506e-21;
+            rlo = 0.0;
+            return ((x - k * p1) - k * p2) - k * p3;
+        }
+    }
+
+    // sin and cos of r + rlo, |r| <= pi/4
+    static BZ_ALWAYS_INLINE double sinKernel(double r, double rlo)
+    {
+        const double z = r * r;
+        if (N_tier == _bz_vecmathAccurate)
+            return r + (r * z * sinPoly(z) + rlo * (1.0 - 0.5 * z));
+        else
+            return r + r * z * sinPoly(z);
+    }
+
+    static BZ_ALWAYS_INLINE double cosKernel(double r, double rlo)
+    {
+        const double z = r * r;
+        const double hz = 0.5 * z;
+        const double w = 1.0 - hz;
+        if (N_tier == _bz_vecmathAccurate)
+            return w + ((((1.0 - w) - hz) - 0.5 * productError(r, r, z))
+                + (z * z * cosPoly(z) - r * rlo));
+        else
+            return w + (((1.0 - w) - hz) + z * z * cosPoly(z));
+    }
+
+    // The quadrant selects the kernel and the sign
+    static BZ_ALWAYS_INLINE double quadrant(double s, double c, T_bits q)
+    {
+        const double y = select(q & 1, c, s);
+        return asDouble(asBits(y) ^ ((q & 2) << 62));
+    }
+
+    static BZ_ALWAYS_INLINE double sin(double x)
+    {
+        double rlo;
+        T_bits q;
+        const double r = reduce(x, rlo, q);
+        // The sum in the kernel turns -0 into +0
+        return select(x == 0.0, x,
+            quadrant(sinKernel(r, rlo), cosKernel(r, rlo), q));
+    }
+
+    static BZ_ALWAYS_INLINE double cos(double x)
+    {
+        double rlo;
+        T_bits q;
+        const double r = reduce(x, rlo, q);
+        return quadrant(sinKernel(r, rlo), cosKernel(r, rlo), q + 1);
+    }
+
+    static BZ_ALWAYS_INLINE double pow(double x, double y)
+    {
+        const double ax = abs(x);
+        const double ay = abs(y);
+
+        double p;
+        if (N_tier == _bz_vecmathAccurate)
+        {
+            // y log|x| as hi + lo
+            double lo;
+            const double h = logExtended(ax, lo);
+            const double hi = y * h;
+            const double l = productError(y, h, hi) + y * lo;
+            p = exp(hi, select(abs(hi) < 1000.0, l, 0.0));
+        }
+        else
+            p = exp(y * log(ax));
+
+        // Whether y is an integer, and odd: below 2^52, adding 2^52 rounds
+        // |y| to an integer held in the low bits; from 2^52 to 2^53 the
+        // low bit of |y| itself is the parity; beyond, y is even.
+        const double two52 = 4503599627370496.0;
+        const double rounded = select(ay < two52, ay + two52, ay);
+        const bool integer = (ay >= two52) | (rounded - two52 == ay);
+        const bool odd = integer & (ay < 2.0 * two52)
+            & bool(asBits(rounded) & 1);
+
+        p = asDouble(asBits(p) ^ (asBits(x) & (T_bits(odd) << 63)));
+        p = select((x < 0.0) & (x > -infinity()) & !integer, nan(), p);
+        p = select((ax == 1.0) & (ay == infinity()), 1.0, p);
+        return select((y == 0.0) | (x == 1.0), 1.0, p);
+    }
+
+    // Floats are computed in double with the polynomials of the float tier
+    static BZ_ALWAYS_INLINE float exp(float x)
+    { return float(_bz_vecmath<_bz_vecmathSingle>::exp(double(x))); }
+
+    static BZ_ALWAYS_INLINE float log(float x)
+    { return float(_bz_vecmath<_bz_vecmathSingle>::log(double(x))); }
+
+    static BZ_ALWAYS_INLINE float sin(float x)
+    { return float(_bz_vecmath<_bz_vecmathSingle>::sin(double(x))); }
+
+    static BZ_ALWAYS_INLINE float cos(float x)
+    { return float(_bz_vecmath<_bz_vecmathSingle>::cos(double(x))); }
+
+    static BZ_ALWAYS_INLINE float pow(float x, float y)
+    {
+        return float(_bz_vecmath<_bz_vecmathSingle>::pow(double(x),
+            double(y)));
+    }
+};
+
+#ifdef BZ_VECMATH_FAST
+typedef _bz_vecmath<_bz_vecmathFast> _bz_vecmathTier;
+#else
+typedef _bz_vecmath<_bz_vecmathAccurate> _bz_vecmathTier;
+#endif
+
+BZ_NAMESPACE_END
+
+#endif // BZ_VECMATH_H
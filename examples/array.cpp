@@ -24,10 +24,10 @@ int main()
 
     Range I(1,N-2), J(1,N-2), K(1,N-2);
 
-#ifdef BZ_HAVE_STD
 #ifdef BZ_ARRAY_SPACE_FILLING_TRAVERSAL
-    generateFastTraversalOrder(TinyVector<int,2>(N-2,N-2));
-#endif
+    // Stencils too large for the cache are evaluated in tiles visited
+    // along a space-filling curve; choose the tile size and order
+    TuningParameters::instance().setCurveTile(16, hilbertTileOrder);
 #endif
 
     for (int i=0; i < numIters; ++i)
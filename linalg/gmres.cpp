@@ -34,14 +34,10 @@
 #include <complex>
 #include <cmath>
 #include <blitz/array.h>
+#include <blitz/array/gmres.h>
 
 using namespace blitz;
 
-double norm2 (const Array<complex<double>, 1>& x)
-{
-  return sqrt(abs(sum(x * conj(x))));
-}
-
 void checkMatrixVectorDimensions(const int M, // required number of A lines 
                                  const int N, // required number of A columns 
                                  const Array<complex<double>, 2>& A, 
@@ -68,67 +64,27 @@ void checkMatrixVectorDimensions(const int M, // required number of A lines
   }
 }
 
-Array<complex<double>, 1> matrixMultiply (const Array<complex<double>, 2>& A,
-                                          const Array<complex<double>, 1>& b)
-{
-  int i, j;
-  const int M = A.extent(0), N = b.extent(0);
-  // check dimensions
-  checkMatrixVectorDimensions(M, N, A, b);
-  Array<complex<double>, 1> result(M);
-  result = 0.0;
-  for (i=0 ; i<M ; i++) {
-    for (j=0 ; j<N ; j++) {
-      result(i) += A(i,j) * b(j);
+// Dense matrix in the operator form expected by blitz::gmres()
+class DenseMatrixOperator {
+public:
+  DenseMatrixOperator(const Array<complex<double>, 2>& A) : A_(A) { }
+
+  void operator()(const Array<complex<double>, 1>& x,
+                  Array<complex<double>, 1>& y) const
+  {
+    const int M = A_.extent(0), N = x.extent(0);
+    const int xbase = x.lbound(0), ybase = y.lbound(0);
+    for (int i=0 ; i<M ; i++) {
+      complex<double> s = 0.0;
+      for (int j=0 ; j<N ; j++)
+        s += A_(A_.lbound(0)+i, A_.lbound(1)+j) * x(xbase+j);
+      y(ybase+i) = s;
     }
   }
-  return result;
-}
 
-void triangleUpSolve(Array<complex<double>, 1>& x,
-                     const Array<complex<double>, 2>& T,
-                     const Array<complex<double>, 1>& y)
-/*
- * This function computes the solution of a linear system
- * where T is a upper triangular matrix, i.e. T(i>j, j) = 0.0.
- */
-{
-  int i, j;
-  const int N = y.extent(0);
-  // check dimensions: T must be square
-  checkMatrixVectorDimensions(N, N, T, y);
-  for (i=N-1 ; i>-1 ; i--) {
-    // x(i) = 1/T(i, i) * ( y(i) - sum(T(i, i+1:N-1) * x(i+1:N-1)) )
-    x(i) = y(i);
-    for (j=i+1 ; j<N ; j++) {
-      x(i) -= T(i, j) * x(j);
-    }
-    x(i) /= T(i, i);
-  }
-}
-
-void rotmat(complex<double>& cs, 
-            complex<double>& sn, 
-            const complex<double>& a, 
-            const complex<double>& b)
-// compute the Givens rotation matrix parameters for a and b
-{
-  complex<double> temp;
-  if (b==0.0) {
-    cs = 1.0;
-    sn = 0.0;
-  }
-  else if ( abs(b) > abs(a) ) {
-    temp = -a/b;
-    sn = 1.0 / sqrt(1.0 + temp*temp);
-    cs = temp * sn;
-  }
-  else {
-    temp = -b/a;
-    cs = 1.0 / sqrt(1.0 + temp*temp);
-    sn = temp * cs;
-  }
-}
+private:
+  const Array<complex<double>, 2>& A_;
+};
 
 void gmres(Array<complex<double>, 1>& x, // INPUT, OUTPUT: initial guess, converged solution
            double & error, // OUTPUT: the error
@@ -154,10 +110,8 @@ void gmres(Array<complex<double>, 1>& x, // INPUT, OUTPUT: initial guess, conver
  *    error  --  the residual after the final iteration
  **************************************************************************/
 {
-  Range all = Range::all();
   flag = 0;
-  int i, k;
-  const int N = b.extent(0), m = RESTRT; // size of the system
+  const int N = b.extent(0);
   // dimensions and other checks
   checkMatrixVectorDimensions(N, N, A, x);
   if (RESTRT < 1) {
@@ -169,89 +123,18 @@ void gmres(Array<complex<double>, 1>& x, // INPUT, OUTPUT: initial guess, conver
     exit(1);
   }
 
-  double bnorm2 = norm2(b), rnorm2;
-  if (bnorm2==0.0) bnorm2 = 1.0;
-  complex<double> temp;
-  Array<complex<double>, 1> r(N);
-
-  // r = precondSolve(M, b, A, x) 
-  //   = M^(-1) * ( b-A*x )
-  // this will be done in a later version of the code
-  r = b - matrixMultiply(A, x);
-  error = norm2(r) / bnorm2;
-  if (error<tol) return;
-
-  // workspaces definitions
-  Array<complex<double>, 1> cs(m), sn(m), e1(m+1), s(m+1), w(N), y;
-  Array<complex<double>, 2> V(N, m+1), H(m+1, m);
-  e1 = 0.0;
-  e1(0) = 1.0;
-
-  for (iter=0 ; iter<MAXITER ; iter++) {
-    // r = precondSolve(M, b, A, x) 
-    //   = M^(-1) * ( b-A*x )
-    // this will be done in a later version of the code
-    r = b - matrixMultiply(A, x);
-    rnorm2 = norm2(r);
-    V(all, 0) = r/rnorm2;
-    s = rnorm2 * e1;
-
-    for (i=0 ; i<m ; i++){
-      // if preconditioning: w = M^(-1) * (A*V(all, i))
-      w = matrixMultiply(A, V(all, i));
-
-      // construct orthonormal basis using Gram-Schmidt
-      for (k=0 ; k<i+1 ; k++) {
-        H(k, i) = sum(w * conj(V(all, k)));
-        w -= H(k, i) * V(all, k);
-      }
-      H(i+1, i) = norm2( w );
-      V(all, i+1) = w / H(i+1, i);
-
-      // now we apply the GIVENS rotations
-      for (k=0 ; k<i ; k++) {
-        temp = conj(cs(k)) * H(k, i) - conj(sn(k)) * H(k+1, i);
-        H(k+1, i) = sn(k) * H(k, i) + cs(k) * H(k+1, i);
-        H(k, i) = temp;
-      }
-
-      // form i-th rotation matrix
-      rotmat(cs(i), sn(i), H(i, i), H(i+1, i));
-      H(i, i) = conj(cs(i)) * H(i, i) - conj(sn(i)) * H(i+1, i);
-      H(i+1,i) = 0.0;
-
-      // approximate residual norm
-      temp = conj(cs(i)) * s(i) - conj(sn(i)) * s(i+1);
-      s(i+1) = sn(i) * s(i) + cs(i) * s(i+1);
-      s(i) = temp;
-      error = abs(s(i+1)) / bnorm2;
-
-      // update approximation x
-      if ( error<=tol ) {
-        y.resize(i+1); // Range: 0..i
-        triangleUpSolve( y, H(Range(0, i), Range(0, i)), s(Range(0, i)) );
-        x += matrixMultiply(V(all, Range(0, i)), y);
-        return;
-      }
-    } // end for (i =...)
-    
-    if ( error<=tol ) return;
-    y.resize(m); // Range: 0..m-1
-    triangleUpSolve( y, H(Range(0, m-1), Range(0, m-1)), s(Range(0, m-1)) );
-    x += matrixMultiply(V(all, Range(0, m-1)), y);
-    // r = precondSolve(M, b, A, x) 
-    //   = M^(-1) * ( b-A*x )
-    // this will be done in a later version of the code
-    r = b - matrixMultiply(A, x);
-    // check convergence
-    error = abs(s(m)) / bnorm2;
-    if ( error<=tol ) return;
-  } // end for (iter =...)
-
-  // bad ending...
-  if (error>tol) flag = 1;
+  // The templated solver in <blitz/array/gmres.h> does the work; its
+  // iteration limit counts inner iterations, ours counts restarts.
+  GMRESWorkspace<complex<double>, 1> workspace(x, RESTRT);
+  const int inner = blitz::gmres(DenseMatrixOperator(A), x, b, workspace,
+                                 tol, RESTRT * MAXITER);
+  error = workspace.residual();
+  // iter counts the restart cycles completed before the converging one,
+  // or is MAXITER if none converged
+  const int its = workspace.iterations();
+  iter = (its > 0) ? (its - 1) / RESTRT : 0;
+  if (inner < 0) {
+    iter = MAXITER;
+    flag = 1;
+  }
 }
-
-
-
-
@@ -0,0 +1,78 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // Cancellation: every 1 is lost when added to 1e16 in double
+    const int n = 4001;
+    Array<double,1> x(n);
+    x = where(tensor::i % 4 == 0, 1e16, where(tensor::i % 4 == 2, -1e16, 1.));
+    x(n-1) = 0.5;
+    const double exact = 2000.5;
+
+    BZTEST(sum(x, compensatedAccumulation) == exact);
+    BZTEST(mean(x, compensatedAccumulation) == exact / n);
+    BZTEST(sum(x, naiveAccumulation) != exact);
+
+    // The same through a strided view, an expression with an index
+    // placeholder and a partial reduction, which take one element at
+    // a time
+    Array<double,1> y(2 * n);
+    y = 7.;
+    y(Range(0, 2*n-2, 2)) = x;
+    BZTEST(sum(y(Range(0, 2*n-2, 2)), compensatedAccumulation) == exact);
+    BZTEST(sum(x + 0 * tensor::i, compensatedAccumulation) == exact);
+
+    Array<double,2> A(3, n);
+    A = x(tensor::j) * (tensor::i + 1);
+    Array<double,1> rows(3);
+    rows = sum(A, tensor::j, compensatedAccumulation);
+    BZTEST(rows(0) == exact && rows(1) == 2 * exact && rows(2) == 3 * exact);
+    BZTEST(sum(A, compensatedAccumulation) == 6 * exact);
+    rows = mean(A, tensor::j, compensatedAccumulation);
+    BZTEST(rows(2) == 3 * exact / n);
+
+    // Without cancellation all the policies agree to rounding
+    Array<float,2> f(300, 1000);
+    f = 0.1f;
+    const double s = sum(f);
+    BZTEST(fabs(s - 30000) < 1e-2);
+    BZTEST(fabs(sum(f, naiveAccumulation) - s) < 1e-6);
+    BZTEST(fabs(sum(f, pairwiseAccumulation) - s) < 1e-6);
+    BZTEST(fabs(sum(f, compensatedAccumulation) - s) < 1e-6);
+    BZTEST(fabs(sum(f, wideAccumulation) - s) < 1e-6);
+    BZTEST(fabs(sum(f, nativeAccumulation) - s) < 1.);
+    BZTEST(fabs(mean(f, nativeAccumulation) - 0.1) < 1e-5);
+
+    Array<double,1> g(1000000);
+    g = 0.1;
+    BZTEST(fabs(sum(g, pairwiseAccumulation) - 1e5) < 1e-9);
+    BZTEST(fabs(sum(g, wideAccumulation) - 1e5) < 1e-9);
+
+    // Integers are summed exactly whatever the order
+    Array<int,2> k(17, 33);
+    k = tensor::i * 33 + tensor::j;
+    BZTEST(sum(k, pairwiseAccumulation) == 560 * 561 / 2);
+    BZTEST(sum(k, nativeAccumulation) == 560 * 561 / 2);
+    BZTEST(product(k(Range(0,0), Range(1,5)), naiveAccumulation) == 120);
+
+    // Products: the compensated product carries the rounding errors
+    Array<double,1> p(50);
+    p = 1. + 1. / (tensor::i + 3);
+    long double exactProduct = 1;
+    for (int i=0; i < 50; ++i)
+        exactProduct *= p(i);
+    BZTEST(fabs(product(p, compensatedAccumulation) - exactProduct)
+        <= fabs(product(p) - exactProduct));
+    BZTEST(fabs(product(p, compensatedAccumulation) - exactProduct) < 4e-15);
+    BZTEST(fabs(product(p, pairwiseAccumulation) - 53. / 3) < 1e-13);
+
+    // Complex numbers are compensated part by part
+    Array<complex<double>,1> z(n);
+    z = zip(x, 2 * x, complex<double>());
+    BZTEST(sum(z, compensatedAccumulation) == complex<double>(exact, 2 * exact));
+
+    return 0;
+}
@@ -43,6 +43,83 @@ int main()
     BZTEST(C.ubound(0) == 2);
     BZTEST(C.ubound(1) == 4);
 
+    // Appending one element at a time reallocates a logarithmic number
+    // of times, and shrinking never does
+    Array<int,1> D(1);
+    D(0) = 0;
+    int moves = 0;
+    for (int n=2; n <= 1000; ++n)
+    {
+        const int* before = D.data();
+        D.resizeAndPreserve(n);
+        D(n-1) = n-1;
+        if (D.data() != before)
+            ++moves;
+        BZTEST(D.capacity() >= n);
+    }
+    BZTEST(moves < 20);
+    BZTEST(all(D == tensor::i));
+    const int* grown = D.data();
+    D.resizeAndPreserve(10);
+    BZTEST(D.data() == grown);
+    BZTEST(all(D == tensor::i));
+    BZTEST(D.capacity() >= 1000);
+
+    // reserve() makes room in advance
+    Array<double,2> R(3, 4);
+    R = tensor::i * 10 + tensor::j;
+    R.reserve(50);
+    BZTEST(R.capacity() >= 50);
+    const double* reserved = R.data();
+    for (int n=4; n <= 50; ++n)
+        R.resizeAndPreserve(n, 4);
+    BZTEST(R.data() == reserved);
+    BZTEST(all(R(Range(0,2), Range::all()) == tensor::i * 10 + tensor::j));
+
+    // Starting from nothing
+    Array<float,2> E(0, 3);
+    E.reserve(100);
+    BZTEST(E.capacity() == 100);
+    E.resizeAndPreserve(1, 3);
+    const float* first = E.data();
+    for (int n=1; n <= 100; ++n)
+    {
+        E.resizeAndPreserve(n, 3);
+        E(n-1, Range::all()) = n;
+    }
+    BZTEST(E.data() == first);
+    BZTEST(all(E(Range::all(), 2) == tensor::i + 1));
+
+    // The slowest-varying rank of a Fortran array is the last one
+    Array<int,2> F(3, 2, FortranArray<2>());
+    F = tensor::i + 10 * tensor::j;
+    F.resizeAndPreserve(3, 7);
+    BZTEST(F.ubound(1) == 7);
+    BZTEST(all(F(Range::all(), Range(1,2)) == tensor::i + 10 * tensor::j));
+    F.resizeAndPreserve(3, 9);
+    BZTEST(all(F(Range::all(), Range(1,2)) == tensor::i + 10 * tensor::j));
+
+    // A shared block is copied, so the other array keeps its elements
+    Array<int,1> S(4), T;
+    S = 1, 2, 3, 4;
+    T.reference(S);
+    S.resizeAndPreserve(6);
+    S(Range(4,5)) = 0;
+    S(0) = 9;
+    BZTEST(T.extent(0) == 4);
+    BZTEST(T(0) == 1);
+    BZTEST((S(1) == 2) && (S(3) == 4));
+
+    // A large block grows without copying where the system allows
+    Array<double,1> L(1 << 17);
+    L = tensor::i;
+    for (int n=1 << 18; n <= 1 << 21; n *= 2)
+    {
+        L.resizeAndPreserve(n);
+        L(Range(n/2, n-1)) = tensor::i + n/2;
+    }
+    BZTEST(all(L == tensor::i));
+
     // Three dimensional resize
     Array<int,3> G(4,5,6);
     G.resize(7,8,9);
@@ -0,0 +1,92 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/tinyvec-et.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    Array<double,3> A(4, 5, 6);
+    A = 100 * tensor::i + 10 * tensor::j + tensor::k;
+
+    // Views of a whole array do not count as references
+    const int refs = A.numReferences();
+    ArrayView<double,3> v(A);
+    ArrayView<double,3> w = v;
+    BZTEST(A.numReferences() == refs);
+    BZTEST(all(v.shape() == A.shape()));
+    BZTEST(v.numElements() == A.numElements());
+    BZTEST(v(2,3,4) == 234);
+    BZTEST(&w(1,2,3) == &A(1,2,3));
+
+    // The view holds only a pointer, bases, extents and strides
+    BZTEST(sizeof(ArrayView<double,3>) ==
+        sizeof(double*) + 3 * (2 * sizeof(int) + sizeof(diffType)));
+    BZTEST(sizeof(ArrayView<double,3,int>) < sizeof(ArrayView<double,3>));
+
+    // Pencils and strided subviews, keeping the bases as Array does
+    ArrayView<double,1> pencil = v(1, 2, Range::all());
+    BZTEST(pencil.extent(0) == 6);
+    BZTEST(pencil(5) == 125);
+    BZTEST(all(pencil == A(1, 2, Range::all())));
+
+    ArrayView<double,2,int> plane = ArrayView<double,3,int>(A)(
+        Range(0,2,2), 4, Range(5,1,-2));
+    Array<double,2> P = A(Range(0,2,2), 4, Range(5,1,-2));
+    BZTEST(all(plane.shape() == P.shape()));
+    BZTEST(all(plane.lbound() == P.lbound()));
+    BZTEST(plane(0,0) == 45);
+    BZTEST(plane(1,2) == 241);
+    BZTEST(all(plane == P));
+    BZTEST(A.numReferences() == refs + 1);      // P, but not plane
+
+    ArrayView<double,3> box = v(RectDomain<3>(shape(1,1,1), shape(2,3,4)));
+    BZTEST(all(box.lbound() == 0));
+    BZTEST(all(box.extent() == shape(2,3,4)));
+    BZTEST(box(0,0,0) == 111);
+    BZTEST(sum(box) == sum(A(Range(1,2), Range(1,3), Range(1,4))));
+
+    // Views of Fortran arrays, with bases of 1
+    Array<float,2> F(3, 4, fortranArray);
+    F = 10 * tensor::i + tensor::j;
+    ArrayView<float,2> f(F);
+    BZTEST(f.lbound(0) == 1);
+    BZTEST(f(3,4) == 34);
+    BZTEST(all(f(Range::all(), 2) == F(Range::all(), 2)));
+    BZTEST(all(f.asArray().ordering() == F.ordering()));
+
+    // Expressions mixing views and arrays, and assignment through views
+    Array<double,1> B(6);
+    B = pencil * 2 + A(3, 4, Range::all());
+    BZTEST(B(0) == 2 * 120 + 340);
+    BZTEST(B(5) == 2 * 125 + 345);
+
+    pencil = 0;
+    BZTEST(all(A(1, 2, Range::all()) == 0));
+    pencil = B + 1;
+    BZTEST(A(1, 2, 5) == B(5) + 1);
+    pencil += 1;
+    pencil *= pencil;
+    BZTEST(A(1, 2, 0) == (B(0) + 2) * (B(0) + 2));
+
+    // Assigning a view rebinds it; assign() copies the elements
+    ArrayView<double,1> other = v(0, 0, Range::all());
+    other.assign(v(3, 3, Range::all()));
+    BZTEST(A(0, 0, 4) == 334);
+    other = pencil;
+    BZTEST(&other(0) == &A(1,2,0));
+
+    // Views of raw memory
+    double raw[12];
+    ArrayView<double,2> r(raw, shape(3,4));
+    r = 4 * tensor::i + tensor::j;
+    BZTEST(raw[7] == 7);
+    ArrayView<double,2> rt(raw, shape(4,3), shape(1,4));
+    BZTEST(rt(3,1) == r(1,3));
+    BZTEST(sum(rt) == 66);
+    BZTEST(max(rt(Range::all(), 2)) == 11);
+
+    BZTEST(A.numReferences() == refs + 1);
+
+    return 0;
+}
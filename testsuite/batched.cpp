@@ -0,0 +1,166 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+typedef TinyMatrix<double,3,3> M3;
+typedef TinyVector<double,3> V3;
+
+double value(int i, int j, int k)
+{
+    return sin(1.3 * i + 0.7 * j + 2.9 * k + 0.1 * i * j);
+}
+
+int main()
+{
+    // 37 x 11 is not a multiple of the batch width
+    const int nx = 37, ny = 11;
+    Array<M3,2> A(nx, ny), B(nx, ny), C(nx, ny), S(nx, ny);
+    Array<V3,2> x(nx, ny), y(nx, ny), b(nx, ny), lambda(nx, ny);
+    Array<double,2> d(nx, ny);
+
+    for (int i=0; i < nx; ++i)
+        for (int j=0; j < ny; ++j)
+        {
+            for (int k=0; k < 9; ++k)
+            {
+                A(i,j).data()[k] = value(i, j, k) + ((k % 4 == 0) ? 3 : 0);
+                B(i,j).data()[k] = value(j, i, k);
+            }
+            for (int k=0; k < 3; ++k)
+                x(i,j)(k) = value(i, j, 10 + k);
+
+            // S = A^T A, symmetric positive definite
+            for (int r=0; r < 3; ++r)
+                for (int c=0; c < 3; ++c)
+                {
+                    double s = 0;
+                    for (int k=0; k < 3; ++k)
+                        s += A(i,j)(k,r) * A(i,j)(k,c);
+                    S(i,j)(r,c) = s;
+                }
+        }
+
+    batchedProduct(C, A, B);
+    batchedProduct(y, A, x);
+    batchedDeterminant(d, A);
+
+    double error = 0;
+    for (int i=0; i < nx; ++i)
+        for (int j=0; j < ny; ++j)
+        {
+            const M3& a = A(i,j);
+            for (int r=0; r < 3; ++r)
+            {
+                double yr = 0;
+                for (int k=0; k < 3; ++k)
+                    yr += a(r,k) * x(i,j)(k);
+                error = max(error, fabs(y(i,j)(r) - yr));
+                for (int c=0; c < 3; ++c)
+                {
+                    double crc = 0;
+                    for (int k=0; k < 3; ++k)
+                        crc += a(r,k) * B(i,j)(k,c);
+                    error = max(error, fabs(C(i,j)(r,c) - crc));
+                }
+            }
+            const double det = a(0,0) * (a(1,1) * a(2,2) - a(1,2) * a(2,1))
+                - a(0,1) * (a(1,0) * a(2,2) - a(1,2) * a(2,0))
+                + a(0,2) * (a(1,0) * a(2,1) - a(1,1) * a(2,0));
+            error = max(error, fabs(d(i,j) - det));
+        }
+    BZTEST(error < 1e-12);
+
+    // Inverse, in place, and solves: A (A^-1 b) = b
+    Array<M3,2> Ainv(A.copy());
+    batchedInverse(Ainv, Ainv);
+    b = x;
+    batchedSolve(y, A, b);
+    error = 0;
+    for (int i=0; i < nx; ++i)
+        for (int j=0; j < ny; ++j)
+            for (int r=0; r < 3; ++r)
+            {
+                double ar = 0;
+                for (int k=0; k < 3; ++k)
+                    ar += A(i,j)(r,k) * y(i,j)(k);
+                error = max(error, fabs(ar - b(i,j)(r)));
+                for (int c=0; c < 3; ++c)
+                {
+                    double e = 0;
+                    for (int k=0; k < 3; ++k)
+                        e += A(i,j)(r,k) * Ainv(i,j)(k,c);
+                    error = max(error, fabs(e - (r == c)));
+                }
+            }
+    BZTEST(error < 1e-10);
+
+    batchedCholeskySolve(y, S, b);
+    error = 0;
+    for (int i=0; i < nx; ++i)
+        for (int j=0; j < ny; ++j)
+            for (int r=0; r < 3; ++r)
+            {
+                double sr = 0;
+                for (int k=0; k < 3; ++k)
+                    sr += S(i,j)(r,k) * y(i,j)(k);
+                error = max(error, fabs(sr - b(i,j)(r)));
+            }
+    BZTEST(error < 1e-9);
+
+    // Eigenvalues: the trace and determinant are their sum and product
+    batchedSymmetricEigenvalues(lambda, S);
+    batchedDeterminant(d, S);
+    error = 0;
+    for (int i=0; i < nx; ++i)
+        for (int j=0; j < ny; ++j)
+        {
+            const V3& l = lambda(i,j);
+            const M3& s = S(i,j);
+            BZTEST(l(0) <= l(1) && l(1) <= l(2) && l(0) > 0);
+            error = max(error, fabs(l(0) + l(1) + l(2)
+                - s(0,0) - s(1,1) - s(2,2)));
+            error = max(error, fabs(l(0) * l(1) * l(2) - d(i,j))
+                / fabs(d(i,j)));
+        }
+    BZTEST(error < 1e-10);
+
+    // Larger matrices go through elimination with pivoting, and strided
+    // views element by element
+    Array<TinyMatrix<double,5,5>,1> P(40), Pinv(40);
+    Array<double,1> pd(40);
+    for (int i=0; i < 40; ++i)
+    {
+        // A permutation matrix, scaled, needs pivoting
+        P(i) = 0.;
+        for (int r=0; r < 5; ++r)
+            P(i)(r, (r + i) % 5) = r + 1;
+    }
+    batchedInverse(Pinv, P);
+    batchedDeterminant(pd, P);
+    error = 0;
+    for (int i=0; i < 40; ++i)
+        for (int r=0; r < 5; ++r)
+            for (int c=0; c < 5; ++c)
+            {
+                double e = 0;
+                for (int k=0; k < 5; ++k)
+                    e += P(i)(r,k) * Pinv(i)(k,c);
+                error = max(error, fabs(e - (r == c)));
+            }
+    BZTEST(error < 1e-14);
+    BZTEST(fabs(pd(0) - 120) < 1e-12 && fabs(pd(1) - 120) < 1e-12);
+
+    Array<double,2> ds(nx, 2 * ny);
+    ds = -1;
+    batchedDeterminant(ds(Range::all(), Range(0, 2*ny-2, 2)), A);
+    batchedDeterminant(d, A);
+    BZTEST(all(ds(Range::all(), Range(0, 2*ny-2, 2)) == d));
+    BZTEST(all(ds(Range::all(), Range(1, 2*ny-1, 2)) == -1));
+
+    // Components of a TinyMatrix array
+    Array<double,2> a01(A[1]);
+    BZTEST(a01(3, 4) == A(3, 4)(0, 1));
+
+    return 0;
+}
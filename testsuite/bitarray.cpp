@@ -0,0 +1,102 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/array/bitarray.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // Sizes which leave a partial last word
+    Array<double,3> phi(7,11,13), h(7,11,13);
+    phi = (tensor::i - 3) * (tensor::j - 5) + tensor::k - 6;
+    h = (tensor::i + tensor::j + tensor::k) % 3;
+
+    BitArray<3> solid(phi < 0.);
+    BZTEST(solid.numElements() == 7 * 11 * 13);
+    BZTEST(solid.numWords() == _bz_bits::numWords(7 * 11 * 13));
+    BZTEST(int(count(solid)) == count(phi < 0.));
+    BZTEST(solid(0,0,0) == (phi(0,0,0) < 0.));
+    BZTEST(solid(6,10,12) == (phi(6,10,12) < 0.));
+
+    // Word-at-a-time logic agrees with the elementwise result
+    BitArray<3> wet = !solid && (h > 0.);
+    BZTEST(int(count(wet)) == count(!(phi < 0.) && (h > 0.)));
+    BitArray<3> flag(h > 1.);
+    BZTEST(int(count(!solid || flag)) == count(phi >= 0. || h > 1.));
+    BZTEST(int(count(!solid)) == 7 * 11 * 13 - int(count(solid)));
+    BZTEST(int(count(solid && !solid)) == 0);
+
+    // The condition of where(), and other array expressions
+    Array<double,3> u(7,11,13);
+    u = where(wet, phi, -1.);
+    BZTEST(all(u == where(phi >= 0. && h > 0., phi, -1.)));
+    Array<bool,3> b(7,11,13);
+    b = solid;
+    BZTEST(all(b == (phi < 0.)));
+    BZTEST(sum(where(!wet && !flag, 1, 0)) == count(!(phi >= 0. && h > 0.)
+        && !(h > 1.)));
+
+    // any() and all(), with the padding bits ignored
+    BitArray<2> M(3,5);
+    M = true;
+    BZTEST(all(M) && any(M) && count(M) == 15);
+    BZTEST(!any(!M) && count(!M) == 0);
+    M(1,2) = false;
+    BZTEST(!all(M) && count(M) == 14 && !M(1,2) && M(1,3));
+    M = false;
+    BZTEST(!any(M) && all(!M));
+    M(2,4) = true;
+    BZTEST(any(M) && count(M) == 1);
+
+    // Updates in place
+    BitArray<3> s(solid.copy());
+    s |= flag;
+    BZTEST(int(count(s)) == count(phi < 0. || h > 1.));
+    s &= !flag;
+    BZTEST(int(count(s)) == count(phi < 0. && !(h > 1.)));
+
+    // Copies share bits, assignment copies them
+    BitArray<3> t(s), v(7,11,13);
+    t(0,0,0) = !t(0,0,0);
+    BZTEST(s(0,0,0) == t(0,0,0));
+    v = s;
+    v(0,0,0) = !v(0,0,0);
+    BZTEST(s(0,0,0) != v(0,0,0));
+
+    // Packing an Array<bool> with a lower bound other than 0
+    Array<bool,1> f(Range(1,100));
+    f = (tensor::i % 7 == 0);
+    BitArray<1> g(f);
+    BZTEST(g.lbound(0) == 1 && g(7) && !g(8) && count(g) == 14);
+
+    // Assigning sources with another base reads them over their own
+    // domain, as Array assignment does
+    BitArray<1> m(100);
+    m = f;
+    BZTEST(m(6) && !m(7) && count(m) == 14);
+    Array<double,1> x(Range(1,100));
+    x = 0;
+    x(1) = 1;
+    m = (x > 0.);
+    BZTEST(m(0) && count(m) == 1);
+
+    // Index placeholders, directly and through an index mapping, with
+    // rows longer than a word
+    BitArray<2> M2(3,70);
+    M2 = (tensor::j > 65);
+    BZTEST(count(M2) == 12 && M2(2,66) && !M2(2,65));
+    Array<double,2> T(70,3);
+    T = tensor::i - 60;
+    BitArray<2> N2(3,70);
+    N2 = (T(tensor::j,tensor::i) > 0.);
+    BZTEST(count(N2) == 27 && N2(0,61) && !N2(1,60));
+
+    // and through a reduction
+    Array<double,3> T3(3,70,2);
+    T3 = tensor::j - 60;
+    BitArray<2> R2(3,70);
+    R2 = (sum(T3(tensor::i,tensor::j,tensor::k), tensor::k) > 0.);
+    BZTEST(count(R2) == 27 && R2(2,61) && !R2(2,60));
+
+    return 0;
+}
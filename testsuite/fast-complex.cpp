@@ -0,0 +1,50 @@
+#define BZ_FAST_COMPLEX
+
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <limits>
+
+BZ_USING_NAMESPACE(blitz)
+
+typedef complex<double> T_complex;
+
+bool close(T_complex a, T_complex b)
+{
+    return abs(a - b) < 1e-12 * (1 + abs(b));
+}
+
+int main()
+{
+    Array<T_complex,1> A(16), B(16), C(16);
+    for (int i=0; i < 16; ++i)
+    {
+        A(i) = T_complex(i - 3, 0.5 * i);
+        B(i) = T_complex(1 + 0.25 * i, 2 - i);
+    }
+
+    C = A * B;
+    for (int i=0; i < 16; ++i)
+        BZTEST(close(C(i), T_complex(i - 3, 0.5 * i)
+            * T_complex(1 + 0.25 * i, 2 - i)));
+
+    C = A / B;
+    for (int i=0; i < 16; ++i)
+        BZTEST(close(C(i), T_complex(i - 3, 0.5 * i)
+            / T_complex(1 + 0.25 * i, 2 - i)));
+
+    C = A;
+    C *= B;
+    C /= B;
+    for (int i=0; i < 16; ++i)
+        BZTEST(close(C(i), A(i)));
+
+    // Limited range: (inf + inf i) * 1 is NaN rather than the infinity
+    // which C99 Annex G recovers
+    const double inf = std::numeric_limits<double>::infinity();
+    A(0) = T_complex(inf, inf);
+    B(0) = T_complex(1, 0);
+    C = A * B;
+    BZTEST(C(0).real() != C(0).real());
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/tinyvec-et.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    typedef FixedArray<double,4,5,6> F3;
+    BZTEST(F3::rank == 3);
+    BZTEST(F3::N_size == 120);
+    BZTEST(sizeof(F3) == 120 * sizeof(double));
+    BZTEST(all(F3::shape() == shape(4,5,6)));
+    BZTEST(F3::stride(0) == 30 && F3::stride(1) == 6 && F3::stride(2) == 1);
+
+    Array<double,3> A(4, 5, 6);
+    A = 100 * tensor::i + 10 * tensor::j + tensor::k;
+
+    // Index placeholders, and Array operands stored like the FixedArray
+    F3 f, g;
+    f = 100 * tensor::i + 10 * tensor::j + tensor::k;
+    BZTEST(f(2,3,4) == 234);
+    g = A * 2 + f;
+    BZTEST(g(3,4,5) == 3 * 345);
+    BZTEST(all(g == 3 * A));
+
+    // A tile of a larger array, which is strided
+    Array<double,3> B(8, 10, 12);
+    B = 1000 * tensor::i + 100 * tensor::j + tensor::k;
+    FixedArray<double,4,5,6> tile;
+    tile = B(Range(4,7), Range(5,9), Range(6,11));
+    BZTEST(tile(0,0,0) == 4506);
+    BZTEST(tile(3,4,5) == 7911);
+
+    // Reversed and transposed operands
+    FixedArray<int,3,2> t;
+    Array<int,2> C(2, 3);
+    C = 10 * tensor::i + tensor::j;
+    t = C.transpose(secondDim, firstDim);
+    BZTEST(t(2,1) == 12);
+    FixedArray<int,3> rev;
+    Array<int,1> D(3);
+    D = 1, 2, 3;
+    rev = D.reverse(firstDim);
+    BZTEST(rev(0) == 3 && rev(2) == 1);
+
+    // Updates and scalars
+    FixedArray<float,4> state(1.0f), flux;
+    state(2) = 3;
+    flux = state * state + 1;
+    BZTEST(flux(0) == 2 && flux(2) == 10);
+    flux += state;
+    flux *= 2;
+    BZTEST(flux(2) == 26);
+    flux -= 1;
+    flux /= 5;
+    BZTEST(flux(2) == 5);
+
+    // Complete reductions
+    BZTEST(sum(f) == sum(A));
+    BZTEST(max(f) == 345);
+    BZTEST(min(f) == 0);
+    BZTEST(count(f >= 300) == 30);
+    BZTEST(sum(f * f) == sum(A * A));
+    BZTEST(mean(state) == 1.5);
+
+    // FixedArrays in Array expressions, and conversions
+    Array<double,3> E(4, 5, 6);
+    E = f - A + 1;
+    BZTEST(all(E == 1));
+    E += f;
+    BZTEST(E(1,2,3) == 124);
+    BZTEST(all(f.asArray() == A));
+    FixedArray<double,4,5,6> copy(f);
+    f = 0;
+    BZTEST(copy(2,3,4) == 234);
+    BZTEST(all(copy == A));
+
+    // Views
+    ArrayView<double,3> v(copy.asArray());
+    g = v(Range::all(), Range::all(), Range::all()) * 2;
+    BZTEST(g(1,1,1) == 222);
+
+    return 0;
+}
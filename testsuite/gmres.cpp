@@ -0,0 +1,122 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/sparse.h>
+#include <blitz/array/gmres.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+// Convection-diffusion on an n x n x n grid: nonsymmetric, diagonally
+// dominant, with a varying diagonal so Jacobi preconditioning helps.
+void convectionDiffusion(SparseMatrix<double>& A, int n)
+{
+    std::vector<SparseTriplet<double> > t;
+    for (int i=0; i < n; ++i)
+    for (int j=0; j < n; ++j)
+    for (int k=0; k < n; ++k)
+    {
+        int row = (i*n + j)*n + k;
+        t.push_back(SparseTriplet<double>(row, row, 6.0 + 0.1*(row % 13)));
+        if (i > 0)   t.push_back(SparseTriplet<double>(row, row - n*n, -1.3));
+        if (i < n-1) t.push_back(SparseTriplet<double>(row, row + n*n, -0.7));
+        if (j > 0)   t.push_back(SparseTriplet<double>(row, row - n, -1.2));
+        if (j < n-1) t.push_back(SparseTriplet<double>(row, row + n, -0.8));
+        if (k > 0)   t.push_back(SparseTriplet<double>(row, row - 1, -1.1));
+        if (k < n-1) t.push_back(SparseTriplet<double>(row, row + 1, -0.9));
+    }
+    A.resize(n*n*n, n*n*n);
+    A.setFromTriplets(t.begin(), t.end());
+}
+
+struct Jacobi {
+    Jacobi(const SparseMatrix<double>& A, int n) : d(n, n, n)
+    {
+        for (int i=0; i < A.rows(); ++i)
+            d.data()[i] = 1.0 / A(i,i);
+    }
+    void operator()(const Array<double,3>& r, Array<double,3>& z) const
+    { z = d * r; }
+    Array<double,3> d;
+};
+
+// Dense complex operator
+struct DenseOperator {
+    DenseOperator(const Array<complex<double>,2>& A) : A_(A) { }
+    void operator()(const Array<complex<double>,1>& x,
+        Array<complex<double>,1>& y) const
+    {
+        for (int i=0; i < A_.extent(0); ++i)
+        {
+            complex<double> s = 0;
+            for (int j=0; j < A_.extent(1); ++j)
+                s += A_(i,j) * x(x.lbound(0) + j);
+            y(y.lbound(0) + i) = s;
+        }
+    }
+    const Array<complex<double>,2>& A_;
+};
+
+int main()
+{
+    const int n = 8;
+    SparseMatrix<double> A;
+    convectionDiffusion(A, n);
+    SparseOperator<double> op(A);
+    Jacobi M(A, n);
+
+    Array<double,3> x(n,n,n), b(n,n,n), r(n,n,n);
+    b = 1.0;
+
+    GMRESWorkspace<double,3> ws(x, 10);
+    const double* basis = ws.basisData(0);
+
+    // Unpreconditioned, right- and left-preconditioned, both
+    // orthogonalization schemes; the workspace is reused throughout.
+    for (int pass=0; pass < 5; ++pass)
+    {
+        x = 0.0;
+        int iters;
+        if (pass == 0)
+            iters = gmres(op, x, b, ws, 1e-10, 500);
+        else
+            iters = gmres(op, x, b, ws, 1e-10, 500, M,
+                (pass % 2) ? gmresRightPreconditioning
+                           : gmresLeftPreconditioning,
+                (pass < 3) ? gmresModifiedGramSchmidt
+                           : gmresClassicalGramSchmidt2);
+        BZTEST(iters > 0);
+        BZTEST(iters == ws.iterations());
+        op(x, r);
+        BZTEST(max(abs(r - b)) < 1e-8);
+    }
+    BZTEST(ws.basisData(0) == basis);
+
+    // Restarting: a short restart still converges
+    GMRESWorkspace<double,3> ws2(x, 3);
+    x = 0.0;
+    BZTEST(gmres(op, x, b, ws2, 1e-10, 1000) > 3);
+    op(x, r);
+    BZTEST(max(abs(r - b)) < 1e-8);
+
+    // Too few iterations is reported as failure
+    x = 0.0;
+    BZTEST(gmres(op, x, b, ws2, 1e-14, 2) == -1);
+    BZTEST(ws2.iterations() == 2);
+
+    // Complex system with a nonzero base
+    const int m = 12;
+    Array<complex<double>,2> C(m, m);
+    for (int i=0; i < m; ++i)
+        for (int j=0; j < m; ++j)
+            C(i,j) = complex<double>(i == j ? 4.0 : 1.0/(1+i+2*j), 0.3*(i-j));
+    Array<complex<double>,1> z(Range(1,m)), c(Range(1,m)), s(Range(1,m));
+    for (int i=1; i <= m; ++i)
+        c(i) = complex<double>(i - 1, 1.0);
+    z = 0;
+    DenseOperator cop(C);
+    GMRESWorkspace<complex<double>,1> cws;
+    BZTEST(gmres(cop, z, c, cws, 1e-12, 100) > 0);
+    cop(z, s);
+    BZTEST(max(abs(s - c)) < 1e-9);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/half.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // Values that are exact in 11 bits survive the round trip
+    BZTEST(float(half(1.f)) == 1.f && half(1.f).bits() == 0x3c00);
+    BZTEST(float(half(-2.5f)) == -2.5f);
+    BZTEST(float(half(65504.f)) == 65504.f);
+    BZTEST(float(half(0.f)) == 0.f);
+
+    // Rounding to nearest, ties to even
+    BZTEST(float(half(1.f + 1.f / 4096)) == 1.f);
+    BZTEST(float(half(1.f + 3.f / 2048)) == 1.f + 2.f / 1024);
+    BZTEST(float(half(2049.f)) == 2048.f && float(half(2051.f)) == 2052.f);
+
+    // Subnormals, overflow, NaN
+    const float tiny = 1.f / (1 << 24);
+    BZTEST(half(tiny).bits() == 0x0001 && float(half(tiny)) == tiny);
+    BZTEST(float(half(3 * tiny)) == 3 * tiny);
+    BZTEST(half(1e6f).bits() == 0x7c00 && half(-1e6f).bits() == 0xfc00);
+    const float nan = numeric_limits<float>::quiet_NaN();
+    BZTEST(float(half(nan)) != float(half(nan)));
+    BZTEST(float(huge(half())) == 65504.f);
+
+    // bfloat16 keeps the range of float with 8 bits of precision
+    BZTEST(float(bfloat16(3.f)) == 3.f && bfloat16(1.f).bits() == 0x3f80);
+    BZTEST(float(bfloat16(1e30f)) > 0.99e30f && float(bfloat16(1e30f)) < 1.01e30f);
+    BZTEST(float(bfloat16(257.f)) == 256.f && float(bfloat16(259.f)) == 260.f);
+    BZTEST(float(bfloat16(nan)) != float(bfloat16(nan)));
+
+    // Storage in arrays; expressions compute in float or double
+    BZTEST(sizeof(half) == 2 && sizeof(bfloat16) == 2);
+    Array<double,2> u(40,50), v(40,50);
+    u = (tensor::i - 20) * 0.25 + tensor::j * 0.5;
+    Array<half,2> h(40,50);
+    h = u;
+    BZTEST(all(h == u));
+    BZTEST(sum(h) == sum(u));
+    BZTEST(min(h) == -5. && max(h) == 29.25 && maxIndex(h)(0) == 39);
+
+    // half + half is float: 2048 + 1 is not rounded back to half
+    Array<half,1> a(4), b(4);
+    a = 2048.f;
+    b = 1.f;
+    Array<float,1> c(4);
+    c = a + b;
+    BZTEST(all(c == 2049.f));
+    v = u + 0.5 * h;
+    BZTEST(all(v == 1.5 * u));
+
+    Array<bfloat16,2> w(40,50);
+    w = h;
+    BZTEST(all(w == u));
+    BZTEST(count(where(h > 0, w, 0) > 0.) == count(u > 0.));
+
+    // Strided and transposed views go through the general traversal
+    Array<half,2> t(h.transpose(1,0));
+    BZTEST(t(3,7) == u(7,3));
+    BZTEST(sum(t(Range::all(), Range(0,39,3))) == sum(u(Range(0,39,3), Range::all())));
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    using namespace blitz::tensor;
+
+    // Placeholders, and a transposed operand
+    Array<double,2> A(4, 5), B(5, 4);
+    B = 10 * i + j;
+    A = 100 * i + B(j, i);
+    for (int r=0; r < 4; ++r)
+        for (int c=0; c < 5; ++c)
+            BZTEST(A(r,c) == 100 * r + 10 * c + r);
+
+    // A diagonal, and an operand which is constant along a rank
+    Array<int,2> M(4, 4), D(4, 4);
+    Array<int,1> v(4);
+    M = 10 * i + j;
+    v = 7, 8, 9, 10;
+    D = M(i, i) + v(j);
+    for (int r=0; r < 4; ++r)
+        for (int c=0; c < 4; ++c)
+            BZTEST(D(r,c) == 11 * r + v(c));
+
+    // Loops which collapse, and loops which do not
+    Array<int,3> E(3, 4, 5), F(5, 4, 3);
+    F = 100 * i + 10 * j + k;
+    E = F(k, j, i) + i;
+    for (int r=0; r < 3; ++r)
+        for (int s=0; s < 4; ++s)
+            for (int t=0; t < 5; ++t)
+                BZTEST(E(r,s,t) == 100 * t + 10 * s + r + r);
+    E = 1000 * k;
+    BZTEST(E(2,3,4) == 4000);
+
+    // Nonzero bases, descending storage and strided destinations
+    Array<int,2> G(Range(1,3), Range(-2,2), ColumnMajorArray<2>());
+    G = 10 * i + j;
+    BZTEST(G(1,-2) == 8);
+    BZTEST(G(3,2) == 32);
+    Array<int,1> H(Range(5,9), GeneralArrayStorage<1>(shape(0), false));
+    H = i * i;
+    BZTEST(H(5) == 25 && H(9) == 81);
+    Array<int,2> big(8, 10);
+    big = -1;
+    big(Range(0,6,2), Range(1,9,2)) = 10 * i + j;
+    BZTEST(big(0,1) == 0);
+    BZTEST(big(6,9) == 34);
+    BZTEST(big(1,1) == -1);
+
+    // Updates
+    A += i;
+    BZTEST(A(3,4) == 300 + 40 + 3 + 3);
+
+    // Partial reductions
+    Array<int,2> P(3, 4);
+    Array<int,1> rowsum(3);
+    P = 10 * i + j;
+    rowsum = sum(P, j) + i;
+    BZTEST(rowsum(0) == 6 && rowsum(2) == 86 + 2);
+    Array<int,2> Q(3, 3);
+    Q = sum(P(i, k) * P(j, k), k);
+    BZTEST(Q(1,2) == sum(P(1, Range::all()) * P(2, Range::all())));
+
+    // Functions of placeholders
+    Array<double,1> x(100), y(100);
+    const double dx = 0.01;
+    x = sin(i * dx) * exp(-i * dx);
+    y = where(i % 2 == 0, i * dx, -1.0);
+    BZTEST(std::fabs(x(37) - std::sin(0.37) * std::exp(-0.37)) < 1e-15);
+    BZTEST(y(10) == 10 * dx && y(11) == -1);
+
+    // FixedArrays
+    FixedArray<int,3,4> f;
+    f = 10 * i + P(i, j);
+    BZTEST(f(2,3) == 20 + 23);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <list>
+#include <vector>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    Array<double,2> A(20,30), B(20,30), C(20,30);
+    firstIndex i;
+    secondIndex j;
+    B = 100 * i + j;
+    C = 1.0;
+
+    // Points: one row segment long enough to be a run, some scattered
+    // points, and a duplicate
+    std::list<TinyVector<int,2> > points;
+    for (int k=5; k < 15; ++k)
+        points.push_back(TinyVector<int,2>(3, k));
+    points.push_back(TinyVector<int,2>(10, 2));
+    points.push_back(TinyVector<int,2>(0, 29));
+    points.push_back(TinyVector<int,2>(19, 0));
+    points.push_back(TinyVector<int,2>(10, 2));
+
+    IndexPlan<2> plan(A, points);
+    BZTEST(plan.size() == 13);
+    BZTEST(plan.numCoalesced() == 10);
+    BZTEST(plan.conforms(B));
+
+    // Memory order
+    BZTEST(plan.position(0)(0) == 0 && plan.position(0)(1) == 29);
+    BZTEST(plan.position(1)(0) == 3 && plan.position(1)(1) == 5);
+    BZTEST(plan.position(12)(0) == 19 && plan.position(12)(1) == 0);
+
+    // Scatter of an expression
+    A = -1;
+    A[plan] = B + C;
+    BZTEST(A(3,5) == 306 && A(3,14) == 315);
+    BZTEST(A(10,2) == 1003 && A(0,29) == 30 && A(19,0) == 1901);
+    BZTEST(A(3,4) == -1 && A(3,15) == -1);
+    BZTEST(count(A != -1) == 13);
+
+    A[plan] = 7;
+    BZTEST(count(A == 7) == 13);
+
+    // Index placeholders, directly and through an index mapping
+    A = -1;
+    A[plan] = j;
+    BZTEST(A(3,5) == 5 && A(3,14) == 14 && A(10,2) == 2 && A(0,29) == 29);
+    Array<double,2> BT(30,20);
+    BT = 100 * i + j;
+    A[plan] = BT(j,i);
+    BZTEST(A(3,5) == 503 && A(3,14) == 1403 && A(19,0) == 19);
+    BZTEST(count(A != -1) == 13);
+
+    // A reduction advances its index with the run like a placeholder
+    Array<double,3> R3(20,30,4);
+    R3 = j + tensor::k;
+    A[plan] = sum(R3(i,j,tensor::k), tensor::k);
+    BZTEST(A(3,5) == 26 && A(3,14) == 62 && A(0,29) == 122);
+
+    // Gather and scatter through packed vectors
+    Array<double,1> v = gather(B, plan);
+    BZTEST(v.numElements() == 13);
+    BZTEST(v(0) == 29 && v(1) == 305 && v(12) == 1900);
+
+    v *= 2;
+    A = 0;
+    scatter(v, A, plan);
+    BZTEST(A(3,7) == 614 && A(10,2) == 2004);
+    BZTEST(sum(A) == 2 * sum(gather(B, plan)));
+
+    // Strips and boxes as RectDomains, on a column-major array
+    Array<int,2> F(10, 10, fortranArray), G(10, 10, fortranArray);
+    G = 10 * i + j;
+    std::vector<RectDomain<2> > strips;
+    strips.push_back(RectDomain<2>(TinyVector<int,2>(2, 4),
+                                   TinyVector<int,2>(9, 4)));
+    strips.push_back(RectDomain<2>(TinyVector<int,2>(1, 1),
+                                   TinyVector<int,2>(2, 2)));
+    IndexPlan<2> strip(F, strips);
+    BZTEST(strip.size() == 12);
+    F = 0;
+    F[strip] = G;
+    BZTEST(F(2,4) == G(2,4) && F(9,4) == G(9,4) && F(2,2) == G(2,2));
+    BZTEST(count(F != 0) == 12);
+
+    // The container interface, with strips in both orientations
+    strips[1] = RectDomain<2>(TinyVector<int,2>(1, 1), TinyVector<int,2>(1, 3));
+    strips.push_back(RectDomain<2>(TinyVector<int,2>(5, 7),
+                                   TinyVector<int,2>(8, 7)));
+    F = 0;
+    F[strips] = G;
+    BZTEST(count(F != 0) == 15);
+    BZTEST(F(1,3) == G(1,3) && F(8,7) == G(8,7));
+
+    // A plan built from a mask restricts assignment and reductions
+    Array<double,2> phi(20,30), rhs(20,30);
+    phi = 0.1 * (i - 10) * (j - 15);
+    rhs = 1.;
+    IndexPlan<2> active(phi, abs(phi) < 1.);
+    BZTEST(active.size() == unsigned(count(abs(phi) < 1.)));
+    BZTEST(sum(phi, active) == sum(where(abs(phi) < 1., phi, 0.)));
+    BZTEST(count(phi > 0., active) == count(phi > 0. && abs(phi) < 1.));
+    BZTEST((max)(abs(phi), active) < 1.);
+
+    Array<double,2> before(phi.copy());
+    phi[active] += 2. * rhs;
+    BZTEST(all(where(abs(before) < 1., before + 2., before) == phi));
+
+    Array<bool,2> mask(20,30);
+    mask = (i == 3);
+    IndexPlan<2> row(phi, mask);
+    BZTEST(row.size() == 30 && row.numSegments() == 1 && row.isContiguous(0));
+    BZTEST(sum(rhs, row) == 30. && mean(rhs + 1., row) == 2.);
+
+    // Plans are rejected for arrays with other strides
+    Array<double,2> T(30,20);
+    BZTEST(!plan.conforms(T));
+    BZTEST(!plan.conforms(Array<double,2>(5,5)));
+
+    return 0;
+}
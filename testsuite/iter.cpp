@@ -4,11 +4,70 @@
 #ifdef BZ_HAVE_STL
 #include <iterator>
 #include <algorithm>
+#include <numeric>
 BZ_USING_NAMESPACE(std)
 #endif
 
 BZ_USING_NAMESPACE(blitz)
 
+// Element n in storage order, the first rank in the ordering varying
+// fastest
+template<typename T, int N>
+const T& nthElement(const Array<T,N>& A, diffType n)
+{
+    TinyVector<int,N> pos;
+    for (int k=0; k < N; ++k)
+    {
+        const int r = A.ordering(k);
+        pos(r) = A.lbound(r) + int(n % A.extent(r));
+        n /= A.extent(r);
+    }
+    return A(pos);
+}
+
+// The random-access iterators visit the elements in storage order,
+// forwards, backwards and by jumps
+template<typename T, int N>
+void checkSegmented(const Array<T,N>& A)
+{
+    typename Array<T,N>::const_segmented_iterator
+        seg = A.beginSegmented(), end = A.endSegmented();
+    const diffType n = A.numElements();
+    BZTEST(end - seg == n);
+
+    for (diffType k=0; seg != end; ++seg, ++k)
+    {
+        BZTEST(&*seg == &nthElement(A, k));
+        BZTEST(&A.beginSegmented()[k] == &nthElement(A, k));
+    }
+
+    for (diffType k=n; seg != A.beginSegmented(); )
+        BZTEST(&*--seg == &nthElement(A, --k));
+
+    for (diffType k=0; k < n; k += 3)
+    {
+        seg += 3;
+        seg -= 3;
+        BZTEST(&*(seg + k) == &*(A.endSegmented() - (n - k)));
+        BZTEST(&*(seg + k) == &nthElement(A, k));
+        BZTEST((seg + k) < end && (seg + k) >= seg);
+    }
+}
+
+struct SegmentCounter {
+    SegmentCounter(int& numSegments, diffType& total)
+      : numSegments_(numSegments), total_(total) { }
+
+    void operator()(const int*, diffType length, diffType)
+    {
+        ++numSegments_;
+        total_ += length;
+    }
+
+    int& numSegments_;
+    diffType& total_;
+};
+
 void check(const Array<int,2>& A, const Array<int,1>& b)
 {
     int i = 0;
@@ -106,5 +165,71 @@ int main()
   }
 #endif // BZ_HAVE_STL
 
+  {
+    // Segmented iterators: contiguous, Fortran-ordered, strided and
+    // reversed arrays
+    Array<int,2> A(5,7);
+    A = (tensor::i * 17 + tensor::j * 5) % 11;
+    checkSegmented(A);
+
+    Array<int,2> F(6,8,FortranArray<2>());
+    F = tensor::i * 8 + tensor::j;
+    checkSegmented(F);
+    Array<int,2> V = F(Range(2,4), Range(1,7,2));
+    checkSegmented(V);
+    Array<int,2> R = A.copy();
+    R.reverseSelf(firstDim);
+    checkSegmented(R);
+
+    int numSegments = 0;
+    diffType total = 0;
+    for_each_segment(A, SegmentCounter(numSegments, total));
+    BZTEST(numSegments == 1 && total == 35);
+    numSegments = 0;
+    total = 0;
+    for_each_segment(V, SegmentCounter(numSegments, total));
+    BZTEST(numSegments == 4 && total == 12);
+
+    // A segment of a strided view steps over the elements left out
+    numSegments = 0;
+    for_each_segment(A(Range::all(), Range(0,6,3)),
+        SegmentCounter(numSegments, total));
+    BZTEST(numSegments == 5);
+
+    Array<int,2> E(0,4);
+    BZTEST(E.beginSegmented() == E.endSegmented());
+  }
+
+#ifdef BZ_HAVE_STL
+  {
+    // Random-access algorithms on a view, leaving the rest alone
+    Array<int,2> F(6,8,FortranArray<2>());
+    F = (tensor::i * 37 + tensor::j * 11) % 23;
+    Array<int,2> G = F.copy();
+    Array<int,2> V = F(Range(2,4), Range(1,7,2));
+
+    const int s = accumulate(V.beginSegmented(), V.endSegmented(), 0);
+    BZTEST(s == sum(V));
+
+    sort(V.beginSegmented(), V.endSegmented());
+    BZTEST(is_sorted(V.beginSegmented(), V.endSegmented()));
+    BZTEST(sum(V) == s);
+    BZTEST(all(F(Range(1,6), 2) == G(Range(1,6), 2)));
+    BZTEST(all(F(1, Range::all()) == G(1, Range::all())));
+
+    Array<int,2>::segmented_iterator mid = V.beginSegmented() + 5;
+    nth_element(V.beginSegmented(), mid, V.endSegmented());
+    BZTEST(*max_element(V.beginSegmented(), mid) <= *mid);
+
+    Array<int,2> B(4,5);
+    transform(V.beginSegmented(), V.endSegmented(), B.beginSegmented() + 2,
+        negate<int>());
+    BZTEST(B(0,2) == -V(1,1) && B(2,3) == -V(3,4));
+    checkInterface(B.beginSegmented());
+    const Array<int,2>& CB(B);
+    checkInterface(CB.beginSegmented());
+  }
+#endif // BZ_HAVE_STL
+
 }
 
@@ -0,0 +1,101 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // Full reductions, agreeing with the single ones
+    Array<double,2> A(300, 457);
+    A = sin(0.01 * tensor::i * tensor::j) + 0.001 * tensor::j;
+
+    ReduceSum<double> s;
+    ReduceMinMax<double> range;
+    ReduceVariance<double> moments;
+    ReduceHistogram<double> hist(-0.5, 0.5, 10);
+    const sizeType n = multiReduce(A, s, range, moments, hist);
+
+    BZTEST(n == A.numElements());
+    BZTEST(fabs(s.result(n) - sum(A)) < 1e-9 * fabs(sum(A)));
+    BZTEST(range.result(n).min == min(A));
+    BZTEST(range.result(n).max == max(A));
+    BZTEST(moments.count() == n);
+    BZTEST(fabs(moments.mean() - mean(A)) < 1e-12);
+
+    const double m = mean(A);
+    const double v = sum((A - m) * (A - m)) / n;
+    BZTEST(fabs(moments.variance() - v) < 1e-12);
+    BZTEST(fabs(moments.sampleVariance() - v * n / (n - 1)) < 1e-12);
+    BZTEST(fabs(variance(A) - v) < 1e-12);
+
+    Array<int,1> counts(hist.result(n));
+    BZTEST(counts.extent(firstDim) == 10);
+    BZTEST(sum(counts) + hist.underflow() + hist.overflow() == int(n));
+    BZTEST(counts(5) == count(A >= 0 && A < 0.1));
+    BZTEST(hist.underflow() == count(A < -0.5));
+    BZTEST(hist.overflow() == count(A >= 0.5));
+
+    // An expression, a strided view and an index placeholder give the
+    // same answers
+    ReduceMean<double> m1, m2, m3;
+    ReduceVariance<double> v1, v2, v3;
+    Array<double,2> B(300, 2 * 457);
+    B = 0;
+    B(Range::all(), Range(0, 2*457-2, 2)) = A;
+    multiReduce(2. * A, m1, v1);
+    multiReduce(B(Range::all(), Range(0, 2*457-2, 2)), m2, v2);
+    multiReduce(A + 0 * tensor::i, m3, v3);
+    BZTEST(fabs(m1.result(n) - 2 * m) < 1e-12);
+    BZTEST(fabs(v1.variance() - 4 * v) < 1e-12);
+    BZTEST(fabs(m2.result(n) - m) < 1e-12 && fabs(v2.variance() - v) < 1e-12);
+    BZTEST(fabs(m3.result(n) - m) < 1e-12 && fabs(v3.variance() - v) < 1e-12);
+
+    // A single long row, which is cut into pieces between threads
+    Array<float,1> x(1000003);
+    x = (tensor::i % 7) - 3;
+    ReduceVariance<float> xv;
+    ReduceCount<bool> positive;
+    ReduceMinMax<float> xr;
+    multiReduce(x, xv, xr);
+    multiReduce(x > 0, positive);
+    BZTEST(fabs(xv.mean() - mean(x)) < 1e-6);
+    BZTEST(fabs(xv.variance() - variance(x)) < 1e-4);
+    BZTEST(xr.result(0).min == -3 && xr.result(0).max == 3);
+    BZTEST(positive.result(0) == count(x > 0));
+
+    // Partial reductions over the last rank
+    Array<double,1> M(300), V(300), S(300), L(300);
+    multiReduce(A, tensor::j, M, ReduceMean<double>(),
+        V, ReduceVariance<double>());
+    Array<double,1> M0(300), V0(300);
+    M0 = mean(A, tensor::j);
+    V0 = variance(A, tensor::j);
+    BZTEST(all(fabs(M - M0) < 1e-12));
+    BZTEST(all(fabs(V - V0) < 1e-12));
+
+    multiReduce(A(tensor::i, tensor::j), tensor::j, S, ReduceSum<double>(),
+        L, ReduceMax<double>(), M, ReduceMin<double>());
+    BZTEST(all(fabs(S - sum(A, tensor::j)) < 1e-9));
+    Array<double,1> L0(300), N0(300);
+    L0 = max(A, tensor::j);
+    N0 = min(A, tensor::j);
+    BZTEST(all(L == L0));
+    BZTEST(all(M == N0));
+
+    // Non-zero base
+    Array<int,2> K(Range(1,4), Range(-2,7));
+    K = tensor::i * 10 + tensor::j;
+    Array<int,1> Ks(Range(1,4)), Kmin(Range(1,4));
+    multiReduce(K, tensor::j, Ks, ReduceSum<int>(), Kmin, ReduceMin<int>());
+    BZTEST(Ks(1) == 100 + 25 && Ks(4) == 400 + 25);
+    BZTEST(Kmin(3) == 28);
+
+    // Empty
+    Array<double,2> E(0, 5);
+    ReduceSum<double> es;
+    ReduceVariance<double> ev;
+    BZTEST(multiReduce(E, es, ev) == 0);
+    BZTEST(es.result(0) == 0 && ev.count() == 0);
+
+    return 0;
+}
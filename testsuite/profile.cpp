@@ -0,0 +1,141 @@
+#define BZ_PROFILE_EXPRESSIONS
+
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <sstream>
+
+BZ_USING_NAMESPACE(blitz)
+
+const ExpressionProfileEntry* findEntry(const char* site)
+{
+    const std::vector<ExpressionProfileEntry*>& entries =
+        ExpressionProfiler::instance().entries();
+    for (unsigned i=0; i < entries.size(); ++i)
+        if (entries[i]->site == site)
+            return entries[i];
+    return 0;
+}
+
+int main()
+{
+    ExpressionProfiler& profiler = ExpressionProfiler::instance();
+    profiler.setTracing(true);
+
+    Array<double,1> a(100), b(100), c(100);
+    b = 1.0;
+    c = 2.0;
+
+    {
+        BZ_PROFILE_SITE("unit");
+        for (int i=0; i < 3; ++i)
+            a = b + c;
+    }
+
+    const ExpressionProfileEntry* e = findEntry("unit");
+    BZTEST(e != 0);
+    BZTEST(e->calls == 3);
+    BZTEST(e->elements == 300);
+    BZTEST(e->traversals[stackTraversal] == 3);
+    BZTEST(e->innerLoops[unitStrideLoop] == 3);
+    BZTEST(e->seconds >= 0);
+    BZTEST(e->expression.find("+") != std::string::npos);
+
+    // Every other element: common stride
+    {
+        BZ_PROFILE_SITE("strided");
+        a(Range(0,98,2)) = b(Range(0,98,2)) * 2.0;
+    }
+    e = findEntry("strided");
+    BZTEST(e != 0);
+    BZTEST(e->calls == 1);
+    BZTEST(e->elements == 50);
+    BZTEST(e->innerLoops[unitStrideLoop] == 0);
+    BZTEST(e->innerLoops[commonStrideLoop] == 1);
+
+    // Contiguous 2D arrays are collapsed into one loop; a transposed
+    // operand is not.
+    Array<float,2> A(10,20), B(10,20), C(20,10);
+    B = 1.0f;
+    C = 2.0f;
+    {
+        BZ_PROFILE_SITE("collapsed");
+        A = B * 3.0f;
+    }
+    e = findEntry("collapsed");
+    BZTEST(e != 0);
+    BZTEST(e->traversals[collapsedTraversal] == 1);
+    BZTEST(e->elements == 200);
+
+    {
+        BZ_PROFILE_SITE("transposed");
+        A = C.transpose(secondDim, firstDim);
+    }
+    e = findEntry("transposed");
+    BZTEST(e != 0);
+    BZTEST(e->traversals[stackTraversal] == 1);
+    BZTEST(e->innerLoops[generalStrideLoop] == 1);
+    BZTEST(all(A == 2.0f));
+
+    // Index placeholders are counters in the stack traversal
+    {
+        BZ_PROFILE_SITE("index");
+        a = tensor::i * 0.5;
+    }
+    e = findEntry("index");
+    BZTEST(e != 0);
+#ifdef BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL
+    BZTEST(e->traversals[stackTraversal] == 1);
+    BZTEST(e->innerLoops[unitStrideLoop] == 1);
+#else
+    BZTEST(e->traversals[indexTraversal] == 1);
+#endif
+    BZTEST(a(10) == 5.0);
+
+#if defined(BZ_ARRAY_SPACE_FILLING_TRAVERSAL) && defined(BZ_RUNTIME_TUNING)
+    // Large 3D stencils are traversed in tiles along a curve
+    Array<double,3> S(12,12,12), T(12,12,12);
+    T = 1.0;
+    const Range I(1,10);
+    TuningParameters::instance().setCurveStencilCache(0);
+    {
+        BZ_PROFILE_SITE("curve");
+        S(I,I,I) = T(I,I,I) + T(I-1,I,I) + T(I+1,I,I) + T(I,I-1,I)
+            + T(I,I+1,I) + T(I,I,I-1) + T(I,I,I+1);
+    }
+    e = findEntry("curve");
+    BZTEST(e != 0);
+    BZTEST(e->traversals[spaceFillingTraversal] == 1);
+    BZTEST(e->innerLoops[unitStrideLoop] == 1);
+    BZTEST(S(5,5,5) == 7.0);
+#endif
+
+    // Paused profiler records nothing
+    profiler.setEnabled(false);
+    {
+        BZ_PROFILE_SITE("unit");
+        a = b + c;
+    }
+    profiler.setEnabled(true);
+    BZTEST(findEntry("unit")->calls == 3);
+
+    std::ostringstream table, trace;
+    profiler.printTable(table);
+    profiler.writeChromeTrace(trace);
+    BZTEST(table.str().find("unit: ") != std::string::npos);
+    BZTEST(table.str().find("collapsed") != std::string::npos);
+    BZTEST(trace.str().find("\"traceEvents\"") != std::string::npos);
+#ifdef BZ_ARRAY_INCREMENTAL_INDEX_TRAVERSAL
+    BZTEST(trace.str().find("\"traversal\":\"stack\"") != std::string::npos);
+#else
+    BZTEST(trace.str().find("\"traversal\":\"index\"") != std::string::npos);
+#endif
+
+    profiler.reset();
+    BZTEST(profiler.entries().empty());
+
+    // Entries cached in evaluate() must be looked up again after reset()
+    a = b + c;
+    BZTEST(profiler.entries().size() == 1);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <sstream>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // Read no tuning file
+    setenv("BZ_TUNING_FILE", "", 1);
+    TuningParameters& params = TuningParameters::instance();
+    BZTEST(params.file().empty());
+
+    // Detected machine
+    const MachineInfo& m = params.machine();
+    BZTEST(m.l1CacheSize >= 1024 && m.l1CacheSize <= (1 << 24));
+    BZTEST(m.l2CacheSize == 0 || m.l2CacheSize >= m.l1CacheSize);
+    BZTEST(m.cacheLineSize >= 16 && m.cacheLineSize <= 1024);
+    BZTEST(m.numPackages >= 1 && m.numCores >= m.numPackages);
+    BZTEST(m.numThreads >= m.numCores);
+    BZTEST(params.tiledStencilCache() == m.l1CacheSize);
+    BZTEST(params.stencilTileHeight() == BZ_ARRAY_2D_STENCIL_TILE_SIZE);
+
+    // Tuning files
+    TuningParameters p;
+    p.setTiledStencilCache(12345);
+    p.setStencilTile(8, 512);
+    p.setParallelThreshold(1 << 20);
+    p.setCurveStencilCache(54321);
+    p.setCurveTile(12, hilbertTileOrder);
+    p.machine().l3CacheSize = 1 << 25;
+    std::ostringstream os;
+    p.write(os);
+    TuningParameters q;
+    std::istringstream is(os.str());
+    BZTEST(q.read(is));
+    BZTEST(q.tiledStencilCache() == 12345);
+    BZTEST(q.stencilTileHeight() == 8 && q.stencilTileWidth() == 512);
+    BZTEST(q.parallelThreshold() == (1 << 20));
+    BZTEST(q.curveStencilCache() == 54321);
+    BZTEST(q.curveTileSize() == 12 && q.tileOrder() == hilbertTileOrder);
+    BZTEST(q.machine().l3CacheSize == (1 << 25));
+    BZTEST(q.machine().l1CacheSize == m.l1CacheSize);
+
+    std::istringstream bad("# comment\n\nstencil_tile_width 32\n"
+        "no_such_parameter 1\nparallel_threshold -5\nthreads many\n"
+        "tile_order 3\n");
+    BZTEST(!q.read(bad));
+    BZTEST(q.stencilTileWidth() == 32);
+    BZTEST(q.parallelThreshold() == (1 << 20));
+    BZTEST(q.tileOrder() == hilbertTileOrder);
+
+    // Stencils give the same result with any tiles, tiled or not
+    const int N = 70, M = 90;
+    Array<double,2> A(N, M), B(N, M), C(N, M);
+    B = tensor::i * 0.5 + tensor::j * tensor::j;
+    const Range I(1, N-2), J(1, M-2);
+    C = 0;
+    params.setTiledStencilCache(1 << 30);
+    C(I,J) = B(I,J) + B(I-1,J) + B(I+1,J) + B(I,J-1) + B(I,J+1);
+    const int tiles[][2] = { { 1, 1 }, { 3, 7 }, { 16, 16 }, { 64, 5 },
+        { 100, 200 } };
+    params.setTiledStencilCache(0);
+    for (int t=0; t < 5; ++t)
+    {
+        params.setStencilTile(tiles[t][0], tiles[t][1]);
+        A = 0;
+        A(I,J) = B(I,J) + B(I-1,J) + B(I+1,J) + B(I,J-1) + B(I,J+1);
+        BZTEST(all(A == C));
+    }
+
+    // Scans, in parallel or not
+    Array<double,1> x(1000), s(1000);
+    x = 1;
+    params.setParallelThreshold(1);
+    s = cumsum(x, firstDim);
+    BZTEST(s(999) == 1000);
+    params.setParallelThreshold(1 << 30);
+    s = cumsum(x, firstDim);
+    BZTEST(s(999) == 1000);
+
+    return 0;
+}
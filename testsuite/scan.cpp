@@ -0,0 +1,75 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+int main()
+{
+    // A long line: with OpenMP it is cut between threads
+    const int n = 200001;
+    Array<int,1> a(n);
+    a = tensor::i % 5;
+    Array<long,1> s(cumsum(a, firstDim));
+    BZTEST(s(0) == 0 && s(4) == 10 && s(n-1) == sum(a));
+    BZTEST(all(s(Range(1, n-1)) - s(Range(0, n-2)) == a(Range(1, n-1))));
+
+    Array<long,1> e(cumsum(a, firstDim, exclusiveScan));
+    BZTEST(e(0) == 0 && e(n-1) == sum(a) - a(n-1));
+    BZTEST(all(s - e == a));
+
+    // Along either rank of a row-major array, which is contiguous for
+    // the second and strided for the first
+    Array<double,2> A(Range(1,7), Range(-3,600));
+    A = tensor::i + 0.001 * tensor::j;
+    Array<double,2> C(cumsum(A, secondDim)), R(cumsum(A, firstDim));
+    BZTEST(C.lbound(firstDim) == 1 && C.lbound(secondDim) == -3);
+    BZTEST(fabs(C(3, 600) - sum(A(3, Range::all()))) < 1e-9);
+    BZTEST(fabs(R(7, 10) - sum(A(Range::all(), 10))) < 1e-12);
+    BZTEST(all(fabs(R(Range(2,7), Range::all())
+        - R(Range(1,6), Range::all()) - A(Range(2,7), Range::all())) < 1e-12));
+
+    Array<double,2> RE(cumsum(A, firstDim, exclusiveScan));
+    BZTEST(all(RE(1, Range::all()) == 0));
+    BZTEST(all(fabs(R - RE - A) < 1e-12));
+
+    // Column-major storage swaps the two cases
+    Array<double,2> F(Range(1,7), Range(-3,600), fortranArray);
+    F = A;
+    Array<double,2> RF(cumsum(F, firstDim)), CF(cumsum(F, secondDim));
+    BZTEST(all(fabs(RF - R) < 1e-12));
+    BZTEST(all(fabs(CF - C) < 1e-9));
+
+    // min, max and product, and an expression
+    Array<double,1> x(10);
+    x = 3, 1, 4, 1, 5, 9, 2, 6, 5, 3;
+    Array<double,1> lo(cummin(x, firstDim)), hi(cummax(-x, firstDim));
+    BZTEST(lo(0) == 3 && lo(1) == 1 && lo(9) == 1);
+    BZTEST(hi(0) == -3 && hi(1) == -1 && hi(9) == -1);
+    Array<double,1> p(cumprod(x(Range(0,3)), firstDim));
+    BZTEST(p(0) == 3 && p(1) == 3 && p(2) == 12 && p(3) == 12);
+    Array<double,1> mx(cummax(x, firstDim, exclusiveScan));
+    BZTEST(mx(0) == neghuge(double()) && mx(1) == 3 && mx(6) == 9);
+
+    // In place, and into a view, with a running mean
+    Array<double,3> B(4, 50, 3);
+    B = tensor::i * tensor::j + tensor::k;
+    Array<double,3> B0(B.copy());
+    scan(B, B, secondDim, ReduceSum<double>());
+    BZTEST(B(2, 49, 1) == sum(B0(2, Range::all(), 1)));
+    BZTEST(B(3, 0, 2) == B0(3, 0, 2));
+
+    Array<double,2> M(4, 60);
+    M = -1;
+    scan(M(Range::all(), Range(5, 54)), B0(Range::all(), Range::all(), 0),
+        secondDim, ReduceMean<double>());
+    BZTEST(M(3, 4) == -1 && M(3, 55) == -1);
+    BZTEST(fabs(M(3, 54) - mean(B0(3, Range::all(), 0))) < 1e-12);
+    BZTEST(M(1, 5) == B0(1, 0, 0));
+
+    // Empty
+    Array<int,2> Z(0, 3);
+    Array<long,2> Zs(cumsum(Z, secondDim));
+    BZTEST(Zs.numElements() == 0);
+
+    return 0;
+}
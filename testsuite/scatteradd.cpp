@@ -0,0 +1,111 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <list>
+#include <vector>
+
+BZ_USING_NAMESPACE(blitz)
+
+typedef complex<double> T_complex;
+
+const ScatterAddStrategy strategies[] = { scatterAddAuto, scatterAddSerial,
+    scatterAddPrivate, scatterAddAtomic, scatterAddSorted };
+
+int main()
+{
+    // Deposit with many collisions; integer weights keep the sums exact
+    const int n = 50000;
+    Array<TinyVector<int,2>,1> cell(n);
+    Array<double,1> charge(n);
+    for (int k=0; k < n; ++k)
+    {
+        cell(k) = TinyVector<int,2>((k * 7) % 13, (k % 1000) * (k % 1000) % 17);
+        charge(k) = k % 5 - 2;
+    }
+
+    Array<double,2> expect(13,17);
+    Array<int,2> hits(13,17);
+    expect = 1.;
+    hits = 0;
+    for (int k=0; k < n; ++k)
+    {
+        expect(cell(k)) += charge(k);
+        ++hits(cell(k));
+    }
+
+    for (int s=0; s < 5; ++s)
+    {
+        Array<double,2> rho(13,17);
+        rho = 1.;
+        scatterAdd(rho, cell, charge, strategies[s]);
+        BZTEST(all(rho == expect));
+    }
+
+    // Reusing the sort
+    ScatterPlan<2> plan(expect, cell);
+    BZTEST(plan.size() == unsigned(n));
+    BZTEST(plan.numCells() == count(hits > 0));
+    Array<double,2> rho(13,17);
+    rho = 1.;
+    scatterAdd(rho, plan, charge);
+    BZTEST(all(rho == expect));
+    scatterAdd(rho, plan, charge);
+    BZTEST(all(rho == 2 * expect - 1));
+
+    // Histogram: rank 1, a constant weight, std::vector entries
+    std::vector<int> bin;
+    for (int k=0; k < n; ++k)
+        bin.push_back((k * 31) % 100);
+    for (int s=0; s < 5; ++s)
+    {
+        Array<int,1> hist(100);
+        hist = 0;
+        scatterAdd(hist, bin, 1, strategies[s]);
+        BZTEST(sum(hist) == n);
+        BZTEST(all(hist == n / 100));
+    }
+
+    // A strided view: the private copies are not used, the view's
+    // neighbours are left alone
+    Array<double,2> big(26,17), view(big(Range(0,24,2), Range::all()));
+    for (int s=0; s < 5; ++s)
+    {
+        big = -5.;
+        view = 1.;
+        scatterAdd(view, cell, charge, strategies[s]);
+        BZTEST(all(view == expect));
+        BZTEST(all(big(Range(1,25,2), Range::all()) == -5.));
+    }
+
+    // Fortran storage and a type without atomic adds
+    Array<T_complex,2> F(13, 17, fortranArray);
+    Array<TinyVector<int,2>,1> fcell(n);
+    Array<T_complex,1> fw(n);
+    for (int k=0; k < n; ++k)
+    {
+        fcell(k) = TinyVector<int,2>(cell(k)(0) + 1, cell(k)(1) + 1);
+        fw(k) = T_complex(charge(k), 1);
+    }
+    for (int s=0; s < 5; ++s)
+    {
+        F = 0.;
+        scatterAdd(F, fcell, fw, strategies[s]);
+        BZTEST(F(13,17) == T_complex(expect(12,16) - 1, hits(12,16)));
+        BZTEST(sum(real(F)) == sum(expect) - 13 * 17);
+        BZTEST(sum(imag(F)) == n);
+    }
+
+    // Updates through an IndexPlan: each distinct point once
+    Array<double,2> A(4,4);
+    A = 1.;
+    std::list<TinyVector<int,2> > points;
+    points.push_back(TinyVector<int,2>(1,1));
+    points.push_back(TinyVector<int,2>(2,3));
+    points.push_back(TinyVector<int,2>(1,1));
+    IndexPlan<2> ip(A, points);
+    A[ip] += 2.;
+    BZTEST(A(1,1) == 3. && A(2,3) == 3. && A(0,0) == 1.);
+    A[ip] *= A;
+    BZTEST(A(1,1) == 9. && A(2,3) == 9. && sum(A) == 32.);
+
+    return 0;
+}
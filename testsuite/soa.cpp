@@ -0,0 +1,140 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/array/soa.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+typedef TinyVector<double,3> T_vec;
+typedef complex<double> T_complex;
+
+bool close(T_complex a, T_complex b)
+{
+    return abs(a - b) < 1e-12 * (1 + abs(b));
+}
+
+int main()
+{
+    SoAArray<T_vec,3> A(4,5,6), B(4,5,6), C(4,5,6);
+
+    BZTEST(A.numElements() == 120);
+    BZTEST(A.planeStride() == 120);
+
+    // Component planes are unit-stride views
+    for (int c=0; c < 3; ++c)
+    {
+        BZTEST(A[c].isStorageContiguous());
+        BZTEST(A[c].stride(thirdDim) == 1);
+        BZTEST(A[c].data() == A[0].data() + c * A.planeStride());
+    }
+
+    // Element proxy
+    B = T_vec(1., 2., 3.);
+    B(1,2,3) = T_vec(4., 5., 6.);
+    T_vec v = B(1,2,3);
+    BZTEST(v[0] == 4. && v[1] == 5. && v[2] == 6.);
+    BZTEST(B(1,2,3)[2] == 6.);
+    BZTEST(B[1](1,2,3) == 5.);
+    B(1,2,3)[0] = 7.;
+    BZTEST(B[0](1,2,3) == 7.);
+    BZTEST(B[0](0,0,0) == 1. && B[2](3,4,5) == 3.);
+
+    C[0] = 10.;
+    C[1] = 20.;
+    C[2] = 30.;
+
+    // Whole-vector expressions, evaluated plane by plane
+    A = B + 2. * C;
+    BZTEST(A[0](0,0,0) == 21. && A[1](0,0,0) == 42. && A[2](0,0,0) == 63.);
+    BZTEST(A[0](1,2,3) == 27.);
+
+    A = (A - B) / C;
+    BZTEST(all(A[0] == 2.) && all(A[1] == 2.) && all(A[2] == 2.));
+
+    A *= T_vec(1., 2., 3.);
+    BZTEST(all(A[0] == 2.) && all(A[1] == 4.) && all(A[2] == 6.));
+
+    A += C;
+    A -= 1;
+    BZTEST(all(A[0] == 11.) && all(A[1] == 23.) && all(A[2] == 35.));
+
+    // Conversion to and from interleaved storage
+    Array<T_vec,2> aos(3,4), back(3,4);
+    for (int i=0; i < 3; ++i)
+        for (int j=0; j < 4; ++j)
+            aos(i,j) = T_vec(i, j, i*j);
+
+    SoAArray<T_vec,2> S(aos);
+    BZTEST(S.extent(firstDim) == 3 && S.extent(secondDim) == 4);
+    BZTEST(S[2](2,3) == 6.);
+    T_vec w = S(2,1);
+    BZTEST(w[0] == 2. && w[1] == 1. && w[2] == 2.);
+
+    S.copyTo(back);
+    BZTEST(all(back[0] == aos[0]) && all(back[1] == aos[1])
+        && all(back[2] == aos[2]));
+
+    // Copy construction shares the data, assignment copies it
+    SoAArray<T_vec,2> R(S), Q(3,4);
+    R(0,0) = T_vec(-1., -1., -1.);
+    BZTEST(S[1](0,0) == -1.);
+    Q = S;
+    Q(0,0) = T_vec(5., 5., 5.);
+    BZTEST(S[1](0,0) == -1.);
+
+    // Plane views keep the data alive
+    Array<double,2> plane;
+    {
+        SoAArray<T_vec,2> T(3,4);
+        T = 8.;
+        plane.reference(T[1]);
+    }
+    BZTEST(all(plane == 8.));
+
+    // Fortran storage order is kept within each plane
+    SoAArray<T_vec,2> F(TinyVector<int,2>(3,4), fortranArray);
+    BZTEST(F[0].stride(firstDim) == 1);
+    BZTEST(F[0].lbound(firstDim) == 1);
+    F = T_vec(1., 2., 3.);
+    BZTEST(F(1,1)[1] == 2.);
+
+    // Split complex storage: complex products and quotients
+    SoAArray<T_complex,2> X(3,4), Y(3,4), Z(3,4);
+    Array<double,2> k(3,4);
+    for (int i=0; i < 3; ++i)
+        for (int j=0; j < 4; ++j)
+        {
+            X(i,j) = T_complex(i + 1, j - 2);
+            Y(i,j) = T_complex(0.5 * j - 1, i + 0.25);
+            k(i,j) = i + j;
+        }
+
+    Z = X * Y;
+    BZTEST(close(Z(2,3), T_complex(3,1) * T_complex(0.5,2.25)));
+    Z = X / Y;
+    BZTEST(close(Z(1,0), T_complex(2,-2) / T_complex(-1,1.25)));
+    Z = 2. / Y;
+    BZTEST(close(Z(1,0), 2. / T_complex(-1,1.25)));
+    Z = X * T_complex(0,1) + 1.;
+    BZTEST(close(Z(2,1), T_complex(3,-1) * T_complex(0,1) + 1.));
+
+    // Real fields scale both planes
+    Z = k * X;
+    BZTEST(close(Z(2,3), 5. * T_complex(3,1)));
+    Z = X / k;
+    BZTEST(close(Z(2,3), T_complex(3,1) / 5.));
+
+    // Products which read the destination
+    Z = X;
+    Z *= Y;
+    BZTEST(close(Z(2,3), T_complex(3,1) * T_complex(0.5,2.25)));
+    Z = Z / Y;
+    BZTEST(close(Z(2,3), T_complex(3,1)));
+    Z = conj(X) * X;
+    BZTEST(close(Z(2,3), T_complex(10,0)));
+
+    BZTEST(real(X).data() == X[0].data());
+    BZTEST(all(imag(X) == X[1]));
+    BZTEST(fabs(sum(norm(X)) - sum(real(Z))) < 1e-12);
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+
+BZ_USING_NAMESPACE(blitz)
+
+// Every point of the grid is visited once
+template<int N>
+bool visitsAll(const TinyVector<int,N>& size, TileOrder order)
+{
+    TraversalOrder<N> tiles(size, order);
+    Array<int,N> seen(size);
+    seen = 0;
+    TinyVector<int,N> point;
+    sizeType count = 0;
+    while (tiles.next(point))
+    {
+        for (int d=0; d < N; ++d)
+            if ((point[d] < 0) || (point[d] >= size[d]))
+                return false;
+        ++seen(point);
+        ++count;
+    }
+    return (count == tiles.length()) && (count == 0 || all(seen == 1));
+}
+
+void stencil7(Array<double,3>& A, const Array<double,3>& B)
+{
+    const Range I(B.lbound(0) + 1, B.ubound(0) - 1),
+        J(B.lbound(1) + 1, B.ubound(1) - 1),
+        K(B.lbound(2) + 1, B.ubound(2) - 1);
+    A(I,J,K) = B(I,J,K) + B(I+1,J,K) + B(I-1,J,K) + B(I,J+1,K)
+        + B(I,J-1,K) + B(I,J,K+1) + 2 * B(I,J,K-1);
+}
+
+int main()
+{
+    // Read no tuning file
+    setenv("BZ_TUNING_FILE", "", 1);
+    TuningParameters& params = TuningParameters::instance();
+
+    // Tile orders
+    const TileOrder orders[] = { storageTileOrder, mortonTileOrder,
+        hilbertTileOrder };
+    for (int o=0; o < 3; ++o)
+    {
+        BZTEST(visitsAll(TinyVector<int,2>(5, 3), orders[o]));
+        BZTEST(visitsAll(TinyVector<int,2>(4, 4), orders[o]));
+        BZTEST(visitsAll(TinyVector<int,2>(1, 7), orders[o]));
+        BZTEST(visitsAll(TinyVector<int,2>(0, 3), orders[o]));
+        BZTEST(visitsAll(TinyVector<int,3>(3, 2, 5), orders[o]));
+    }
+
+    TinyVector<int,2> p;
+    TraversalOrder<2> storage(TinyVector<int,2>(3, 2), storageTileOrder);
+    storage.next(p);
+    storage.next(p);
+    BZTEST(p[0] == 1 && p[1] == 0);
+
+    TraversalOrder<2> morton(TinyVector<int,2>(4, 4), mortonTileOrder);
+    morton.next(p);
+    BZTEST(p[0] == 0 && p[1] == 0);
+    morton.next(p);
+    BZTEST(p[0] == 1 && p[1] == 0);
+    morton.next(p);
+    BZTEST(p[0] == 0 && p[1] == 1);
+    morton.next(p);
+    morton.next(p);
+    BZTEST(p[0] == 2 && p[1] == 0);
+
+    // Consecutive points of a Hilbert curve are neighbours
+    TraversalOrder<2> hilbert(TinyVector<int,2>(16, 16), hilbertTileOrder);
+    TinyVector<int,2> q;
+    hilbert.next(q);
+    BZTEST(q[0] == 0 && q[1] == 0);
+    int steps = 0;
+    while (hilbert.next(p))
+    {
+        BZTEST(std::abs(p[0] - q[0]) + std::abs(p[1] - q[1]) == 1);
+        q = p;
+        ++steps;
+    }
+    BZTEST(steps == 255);
+    hilbert.reset();
+    BZTEST(hilbert.next(p) && p[0] == 0 && p[1] == 0);
+
+    // Stencils give the same result in tiles, in any order
+    Array<double,3> B(13, 11, 17), A(13, 11, 17), C(13, 11, 17);
+    B = tensor::i * 100 + tensor::j * tensor::j + tensor::k * 0.5;
+    C = 0;
+    params.setCurveStencilCache(1 << 30);
+    stencil7(C, B);
+    params.setCurveStencilCache(0);
+    const int sizes[] = { 1, 3, 8, 100 };
+    for (int o=0; o < 3; ++o)
+        for (int s=0; s < 4; ++s)
+        {
+            params.setCurveTile(sizes[s], orders[o]);
+            A = 0;
+            stencil7(A, B);
+            BZTEST(all(A == C));
+        }
+
+    // Other storage orders and bases, and updates
+    params.setCurveTile(4, hilbertTileOrder);
+    const TinyVector<int,3> zero(0, 0, 0);
+    Array<double,3> D(Range(-2,10), Range(1,11), Range(5,21),
+        ColumnMajorArray<3>()), E(Range(-2,10), Range(1,11), Range(5,21),
+        ColumnMajorArray<3>());
+    D.reindex(zero) = B;
+    E = 0;
+    stencil7(E, D);
+    BZTEST(all(E.reindex(zero) == C));
+    Array<double,3> F(13, 11, 17);
+    F = 1;
+    const Range I(1,11), J(1,9), K(1,15);
+    F(I,J,K) += B(I,J,K) + B(I+1,J,K) + B(I-1,J,K) + B(I,J+1,K)
+        + B(I,J-1,K) + B(I,J,K+1) + 2 * B(I,J,K-1);
+    BZTEST(all(F(I,J,K) == C(I,J,K) + 1));
+    BZTEST(F(0,0,0) == 1);
+
+    // Rank 4
+    Array<int,4> G(5, 6, 4, 7), H(5, 6, 4, 7), R(5, 6, 4, 7);
+    G = tensor::i * 1000 + tensor::j * 100 + tensor::k * 10 + tensor::l;
+    const Range L(1,5);
+    H = 0;
+    params.setCurveTile(2, mortonTileOrder);
+    H(Range(1,3), Range(1,4), Range(1,2), L) = G(Range(0,2), Range(1,4),
+        Range(1,2), L) + G(Range(2,4), Range(1,4), Range(1,2), L)
+        + G(Range(1,3), Range(0,3), Range(1,2), L)
+        + G(Range(1,3), Range(2,5), Range(1,2), L)
+        + G(Range(1,3), Range(1,4), Range(0,1), L)
+        + G(Range(1,3), Range(1,4), Range(2,3), L)
+        + G(Range(1,3), Range(1,4), Range(1,2), L - 1);
+    R = 0;
+    for (int a=1; a <= 3; ++a)
+        for (int b=1; b <= 4; ++b)
+            for (int c=1; c <= 2; ++c)
+                for (int d=1; d <= 5; ++d)
+                    R(a,b,c,d) = G(a-1,b,c,d) + G(a+1,b,c,d) + G(a,b-1,c,d)
+                        + G(a,b+1,c,d) + G(a,b,c-1,d) + G(a,b,c+1,d)
+                        + G(a,b,c,d-1);
+    BZTEST(all(H == R));
+
+    return 0;
+}
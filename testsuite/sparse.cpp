@@ -0,0 +1,117 @@
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <blitz/sparse.h>
+#include <blitz/array/cgsolve.h>
+#include <algorithm>
+#include <cstdlib>
+
+BZ_USING_NAMESPACE(blitz)
+
+// 7-point Laplacian (plus a diagonal shift) on an n x n x n grid,
+// assembled with duplicate entries for the diagonal.
+void laplacian(SparseMatrix<double>& A, int n)
+{
+    std::vector<SparseTriplet<double> > t;
+    for (int i=0; i < n; ++i)
+    for (int j=0; j < n; ++j)
+    for (int k=0; k < n; ++k)
+    {
+        int row = (i*n + j)*n + k;
+        t.push_back(SparseTriplet<double>(row, row, 6.0));
+        t.push_back(SparseTriplet<double>(row, row, 0.5));
+        if (i > 0)   t.push_back(SparseTriplet<double>(row, row - n*n, -1));
+        if (i < n-1) t.push_back(SparseTriplet<double>(row, row + n*n, -1));
+        if (j > 0)   t.push_back(SparseTriplet<double>(row, row - n, -1));
+        if (j < n-1) t.push_back(SparseTriplet<double>(row, row + n, -1));
+        if (k > 0)   t.push_back(SparseTriplet<double>(row, row - 1, -1));
+        if (k < n-1) t.push_back(SparseTriplet<double>(row, row + 1, -1));
+    }
+    // Shuffle with a fixed seed
+    srand(12345);
+    for (int i=int(t.size()) - 1; i > 0; --i)
+        std::swap(t[i], t[rand() % (i+1)]);
+    A.resize(n*n*n, n*n*n);
+    A.setFromTriplets(t.begin(), t.end());
+}
+
+int main()
+{
+    // Small nonsymmetric matrix, assembled from index arrays
+    Array<int,1> I(6), J(6);
+    Array<double,1> V(6);
+    I = 0, 0, 1, 2, 2, 0;
+    J = 0, 2, 1, 0, 3, 2;
+    V = 1, 2, 3, 4, 5, 10;
+
+    SparseMatrix<double> B(3, 4);
+    B.setFromTriplets(I, J, V);
+    BZTEST(B.nonZeros() == 5);
+    BZTEST(B(0,2) == 12);
+    BZTEST(B(1,1) == 3);
+    BZTEST(B(1,3) == 0);
+
+    Array<double,1> x(4), y(3), z(4);
+    x = 1, 2, 3, 4;
+    B.multiply(x, y);
+    BZTEST(y(0) == 37 && y(1) == 6 && y(2) == 24);
+
+    B.useSlicedEll();
+    BZTEST(B.layout() == SparseMatrix<double>::slicedEll);
+    y = 0;
+    B.multiply(x, y);
+    BZTEST(y(0) == 37 && y(1) == 6 && y(2) == 24);
+
+    y = 1, 2, 3;
+    B.multiplyTranspose(y, z);
+    BZTEST(z(0) == 13 && z(1) == 6 && z(2) == 12 && z(3) == 15);
+
+    // A matrix without nonzeros
+    SparseMatrix<double> E(3, 4);
+    BZTEST(E.nonZeros() == 0);
+    BZTEST(E(2,3) == 0);
+
+    // No columns
+    SparseMatrix<double> Z(3, 0);
+    Z.useSlicedEll();
+    Array<double,1> z0(0), z3(3);
+    z3 = 1;
+    Z.multiply(z0, z3);
+    BZTEST(all(z3 == 0));
+
+    // Strided operands
+    Array<double,1> xs(7), ys(6);
+    xs = 0;
+    xs(Range(0,6,2)) = x;
+    Array<double,1> xv = xs(Range(0,6,2)), yv = ys(Range(1,5,2));
+    B.multiply(xv, yv);
+    BZTEST(yv(0) == 37 && yv(1) == 6 && yv(2) == 24);
+
+    // CSR and sliced-ELL products agree on a stencil matrix
+    const int n = 7, N = n*n*n;
+    SparseMatrix<double> A;
+    laplacian(A, n);
+    BZTEST(A.nonZeros() == 7*N - 6*n*n);
+    BZTEST(A(0,0) == 6.5);
+
+    Array<double,1> u(N), v1(N), v2(N);
+    firstIndex i;
+    u = sin(0.1 * i);
+    A.multiply(u, v1);
+    A.useSlicedEll();
+    A.multiply(u, v2);
+    BZTEST(max(abs(v1 - v2)) < 1e-12);
+    A.multiplyTranspose(u, v2);
+    BZTEST(max(abs(v1 - v2)) < 1e-12);
+
+    // Matrix-free CG on a 3D field through the operator adapter
+    Array<double,3> b(n,n,n), f(n,n,n), r(n,n,n);
+    b = 1.0;
+    f = 0.0;
+    SparseOperator<double> op = sparseOperator(A);
+    int iters = conjugateGradient(op, f, b, 1e-10, 200);
+    BZTEST(iters > 0);
+    op(f, r);
+    BZTEST(max(abs(r - b)) < 1e-8);
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "testsuite.h"
 
 #include <blitz/tinymat.h>
+#include <blitz/tinyvec-et.h>
 
 BZ_USING_NAMESPACE(blitz)
 
@@ -16,6 +17,66 @@ int main()
     BZTEST(A(0,0) == 0);
     BZTEST(A(1,2) == 4);
 
+    // Element-wise expressions
+    TinyMatrix<int,2,3> B, C;
+    B = 1, 1, 1,
+        2, 2, 2;
+    C = A + B * 2 - 1;
+    BZTEST(C(0,0) == 1);
+    BZTEST(C(1,2) == 7);
+    C = -(A - B) / 1;
+    BZTEST(C(0,2) == -1 && C(1,0) == 0);
+    C += A;
+    C *= 2;
+    BZTEST(C(0,2) == 2 && C(1,2) == 4);
+    C -= 1;
+    BZTEST(C(1,2) == 3);
+
+    TinyMatrix<double,2,3> D = A * 0.5;
+    BZTEST(D(1,1) == 1.5);
+
+    // Transpose
+    TinyMatrix<int,3,2> At;
+    At = transpose(A);
+    BZTEST(At(2,0) == 2 && At(0,1) == 2 && At(2,1) == 4);
+    At = transpose(A + B) * 2;
+    BZTEST(At(2,1) == 12);
+
+    // Products
+    TinyMatrix<double,3,3> M, N, P;
+    M = 2, 0, 0,
+        0, 3, 0,
+        1, 0, 1;
+    N = 1, 2, 3,
+        4, 5, 6,
+        7, 8, 9;
+    P = product(M, N);
+    BZTEST(P(0,2) == 6 && P(1,1) == 15 && P(2,0) == 8);
+    P = product(M, N) + M;
+    BZTEST(P(0,0) == 4 && P(2,0) == 9);
+    P = product(transpose(N), M - M);
+    BZTEST(P(1,2) == 0);
+    P = product(transpose(M), N);
+    BZTEST(P(0,0) == 9 && P(2,2) == 9);
+
+    // Operands may read the matrix assigned to
+    P = N;
+    P = transpose(P);
+    BZTEST(P(0,2) == 7 && P(2,0) == 3);
+    P = product(M, P);
+    BZTEST(P(0,0) == 2 && P(2,2) == 16);
+    P += transpose(P);
+    BZTEST(P(2,0) == 18 && P(0,2) == 18);
+
+    TinyVector<double,3> x(1, 2, 3), y;
+    y = product(M, x);
+    BZTEST(y(0) == 2 && y(1) == 6 && y(2) == 4);
+    y = product(x, M);
+    BZTEST(y(0) == 5 && y(1) == 6 && y(2) == 3);
+    y = product(transpose(M), x);
+    BZTEST(y(0) == 5 && y(1) == 6 && y(2) == 3);
+    y = product(x, M * 2);
+    BZTEST(y(0) == 10);
+
     return 0;
 }
-
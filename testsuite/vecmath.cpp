@@ -0,0 +1,104 @@
+#define BZ_VECMATH
+
+#include "testsuite.h"
+#include <blitz/array.h>
+#include <limits>
+
+BZ_USING_NAMESPACE(blitz)
+
+// Within n units in the last place of b
+bool close(double a, double b, double n)
+{
+    return std::fabs(a - b)
+        <= n * numeric_limits<double>::epsilon() * std::fabs(b);
+}
+
+bool close(float a, float b, float n)
+{
+    return std::fabs(a - b)
+        <= n * numeric_limits<float>::epsilon() * std::fabs(b);
+}
+
+// The same zero, infinity or NaN, or close to a finite nonzero value
+bool same(double a, double b)
+{
+    if (a != a)
+        return b != b;
+    if ((b == 0) || (std::fabs(b) == numeric_limits<double>::infinity()))
+        return (a == b) && ((1 / a > 0) == (1 / b > 0));
+    return close(a, b, 1);
+}
+
+int main()
+{
+    const int N = 1000;
+    Array<double,1> x(N), y(N), e(N), l(N), s(N), c(N), p(N);
+    for (int i=0; i < N; ++i)
+    {
+        x(i) = -700 + 1.4 * i + 0.001 * (i % 7);
+        y(i) = pow(10.0, -300 + 0.6 * i) * (1 + 0.1 * (i % 3));
+    }
+
+    e = exp(x);
+    l = log(y);
+    s = sin(x);
+    c = cos(x);
+    p = pow(y, 0.37);
+    for (int i=0; i < N; ++i)
+    {
+        BZTEST(close(e(i), std::exp(x(i)), 1));
+        BZTEST(close(l(i), std::log(y(i)), 1));
+        BZTEST(close(s(i), std::sin(x(i)), 1));
+        BZTEST(close(c(i), std::cos(x(i)), 1));
+        BZTEST(close(p(i), std::pow(y(i), 0.37), 1));
+    }
+
+    // Mixed expressions, and updates
+    e = 1;
+    e *= exp(-0.01 * x) * cos(x);
+    for (int i=0; i < N; ++i)
+        BZTEST(close(e(i), std::exp(-0.01 * x(i)) * std::cos(x(i)), 4));
+
+    // Floats
+    Array<float,1> xf(N), ef(N), lf(N);
+    xf = cast<float>(x) / 10;
+    ef = exp(xf);
+    lf = log(exp(xf));
+    for (int i=0; i < N; ++i)
+    {
+        BZTEST(close(ef(i), std::exp(xf(i)), 1.f));
+        BZTEST(close(lf(i), std::log(std::exp(xf(i))), 1.f));
+    }
+
+    // Special values follow C99 Annex F
+    const double inf = numeric_limits<double>::infinity();
+    const double nan = numeric_limits<double>::quiet_NaN();
+    const double special[] = { 0.0, -0.0, 1.0, -1.0, 0.5, -2.0, 3.0,
+        inf, -inf, nan, 4.9e-324, 710.0, -746.0 };
+    const int M = sizeof(special) / sizeof(special[0]);
+    Array<double,1> a(M), b(M), r(M);
+    for (int i=0; i < M; ++i)
+        a(i) = special[i];
+
+    r = exp(a);
+    for (int i=0; i < M; ++i)
+        BZTEST(same(r(i), std::exp(a(i))));
+    r = log(a);
+    for (int i=0; i < M; ++i)
+        BZTEST(same(r(i), std::log(a(i))));
+    r = sin(a);
+    for (int i=0; i < M; ++i)
+        BZTEST(same(r(i), std::sin(a(i))));
+    r = cos(a);
+    for (int i=0; i < M; ++i)
+        BZTEST(same(r(i), std::cos(a(i))));
+    for (int j=0; j < M; ++j)
+    {
+        b = special[j];
+        r = pow(a, b);
+        for (int i=0; i < M; ++i)
+            BZTEST(same(r(i), std::pow(a(i), b(i))));
+    }
+
+    return 0;
+}
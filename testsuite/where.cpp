@@ -27,6 +27,26 @@ int main()
     Array<int,1> F ( where(A > 0, pow2(B), pow2(C)) ); 
     BZTEST(count(D == E) == N);
 
+    // Integer division on the side not taken must not be evaluated
+    D = where(B != 0, C / B, -1);
+    E = -1, 11, 6, 4, 3;
+    BZTEST(count(D == E) == N);
+
+    // Nor inside a floating-point expression
+    Array<double,1> R(N);
+    R = where(B != 0, cast<double>(C / B), -1.);
+    BZTEST(R(0) == -1. && R(1) == 11. && R(4) == 3.);
+
+    // Floating point: both sides are computed, then one is selected
+    Array<double,2> X(7,9), Y(7,9);
+    for (int i=0; i < 7; ++i)
+        for (int j=0; j < 9; ++j)
+            X(i,j) = (i * 9 + j) % 4;
+    Y = where(X != 0., 1. / X, X - 5.);
+    BZTEST(Y(0,0) == -5. && Y(0,1) == 1. && Y(0,2) == 0.5);
+    BZTEST(count(Y == -5.) == count(X == 0.));
+    BZTEST(sum(where(X > 1., X, 0.)) == sum(X) - count(X == 1.));
+
     TinyVector<int,3> a(1,2,3);
     TinyVector<int,3> b(3,2,1);
     TinyVector<int,3> c(0,0,0);